@@ -49,6 +49,50 @@ extern "C" {
  */
 typedef struct secp256k1_context_struct secp256k1_context;
 
+/** Opaque data structure that holds rewritable "scratch space"
+ *
+ *  The purpose of this structure is to let the caller provide and reuse the
+ *  memory that functions operating on many points at once (e.g.,
+ *  secp256k1_ecmult_multi) need for intermediate results, instead of
+ *  having the library allocate it internally on every call.
+ *
+ *  Unlike the context object, this cannot safely be shared between threads
+ *  without additional synchronization logic.
+ */
+typedef struct secp256k1_scratch_space_struct secp256k1_scratch_space;
+
+/** Opaque data structure that holds a public key together with precomputed
+ *  tables that make verifying signatures for it faster.
+ *
+ *  Preparing a public key takes about as long as 40 signature verifications
+ *  and uses about 64 kB of memory, so it pays off for keys that many
+ *  signatures are verified with. A prepared public key is not modified after
+ *  it has been created, so it can be used from multiple threads at once.
+ */
+typedef struct secp256k1_prepared_pubkey_struct secp256k1_prepared_pubkey;
+
+/** Opaque data structure that holds a precomputed table for multiplying secret
+ *  scalars with a fixed generator other than the secp256k1 base point, such as
+ *  the second generator of Pedersen commitments.
+ *
+ *  Multiplications with a prepared generator are constant time and blinded in
+ *  the same way as public key generation, and about as fast. Preparing a
+ *  generator takes a fraction of a millisecond and uses about 22 kB of memory
+ *  (with the default build configuration). A prepared generator that is not
+ *  being randomized can be used from multiple threads at once.
+ */
+typedef struct secp256k1_prepared_generator_struct secp256k1_prepared_generator;
+
+/** Opaque data structure that holds precomputed tables for a fixed list of
+ *  points, for computing multi-scalar multiplications with these points many
+ *  times with changing scalars.
+ *
+ *  The tables take about 4 kB of memory per point. Fixed bases are not
+ *  modified after they have been created, so they can be used from multiple
+ *  threads at once.
+ */
+typedef struct secp256k1_fixed_bases_struct secp256k1_fixed_bases;
+
 /** Opaque data structure that holds a parsed and valid public key.
  *
  *  The exact representation of data inside is implementation defined and not
@@ -75,6 +119,20 @@ typedef struct secp256k1_ecdsa_signature {
     unsigned char data[64];
 } secp256k1_ecdsa_signature;
 
+/** Opaque data structure that holds the SHA256 state after hashing
+ *  SHA256(tag)||SHA256(tag) for a tag, so that tagged hashes with this tag
+ *  do not need to hash the tag again.
+ *
+ *  The exact representation of data inside is implementation defined and not
+ *  guaranteed to be portable between different platforms or versions. It is
+ *  however guaranteed to be 32 bytes in size, and can be safely copied/moved.
+ *  It is not modified by secp256k1_tagged_sha256_with_midstate, so it can be
+ *  used from multiple threads at once.
+ */
+typedef struct secp256k1_tagged_sha256_midstate {
+    unsigned char data[32];
+} secp256k1_tagged_sha256_midstate;
+
 /** A pointer to a function to deterministically generate a nonce.
  *
  * Returns: 1 if a nonce was successfully generated. 0 will cause signing to fail.
@@ -284,11 +342,76 @@ SECP256K1_API secp256k1_context *secp256k1_context_create(
     unsigned int flags
 ) SECP256K1_WARN_UNUSED_RESULT;
 
+/** Create a secp256k1 context object with custom precomputed tables for verification.
+ *
+ *  Like secp256k1_context_create, but the tables of multiples of the generator used
+ *  by signature verification and public key recovery are computed for the given
+ *  window size instead of using the ones compiled into the library (whose window
+ *  size is set by the ECMULT_WINDOW_SIZE build option, 15 by default). Every
+ *  increase of the window by one doubles the memory used by the tables, which is
+ *  2^(ecmult_window+5) bytes on most platforms, and the time needed to compute them,
+ *  and saves a few point additions per verification. Window sizes in the range
+ *  [17..22] make sense for applications verifying many signatures over the lifetime
+ *  of a context.
+ *
+ *  This function calls malloc twice, once for the context and once for the tables.
+ *  No tables are computed if ecmult_window equals the compiled-in window size.
+ *  Contexts created by secp256k1_context_preallocated_clone from the returned context
+ *  use the compiled-in tables.
+ *
+ *  Returns: pointer to a newly created context object, or NULL if ecmult_window is
+ *           not in the range [2..24].
+ *  In:      flags:         Always set to SECP256K1_CONTEXT_NONE.
+ *           ecmult_window: window size of the tables.
+ */
+SECP256K1_API secp256k1_context *secp256k1_context_create_with_ecmult_window(
+    unsigned int flags,
+    unsigned int ecmult_window
+) SECP256K1_WARN_UNUSED_RESULT;
+
+/** Create a secp256k1 context object with a custom comb table for signing.
+ *
+ *  Like secp256k1_context_create, but the table of multiples of the generator used
+ *  by signing, public key generation and other computations involving secret keys
+ *  is computed for the given comb parameters instead of using the one compiled into
+ *  the library (which is set by the ECMULT_GEN_KB build option). The table holds
+ *  blocks * 2^(teeth-1) entries of 64 bytes on most platforms. A multiplication
+ *  performs blocks * ceil(256 / (blocks * teeth)) point additions, each of which
+ *  scans all 2^(teeth-1) entries of a block to keep the computation constant time.
+ *  Therefore, more teeth quickly stop paying off, and it depends on the platform
+ *  whether a table larger than the compiled-in one (11 blocks of 6 teeth by default)
+ *  is any faster; benchmark before choosing, e.g., 43 blocks of 6 teeth (86 kB) or
+ *  37 blocks of 7 teeth (148 kB). Blinding (see secp256k1_context_randomize) works
+ *  as for any other context.
+ *
+ *  This function calls malloc twice, once for the context and once for the table,
+ *  and once more temporarily while computing the table. No table is computed if the
+ *  parameters equal the compiled-in ones. Contexts created by
+ *  secp256k1_context_preallocated_clone from the returned context use the compiled-in
+ *  table.
+ *
+ *  Returns: pointer to a newly created context object, or NULL if the parameters are
+ *           invalid.
+ *  In:      flags:  Always set to SECP256K1_CONTEXT_NONE.
+ *           blocks: number of blocks of the comb, in the range [1..256].
+ *           teeth:  number of teeth of the comb, in the range [1..12]. Parameters
+ *                   for which fewer blocks or teeth cover all 256 bits of a scalar
+ *                   are rejected.
+ */
+SECP256K1_API secp256k1_context *secp256k1_context_create_with_ecmult_gen_comb(
+    unsigned int flags,
+    unsigned int blocks,
+    unsigned int teeth
+) SECP256K1_WARN_UNUSED_RESULT;
+
 /** Copy a secp256k1 context object (into dynamically allocated memory).
  *
  *  This function uses malloc to allocate memory. It is guaranteed that malloc is
- *  called at most once for every call of this function. If you need to avoid dynamic
- *  memory allocation entirely, see the functions in secp256k1_preallocated.h.
+ *  called at most once for every call of this function, unless ctx was created by
+ *  secp256k1_context_create_with_ecmult_window or
+ *  secp256k1_context_create_with_ecmult_gen_comb, in which case its tables are
+ *  copied with further calls. If you need to avoid dynamic memory allocation entirely, see
+ *  the functions in secp256k1_preallocated.h.
  *
  *  Cloning secp256k1_context_static is not possible, and should not be emulated by
  *  the caller (e.g., using memcpy). Create a new context instead.
@@ -304,8 +427,9 @@ SECP256K1_API secp256k1_context *secp256k1_context_clone(
  *
  *  The context pointer may not be used afterwards.
  *
- *  The context to destroy must have been created using secp256k1_context_create
- *  or secp256k1_context_clone. If the context has instead been created using
+ *  The context to destroy must have been created using secp256k1_context_create,
+ *  secp256k1_context_create_with_ecmult_window,
+ *  secp256k1_context_create_with_ecmult_gen_comb or secp256k1_context_clone. If the context has instead been created using
  *  secp256k1_context_preallocated_create or secp256k1_context_preallocated_clone, the
  *  behaviour is undefined. In that case, secp256k1_context_preallocated_destroy must
  *  be used instead.
@@ -389,6 +513,31 @@ SECP256K1_API void secp256k1_context_set_error_callback(
     const void *data
 ) SECP256K1_ARG_NONNULL(1);
 
+/** Create a secp256k1 scratch space object.
+ *
+ *  Returns: a newly created scratch space, or NULL if the allocation failed
+ *           (after calling the error callback).
+ *  Args: ctx:  pointer to a context object.
+ *  In:   size: amount of memory to be available as scratch space. Some extra
+ *              (<100 bytes) will be allocated for extra accounting.
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT secp256k1_scratch_space *secp256k1_scratch_space_create(
+    const secp256k1_context *ctx,
+    size_t size
+) SECP256K1_ARG_NONNULL(1);
+
+/** Destroy a secp256k1 scratch space.
+ *
+ *  The pointer may not be used afterwards.
+ *  Args:     ctx: pointer to a context object.
+ *        scratch: space to destroy (can be NULL, in which case this function
+ *                 is a no-op).
+ */
+SECP256K1_API void secp256k1_scratch_space_destroy(
+    const secp256k1_context *ctx,
+    secp256k1_scratch_space *scratch
+) SECP256K1_ARG_NONNULL(1);
+
 /** Parse a variable-length public key into the pubkey object.
  *
  *  Returns: 1 if the public key was fully valid.
@@ -570,6 +719,88 @@ SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ecdsa_verify(
     const secp256k1_pubkey *pubkey
 ) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4);
 
+/** Verify many independent ECDSA signatures.
+ *
+ *  This gives the same results as calling secp256k1_ecdsa_verify for every
+ *  signature, but shares the modular inversions of the s values between
+ *  signatures and computes the multiplications of several signatures at once,
+ *  which makes it faster per signature. Unlike batch verification, the result
+ *  of every signature is reported individually.
+ *
+ *  Returns: 1: all signatures are correct (or n_sigs is 0)
+ *           0: at least one signature is incorrect or unparseable
+ *  Args:    ctx:        pointer to a context object
+ *  Out:     results:    pointer to an array of n_sigs integers which are set
+ *                       to 1 if the i-th signature is correct and to 0
+ *                       otherwise (can be NULL)
+ *  In:      sigs:       array of pointers to the signatures being verified.
+ *           msghash32s: array of pointers to the 32-byte message hashes being
+ *                       verified. See secp256k1_ecdsa_verify for how they must
+ *                       be computed.
+ *           pubkeys:    array of pointers to initialized public keys to verify
+ *                       with.
+ *           n_sigs:     number of signatures, i.e., the length of the arrays
+ *                       above (the arrays can be NULL if n_sigs is 0).
+ *
+ * As with secp256k1_ecdsa_verify, only signatures in lower-S form are
+ * accepted.
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ecdsa_verify_many(
+    const secp256k1_context *ctx,
+    int *results,
+    const secp256k1_ecdsa_signature * const *sigs,
+    const unsigned char * const *msghash32s,
+    const secp256k1_pubkey * const *pubkeys,
+    size_t n_sigs
+) SECP256K1_ARG_NONNULL(1);
+
+/** Prepare a public key for verifying many signatures.
+ *
+ *  Returns: a newly created prepared public key, or NULL if memory could not be
+ *           allocated.
+ *  Args:    ctx: pointer to a context object.
+ *  In:   pubkey: pointer to an initialized public key.
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT secp256k1_prepared_pubkey *secp256k1_prepared_pubkey_create(
+    const secp256k1_context *ctx,
+    const secp256k1_pubkey *pubkey
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2);
+
+/** Destroy a prepared public key.
+ *
+ *  The pointer may not be used afterwards.
+ *  Args:      ctx: pointer to a context object.
+ *        prepared: pointer to the prepared public key to destroy (can be NULL,
+ *                  in which case this function is a no-op).
+ */
+SECP256K1_API void secp256k1_prepared_pubkey_destroy(
+    const secp256k1_context *ctx,
+    secp256k1_prepared_pubkey *prepared
+) SECP256K1_ARG_NONNULL(1);
+
+/** Verify an ECDSA signature with a prepared public key.
+ *
+ *  Like secp256k1_ecdsa_verify, but takes a public key prepared with
+ *  secp256k1_prepared_pubkey_create, which makes verification faster.
+ *
+ *  Returns: 1: correct signature
+ *           0: incorrect or unparseable signature
+ *  Args:    ctx:       pointer to a context object
+ *  In:      sig:       the signature being verified.
+ *           msghash32: the 32-byte message hash being verified (see
+ *                      secp256k1_ecdsa_verify).
+ *           prepared:  pointer to the prepared public key to verify with.
+ *
+ * As with secp256k1_ecdsa_verify, only signatures in lower-S form are
+ * accepted.
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ecdsa_verify_prepared(
+    const secp256k1_context *ctx,
+    const secp256k1_ecdsa_signature *sig,
+    const unsigned char *msghash32,
+    const secp256k1_prepared_pubkey *prepared
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4);
+
 /** Convert a signature to a normalized lower-S form.
  *
  *  Returns: 1 if sigin was not normalized, 0 if it already was.
@@ -851,6 +1082,74 @@ SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_context_randomize(
     const unsigned char *seed32
 ) SECP256K1_ARG_NONNULL(1);
 
+/** Prepare a generator for multiplying secret scalars with it.
+ *
+ *  The returned prepared generator is not randomized. As for contexts, it is
+ *  highly recommended to call secp256k1_prepared_generator_randomize on it
+ *  before using it with secret scalars.
+ *
+ *  Returns: a newly created prepared generator, or NULL if memory could not be
+ *           allocated.
+ *  Args:    ctx:       pointer to a context object.
+ *  In:      generator: pointer to an initialized public key holding the
+ *                      generator. Its discrete logarithm with respect to the
+ *                      base point does not need to be known.
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT secp256k1_prepared_generator *secp256k1_prepared_generator_create(
+    const secp256k1_context *ctx,
+    const secp256k1_pubkey *generator
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2);
+
+/** Destroy a prepared generator.
+ *
+ *  The pointer may not be used afterwards.
+ *  Args:      ctx: pointer to a context object.
+ *        prepared: pointer to the prepared generator to destroy (can be NULL,
+ *                  in which case this function is a no-op).
+ */
+SECP256K1_API void secp256k1_prepared_generator_destroy(
+    const secp256k1_context *ctx,
+    secp256k1_prepared_generator *prepared
+) SECP256K1_ARG_NONNULL(1);
+
+/** Randomizes a prepared generator to provide enhanced protection against
+ *  side-channel leakage.
+ *
+ *  This is the counterpart of secp256k1_context_randomize for multiplications
+ *  with a prepared generator; see its documentation for details.
+ *
+ *  Returns: 1: randomization successful
+ *           0: error
+ *  Args:    ctx:       pointer to a context object.
+ *  In/Out:  prepared:  pointer to the prepared generator to randomize.
+ *  In:      seed32:    pointer to a 32-byte random seed (NULL resets to initial state).
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_prepared_generator_randomize(
+    const secp256k1_context *ctx,
+    secp256k1_prepared_generator *prepared,
+    const unsigned char *seed32
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2);
+
+/** Multiply a prepared generator by a secret scalar.
+ *
+ *  Computes scalar32 times the generator in constant time, like
+ *  secp256k1_ec_pubkey_create does for the base point.
+ *
+ *  Returns: 1: scalar was valid, result stores the product.
+ *           0: scalar was zero or not less than the group order (the result
+ *              is set to an invalid value).
+ *  Args:    ctx:      pointer to a context object.
+ *  Out:     result:   pointer to a public key object for the product.
+ *  In:      scalar32: pointer to a 32-byte big-endian scalar.
+ *           prepared: pointer to the prepared generator.
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_prepared_generator_mul(
+    const secp256k1_context *ctx,
+    secp256k1_pubkey *result,
+    const unsigned char *scalar32,
+    const secp256k1_prepared_generator *prepared
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4);
+
 /** Add a number of public keys together.
  *
  *  Returns: 1: the sum of the public keys is valid.
@@ -867,6 +1166,298 @@ SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ec_pubkey_combine(
     size_t n
 ) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
 
+/** Return the scratch space size needed by secp256k1_ecmult_multi.
+ *
+ *  A scratch space of the returned size (passed as the size argument of
+ *  secp256k1_scratch_space_create) is sufficient to process up to n_points
+ *  points in a single pass of the fastest algorithm. Smaller scratch spaces
+ *  work as well, but the points are then processed in several passes.
+ *
+ *  Returns: the required size in bytes.
+ *  In:  n_points: the number of points.
+ */
+SECP256K1_API size_t secp256k1_ecmult_multi_scratch_size(
+    size_t n_points
+) SECP256K1_WARN_UNUSED_RESULT;
+
+/** Compute a multi-scalar multiplication sum(scalars[i]*points[i]) + g_scalar*G.
+ *
+ *  Depending on the number of points and the available scratch space, this uses
+ *  Strauss' or Pippenger's algorithm, which is much faster than multiplying
+ *  and adding the points one by one.
+ *
+ *  This function is not constant-time and must not be used with secret scalars.
+ *
+ *  Returns: 1: the result is valid.
+ *           0: a scalar overflowed (is not less than the group order) or the
+ *              result is the point at infinity.
+ *  Args:        ctx: pointer to a context object.
+ *           scratch: scratch space to use for intermediate results (can be
+ *                    NULL, in which case the points are multiplied one by one).
+ *  Out:      result: pointer to a public key object for placing the result.
+ *  In:   g_scalar32: pointer to a 32-byte scalar to multiply the generator with
+ *                    (can be NULL, which is equivalent to a zero scalar).
+ *         scalars32: array of pointers to 32-byte scalars (can be NULL if
+ *                    n_points is 0).
+ *            points: array of pointers to public keys (can be NULL if n_points
+ *                    is 0).
+ *          n_points: the number of scalars and points.
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ecmult_multi(
+    const secp256k1_context *ctx,
+    secp256k1_scratch_space *scratch,
+    secp256k1_pubkey *result,
+    const unsigned char *g_scalar32,
+    const unsigned char * const *scalars32,
+    const secp256k1_pubkey * const *points,
+    size_t n_points
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(3);
+
+/** Compute a multi-scalar multiplication like secp256k1_ecmult_multi, reading
+ *  the scalars and points from contiguous arrays.
+ *
+ *  This avoids setting up arrays of pointers to the scalars and points. The
+ *  scratch space sizes returned by secp256k1_ecmult_multi_scratch_size apply.
+ *
+ *  This function is not constant-time and must not be used with secret scalars.
+ *
+ *  Returns: 1: the result is valid.
+ *           0: a scalar overflowed (is not less than the group order) or the
+ *              result is the point at infinity.
+ *  Args:        ctx: pointer to a context object.
+ *           scratch: scratch space to use for intermediate results (can be
+ *                    NULL, in which case the points are multiplied one by one).
+ *  Out:      result: pointer to a public key object for placing the result.
+ *  In:   g_scalar32: pointer to a 32-byte scalar to multiply the generator with
+ *                    (can be NULL, which is equivalent to a zero scalar).
+ *         scalars32: pointer to n_points consecutive 32-byte scalars, i.e.,
+ *                    32*n_points bytes (can be NULL if n_points is 0).
+ *            points: pointer to an array of n_points public keys (can be NULL
+ *                    if n_points is 0).
+ *          n_points: the number of scalars and points.
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ecmult_multi_array(
+    const secp256k1_context *ctx,
+    secp256k1_scratch_space *scratch,
+    secp256k1_pubkey *result,
+    const unsigned char *g_scalar32,
+    const unsigned char *scalars32,
+    const secp256k1_pubkey *points,
+    size_t n_points
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(3);
+
+/** Precompute tables for multi-scalar multiplications with a fixed list of points.
+ *
+ *  Building the tables takes about as long as two multiplications of each
+ *  point with a scalar.
+ *
+ *  Returns: a newly created fixed bases object, or NULL if a point is invalid,
+ *           there are too many points for the size of the tables to fit into
+ *           a size_t, or memory could not be allocated.
+ *  Args:    ctx:      pointer to a context object.
+ *  In:      points:   pointer to an array of n_points public keys.
+ *           n_points: the number of points (must be at least 1).
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT secp256k1_fixed_bases *secp256k1_fixed_bases_create(
+    const secp256k1_context *ctx,
+    const secp256k1_pubkey *points,
+    size_t n_points
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2);
+
+/** Destroy a fixed bases object.
+ *
+ *  The pointer may not be used afterwards.
+ *  Args:   ctx: pointer to a context object.
+ *        bases: pointer to the fixed bases object to destroy (can be NULL, in
+ *               which case this function is a no-op).
+ */
+SECP256K1_API void secp256k1_fixed_bases_destroy(
+    const secp256k1_context *ctx,
+    secp256k1_fixed_bases *bases
+) SECP256K1_ARG_NONNULL(1);
+
+/** Return the scratch space size needed by secp256k1_ecmult_multi_fixed.
+ *
+ *  For fewer than several hundred points, this is larger than what
+ *  secp256k1_ecmult_multi_scratch_size returns, because the digits of the
+ *  scalars of all points are held at once. With less scratch space, the points
+ *  are processed in batches, each of which repeats the doublings.
+ *
+ *  Returns: the required size in bytes.
+ *  In:  n_points: the number of points of the fixed bases object.
+ */
+SECP256K1_API size_t secp256k1_ecmult_multi_fixed_scratch_size(
+    size_t n_points
+) SECP256K1_WARN_UNUSED_RESULT;
+
+/** Compute a multi-scalar multiplication sum(scalars[i]*points[i]) + g_scalar*G
+ *  with the points of a fixed bases object.
+ *
+ *  For up to several hundred points, this takes about 20% to 40% less time
+ *  than secp256k1_ecmult_multi_array, as the multiples of the points are looked
+ *  up in the precomputed tables instead of being computed, and most doublings
+ *  are avoided. For more points, it is as fast as secp256k1_ecmult_multi_array. A
+ *  scratch space of the size returned by secp256k1_ecmult_multi_fixed_scratch_size
+ *  for the number of points is sufficient to process all points at once.
+ *
+ *  This function is not constant-time and must not be used with secret scalars.
+ *
+ *  Returns: 1: the result is valid.
+ *           0: a scalar overflowed (is not less than the group order) or the
+ *              result is the point at infinity.
+ *  Args:        ctx: pointer to a context object.
+ *           scratch: scratch space to use for intermediate results (can be
+ *                    NULL, in which case the points are processed one by one).
+ *  Out:      result: pointer to a public key object for placing the result.
+ *  In:   g_scalar32: pointer to a 32-byte scalar to multiply the generator with
+ *                    (can be NULL, which is equivalent to a zero scalar).
+ *         scalars32: pointer to consecutive 32-byte scalars, one for every
+ *                    point of bases.
+ *             bases: pointer to the fixed bases object.
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ecmult_multi_fixed(
+    const secp256k1_context *ctx,
+    secp256k1_scratch_space *scratch,
+    secp256k1_pubkey *result,
+    const unsigned char *g_scalar32,
+    const unsigned char *scalars32,
+    const secp256k1_fixed_bases *bases
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(5) SECP256K1_ARG_NONNULL(6);
+
+/** A pointer to a function that runs the tasks of secp256k1_ecmult_multi_parallel.
+ *
+ *  It must call task(task_data, i) exactly once for every i in [0, n_tasks), for
+ *  example by handing the calls to the threads of a thread pool, and may only
+ *  return after all of these calls have returned.
+ *
+ *  In:  task:      the function to call.
+ *       task_data: the first argument to pass to task.
+ *       n_tasks:   the number of calls.
+ *       data:      the runner_data passed to secp256k1_ecmult_multi_parallel.
+ */
+typedef void (*secp256k1_task_runner)(
+    void (*task)(void *task_data, size_t idx),
+    void *task_data,
+    size_t n_tasks,
+    void *data
+);
+
+/** Return the scratch space size needed by secp256k1_ecmult_multi_parallel.
+ *
+ *  Like secp256k1_ecmult_multi_scratch_size, but makes room for every one of
+ *  n_tasks tasks to process its share of the points in a single pass.
+ *
+ *  Returns: the required size in bytes.
+ *  In:  n_points: the number of points.
+ *       n_tasks:  the number of tasks.
+ */
+SECP256K1_API size_t secp256k1_ecmult_multi_parallel_scratch_size(
+    size_t n_points,
+    size_t n_tasks
+) SECP256K1_WARN_UNUSED_RESULT;
+
+/** Compute a multi-scalar multiplication like secp256k1_ecmult_multi, splitting
+ *  the work into tasks that can run in parallel.
+ *
+ *  The points are split into up to n_tasks ranges of consecutive points, each of
+ *  which is multiplied by a separate task using its own share of the scratch
+ *  space, and the partial results are added up. Ranges are kept large enough for
+ *  Pippenger's algorithm, so fewer tasks are used for small inputs, and all work
+ *  is done by the calling thread if scratch is NULL. The tasks are run by calling
+ *  runner once. Since they may run concurrently, the callbacks of ctx may be
+ *  called from several threads.
+ *
+ *  This function is not constant-time and must not be used with secret scalars.
+ *
+ *  Returns: 1: the result is valid.
+ *           0: a scalar overflowed (is not less than the group order) or the
+ *              result is the point at infinity.
+ *  Args:        ctx: pointer to a context object.
+ *           scratch: scratch space to share between the tasks (can be NULL).
+ *  Out:      result: pointer to a public key object for placing the result.
+ *  In:   g_scalar32: pointer to a 32-byte scalar to multiply the generator with
+ *                    (can be NULL, which is equivalent to a zero scalar).
+ *         scalars32: array of pointers to 32-byte scalars (can be NULL if
+ *                    n_points is 0).
+ *            points: array of pointers to public keys (can be NULL if n_points
+ *                    is 0).
+ *          n_points: the number of scalars and points.
+ *            runner: pointer to a function that runs the tasks.
+ *       runner_data: arbitrary data passed to runner (can be NULL).
+ *           n_tasks: the maximum number of tasks, e.g., the number of threads
+ *                    (must be at least 1).
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ecmult_multi_parallel(
+    const secp256k1_context *ctx,
+    secp256k1_scratch_space *scratch,
+    secp256k1_pubkey *result,
+    const unsigned char *g_scalar32,
+    const unsigned char * const *scalars32,
+    const secp256k1_pubkey * const *points,
+    size_t n_points,
+    secp256k1_task_runner runner,
+    void *runner_data,
+    size_t n_tasks
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(8);
+
+/** Tune the algorithm choices of multi-scalar multiplications to this machine.
+ *
+ *  Which algorithm secp256k1_ecmult_multi and secp256k1_ecmult_multi_parallel
+ *  use for a given number of points, and how, is decided by thresholds compiled
+ *  into the library, which have been measured on a single machine. This function
+ *  times the algorithms on the running machine instead, and makes all
+ *  multi-scalar multiplications with ctx, including those of batch verification
+ *  functions, use the results. This takes about a second of CPU time and uses
+ *  a few megabytes of memory temporarily.
+ *
+ *  To avoid repeating the measurements, the results can be saved with
+ *  secp256k1_context_serialize_ecmult_multi_tuning and restored with
+ *  secp256k1_context_parse_ecmult_multi_tuning. Like the other functions
+ *  that modify a context, these must not be called while ctx is in use by
+ *  another thread. Clones of ctx inherit its tuning.
+ *
+ *  Scratch space sizes returned by secp256k1_ecmult_multi_scratch_size and
+ *  similar functions remain based on the compiled-in thresholds, so a tuned
+ *  context may need to process the points in more than one pass.
+ *
+ *  Returns: 1: the tuning succeeded.
+ *           0: CPU time can't be measured on this platform, ctx is unchanged.
+ *  Args:    ctx: pointer to a context object (not secp256k1_context_static).
+ */
+SECP256K1_API int secp256k1_context_tune_ecmult_multi(
+    secp256k1_context *ctx
+) SECP256K1_ARG_NONNULL(1);
+
+/** The size of a serialized tuning of multi-scalar multiplications. */
+#define SECP256K1_ECMULT_MULTI_TUNING_SIZE 53
+
+/** Serialize the tuning of multi-scalar multiplications of a context.
+ *
+ *  The output is only meaningful for the version of the library it has been
+ *  created by, running on the same machine.
+ *
+ *  Returns: 1 always.
+ *  Args:    ctx: pointer to a context object.
+ *  Out:  output: pointer to a SECP256K1_ECMULT_MULTI_TUNING_SIZE-byte array.
+ */
+SECP256K1_API int secp256k1_context_serialize_ecmult_multi_tuning(
+    const secp256k1_context *ctx,
+    unsigned char *output
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2);
+
+/** Restore a tuning of multi-scalar multiplications.
+ *
+ *  Returns: 1: the tuning has been restored.
+ *           0: the input is not a valid serialized tuning, ctx is unchanged.
+ *  Args:    ctx: pointer to a context object (not secp256k1_context_static).
+ *  In:    input: pointer to a SECP256K1_ECMULT_MULTI_TUNING_SIZE-byte array
+ *                written by secp256k1_context_serialize_ecmult_multi_tuning.
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_context_parse_ecmult_multi_tuning(
+    secp256k1_context *ctx,
+    const unsigned char *input
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2);
+
 /** Compute a tagged hash as defined in BIP-340.
  *
  *  This is useful for creating a message hash and achieving domain separation
@@ -892,6 +1483,47 @@ SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_tagged_sha256(
     size_t msglen
 ) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(5);
 
+/** Precompute the SHA256 state for computing tagged hashes with a fixed tag.
+ *
+ *  Computing many tagged hashes with the same tag using
+ *  secp256k1_tagged_sha256_with_midstate saves the two SHA256 compressions
+ *  of the tag hashes per call compared to secp256k1_tagged_sha256.
+ *
+ *  Returns: 1 always.
+ *  Args:       ctx: pointer to a context object
+ *  Out:   midstate: pointer to a midstate object to initialize
+ *  In:         tag: pointer to an array containing the tag
+ *           taglen: length of the tag array
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_tagged_sha256_midstate_init(
+    const secp256k1_context *ctx,
+    secp256k1_tagged_sha256_midstate *midstate,
+    const unsigned char *tag,
+    size_t taglen
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
+
+/** Compute a tagged hash as defined in BIP-340 using a precomputed midstate.
+ *
+ *  Returns SHA256(SHA256(tag)||SHA256(tag)||msg) like
+ *  secp256k1_tagged_sha256, where tag is the tag the midstate was initialized
+ *  with.
+ *
+ *  Returns: 1 always.
+ *  Args:       ctx: pointer to a context object
+ *  Out:     hash32: pointer to a 32-byte array to store the resulting hash
+ *  In:    midstate: pointer to a midstate initialized with
+ *                   secp256k1_tagged_sha256_midstate_init
+ *              msg: pointer to an array containing the message
+ *           msglen: length of the message array
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_tagged_sha256_with_midstate(
+    const secp256k1_context *ctx,
+    unsigned char *hash32,
+    const secp256k1_tagged_sha256_midstate *midstate,
+    const unsigned char *msg,
+    size_t msglen
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4);
+
 #ifdef __cplusplus
 }
 #endif
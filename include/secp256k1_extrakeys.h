@@ -155,6 +155,42 @@ SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_xonly_pubkey_tweak_add_
     const unsigned char *tweak32
 ) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(4) SECP256K1_ARG_NONNULL(5);
 
+/** Performs a batch of secp256k1_xonly_pubkey_tweak_add_check checks.
+ *
+ *  The checks are performed together using a single multi-scalar
+ *  multiplication with randomly weighted equations, which is considerably
+ *  faster than calling secp256k1_xonly_pubkey_tweak_add_check for each of
+ *  them. The result is the same as that of performing each check
+ *  individually. The interface matches secp256k1_schnorrsig_verify_batch, so
+ *  for example the Taproot commitments and the Schnorr signatures of a block
+ *  can be validated with one call each. For large batches this function
+ *  allocates memory on the heap.
+ *
+ *  Returns: 1: all tweaked pubkeys are the result of tweaking their
+ *              internal_pubkey with their tweak (or n_checks is 0)
+ *           0: the arguments are invalid or at least one check fails
+ *  Args:               ctx: pointer to a context object.
+ *  Out:        invalid_idx: pointer to an index that is set to the index of
+ *                           the first failing check if 0 is returned (can be
+ *                           NULL).
+ *  In:   tweaked_pubkeys32: array of pointers to serialized xonly_pubkeys.
+ *      tweaked_pk_parities: array of the parities of the tweaked pubkeys.
+ *         internal_pubkeys: array of pointers to x-only public keys to apply
+ *                           the tweaks to.
+ *                 tweaks32: array of pointers to 32-byte tweaks.
+ *                 n_checks: number of checks, i.e., the length of the arrays
+ *                           above (the arrays can be NULL if n_checks is 0).
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_xonly_pubkey_tweak_add_check_batch(
+    const secp256k1_context *ctx,
+    size_t *invalid_idx,
+    const unsigned char * const *tweaked_pubkeys32,
+    const int *tweaked_pk_parities,
+    const secp256k1_xonly_pubkey * const *internal_pubkeys,
+    const unsigned char * const *tweaks32,
+    size_t n_checks
+) SECP256K1_ARG_NONNULL(1);
+
 /** Compute the keypair for a valid secret key.
  *
  *  See the documentation of `secp256k1_ec_seckey_verify` for more information
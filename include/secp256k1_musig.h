@@ -179,6 +179,9 @@ SECP256K1_API int secp256k1_musig_partial_sig_serialize(
  *
  *  Different orders of `pubkeys` result in different `agg_pk`s.
  *
+ *  If more than one public key is given, this function allocates memory on the
+ *  heap to aggregate the keys with a single multi-scalar multiplication.
+ *
  *  Before aggregating, the pubkeys can be sorted with `secp256k1_ec_pubkey_sort`
  *  which ensures the same `agg_pk` result for the same multiset of pubkeys.
  *  This is useful to do before `pubkey_agg`, such that the order of pubkeys
@@ -561,6 +564,46 @@ SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_musig_partial_sig_verif
     const secp256k1_musig_session *session
 ) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4) SECP256K1_ARG_NONNULL(5) SECP256K1_ARG_NONNULL(6);
 
+/** Verifies the partial signatures of all signers of a session at once
+ *
+ *  The partial signatures are checked together using a single multi-scalar
+ *  multiplication with randomly weighted verification equations, which is
+ *  considerably faster than calling `musig_partial_sig_verify` for each of
+ *  them. The result is the same as that of verifying each partial signature
+ *  individually, and the same requirements on the arguments apply for every
+ *  signer. This function allocates memory on the heap if n_sigs is greater
+ *  than 1.
+ *
+ *  Returns: 1 if all partial signatures verify (or n_sigs is 0), 0 if the
+ *           arguments are invalid or at least one partial signature does not
+ *           verify
+ *  Args          ctx: pointer to a context object
+ *  Out:  invalid_idx: pointer to an index that is set to the index of the
+ *                     first partial signature that does not verify if 0 is
+ *                     returned (can be NULL)
+ *  In:  partial_sigs: array of pointers to partial signatures to verify, where
+ *                     the i-th partial signature is sent by the signer
+ *                     associated with the i-th pubnonce and pubkey
+ *          pubnonces: array of pointers to the public nonces of the signers
+ *            pubkeys: array of pointers to the public keys of the signers
+ *       keyagg_cache: pointer to the keyagg_cache that was output when the
+ *                     aggregate public key for this signing session
+ *            session: pointer to the session that was created with
+ *                     `musig_nonce_process`
+ *             n_sigs: number of partial signatures, i.e., the length of the
+ *                     arrays above (the arrays can be NULL if n_sigs is 0)
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_musig_partial_sig_verify_batch(
+    const secp256k1_context *ctx,
+    size_t *invalid_idx,
+    const secp256k1_musig_partial_sig * const *partial_sigs,
+    const secp256k1_musig_pubnonce * const *pubnonces,
+    const secp256k1_pubkey * const *pubkeys,
+    const secp256k1_musig_keyagg_cache *keyagg_cache,
+    const secp256k1_musig_session *session,
+    size_t n_sigs
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(6) SECP256K1_ARG_NONNULL(7);
+
 /** Aggregates partial signatures
  *
  *  Returns: 0 if the arguments are invalid, 1 otherwise (which does NOT mean
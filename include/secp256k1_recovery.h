@@ -106,6 +106,74 @@ SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ecdsa_recover(
     const unsigned char *msghash32
 ) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4);
 
+/** Recover the ECDSA public keys from a batch of signatures.
+ *
+ *  The result is the same as that of calling secp256k1_ecdsa_recover for
+ *  every signature, but the modular inversions needed for recovery are
+ *  shared between signatures, which makes this faster per signature.
+ *
+ *  Returns: 1: all public keys successfully recovered (or n_sigs is 0).
+ *           0: at least one public key could not be recovered.
+ *  Args:    ctx:        pointer to a context object.
+ *  Out:     pubkeys:    pointer to an array of n_sigs public keys, where the
+ *                       public key recovered from the i-th signature is
+ *                       placed (can be NULL if n_sigs is 0). Keys that can't
+ *                       be recovered are left invalid.
+ *           results:    pointer to an array of n_sigs integers which are set
+ *                       to 1 if the i-th public key was recovered and to 0
+ *                       otherwise (can be NULL).
+ *  In:      signatures: array of pointers to initialized signatures that
+ *                       support pubkey recovery.
+ *           msghash32s: array of pointers to the 32-byte message hashes
+ *                       assumed to be signed.
+ *           n_sigs:     number of signatures, i.e., the length of the arrays
+ *                       above (the arrays can be NULL if n_sigs is 0).
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ecdsa_recover_batch(
+    const secp256k1_context *ctx,
+    secp256k1_pubkey *pubkeys,
+    int *results,
+    const secp256k1_ecdsa_recoverable_signature * const *signatures,
+    const unsigned char * const *msghash32s,
+    size_t n_sigs
+) SECP256K1_ARG_NONNULL(1);
+
+/** Verify a batch of ECDSA signatures that carry a recovery id.
+ *
+ *  Since the recovery id determines the point R of a signature, the signatures
+ *  can be checked together using a single multi-scalar multiplication with
+ *  randomly weighted verification equations, which is considerably faster
+ *  than verifying them one by one. A signature is correct iff
+ *  secp256k1_ecdsa_verify accepts it after conversion with
+ *  secp256k1_ecdsa_recoverable_signature_convert (in particular, it must be
+ *  in lower-S form) and its recovery id is correct, i.e.,
+ *  secp256k1_ecdsa_recover recovers pubkey from it. For large batches this
+ *  function allocates memory on the heap.
+ *
+ *  Returns: 1: all signatures are correct (or n_sigs is 0).
+ *           0: at least one signature is incorrect.
+ *  Args:    ctx:         pointer to a context object.
+ *  Out:     invalid_idx: pointer to an index that is set to the index of the
+ *                        first incorrect signature if 0 is returned (can be
+ *                        NULL).
+ *  In:      signatures:  array of pointers to initialized signatures that
+ *                        support pubkey recovery.
+ *           msghash32s:  array of pointers to the 32-byte message hashes being
+ *                        verified.
+ *           pubkeys:     array of pointers to initialized public keys to
+ *                        verify with.
+ *           n_sigs:      number of signatures, i.e., the length of the arrays
+ *                        above (the arrays can be NULL if n_sigs is 0).
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ecdsa_recoverable_verify_batch(
+    const secp256k1_context *ctx,
+    size_t *invalid_idx,
+    const secp256k1_ecdsa_recoverable_signature * const *signatures,
+    const unsigned char * const *msghash32s,
+    const secp256k1_pubkey * const *pubkeys,
+    size_t n_sigs
+) SECP256K1_ARG_NONNULL(1);
+
 #ifdef __cplusplus
 }
 #endif
@@ -183,6 +183,336 @@ SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_schnorrsig_verify(
     const secp256k1_xonly_pubkey *pubkey
 ) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(5);
 
+/** Verify a Schnorr signature with a prepared public key.
+ *
+ *  Like secp256k1_schnorrsig_verify, but takes a public key prepared with
+ *  secp256k1_prepared_pubkey_create, which makes verification faster. The
+ *  signature is verified with the x-only public key of the prepared key, so
+ *  the parity of its Y coordinate does not matter. To prepare a 32-byte x-only
+ *  public key, parse it with secp256k1_ec_pubkey_parse after prepending the
+ *  byte 0x02.
+ *
+ *  Returns: 1: correct signature
+ *           0: incorrect signature
+ *  Args:    ctx: pointer to a context object.
+ *  In:    sig64: pointer to the 64-byte signature to verify.
+ *           msg: the message being verified. Can only be NULL if msglen is 0.
+ *        msglen: length of the message
+ *      prepared: pointer to the prepared public key to verify with
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_schnorrsig_verify_prepared(
+    const secp256k1_context *ctx,
+    const unsigned char *sig64,
+    const unsigned char *msg,
+    size_t msglen,
+    const secp256k1_prepared_pubkey *prepared
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(5);
+
+/** Verify many independent Schnorr signatures.
+ *
+ *  This gives the same results as calling secp256k1_schnorrsig_verify for
+ *  every signature, but verifies several signatures at once, which makes it
+ *  faster per signature. Unlike batch verification, the result of every
+ *  signature is reported individually.
+ *
+ *  Returns: 1: all signatures are correct (or n_sigs is 0)
+ *           0: at least one signature is incorrect
+ *  Args:     ctx: pointer to a context object.
+ *  Out:  results: pointer to an array of n_sigs integers which are set to 1 if
+ *                 the i-th signature is correct and to 0 otherwise (can be
+ *                 NULL)
+ *  In:    sigs64: array of pointers to 64-byte signatures to verify.
+ *           msgs: array of pointers to the messages being verified. A message
+ *                 can only be NULL if its length is 0.
+ *        msglens: array of the lengths of the messages.
+ *        pubkeys: array of pointers to x-only public keys to verify with.
+ *         n_sigs: number of signatures, i.e., the length of the arrays above
+ *                 (the arrays can be NULL if n_sigs is 0).
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_schnorrsig_verify_many(
+    const secp256k1_context *ctx,
+    int *results,
+    const unsigned char * const *sigs64,
+    const unsigned char * const *msgs,
+    const size_t *msglens,
+    const secp256k1_xonly_pubkey * const *pubkeys,
+    size_t n_sigs
+) SECP256K1_ARG_NONNULL(1);
+
+/** Verify a batch of Schnorr signatures.
+ *
+ *  The signatures are checked together using a single multi-scalar
+ *  multiplication with randomly weighted verification equations, which is
+ *  considerably faster than verifying them one by one with
+ *  secp256k1_schnorrsig_verify. The result is the same as that of verifying
+ *  each signature individually. For large batches this function allocates
+ *  memory on the heap.
+ *
+ *  Returns: 1: all signatures are correct (or n_sigs is 0)
+ *           0: at least one signature is incorrect
+ *  Args:         ctx: pointer to a context object.
+ *  Out:  invalid_idx: pointer to an index that is set to the index of the
+ *                     first incorrect signature if 0 is returned (can be
+ *                     NULL).
+ *  In:        sigs64: array of pointers to 64-byte signatures to verify.
+ *               msgs: array of pointers to the messages being verified. A
+ *                     message can only be NULL if its length is 0.
+ *            msglens: array of the lengths of the messages.
+ *            pubkeys: array of pointers to x-only public keys to verify with.
+ *             n_sigs: number of signatures, i.e., the length of the arrays
+ *                     above (the arrays can be NULL if n_sigs is 0).
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_schnorrsig_verify_batch(
+    const secp256k1_context *ctx,
+    size_t *invalid_idx,
+    const unsigned char * const *sigs64,
+    const unsigned char * const *msgs,
+    const size_t *msglens,
+    const secp256k1_xonly_pubkey * const *pubkeys,
+    size_t n_sigs
+) SECP256K1_ARG_NONNULL(1);
+
+/** Opaque data structure that collects Schnorr signatures and verifies them in
+ *  batches.
+ *
+ *  Signatures are added one at a time together with a callback that receives
+ *  the result of verifying the signature. Whenever the queue is full, and when
+ *  secp256k1_schnorrsig_verify_queue_flush is called, all signatures in the
+ *  queue are checked with batch verification. If the batch does not verify,
+ *  it is bisected to find the incorrect signatures, so every callback learns
+ *  the same result as secp256k1_schnorrsig_verify would have returned.
+ *
+ *  A queue must not be used by several threads at the same time. The library
+ *  does not create threads on its own; to verify on several threads, give every
+ *  thread its own queue.
+ */
+typedef struct secp256k1_schnorrsig_verify_queue_struct secp256k1_schnorrsig_verify_queue;
+
+/** A pointer to a function that receives the result of verifying a signature
+ *  added to a verification queue.
+ *
+ *  In:  result: 1 if the signature is correct, 0 otherwise.
+ *       data:   the callback_data passed to secp256k1_schnorrsig_verify_queue_add.
+ */
+typedef void (*secp256k1_schnorrsig_verify_callback)(
+    int result,
+    void *data
+);
+
+/** Create a verification queue for Schnorr signatures.
+ *
+ *  The queue holds up to max_sigs signatures, which are verified together.
+ *  Larger queues make batch verification more efficient, but cause results to
+ *  be reported later. Queues for more than a few thousand signatures are not
+ *  faster than smaller ones.
+ *
+ *  Returns: a newly created verification queue, or NULL if max_sigs is 0 or
+ *           memory could not be allocated.
+ *  Args:      ctx: pointer to a context object.
+ *  In:   max_sigs: the maximum number of signatures held by the queue.
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT secp256k1_schnorrsig_verify_queue *secp256k1_schnorrsig_verify_queue_create(
+    const secp256k1_context *ctx,
+    size_t max_sigs
+) SECP256K1_ARG_NONNULL(1);
+
+/** Destroy a verification queue.
+ *
+ *  Signatures that are still in the queue are discarded without calling their
+ *  callbacks. Call secp256k1_schnorrsig_verify_queue_flush first to have them
+ *  verified.
+ *
+ *  The pointer may not be used afterwards.
+ *  Args:    ctx: pointer to a context object.
+ *         queue: pointer to the queue to destroy (can be NULL, in which case
+ *                this function is a no-op).
+ */
+SECP256K1_API void secp256k1_schnorrsig_verify_queue_destroy(
+    const secp256k1_context *ctx,
+    secp256k1_schnorrsig_verify_queue *queue
+) SECP256K1_ARG_NONNULL(1);
+
+/** Add a Schnorr signature to a verification queue.
+ *
+ *  If the queue is full, the signatures already in it are verified first,
+ *  calling their callbacks. The message is only accessed during this call, so
+ *  its memory can be reused as soon as this function returns.
+ *
+ *  Returns: 1 if the signature was added, 0 if the arguments are invalid.
+ *  Args:           ctx: pointer to a context object.
+ *                queue: pointer to a verification queue.
+ *  In:           sig64: pointer to the 64-byte signature to verify.
+ *                  msg: the message being verified. Can only be NULL if msglen
+ *                       is 0.
+ *               msglen: length of the message.
+ *               pubkey: pointer to an x-only public key to verify with.
+ *             callback: pointer to a function that receives the result (can be
+ *                       NULL).
+ *        callback_data: arbitrary data passed to callback (can be NULL).
+ */
+SECP256K1_API int secp256k1_schnorrsig_verify_queue_add(
+    const secp256k1_context *ctx,
+    secp256k1_schnorrsig_verify_queue *queue,
+    const unsigned char *sig64,
+    const unsigned char *msg,
+    size_t msglen,
+    const secp256k1_xonly_pubkey *pubkey,
+    secp256k1_schnorrsig_verify_callback callback,
+    void *callback_data
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(6);
+
+/** Verify all signatures in a verification queue and empty it.
+ *
+ *  The callbacks of the signatures are called in the order in which the
+ *  signatures were added. If all signatures are correct, this costs a single
+ *  batch verification; otherwise additional batch verifications of halves of
+ *  the queue are needed for every incorrect signature.
+ *
+ *  Returns: 1: all signatures in the queue are correct (or it was empty)
+ *           0: at least one signature is incorrect
+ *  Args:    ctx: pointer to a context object.
+ *         queue: pointer to a verification queue.
+ */
+SECP256K1_API int secp256k1_schnorrsig_verify_queue_flush(
+    const secp256k1_context *ctx,
+    secp256k1_schnorrsig_verify_queue *queue
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2);
+
+/** Opaque data structure that holds the state of signing or verifying a
+ *  Schnorr signature over a message that is passed in chunks.
+ *
+ *  The exact representation of data inside is implementation defined and not
+ *  guaranteed to be portable between different platforms or versions. It can
+ *  be safely copied/moved. A stream used for signing contains the secret key
+ *  and, after the first pass, the secret nonce, so its memory should be
+ *  cleared if it is not finished with secp256k1_schnorrsig_sign_stream_finish,
+ *  which clears it.
+ */
+typedef struct secp256k1_schnorrsig_stream {
+    unsigned char data[342];
+} secp256k1_schnorrsig_stream;
+
+/** Start verifying a Schnorr signature over a message that is passed in chunks.
+ *
+ *  The message is passed with secp256k1_schnorrsig_stream_write, which can be
+ *  called any number of times, and the signature is checked with
+ *  secp256k1_schnorrsig_verify_stream_finish. The result is the same as that
+ *  of secp256k1_schnorrsig_verify with the concatenation of the chunks as the
+ *  message.
+ *
+ *  Returns: 1 if the stream was initialized, 0 if the arguments are invalid
+ *           (the stream is then cleared and can't be used).
+ *  Args:    ctx: pointer to a context object.
+ *  Out:  stream: pointer to a stream object to initialize.
+ *  In:    sig64: pointer to the 64-byte signature to verify.
+ *        pubkey: pointer to an x-only public key to verify with.
+ */
+SECP256K1_API int secp256k1_schnorrsig_verify_stream_init(
+    const secp256k1_context *ctx,
+    secp256k1_schnorrsig_stream *stream,
+    const unsigned char *sig64,
+    const secp256k1_xonly_pubkey *pubkey
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4);
+
+/** Pass the next chunk of the message to a stream.
+ *
+ *  The chunk is only accessed during this call, so its memory can be reused as
+ *  soon as this function returns.
+ *
+ *  Returns: 1 always.
+ *  Args:    ctx: pointer to a context object.
+ *        stream: pointer to a stream initialized with
+ *                secp256k1_schnorrsig_verify_stream_init or
+ *                secp256k1_schnorrsig_sign_stream_init.
+ *  In:     data: the next chunk of the message. Can only be NULL if len is 0.
+ *           len: length of the chunk.
+ */
+SECP256K1_API int secp256k1_schnorrsig_stream_write(
+    const secp256k1_context *ctx,
+    secp256k1_schnorrsig_stream *stream,
+    const unsigned char *data,
+    size_t len
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2);
+
+/** Finish verifying a Schnorr signature over a message passed in chunks.
+ *
+ *  The stream can not be used afterwards.
+ *
+ *  Returns: 1 on correct signature, 0 on incorrect signature
+ *  Args:    ctx: pointer to a context object.
+ *        stream: pointer to a stream initialized with
+ *                secp256k1_schnorrsig_verify_stream_init.
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_schnorrsig_verify_stream_finish(
+    const secp256k1_context *ctx,
+    secp256k1_schnorrsig_stream *stream
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2);
+
+/** Start creating a Schnorr signature over a message that is passed in chunks.
+ *
+ *  Because the BIP-340 nonce depends on the message, and the challenge hash
+ *  depends on the nonce, the message has to be passed twice:
+ *   1. Pass the message with secp256k1_schnorrsig_stream_write.
+ *   2. Call secp256k1_schnorrsig_sign_stream_second_pass.
+ *   3. Pass the same message again with secp256k1_schnorrsig_stream_write. It
+ *      can be split into chunks differently than in the first pass.
+ *   4. Obtain the signature with secp256k1_schnorrsig_sign_stream_finish.
+ *  The signature is the same as the one computed by secp256k1_schnorrsig_sign_custom
+ *  with the concatenation of the chunks as the message and extraparams that
+ *  only set ndata to aux_rand32.
+ *
+ *  If the message passed in the second pass differs from the one passed in the
+ *  first pass, secp256k1_schnorrsig_sign_stream_finish fails, as a signature
+ *  with a nonce derived from a different message would reveal the secret key.
+ *
+ *  See secp256k1_schnorrsig_sign32 for the requirements on aux_rand32.
+ *
+ *  Returns: 1 on success, 0 on failure.
+ *  Args:    ctx: pointer to a context object (not secp256k1_context_static).
+ *  Out:  stream: pointer to a stream object to initialize.
+ *  In:  keypair: pointer to an initialized keypair.
+ *    aux_rand32: 32 bytes of fresh randomness. While recommended to provide
+ *                this, it is only supplemental to security and can be NULL.
+ */
+SECP256K1_API int secp256k1_schnorrsig_sign_stream_init(
+    const secp256k1_context *ctx,
+    secp256k1_schnorrsig_stream *stream,
+    const secp256k1_keypair *keypair,
+    const unsigned char *aux_rand32
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
+
+/** Finish the first pass over the message of a signing stream.
+ *
+ *  Derives the nonce from the message passed so far and prepares the stream
+ *  for passing the message a second time.
+ *
+ *  Returns: 1 on success, 0 on failure.
+ *  Args:    ctx: pointer to a context object (not secp256k1_context_static).
+ *        stream: pointer to a stream initialized with
+ *                secp256k1_schnorrsig_sign_stream_init.
+ */
+SECP256K1_API int secp256k1_schnorrsig_sign_stream_second_pass(
+    const secp256k1_context *ctx,
+    secp256k1_schnorrsig_stream *stream
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2);
+
+/** Finish creating a Schnorr signature over a message passed in chunks.
+ *
+ *  The stream is cleared and can not be used afterwards.
+ *
+ *  Returns: 1 on success, 0 on failure (in particular if the message passed in
+ *           the second pass differs from the one passed in the first pass).
+ *  Args:    ctx: pointer to a context object.
+ *        stream: pointer to a stream on which
+ *                secp256k1_schnorrsig_sign_stream_second_pass was called.
+ *  Out:   sig64: pointer to a 64-byte array to store the serialized signature.
+ */
+SECP256K1_API int secp256k1_schnorrsig_sign_stream_finish(
+    const secp256k1_context *ctx,
+    unsigned char *sig64,
+    secp256k1_schnorrsig_stream *stream
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
+
 #ifdef __cplusplus
 }
 #endif
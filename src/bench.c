@@ -39,11 +39,18 @@ static void help(int default_iters) {
     printf("    ecdsa             : all ECDSA algorithms--sign, verify, recovery (if enabled)\n");
     printf("    ecdsa_sign        : ECDSA siging algorithm\n");
     printf("    ecdsa_verify      : ECDSA verification algorithm\n");
+    printf("    ecdsa_verify_many : ECDSA verification of many signatures\n");
+    printf("    ecdsa_verify_prepared : ECDSA verification with a prepared public key\n");
+    printf("    ecdsa_verify_window20 : ECDSA verification with a context with window size 20 tables (only run if named)\n");
     printf("    ec                : all EC public key algorithms (keygen)\n");
     printf("    ec_keygen         : EC public key generation\n");
+    printf("    ec_keygen_comb43x6 : EC public key generation with a context with a 43 block, 6 teeth comb table\n");
+    printf("    ec_generator_mul  : EC multiplication of a prepared generator other than G\n");
 
 #ifdef ENABLE_MODULE_RECOVERY
     printf("    ecdsa_recover     : ECDSA public key recovery algorithm\n");
+    printf("    ecdsa_recover_batch : ECDSA batch public key recovery algorithm\n");
+    printf("    ecdsa_recoverable_verify_batch : ECDSA batch verification of signatures with recovery id\n");
 #endif
 
 #ifdef ENABLE_MODULE_ECDH
@@ -54,6 +61,9 @@ static void help(int default_iters) {
     printf("    schnorrsig        : all Schnorr signature algorithms (sign, verify)\n");
     printf("    schnorrsig_sign   : Schnorr sigining algorithm\n");
     printf("    schnorrsig_verify : Schnorr verification algorithm\n");
+    printf("    schnorrsig_verify_many  : Schnorr verification of many signatures\n");
+    printf("    schnorrsig_verify_batch : Schnorr batch verification algorithm\n");
+    printf("    schnorrsig_verify_queue : Schnorr verification through a queue of 1024 signatures\n");
 #endif
 
 #ifdef ENABLE_MODULE_ELLSWIFT
@@ -75,6 +85,7 @@ typedef struct {
     size_t siglen;
     unsigned char pubkey[33];
     size_t pubkeylen;
+    secp256k1_prepared_pubkey *prepared;
 } bench_data;
 
 static void bench_verify(void* arg, int iters) {
@@ -96,6 +107,63 @@ static void bench_verify(void* arg, int iters) {
     }
 }
 
+#define VERIFY_MANY_SIZE 64
+
+static void bench_verify_many(void* arg, int iters) {
+    int i;
+    bench_data* data = (bench_data*)arg;
+    secp256k1_pubkey pubkey;
+    secp256k1_ecdsa_signature sig;
+    const secp256k1_pubkey *pubkeys[VERIFY_MANY_SIZE];
+    const secp256k1_ecdsa_signature *sigs[VERIFY_MANY_SIZE];
+    const unsigned char *msgs[VERIFY_MANY_SIZE];
+
+    CHECK(secp256k1_ec_pubkey_parse(data->ctx, &pubkey, data->pubkey, data->pubkeylen) == 1);
+    CHECK(secp256k1_ecdsa_signature_parse_der(data->ctx, &sig, data->sig, data->siglen) == 1);
+    for (i = 0; i < VERIFY_MANY_SIZE; i++) {
+        pubkeys[i] = &pubkey;
+        sigs[i] = &sig;
+        msgs[i] = data->msg;
+    }
+    for (i = 0; i < iters; i += VERIFY_MANY_SIZE) {
+        size_t n = iters - i < VERIFY_MANY_SIZE ? iters - i : VERIFY_MANY_SIZE;
+        CHECK(secp256k1_ecdsa_verify_many(data->ctx, NULL, sigs, msgs, pubkeys, n) == 1);
+    }
+}
+
+static void bench_verify_prepared_setup(void* arg) {
+    bench_data* data = (bench_data*)arg;
+    secp256k1_pubkey pubkey;
+
+    CHECK(secp256k1_ec_pubkey_parse(data->ctx, &pubkey, data->pubkey, data->pubkeylen) == 1);
+    data->prepared = secp256k1_prepared_pubkey_create(data->ctx, &pubkey);
+    CHECK(data->prepared != NULL);
+}
+
+static void bench_verify_prepared_teardown(void* arg, int iters) {
+    bench_data* data = (bench_data*)arg;
+    (void)iters;
+
+    secp256k1_prepared_pubkey_destroy(data->ctx, data->prepared);
+}
+
+static void bench_verify_prepared(void* arg, int iters) {
+    int i;
+    bench_data* data = (bench_data*)arg;
+
+    for (i = 0; i < iters; i++) {
+        secp256k1_ecdsa_signature sig;
+        data->sig[data->siglen - 1] ^= (i & 0xFF);
+        data->sig[data->siglen - 2] ^= ((i >> 8) & 0xFF);
+        data->sig[data->siglen - 3] ^= ((i >> 16) & 0xFF);
+        CHECK(secp256k1_ecdsa_signature_parse_der(data->ctx, &sig, data->sig, data->siglen) == 1);
+        CHECK(secp256k1_ecdsa_verify_prepared(data->ctx, &sig, data->msg, data->prepared) == (i == 0));
+        data->sig[data->siglen - 1] ^= (i & 0xFF);
+        data->sig[data->siglen - 2] ^= ((i >> 8) & 0xFF);
+        data->sig[data->siglen - 3] ^= ((i >> 16) & 0xFF);
+    }
+}
+
 static void bench_sign_setup(void* arg) {
     int i;
     bench_data *data = (bench_data*)arg;
@@ -149,6 +217,27 @@ static void bench_keygen_run(void *arg, int iters) {
     }
 }
 
+static void bench_generator_mul_run(void *arg, int iters) {
+    int i;
+    bench_data *data = (bench_data*)arg;
+    unsigned char h32[32] = { 3 };
+    secp256k1_pubkey hpub;
+    secp256k1_prepared_generator *prepared;
+
+    CHECK(secp256k1_ec_pubkey_create(data->ctx, &hpub, h32));
+    prepared = secp256k1_prepared_generator_create(data->ctx, &hpub);
+    CHECK(prepared != NULL);
+    for (i = 0; i < iters; i++) {
+        unsigned char pub33[33];
+        size_t len = 33;
+        secp256k1_pubkey pubkey;
+        CHECK(secp256k1_prepared_generator_mul(data->ctx, &pubkey, data->key, prepared));
+        CHECK(secp256k1_ec_pubkey_serialize(data->ctx, pub33, &len, &pubkey, SECP256K1_EC_COMPRESSED));
+        memcpy(data->key, pub33 + 1, 32);
+    }
+    secp256k1_prepared_generator_destroy(data->ctx, prepared);
+}
+
 
 #ifdef ENABLE_MODULE_ECDH
 # include "modules/ecdh/bench_impl.h"
@@ -177,9 +266,9 @@ int main(int argc, char** argv) {
     int iters = get_iters(default_iters);
 
     /* Check for invalid user arguments */
-    char* valid_args[] = {"ecdsa", "verify", "ecdsa_verify", "sign", "ecdsa_sign", "ecdh", "recover",
-                         "ecdsa_recover", "schnorrsig", "schnorrsig_verify", "schnorrsig_sign", "ec",
-                         "keygen", "ec_keygen", "ellswift", "encode", "ellswift_encode", "decode",
+    char* valid_args[] = {"ecdsa", "verify", "ecdsa_verify", "ecdsa_verify_many", "ecdsa_verify_prepared", "ecdsa_verify_window20", "sign", "ecdsa_sign", "ecdh", "recover",
+                         "ecdsa_recover", "ecdsa_recover_batch", "ecdsa_recoverable_verify_batch", "schnorrsig", "schnorrsig_verify", "schnorrsig_sign", "schnorrsig_verify_many", "schnorrsig_verify_batch", "schnorrsig_verify_queue", "ec",
+                         "keygen", "ec_keygen", "ec_keygen_comb43x6", "ec_generator_mul", "ellswift", "encode", "ellswift_encode", "decode",
                          "ellswift_decode", "ellswift_keygen", "ellswift_ecdh"};
     size_t valid_args_size = sizeof(valid_args)/sizeof(valid_args[0]);
     int invalid_args = have_invalid_args(argc, argv, valid_args, valid_args_size);
@@ -207,7 +296,7 @@ int main(int argc, char** argv) {
 #endif
 
 #ifndef ENABLE_MODULE_RECOVERY
-    if (have_flag(argc, argv, "recover") || have_flag(argc, argv, "ecdsa_recover")) {
+    if (have_flag(argc, argv, "recover") || have_flag(argc, argv, "ecdsa_recover") || have_flag(argc, argv, "ecdsa_recover_batch") || have_flag(argc, argv, "ecdsa_recoverable_verify_batch")) {
         fprintf(stderr, "./bench: Public key recovery module not enabled.\n");
         fprintf(stderr, "Use ./configure --enable-module-recovery.\n\n");
         return EXIT_FAILURE;
@@ -215,7 +304,7 @@ int main(int argc, char** argv) {
 #endif
 
 #ifndef ENABLE_MODULE_SCHNORRSIG
-    if (have_flag(argc, argv, "schnorrsig") || have_flag(argc, argv, "schnorrsig_sign") || have_flag(argc, argv, "schnorrsig_verify")) {
+    if (have_flag(argc, argv, "schnorrsig") || have_flag(argc, argv, "schnorrsig_sign") || have_flag(argc, argv, "schnorrsig_verify") || have_flag(argc, argv, "schnorrsig_verify_many") || have_flag(argc, argv, "schnorrsig_verify_batch") || have_flag(argc, argv, "schnorrsig_verify_queue")) {
         fprintf(stderr, "./bench: Schnorr signatures module not enabled.\n");
         fprintf(stderr, "Use ./configure --enable-module-schnorrsig.\n\n");
         return EXIT_FAILURE;
@@ -250,9 +339,27 @@ int main(int argc, char** argv) {
 
     print_output_table_header_row();
     if (d || have_flag(argc, argv, "ecdsa") || have_flag(argc, argv, "verify") || have_flag(argc, argv, "ecdsa_verify")) run_benchmark("ecdsa_verify", bench_verify, NULL, NULL, &data, 10, iters);
+    if (d || have_flag(argc, argv, "ecdsa") || have_flag(argc, argv, "verify") || have_flag(argc, argv, "ecdsa_verify_many")) run_benchmark("ecdsa_verify_many", bench_verify_many, NULL, NULL, &data, 10, iters);
+    if (d || have_flag(argc, argv, "ecdsa") || have_flag(argc, argv, "verify") || have_flag(argc, argv, "ecdsa_verify_prepared")) run_benchmark("ecdsa_verify_prepared", bench_verify_prepared, bench_verify_prepared_setup, bench_verify_prepared_teardown, &data, 10, iters);
+    /* Building the window 20 tables takes a while, so only do it on request. */
+    if (have_flag(argc, argv, "ecdsa_verify_window20")) {
+        secp256k1_context *ctx = data.ctx;
+        data.ctx = secp256k1_context_create_with_ecmult_window(SECP256K1_CONTEXT_NONE, 20);
+        run_benchmark("ecdsa_verify_window20", bench_verify, NULL, NULL, &data, 10, iters);
+        secp256k1_context_destroy(data.ctx);
+        data.ctx = ctx;
+    }
 
     if (d || have_flag(argc, argv, "ecdsa") || have_flag(argc, argv, "sign") || have_flag(argc, argv, "ecdsa_sign")) run_benchmark("ecdsa_sign", bench_sign_run, bench_sign_setup, NULL, &data, 10, iters);
     if (d || have_flag(argc, argv, "ec") || have_flag(argc, argv, "keygen") || have_flag(argc, argv, "ec_keygen")) run_benchmark("ec_keygen", bench_keygen_run, bench_keygen_setup, NULL, &data, 10, iters);
+    if (d || have_flag(argc, argv, "ec") || have_flag(argc, argv, "keygen") || have_flag(argc, argv, "ec_keygen_comb43x6")) {
+        secp256k1_context *ctx = data.ctx;
+        data.ctx = secp256k1_context_create_with_ecmult_gen_comb(SECP256K1_CONTEXT_NONE, 43, 6);
+        run_benchmark("ec_keygen_comb43x6", bench_keygen_run, bench_keygen_setup, NULL, &data, 10, iters);
+        secp256k1_context_destroy(data.ctx);
+        data.ctx = ctx;
+    }
+    if (d || have_flag(argc, argv, "ec") || have_flag(argc, argv, "ec_generator_mul")) run_benchmark("ec_generator_mul", bench_generator_mul_run, bench_keygen_setup, NULL, &data, 10, iters);
 
     secp256k1_context_destroy(data.ctx);
 
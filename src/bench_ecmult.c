@@ -19,10 +19,13 @@
 
 #define POINTS 32768
 
+/* Batch sizes of the large benchmark */
+static const size_t large_counts[] = { 10000, 100000, 1000000 };
+
 static void help(char **argv) {
     printf("Benchmark EC multiplication algorithms\n");
     printf("\n");
-    printf("Usage: %s <help|pippenger_wnaf|strauss_wnaf|simple>\n", argv[0]);
+    printf("Usage: %s <help|pippenger_wnaf|strauss_wnaf|simple> [large]\n", argv[0]);
     printf("The output shows the number of multiplied and summed points right after the\n");
     printf("function name. The letter 'g' indicates that one of the points is the generator.\n");
     printf("The benchmarks are divided by the number of points.\n");
@@ -32,6 +35,9 @@ static void help(char **argv) {
     printf("pippenger_wnaf:         for all batch sizes\n");
     printf("strauss_wnaf:           for all batch sizes\n");
     printf("simple:                 multiply and sum each point individually\n");
+    printf("\n");
+    printf("large:                  only benchmark batches of 10^4, 10^5 and 10^6 points,\n");
+    printf("                        which needs about 400 MB of memory\n");
 }
 
 typedef struct {
@@ -278,12 +284,13 @@ int main(int argc, char **argv) {
     bench_data data;
     int i, p;
     size_t scratch_size;
+    int large = have_flag(argc, argv, "large");
 
     int iters = get_iters(10000);
 
     data.ecmult_multi = secp256k1_ecmult_multi_var;
 
-    if (argc > 1) {
+    if (argc > 1 + large) {
         if(have_flag(argc, argv, "-h")
            || have_flag(argc, argv, "--help")
            || have_flag(argc, argv, "help")) {
@@ -306,6 +313,13 @@ int main(int argc, char **argv) {
 
     data.ctx = secp256k1_context_create(SECP256K1_CONTEXT_NONE);
     scratch_size = secp256k1_strauss_scratch_size(POINTS) + STRAUSS_SCRATCH_OBJECTS*16;
+    if (large) {
+        if (have_flag(argc, argv, "strauss_wnaf")) {
+            fprintf(stderr, "%s: strauss_wnaf doesn't support large batches.\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+        scratch_size = secp256k1_pippenger_scratch_size(large_counts[2], PIPPENGER_MAX_BUCKET_WINDOW) + PIPPENGER_SCRATCH_OBJECTS*ALIGNMENT;
+    }
     if (!have_flag(argc, argv, "simple")) {
         data.scratch = secp256k1_scratch_space_create(data.ctx, scratch_size);
     } else {
@@ -336,16 +350,22 @@ int main(int argc, char **argv) {
     print_output_table_header_row();
     /* Initialize offset1 and offset2 */
     hash_into_offset(&data, 0);
-    run_ecmult_bench(&data, iters);
+    if (large) {
+        for (i = 0; i < (int)(sizeof(large_counts)/sizeof(large_counts[0])); ++i) {
+            run_ecmult_multi_bench(&data, large_counts[i], 1, iters);
+        }
+    } else {
+        run_ecmult_bench(&data, iters);
 
-    for (i = 1; i <= 8; ++i) {
-        run_ecmult_multi_bench(&data, i, 1, iters);
+        for (i = 1; i <= 8; ++i) {
+            run_ecmult_multi_bench(&data, i, 1, iters);
+        }
     }
 
     /* This is disabled with low count of iterations because the loop runs 77 times even with iters=1
     * and the higher it goes the longer the computation takes(more points)
     * So we don't run this benchmark with low iterations to prevent slow down */
-     if (iters > 2) {
+     if (iters > 2 && !large) {
         for (p = 0; p <= 11; ++p) {
             for (i = 9; i <= 16; ++i) {
                 run_ecmult_multi_bench(&data, i << p, 1, iters);
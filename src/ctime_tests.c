@@ -76,6 +76,8 @@ int main(void) {
 static void run_tests(secp256k1_context *ctx, unsigned char *key) {
     secp256k1_ecdsa_signature signature;
     secp256k1_pubkey pubkey;
+    secp256k1_pubkey generator_mul;
+    secp256k1_prepared_generator *prepared;
     size_t siglen = 74;
     size_t outputlen = 33;
     int i;
@@ -107,6 +109,16 @@ static void run_tests(secp256k1_context *ctx, unsigned char *key) {
     CHECK(ret);
     CHECK(secp256k1_ec_pubkey_serialize(ctx, spubkey, &outputlen, &pubkey, SECP256K1_EC_COMPRESSED) == 1);
 
+    /* Test multiplication with a prepared generator. */
+    prepared = secp256k1_prepared_generator_create(ctx, &pubkey);
+    CHECK(prepared != NULL);
+    SECP256K1_CHECKMEM_UNDEFINE(key, 32);
+    ret = secp256k1_prepared_generator_mul(ctx, &generator_mul, key, prepared);
+    SECP256K1_CHECKMEM_DEFINE(&generator_mul, sizeof(secp256k1_pubkey));
+    SECP256K1_CHECKMEM_DEFINE(&ret, sizeof(ret));
+    CHECK(ret);
+    secp256k1_prepared_generator_destroy(ctx, prepared);
+
     /* Test signing. */
     SECP256K1_CHECKMEM_UNDEFINE(key, 32);
     ret = secp256k1_ecdsa_sign(ctx, &signature, msg, key, NULL, NULL);
@@ -184,6 +196,21 @@ static void run_tests(secp256k1_context *ctx, unsigned char *key) {
     ret = secp256k1_schnorrsig_sign32(ctx, sig, msg, &keypair, NULL);
     SECP256K1_CHECKMEM_DEFINE(&ret, sizeof(ret));
     CHECK(ret == 1);
+    {
+        secp256k1_schnorrsig_stream stream;
+
+        ret = secp256k1_schnorrsig_sign_stream_init(ctx, &stream, &keypair, NULL);
+        SECP256K1_CHECKMEM_DEFINE(&ret, sizeof(ret));
+        CHECK(ret == 1);
+        CHECK(secp256k1_schnorrsig_stream_write(ctx, &stream, msg, sizeof(msg)));
+        ret = secp256k1_schnorrsig_sign_stream_second_pass(ctx, &stream);
+        SECP256K1_CHECKMEM_DEFINE(&ret, sizeof(ret));
+        CHECK(ret == 1);
+        CHECK(secp256k1_schnorrsig_stream_write(ctx, &stream, msg, sizeof(msg)));
+        ret = secp256k1_schnorrsig_sign_stream_finish(ctx, sig, &stream);
+        SECP256K1_CHECKMEM_DEFINE(&ret, sizeof(ret));
+        CHECK(ret == 1);
+    }
 #endif
 
 #ifdef ENABLE_MODULE_MUSIG
@@ -15,7 +15,15 @@
 
 static int secp256k1_ecdsa_sig_parse(secp256k1_scalar *r, secp256k1_scalar *s, const unsigned char *sig, size_t size);
 static int secp256k1_ecdsa_sig_serialize(unsigned char *sig, size_t *size, const secp256k1_scalar *r, const secp256k1_scalar *s);
-static int secp256k1_ecdsa_sig_verify(const secp256k1_scalar* r, const secp256k1_scalar* s, const secp256k1_ge *pubkey, const secp256k1_scalar *message);
+static int secp256k1_ecdsa_sig_verify(const secp256k1_ecmult_tables *tables, const secp256k1_scalar* r, const secp256k1_scalar* s, const secp256k1_ge *pubkey, const secp256k1_scalar *message);
+/** Like secp256k1_ecdsa_sig_verify, but takes the inverse of s instead of s. r and s must be nonzero. */
+static int secp256k1_ecdsa_sig_verify_sinv(const secp256k1_ecmult_tables *tables, const secp256k1_scalar* r, const secp256k1_scalar* sinv, const secp256k1_ge *pubkey, const secp256k1_scalar *message);
+/** Checks whether pr, computed as (m/s)*G + (r/s)*pubkey, makes the signature
+ *  valid, i.e., whether the x coordinate of pr, reduced modulo the group order,
+ *  equals r. */
+static int secp256k1_ecdsa_sig_check_r(const secp256k1_scalar* r, const secp256k1_gej *pr);
+/** Like secp256k1_ecdsa_sig_verify, but the public key is given by tables built for it. */
+static int secp256k1_ecdsa_sig_verify_point_table(const secp256k1_ecmult_tables *tables, const secp256k1_scalar* r, const secp256k1_scalar* s, const secp256k1_ecmult_point_table *pubkey_table, const secp256k1_scalar *message);
 static int secp256k1_ecdsa_sig_sign(const secp256k1_ecmult_gen_context *ctx, secp256k1_scalar* r, secp256k1_scalar* s, const secp256k1_scalar *seckey, const secp256k1_scalar *message, const secp256k1_scalar *nonce, int *recid);
 
 #endif /* SECP256K1_ECDSA_H */
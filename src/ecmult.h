@@ -40,11 +40,131 @@
 /** The number of entries a table with precomputed multiples needs to have. */
 #define ECMULT_TABLE_SIZE(w) (1L << ((w)-2))
 
+/** Precomputed odd multiples of G and of 2^128*G, each table holding
+ *  ECMULT_TABLE_SIZE(window_g) entries. */
+typedef struct {
+    const secp256k1_ge_storage *pre_g;
+    const secp256k1_ge_storage *pre_g_128;
+    int window_g;
+} secp256k1_ecmult_tables;
+
+/** Sets tables to the tables compiled into the library. */
+static void secp256k1_ecmult_tables_set_default(secp256k1_ecmult_tables *tables);
+
+/** Returns whether tables were allocated by secp256k1_ecmult_tables_build. */
+static int secp256k1_ecmult_tables_is_allocated(const secp256k1_ecmult_tables *tables);
+
+/** Allocates and computes tables for the given window size, which must be in
+ *  range [2..24]. Returns 0 if the allocation failed. */
+static int secp256k1_ecmult_tables_build(const secp256k1_callback *error_callback, secp256k1_ecmult_tables *tables, int window_g);
+
+/** Copies src into dst, duplicating the tables if they were allocated.
+ *  Returns 0 if the allocation failed. */
+static int secp256k1_ecmult_tables_clone(const secp256k1_callback *error_callback, secp256k1_ecmult_tables *dst, const secp256k1_ecmult_tables *src);
+
+/** Frees allocated tables and resets tables to the default ones. */
+static void secp256k1_ecmult_tables_free(secp256k1_ecmult_tables *tables);
+
 /** Double multiply: R = na*A + ng*G */
 static void secp256k1_ecmult(secp256k1_gej *r, const secp256k1_gej *a, const secp256k1_scalar *na, const secp256k1_scalar *ng);
 
+/** Like secp256k1_ecmult, but uses the given precomputed tables for G. */
+static void secp256k1_ecmult_with_tables(const secp256k1_ecmult_tables *tables, secp256k1_gej *r, const secp256k1_gej *a, const secp256k1_scalar *na, const secp256k1_scalar *ng);
+
+/** Maximum number of independent double multiplications that
+ *  secp256k1_ecmult_interleaved performs at once. */
+#define ECMULT_INTERLEAVE_MAX 4
+
+/** Computes r[k] = na[k]*a[k] + ng[k]*G for every k < n, where n must be in
+ *  range [1..ECMULT_INTERLEAVE_MAX]. The results are the same as those of n
+ *  calls to secp256k1_ecmult_with_tables, but the multiplications run in
+ *  lockstep, so that the table lookups and field operations of different
+ *  multiplications overlap instead of waiting for each other. */
+static void secp256k1_ecmult_interleaved(const secp256k1_ecmult_tables *tables, secp256k1_gej *r, const secp256k1_gej *a, const secp256k1_scalar *na, const secp256k1_scalar *ng, size_t n);
+
+/** Precomputed odd multiples of a point A and of lambda*A (where lambda is the
+ *  cube root of unity of the endomorphism), each table holding
+ *  ECMULT_TABLE_SIZE(window) entries. They make multiplying A as cheap as
+ *  multiplying G. */
+typedef struct {
+    secp256k1_ge_storage *pre;
+    secp256k1_ge_storage *pre_lam;
+    int window;
+} secp256k1_ecmult_point_table;
+
+/** Window size of the tables built for prepared public keys. Larger windows
+ *  barely make multiplications faster, but take twice as long to build and
+ *  twice the memory with every increment. */
+#define ECMULT_POINT_TABLE_WINDOW 11
+
+/** Allocates and computes tables for the point a, which must not be infinity,
+ *  for the given window size, which must be in range [2..24]. Returns 0 if the
+ *  allocation failed. */
+static int secp256k1_ecmult_point_table_build(const secp256k1_callback *error_callback, secp256k1_ecmult_point_table *table, const secp256k1_ge *a, int window);
+
+/** Frees the tables allocated by secp256k1_ecmult_point_table_build. */
+static void secp256k1_ecmult_point_table_free(secp256k1_ecmult_point_table *table);
+
+/** Double multiply: R = na*A + ng*G, where A is the point table was built for,
+ *  and the given tables are used for G. ng can be NULL. */
+static void secp256k1_ecmult_with_point_table(const secp256k1_ecmult_tables *tables, const secp256k1_ecmult_point_table *table, secp256k1_gej *r, const secp256k1_scalar *na, const secp256k1_scalar *ng);
+
 typedef int (secp256k1_ecmult_multi_callback)(secp256k1_scalar *sc, secp256k1_ge *pt, size_t idx, void *data);
 
+/** Source of the scalars and points of a multi-multiplication. They are either
+ *  obtained from a callback, or read in place from arrays holding 32-byte
+ *  big-endian scalars and 64-byte points as written by secp256k1_ge_to_bytes.
+ *  Use the secp256k1_ecmult_multi_input_init_* functions to set it up. */
+typedef struct {
+    secp256k1_ecmult_multi_callback *cb;
+    void *cbdata;
+    const unsigned char *scalars32;
+    const unsigned char *points64;
+} secp256k1_ecmult_multi_input;
+
+/** Sets input to call cb(sc, pt, idx, cbdata) for the idx-th scalar and point. */
+static void secp256k1_ecmult_multi_input_init_callback(secp256k1_ecmult_multi_input *input, secp256k1_ecmult_multi_callback cb, void *cbdata);
+
+/** Sets input to read the idx-th scalar and point from the 32 bytes at
+ *  scalars32 + 32*idx and the 64 bytes at points64 + 64*idx. Scalars that
+ *  overflow and all-zero points, which secp256k1_pubkey uses to mark invalid
+ *  public keys, make the multi-multiplication fail. */
+static void secp256k1_ecmult_multi_input_init_bytes(secp256k1_ecmult_multi_input *input, const unsigned char *scalars32, const unsigned char *points64);
+
+#define PIPPENGER_MAX_BUCKET_WINDOW 12
+
+/** Parameters that determine which algorithm secp256k1_ecmult_multi_var uses
+ *  for a given number of points, and how. */
+typedef struct {
+    /* Minimum number of points in a batch for which Pippenger's algorithm is
+     * used instead of Strauss' algorithm */
+    size_t pippenger_threshold;
+    /* pippenger_max_points[w-1] is the maximum number of points for which
+     * Pippenger's algorithm uses a bucket window of w. The entries are
+     * non-decreasing, and the last one is SIZE_MAX. */
+    size_t pippenger_max_points[PIPPENGER_MAX_BUCKET_WINDOW];
+} secp256k1_ecmult_multi_params;
+
+/** The size of a serialized secp256k1_ecmult_multi_params. */
+#define ECMULT_MULTI_PARAMS_SIZE (1 + 4 * (1 + PIPPENGER_MAX_BUCKET_WINDOW))
+
+/** Sets params to the values compiled into the library. */
+static void secp256k1_ecmult_multi_params_set_default(secp256k1_ecmult_multi_params *params);
+
+/** Measures the speed of Strauss' algorithm and of Pippenger's algorithm with
+ *  every bucket window on this machine, and sets params such that the fastest
+ *  choice is made for any number of points. This takes about a second of CPU
+ *  time. Returns 0 and leaves params unchanged if CPU time can't be measured. */
+static int secp256k1_ecmult_multi_params_calibrate(const secp256k1_callback *error_callback, secp256k1_ecmult_multi_params *params);
+
+/** Serializes params into ECMULT_MULTI_PARAMS_SIZE bytes. */
+static void secp256k1_ecmult_multi_params_to_bytes(unsigned char *buf, const secp256k1_ecmult_multi_params *params);
+
+/** Parses ECMULT_MULTI_PARAMS_SIZE bytes written by
+ *  secp256k1_ecmult_multi_params_to_bytes. Returns 0 and leaves params
+ *  unchanged if they are invalid. */
+static int secp256k1_ecmult_multi_params_from_bytes(secp256k1_ecmult_multi_params *params, const unsigned char *buf);
+
 /**
  * Multi-multiply: R = inp_g_sc * G + sum_i ni * Ai.
  * Chooses the right algorithm for a given number of points and scratch space
@@ -58,4 +178,86 @@ typedef int (secp256k1_ecmult_multi_callback)(secp256k1_scalar *sc, secp256k1_ge
  */
 static int secp256k1_ecmult_multi_var(const secp256k1_callback* error_callback, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, void *cbdata, size_t n);
 
+/** Like secp256k1_ecmult_multi_var, but chooses the algorithm according to the
+ *  given params instead of the compiled-in ones. */
+static int secp256k1_ecmult_multi_var_with_params(const secp256k1_ecmult_multi_params *params, const secp256k1_callback* error_callback, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, void *cbdata, size_t n);
+
+/** Like secp256k1_ecmult_multi_var_with_params, but reads the points and
+ *  scalars from input. */
+static int secp256k1_ecmult_multi_var_input(const secp256k1_ecmult_multi_params *params, const secp256k1_callback* error_callback, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, const secp256k1_ecmult_multi_input *input, size_t n);
+
+/** Precomputed tables for a fixed list of points A_0, ..., A_(n-1), for computing
+ *  sum(s_i*A_i) many times with changing scalars s_i.
+ *
+ *  The scalars are split with the endomorphism into two halves with at most 129
+ *  wNAF digits each, and the digits of a half are split further into `chunks`
+ *  consecutive ranges of bits = CEIL_DIV(129, chunks) digits. Like pre_g_128
+ *  holds the odd multiples of 2^128*G, there is a table of the odd multiples of
+ *  2^(c*bits)*A_i for every range c, so all ranges are processed simultaneously
+ *  and a multiplication only needs bits - 1 doublings. The multiples of
+ *  lambda*2^(c*bits)*A_i are derived from the same tables when they are looked up. */
+typedef struct {
+    size_t n;
+    int window;
+    int chunks;
+    /* The points A_i. */
+    secp256k1_ge_storage *points;
+    /* n * chunks tables of ECMULT_TABLE_SIZE(window) entries each, the ones of A_0 first. */
+    secp256k1_ge_storage *pre;
+} secp256k1_ecmult_fixed_bases;
+
+/** Default window size and number of bit ranges of secp256k1_ecmult_fixed_bases,
+ *  which take 4 kB of tables per point and need 64 doublings per multiplication.
+ *  With more ranges, there are even fewer doublings, but the tables grow while
+ *  the number of additions stays the same. */
+#define ECMULT_FIXED_BASES_WINDOW 7
+#define ECMULT_FIXED_BASES_CHUNKS 2
+#define ECMULT_FIXED_BASES_MAX_CHUNKS 8
+
+/** Minimum number of fixed bases for which secp256k1_ecmult_multi_fixed_var
+ *  uses Pippenger's algorithm on the points instead of their tables. Beyond
+ *  this, the tables no longer fit into the CPU caches. */
+#define ECMULT_FIXED_BASES_PIPPENGER_THRESHOLD 768
+
+/** Returns the largest number of points whose tables for the given window size
+ *  and number of chunks have a size that fits into a size_t. */
+static size_t secp256k1_ecmult_fixed_bases_max_points(int window, int chunks);
+
+/** Allocates and computes tables for the n points, none of which may be infinity,
+ *  for the given window size in range [2..16] and number of chunks in range
+ *  [1..ECMULT_FIXED_BASES_MAX_CHUNKS]. Returns 0 if n exceeds
+ *  secp256k1_ecmult_fixed_bases_max_points or the allocation failed. */
+static int secp256k1_ecmult_fixed_bases_build(const secp256k1_callback *error_callback, secp256k1_ecmult_fixed_bases *bases, const secp256k1_ge *points, size_t n, int window, int chunks);
+
+/** Frees the tables allocated by secp256k1_ecmult_fixed_bases_build. */
+static void secp256k1_ecmult_fixed_bases_free(secp256k1_ecmult_fixed_bases *bases);
+
+/**
+ * Multi-multiply with fixed bases: R = inp_g_sc * G + sum_i s_i * A_i, where the
+ * A_i are the points the tables were built for, and s_i is the 32-byte
+ * big-endian scalar at scalars32 + 32*i. The given tables are used for G, and
+ * inp_g_sc can be NULL. The scratch space holds the wNAF digits of as many
+ * points as possible at once; if it is NULL or too small for a single point,
+ * the points are processed one at a time. With at least
+ * ECMULT_FIXED_BASES_PIPPENGER_THRESHOLD points, Pippenger's algorithm is used
+ * with the given params if all points fit into the scratch space.
+ * Returns: 1 on success
+ *          0 if a scalar overflows
+ */
+static int secp256k1_ecmult_multi_fixed_var(const secp256k1_ecmult_multi_params *params, const secp256k1_ecmult_tables *tables, const secp256k1_callback* error_callback, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, const secp256k1_ecmult_fixed_bases *bases, const unsigned char *scalars32);
+
+/** Runs task(task_data, i) for every i in [0, n_tasks), possibly concurrently, and
+ *  returns once all of these calls have returned. */
+typedef void (secp256k1_ecmult_task_runner)(void (*task)(void *task_data, size_t idx), void *task_data, size_t n_tasks, void *runner_data);
+
+/**
+ * Like secp256k1_ecmult_multi_var_with_params, but splits the points into up
+ * to n_tasks ranges of consecutive points, which are multiplied by separate
+ * tasks run by runner, and adds up their results. The scratch space is shared
+ * equally between the tasks. Since tasks may run concurrently, cb must be safe
+ * to call from several threads at once. If scratch is NULL or too small to be
+ * split, everything is done by the calling thread.
+ */
+static int secp256k1_ecmult_multi_var_parallel(const secp256k1_ecmult_multi_params *params, const secp256k1_callback* error_callback, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, void *cbdata, size_t n, secp256k1_ecmult_task_runner runner, void *runner_data, size_t n_tasks);
+
 #endif /* SECP256K1_ECMULT_H */
@@ -0,0 +1,89 @@
+/***********************************************************************
+ * Distributed under the MIT software license, see the accompanying    *
+ * file COPYING or https://www.opensource.org/licenses/mit-license.php.*
+ ***********************************************************************/
+
+#ifndef SECP256K1_ECMULT_BATCH_H
+#define SECP256K1_ECMULT_BATCH_H
+
+#include "ecmult.h"
+#include "group.h"
+#include "hash.h"
+#include "scalar.h"
+#include "scratch.h"
+
+/* Maximum number of terms a batch created by the API functions holds before it
+ * is verified and emptied. */
+#define ECMULT_BATCH_MAX_TERMS ECMULT_MAX_SCRATCH_POINTS
+
+/** Accumulator for randomized batch verification.
+ *
+ *  Verification equations of the form sum_i sc_i*P_i + sc_g*G = 0 are
+ *  multiplied by a randomizer and summed up. If the sum is the point at
+ *  infinity, all equations hold with overwhelming probability. Randomizers
+ *  are derived from a running hash over the data of all equations added so
+ *  far, so they can't be predicted by whoever chose the inputs.
+ *
+ *  The term arrays live on a scratch space; multi-multiplications use the
+ *  remainder of that scratch space.
+ */
+typedef struct {
+    const secp256k1_ecmult_multi_params *params;
+    secp256k1_scratch *scratch;
+    size_t scratch_checkpoint;
+    secp256k1_scalar *scalars;
+    secp256k1_ge *points;
+    size_t len;
+    size_t capacity;
+    secp256k1_scalar sc_g;
+    secp256k1_sha256 transcript;
+    /* 0 if an equation has been found not to hold since the last reset */
+    int result;
+} secp256k1_ecmult_batch;
+
+/** Returns the scratch space size that lets a batch with a capacity of
+ *  max_terms run its multi-multiplications in a single pass. */
+static size_t secp256k1_ecmult_batch_scratch_size(size_t max_terms);
+
+/** Initializes a batch holding up to max_terms terms, allocated on scratch,
+ *  whose multi-multiplications choose their algorithm according to params.
+ *  Returns 0 if max_terms is 0 or doesn't fit in the scratch space. */
+static int secp256k1_ecmult_batch_init(const secp256k1_callback *error_callback, const secp256k1_ecmult_multi_params *params, secp256k1_ecmult_batch *batch, secp256k1_scratch *scratch, size_t max_terms);
+
+/** Releases the allocations of the batch on its scratch space. */
+static void secp256k1_ecmult_batch_clear(const secp256k1_callback *error_callback, secp256k1_ecmult_batch *batch);
+
+/** Empties the batch and forgets about previous failures. The transcript is
+ *  kept, so randomizers never repeat over the lifetime of the batch. */
+static void secp256k1_ecmult_batch_reset(secp256k1_ecmult_batch *batch);
+
+/** Ensures that n_terms more terms fit into the batch, verifying and emptying
+ *  it if necessary. n_terms must not exceed the capacity. */
+static void secp256k1_ecmult_batch_reserve(const secp256k1_callback *error_callback, secp256k1_ecmult_batch *batch, size_t n_terms);
+
+/** Derives the randomizer for the next equation. The caller must have written
+ *  an unambiguous encoding of the equation to batch->transcript before. */
+static void secp256k1_ecmult_batch_randomizer(secp256k1_ecmult_batch *batch, secp256k1_scalar *r);
+
+/** Adds the term sc*pt to the batch. Space must have been reserved. */
+static void secp256k1_ecmult_batch_add(secp256k1_ecmult_batch *batch, const secp256k1_scalar *sc, const secp256k1_ge *pt);
+
+/** Adds the term sc*G to the batch. */
+static void secp256k1_ecmult_batch_add_g(secp256k1_ecmult_batch *batch, const secp256k1_scalar *sc);
+
+/** Checks all equations added since the last reset and resets the batch.
+ *  Returns 1 if all of them hold, 0 otherwise. */
+static int secp256k1_ecmult_batch_verify(const secp256k1_callback *error_callback, secp256k1_ecmult_batch *batch);
+
+/** Adds the equations offset..offset+len-1 of a caller-defined list to the
+ *  empty batch and verifies them. Returns 1 if all of them are well-formed
+ *  and hold, 0 otherwise. */
+typedef int (secp256k1_ecmult_batch_range_callback)(secp256k1_ecmult_batch *batch, size_t offset, size_t len, void *data);
+
+/** Checks all n equations of a list with cb. Returns 1 if all of them hold.
+ *  Otherwise returns 0 and, if invalid_idx is not NULL, sets *invalid_idx to
+ *  the index of the first equation that doesn't hold. Finding that index
+ *  bisects the list, which costs about as much as checking it again. */
+static int secp256k1_ecmult_batch_find_invalid(secp256k1_ecmult_batch *batch, size_t *invalid_idx, secp256k1_ecmult_batch_range_callback cb, void *cbdata, size_t n);
+
+#endif /* SECP256K1_ECMULT_BATCH_H */
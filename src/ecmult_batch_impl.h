@@ -0,0 +1,133 @@
+/***********************************************************************
+ * Distributed under the MIT software license, see the accompanying    *
+ * file COPYING or https://www.opensource.org/licenses/mit-license.php.*
+ ***********************************************************************/
+
+#ifndef SECP256K1_ECMULT_BATCH_IMPL_H
+#define SECP256K1_ECMULT_BATCH_IMPL_H
+
+#include "ecmult_batch.h"
+#include "ecmult_impl.h"
+#include "hash_impl.h"
+#include "scratch_impl.h"
+
+static size_t secp256k1_ecmult_batch_scratch_size(size_t max_terms) {
+    size_t arrays = max_terms * (sizeof(secp256k1_scalar) + sizeof(secp256k1_ge)) + 2 * ALIGNMENT;
+    return arrays + secp256k1_ecmult_multi_scratch_size_internal(max_terms);
+}
+
+static int secp256k1_ecmult_batch_init(const secp256k1_callback *error_callback, const secp256k1_ecmult_multi_params *params, secp256k1_ecmult_batch *batch, secp256k1_scratch *scratch, size_t max_terms) {
+    if (max_terms == 0 || max_terms > SIZE_MAX / sizeof(secp256k1_ge)) {
+        return 0;
+    }
+    batch->params = params;
+    batch->scratch = scratch;
+    batch->scratch_checkpoint = secp256k1_scratch_checkpoint(error_callback, scratch);
+    batch->scalars = (secp256k1_scalar *)secp256k1_scratch_alloc(error_callback, scratch, max_terms * sizeof(secp256k1_scalar));
+    batch->points = (secp256k1_ge *)secp256k1_scratch_alloc(error_callback, scratch, max_terms * sizeof(secp256k1_ge));
+    if (batch->scalars == NULL || batch->points == NULL) {
+        secp256k1_scratch_apply_checkpoint(error_callback, scratch, batch->scratch_checkpoint);
+        return 0;
+    }
+    batch->capacity = max_terms;
+    secp256k1_sha256_initialize(&batch->transcript);
+    secp256k1_ecmult_batch_reset(batch);
+    return 1;
+}
+
+static void secp256k1_ecmult_batch_clear(const secp256k1_callback *error_callback, secp256k1_ecmult_batch *batch) {
+    secp256k1_scratch_apply_checkpoint(error_callback, batch->scratch, batch->scratch_checkpoint);
+}
+
+static void secp256k1_ecmult_batch_reset(secp256k1_ecmult_batch *batch) {
+    batch->len = 0;
+    secp256k1_scalar_set_int(&batch->sc_g, 0);
+    batch->result = 1;
+}
+
+static int secp256k1_ecmult_batch_callback(secp256k1_scalar *sc, secp256k1_ge *pt, size_t idx, void *data) {
+    const secp256k1_ecmult_batch *batch = (const secp256k1_ecmult_batch *)data;
+    *sc = batch->scalars[idx];
+    *pt = batch->points[idx];
+    return 1;
+}
+
+/* Multiplies out the terms in the batch, stores whether they sum up to
+ * infinity in batch->result and empties the batch. */
+static void secp256k1_ecmult_batch_flush(const secp256k1_callback *error_callback, secp256k1_ecmult_batch *batch) {
+    secp256k1_gej r;
+
+    if (batch->result && (batch->len > 0 || !secp256k1_scalar_is_zero(&batch->sc_g))) {
+        batch->result = secp256k1_ecmult_multi_var_with_params(batch->params, error_callback, batch->scratch, &r, &batch->sc_g, secp256k1_ecmult_batch_callback, (void *)batch, batch->len)
+                        && secp256k1_gej_is_infinity(&r);
+    }
+    batch->len = 0;
+    secp256k1_scalar_set_int(&batch->sc_g, 0);
+}
+
+static void secp256k1_ecmult_batch_reserve(const secp256k1_callback *error_callback, secp256k1_ecmult_batch *batch, size_t n_terms) {
+    VERIFY_CHECK(n_terms <= batch->capacity);
+    if (batch->capacity - batch->len < n_terms) {
+        secp256k1_ecmult_batch_flush(error_callback, batch);
+    }
+}
+
+static void secp256k1_ecmult_batch_randomizer(secp256k1_ecmult_batch *batch, secp256k1_scalar *r) {
+    secp256k1_sha256 sha = batch->transcript;
+    unsigned char buf[32];
+
+    secp256k1_sha256_finalize(&sha, buf);
+    /* Overflow only happens with negligible probability and doesn't matter,
+     * the randomizer just needs to be unpredictable. */
+    secp256k1_scalar_set_b32(r, buf, NULL);
+}
+
+static void secp256k1_ecmult_batch_add(secp256k1_ecmult_batch *batch, const secp256k1_scalar *sc, const secp256k1_ge *pt) {
+    VERIFY_CHECK(batch->len < batch->capacity);
+    batch->scalars[batch->len] = *sc;
+    batch->points[batch->len] = *pt;
+    batch->len++;
+}
+
+static void secp256k1_ecmult_batch_add_g(secp256k1_ecmult_batch *batch, const secp256k1_scalar *sc) {
+    secp256k1_scalar_add(&batch->sc_g, &batch->sc_g, sc);
+}
+
+static int secp256k1_ecmult_batch_verify(const secp256k1_callback *error_callback, secp256k1_ecmult_batch *batch) {
+    int ret;
+
+    secp256k1_ecmult_batch_flush(error_callback, batch);
+    ret = batch->result;
+    secp256k1_ecmult_batch_reset(batch);
+    return ret;
+}
+
+static int secp256k1_ecmult_batch_find_invalid(secp256k1_ecmult_batch *batch, size_t *invalid_idx, secp256k1_ecmult_batch_range_callback cb, void *cbdata, size_t n) {
+    size_t offset = 0;
+
+    secp256k1_ecmult_batch_reset(batch);
+    if (cb(batch, 0, n, cbdata)) {
+        return 1;
+    }
+    if (invalid_idx == NULL) {
+        return 0;
+    }
+
+    /* If the left half of the remaining range holds, the first equation that
+     * doesn't is in the right half. The ranges checked shrink by half in every
+     * step, so in total they are about as large as the whole list. */
+    while (n > 1) {
+        size_t half = n / 2;
+        secp256k1_ecmult_batch_reset(batch);
+        if (cb(batch, offset, half, cbdata)) {
+            offset += half;
+            n -= half;
+        } else {
+            n = half;
+        }
+    }
+    *invalid_idx = offset;
+    return 0;
+}
+
+#endif /* SECP256K1_ECMULT_BATCH_IMPL_H */
@@ -107,6 +107,14 @@
 #  error "COMB_TEETH can be reduced"
 #endif
 
+/* Limits for comb tables computed at runtime by secp256k1_ecmult_gen_context_build_comb.
+ * Every table lookup scans all (1 << (teeth - 1)) entries of a block, so more teeth
+ * quickly stop paying off. The other parameter checks above imply that the number of
+ * bits covered by all the blocks is less than 2 * 256. */
+#define ECMULT_GEN_MAX_COMB_BLOCKS 256
+#define ECMULT_GEN_MAX_COMB_TEETH 12
+#define ECMULT_GEN_MAX_COMB_BITS 512
+
 #ifdef DEBUG_CONFIG
 #  pragma message DEBUG_CONFIG_DEF(COMB_RANGE)
 #  pragma message DEBUG_CONFIG_DEF(COMB_BLOCKS)
@@ -118,6 +126,11 @@ typedef struct {
     /* Whether the context has been built. */
     int built;
 
+    /* The point the comb table is computed for, which is G unless the table was
+     * computed by secp256k1_ecmult_gen_context_build_comb for another generator.
+     * Everything below refers to it as G. */
+    secp256k1_ge gen;
+
     /* Values chosen such that
      *
      *   n*G == comb(n + scalar_offset, G/2) + ge_offset.
@@ -130,11 +143,43 @@ typedef struct {
     /* Factor used for projective blinding. This value is used to rescale the Z
      * coordinate of the first table lookup. */
     secp256k1_fe proj_blind;
+
+    /* The comb table with blocks * (1 << (teeth - 1)) entries and its parameters,
+     * which are COMB_BLOCKS, COMB_TEETH and COMB_SPACING unless the table was
+     * computed by secp256k1_ecmult_gen_context_build_comb. */
+    const secp256k1_ge_storage *table;
+    int blocks;
+    int teeth;
+    int spacing;
 } secp256k1_ecmult_gen_context;
 
 static void secp256k1_ecmult_gen_context_build(secp256k1_ecmult_gen_context* ctx);
 static void secp256k1_ecmult_gen_context_clear(secp256k1_ecmult_gen_context* ctx);
 
+/** Returns whether blocks and teeth are valid parameters for
+ *  secp256k1_ecmult_gen_context_build_comb. */
+static int secp256k1_ecmult_gen_comb_params_valid(int blocks, int teeth);
+
+/** Like secp256k1_ecmult_gen_context_build, but computes a comb table for the generator
+ *  gen (which must not be infinity) with the given parameters, which must be valid.
+ *  Returns 0 if the allocation failed. */
+static int secp256k1_ecmult_gen_context_build_comb(secp256k1_ecmult_gen_context* ctx, const secp256k1_callback* error_callback, const secp256k1_ge* gen, int blocks, int teeth);
+
+/** Returns whether the table of ctx was allocated by secp256k1_ecmult_gen_context_build_comb. */
+static int secp256k1_ecmult_gen_context_is_allocated(const secp256k1_ecmult_gen_context* ctx);
+
+/** Makes dst, a copy of src switched to the default table, a copy of src with its own
+ *  copy of the table. Returns 0 if the allocation failed, in which case dst is unchanged. */
+static int secp256k1_ecmult_gen_context_clone_table(secp256k1_ecmult_gen_context* dst, const secp256k1_callback* error_callback, const secp256k1_ecmult_gen_context* src);
+
+/** Switches ctx, whose generator must be G, to the default table, keeping the blinding
+ *  values. Frees the table if free_table is set. */
+static void secp256k1_ecmult_gen_context_set_default_table(secp256k1_ecmult_gen_context* ctx, int free_table);
+
+/** Frees the table of ctx if it was allocated and clears ctx. Unlike
+ *  secp256k1_ecmult_gen_context_set_default_table, this works for any generator. */
+static void secp256k1_ecmult_gen_context_free(secp256k1_ecmult_gen_context* ctx);
+
 /** Multiply with the generator: R = a*G */
 static void secp256k1_ecmult_gen(const secp256k1_ecmult_gen_context* ctx, secp256k1_gej *r, const secp256k1_scalar *a);
 
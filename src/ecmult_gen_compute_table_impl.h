@@ -46,7 +46,10 @@ static void secp256k1_ecmult_gen_compute_table(secp256k1_ge_storage* table, cons
     }
 #endif
 
-    for (block = 0; block < blocks; ++block) {
+    /* A do-while loop, as blocks is positive. This lets compilers see that vs is
+     * written before it is read when blocks is only known at runtime. */
+    block = 0;
+    do {
         int tooth;
         /* Here u = 2^(block*teeth*spacing) * gen/2. */
         secp256k1_gej sum;
@@ -85,7 +88,7 @@ static void secp256k1_ecmult_gen_compute_table(secp256k1_ge_storage* table, cons
                 secp256k1_gej_add_var(&vs[vs_pos], &vs[vs_pos - stride], &ds[tooth], NULL);
             }
         }
-    }
+    } while (++block < blocks);
     VERIFY_CHECK(vs_pos == points_total);
 
     /* Convert all points simultaneously from secp256k1_gej to secp256k1_ge. */
@@ -13,27 +13,77 @@
 #include "ecmult_gen.h"
 #include "hash_impl.h"
 #include "precomputed_ecmult_gen.h"
+#include "ecmult_gen_compute_table_impl.h"
+
+static void secp256k1_ecmult_gen_context_set_table(secp256k1_ecmult_gen_context *ctx, const secp256k1_ge_storage *table, int blocks, int teeth) {
+    ctx->table = table;
+    ctx->blocks = blocks;
+    ctx->teeth = teeth;
+    ctx->spacing = CEIL_DIV(COMB_RANGE, blocks * teeth);
+}
 
 static void secp256k1_ecmult_gen_context_build(secp256k1_ecmult_gen_context *ctx) {
+    ctx->gen = secp256k1_ge_const_g;
+    secp256k1_ecmult_gen_context_set_table(ctx, &secp256k1_ecmult_gen_prec_table[0][0], COMB_BLOCKS, COMB_TEETH);
     secp256k1_ecmult_gen_blind(ctx, NULL);
     ctx->built = 1;
 }
 
+static int secp256k1_ecmult_gen_comb_params_valid(int blocks, int teeth) {
+    int spacing;
+
+    if (blocks < 1 || blocks > ECMULT_GEN_MAX_COMB_BLOCKS || teeth < 1 || teeth > ECMULT_GEN_MAX_COMB_TEETH) {
+        return 0;
+    }
+    spacing = CEIL_DIV(COMB_RANGE, blocks * teeth);
+    /* Same as the checks on COMB_BLOCKS and COMB_TEETH in ecmult_gen.h. */
+    if ((blocks - 1) * teeth * spacing >= 256 || blocks * (teeth - 1) * spacing >= 256) {
+        return 0;
+    }
+    VERIFY_CHECK(blocks * teeth * spacing <= ECMULT_GEN_MAX_COMB_BITS);
+    return 1;
+}
+
+static int secp256k1_ecmult_gen_context_build_comb(secp256k1_ecmult_gen_context *ctx, const secp256k1_callback *error_callback, const secp256k1_ge *gen, int blocks, int teeth) {
+    secp256k1_ge_storage *table;
+
+    VERIFY_CHECK(secp256k1_ecmult_gen_comb_params_valid(blocks, teeth));
+    VERIFY_CHECK(!secp256k1_ge_is_infinity(gen));
+    table = (secp256k1_ge_storage *)checked_malloc(error_callback, ((size_t)blocks << (teeth - 1)) * sizeof(secp256k1_ge_storage));
+    if (table == NULL) {
+        return 0;
+    }
+    secp256k1_ecmult_gen_compute_table(table, gen, blocks, teeth, CEIL_DIV(COMB_RANGE, blocks * teeth));
+    ctx->gen = *gen;
+    secp256k1_ecmult_gen_context_set_table(ctx, table, blocks, teeth);
+    secp256k1_ecmult_gen_blind(ctx, NULL);
+    ctx->built = 1;
+    return 1;
+}
+
 static int secp256k1_ecmult_gen_context_is_built(const secp256k1_ecmult_gen_context* ctx) {
     return ctx->built;
 }
 
+static int secp256k1_ecmult_gen_context_is_allocated(const secp256k1_ecmult_gen_context* ctx) {
+    return ctx->table != NULL && ctx->table != &secp256k1_ecmult_gen_prec_table[0][0];
+}
+
 static void secp256k1_ecmult_gen_context_clear(secp256k1_ecmult_gen_context *ctx) {
     ctx->built = 0;
+    secp256k1_ge_clear(&ctx->gen);
     secp256k1_scalar_clear(&ctx->scalar_offset);
     secp256k1_ge_clear(&ctx->ge_offset);
     secp256k1_fe_clear(&ctx->proj_blind);
+    ctx->table = NULL;
 }
 
 /* Compute the scalar (2^COMB_BITS - 1) / 2, the difference between the gn argument to
  * secp256k1_ecmult_gen, and the scalar whose encoding the table lookup bits are drawn
- * from (before applying blinding). */
-static void secp256k1_ecmult_gen_scalar_diff(secp256k1_scalar* diff) {
+ * from (before applying blinding). COMB_BITS is the number of bits covered by the
+ * comb table of ctx. */
+static void secp256k1_ecmult_gen_scalar_diff(const secp256k1_ecmult_gen_context *ctx, secp256k1_scalar* diff) {
+    int comb_bits = ctx->blocks * ctx->teeth * ctx->spacing;
     int i;
 
     /* Compute scalar -1/2. */
@@ -43,7 +93,7 @@ static void secp256k1_ecmult_gen_scalar_diff(secp256k1_scalar* diff) {
 
     /* Compute offset = 2^(COMB_BITS - 1). */
     *diff = secp256k1_scalar_one;
-    for (i = 0; i < COMB_BITS - 1; ++i) {
+    for (i = 0; i < comb_bits - 1; ++i) {
         secp256k1_scalar_add(diff, diff, diff);
     }
 
@@ -51,16 +101,63 @@ static void secp256k1_ecmult_gen_scalar_diff(secp256k1_scalar* diff) {
     secp256k1_scalar_add(diff, diff, &neghalf);
 }
 
+static void secp256k1_ecmult_gen_context_set_default_table(secp256k1_ecmult_gen_context *ctx, int free_table) {
+    secp256k1_scalar diff;
+
+    if (!secp256k1_ecmult_gen_context_is_allocated(ctx)) {
+        return;
+    }
+    VERIFY_CHECK(secp256k1_ge_eq_var(&ctx->gen, &secp256k1_ge_const_g));
+    /* scalar_offset = diff - b depends on the number of bits covered by the table,
+     * so replace the old diff with the new one. */
+    secp256k1_ecmult_gen_scalar_diff(ctx, &diff);
+    secp256k1_scalar_negate(&diff, &diff);
+    secp256k1_scalar_add(&ctx->scalar_offset, &ctx->scalar_offset, &diff);
+    if (free_table) {
+        free((void *)ctx->table);
+    }
+    secp256k1_ecmult_gen_context_set_table(ctx, &secp256k1_ecmult_gen_prec_table[0][0], COMB_BLOCKS, COMB_TEETH);
+    secp256k1_ecmult_gen_scalar_diff(ctx, &diff);
+    secp256k1_scalar_add(&ctx->scalar_offset, &ctx->scalar_offset, &diff);
+}
+
+static int secp256k1_ecmult_gen_context_clone_table(secp256k1_ecmult_gen_context *dst, const secp256k1_callback *error_callback, const secp256k1_ecmult_gen_context *src) {
+    secp256k1_ge_storage *table;
+    size_t size;
+
+    if (!secp256k1_ecmult_gen_context_is_allocated(src)) {
+        return 1;
+    }
+    size = ((size_t)src->blocks << (src->teeth - 1)) * sizeof(secp256k1_ge_storage);
+    table = (secp256k1_ge_storage *)checked_malloc(error_callback, size);
+    if (table == NULL) {
+        return 0;
+    }
+    memcpy(table, src->table, size);
+    *dst = *src;
+    dst->table = table;
+    return 1;
+}
+
+static void secp256k1_ecmult_gen_context_free(secp256k1_ecmult_gen_context *ctx) {
+    if (secp256k1_ecmult_gen_context_is_allocated(ctx)) {
+        free((void *)ctx->table);
+    }
+    secp256k1_ecmult_gen_context_clear(ctx);
+}
+
 static void secp256k1_ecmult_gen(const secp256k1_ecmult_gen_context *ctx, secp256k1_gej *r, const secp256k1_scalar *gn) {
+    const int blocks = ctx->blocks, teeth = ctx->teeth, spacing = ctx->spacing;
+    const uint32_t points = (uint32_t)1 << (teeth - 1);
     uint32_t comb_off;
     secp256k1_ge add;
     secp256k1_fe neg;
     secp256k1_ge_storage adds;
     secp256k1_scalar d;
-    /* Array of uint32_t values large enough to store COMB_BITS bits. Only the bottom
-     * 8 are ever nonzero, but having the zero padding at the end if COMB_BITS>256
-     * avoids the need to deal with out-of-bounds reads from a scalar. */
-    uint32_t recoded[(COMB_BITS + 31) >> 5] = {0};
+    /* Array of uint32_t values large enough to store COMB_BITS bits for any table.
+     * Only the bottom 8 are ever nonzero, but having the zero padding at the end if
+     * COMB_BITS>256 avoids the need to deal with out-of-bounds reads from a scalar. */
+    uint32_t recoded[(ECMULT_GEN_MAX_COMB_BITS + 31) >> 5] = {0};
     int first = 1, i;
 
     memset(&adds, 0, sizeof(adds));
@@ -109,7 +206,7 @@ static void secp256k1_ecmult_gen(const secp256k1_ecmult_gen_context *ctx, secp25
     /* Compute the scalar d = (gn + ctx->scalar_offset). */
     secp256k1_scalar_add(&d, &ctx->scalar_offset, gn);
     /* Convert to recoded array. */
-    for (i = 0; i < 8 && i < ((COMB_BITS + 31) >> 5); ++i) {
+    for (i = 0; i < 8 && i < ((blocks * teeth * spacing + 31) >> 5); ++i) {
         recoded[i] = secp256k1_scalar_get_bits_limb32(&d, 32 * i, 32);
     }
     secp256k1_scalar_clear(&d);
@@ -186,15 +283,17 @@ static void secp256k1_ecmult_gen(const secp256k1_ecmult_gen_context *ctx, secp25
      * it.
      *
      * secp256k1_ecmult_gen_prec_table[b][index] stores the table(b, m) entries. Index
-     * is the relevant mask(b) bits of m packed together without gaps. */
+     * is the relevant mask(b) bits of m packed together without gaps. Tables computed
+     * at runtime have the same layout, with ctx->blocks, ctx->teeth and ctx->spacing
+     * taking the place of COMB_BLOCKS, COMB_TEETH and COMB_SPACING. */
 
-    /* Outer loop: iterate over comb_off from COMB_SPACING - 1 down to 0. */
-    comb_off = COMB_SPACING - 1;
+    /* Outer loop: iterate over comb_off from spacing - 1 down to 0. */
+    comb_off = spacing - 1;
     while (1) {
         uint32_t block;
         uint32_t bit_pos = comb_off;
         /* Inner loop: for each block, add table entries to the result. */
-        for (block = 0; block < COMB_BLOCKS; ++block) {
+        for (block = 0; block < (uint32_t)blocks; ++block) {
             /* Gather the mask(block)-selected bits of d into bits. They're packed:
              * bits[tooth] = d[(block*COMB_TEETH + tooth)*COMB_SPACING + comb_off]. */
             uint32_t bits = 0, sign, abs, index, tooth;
@@ -206,7 +305,7 @@ static void secp256k1_ecmult_gen(const secp256k1_ecmult_gen_context *ctx, secp25
              * just two values when reading a single bit into a variable.) See:
              * https://www.usenix.org/system/files/conference/usenixsecurity18/sec18-alam.pdf
              */
-            for (tooth = 0; tooth < COMB_TEETH; ++tooth) {
+            for (tooth = 0; tooth < (uint32_t)teeth; ++tooth) {
                 /* Construct bitdata s.t. the bottom bit is the bit we'd like to read.
                  *
                  * We could just set bitdata = recoded[bit_pos >> 5] >> (bit_pos & 0x1f)
@@ -224,15 +323,15 @@ static void secp256k1_ecmult_gen(const secp256k1_ecmult_gen_context *ctx, secp25
 
                 /* Write the bit into position tooth (and junk into higher bits). */
                 bits ^= bitdata << tooth;
-                bit_pos += COMB_SPACING;
+                bit_pos += spacing;
             }
 
             /* If the top bit of bits is 1, flip them all (corresponding to looking up
              * the negated table value), and remember to negate the result in sign. */
-            sign = (bits >> (COMB_TEETH - 1)) & 1;
-            abs = (bits ^ -sign) & (COMB_POINTS - 1);
+            sign = (bits >> (teeth - 1)) & 1;
+            abs = (bits ^ -sign) & (points - 1);
             VERIFY_CHECK(sign == 0 || sign == 1);
-            VERIFY_CHECK(abs < COMB_POINTS);
+            VERIFY_CHECK(abs < points);
 
             /** This uses a conditional move to avoid any secret data in array indexes.
              *   _Any_ use of secret indexes has been demonstrated to result in timing
@@ -244,8 +343,8 @@ static void secp256k1_ecmult_gen(const secp256k1_ecmult_gen_context *ctx, secp25
              *    by Dag Arne Osvik, Adi Shamir, and Eran Tromer
              *    (https://www.tau.ac.il/~tromer/papers/cache.pdf)
              */
-            for (index = 0; index < COMB_POINTS; ++index) {
-                secp256k1_ge_storage_cmov(&adds, &secp256k1_ecmult_gen_prec_table[block][index], index == abs);
+            for (index = 0; index < points; ++index) {
+                secp256k1_ge_storage_cmov(&adds, &ctx->table[block * points + index], index == abs);
             }
 
             /* Set add=adds or add=-adds, in constant time, based on sign. */
@@ -292,11 +391,11 @@ static void secp256k1_ecmult_gen_blind(secp256k1_ecmult_gen_context *ctx, const
     unsigned char keydata[64];
 
     /* Compute the (2^COMB_BITS - 1)/2 term once. */
-    secp256k1_ecmult_gen_scalar_diff(&diff);
+    secp256k1_ecmult_gen_scalar_diff(ctx, &diff);
 
     if (seed32 == NULL) {
         /* When seed is NULL, reset the final point and blinding value. */
-        secp256k1_ge_neg(&ctx->ge_offset, &secp256k1_ge_const_g);
+        secp256k1_ge_neg(&ctx->ge_offset, &ctx->gen);
         secp256k1_scalar_add(&ctx->scalar_offset, &secp256k1_scalar_one, &diff);
         ctx->proj_blind = secp256k1_fe_one;
         return;
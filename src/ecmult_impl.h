@@ -9,12 +9,14 @@
 
 #include <string.h>
 #include <stdint.h>
+#include <time.h>
 
 #include "util.h"
 #include "group.h"
 #include "scalar.h"
 #include "ecmult.h"
 #include "precomputed_ecmult.h"
+#include "ecmult_compute_table_impl.h"
 
 #if defined(EXHAUSTIVE_TEST_ORDER)
 /* We need to lower these values for exhaustive tests because
@@ -46,16 +48,24 @@
 #define WNAF_SIZE(w) WNAF_SIZE_BITS(WNAF_BITS, w)
 
 /* The number of objects allocated on the scratch space for ecmult_multi algorithms */
-#define PIPPENGER_SCRATCH_OBJECTS 6
+#define PIPPENGER_SCRATCH_OBJECTS 9
 #define STRAUSS_SCRATCH_OBJECTS 5
 
-#define PIPPENGER_MAX_BUCKET_WINDOW 12
+/* Minimum bucket window for which Pippenger's algorithm accumulates buckets in
+ * affine coordinates. Below, there are too few points per bucket for the
+ * batched inversions to pay off. */
+#define PIPPENGER_AFFINE_MIN_BUCKET_WINDOW 9
 
 /* Minimum number of points for which pippenger_wnaf is faster than strauss wnaf */
 #define ECMULT_PIPPENGER_THRESHOLD 88
 
 #define ECMULT_MAX_POINTS_PER_BATCH 5000000
 
+/* Maximum number of points that API functions which allocate a scratch space
+ * internally make room for. Beyond this, the per-point cost of Pippenger's
+ * algorithm barely improves, but the required memory keeps growing. */
+#define ECMULT_MAX_SCRATCH_POINTS 16384
+
 /** Fill a table 'pre_a' with precomputed odd multiples of a.
  *  pre_a will contain [1*a,3*a,...,(2*n-1)*a], so it needs space for n group elements.
  *  zr needs space for n field elements.
@@ -234,7 +244,60 @@ struct secp256k1_strauss_state {
     struct secp256k1_strauss_point_state* ps;
 };
 
-static void secp256k1_ecmult_strauss_wnaf(const struct secp256k1_strauss_state *state, secp256k1_gej *r, size_t num, const secp256k1_gej *a, const secp256k1_scalar *na, const secp256k1_scalar *ng) {
+static void secp256k1_ecmult_tables_set_default(secp256k1_ecmult_tables *tables) {
+    tables->pre_g = secp256k1_pre_g;
+    tables->pre_g_128 = secp256k1_pre_g_128;
+    tables->window_g = WINDOW_G;
+}
+
+static int secp256k1_ecmult_tables_is_allocated(const secp256k1_ecmult_tables *tables) {
+    return tables->pre_g != secp256k1_pre_g;
+}
+
+static int secp256k1_ecmult_tables_build(const secp256k1_callback *error_callback, secp256k1_ecmult_tables *tables, int window_g) {
+    secp256k1_ge_storage *pre_g;
+
+    VERIFY_CHECK(window_g >= 2 && window_g <= 24);
+    /* Both tables live in a single allocation, pre_g_128 right after pre_g. */
+    pre_g = (secp256k1_ge_storage *)checked_malloc(error_callback, 2 * ECMULT_TABLE_SIZE(window_g) * sizeof(secp256k1_ge_storage));
+    if (pre_g == NULL) {
+        return 0;
+    }
+    secp256k1_ecmult_compute_two_tables(pre_g, pre_g + ECMULT_TABLE_SIZE(window_g), window_g, &secp256k1_ge_const_g);
+    tables->pre_g = pre_g;
+    tables->pre_g_128 = pre_g + ECMULT_TABLE_SIZE(window_g);
+    tables->window_g = window_g;
+    return 1;
+}
+
+static int secp256k1_ecmult_tables_clone(const secp256k1_callback *error_callback, secp256k1_ecmult_tables *dst, const secp256k1_ecmult_tables *src) {
+    secp256k1_ge_storage *pre_g;
+    size_t size;
+
+    if (!secp256k1_ecmult_tables_is_allocated(src)) {
+        *dst = *src;
+        return 1;
+    }
+    size = 2 * ECMULT_TABLE_SIZE(src->window_g) * sizeof(secp256k1_ge_storage);
+    pre_g = (secp256k1_ge_storage *)checked_malloc(error_callback, size);
+    if (pre_g == NULL) {
+        return 0;
+    }
+    memcpy(pre_g, src->pre_g, size);
+    dst->pre_g = pre_g;
+    dst->pre_g_128 = pre_g + ECMULT_TABLE_SIZE(src->window_g);
+    dst->window_g = src->window_g;
+    return 1;
+}
+
+static void secp256k1_ecmult_tables_free(secp256k1_ecmult_tables *tables) {
+    if (secp256k1_ecmult_tables_is_allocated(tables)) {
+        free((void *)tables->pre_g);
+    }
+    secp256k1_ecmult_tables_set_default(tables);
+}
+
+static void secp256k1_ecmult_strauss_wnaf(const secp256k1_ecmult_tables *tables, const struct secp256k1_strauss_state *state, secp256k1_gej *r, size_t num, const secp256k1_gej *a, const secp256k1_scalar *na, const secp256k1_scalar *ng) {
     secp256k1_ge tmpa;
     secp256k1_fe Z;
     /* Split G factors. */
@@ -306,8 +369,8 @@ static void secp256k1_ecmult_strauss_wnaf(const struct secp256k1_strauss_state *
         secp256k1_scalar_split_128(&ng_1, &ng_128, ng);
 
         /* Build wnaf representation for ng_1 and ng_128 */
-        bits_ng_1   = secp256k1_ecmult_wnaf(wnaf_ng_1,   129, &ng_1,   WINDOW_G);
-        bits_ng_128 = secp256k1_ecmult_wnaf(wnaf_ng_128, 129, &ng_128, WINDOW_G);
+        bits_ng_1   = secp256k1_ecmult_wnaf(wnaf_ng_1,   129, &ng_1,   tables->window_g);
+        bits_ng_128 = secp256k1_ecmult_wnaf(wnaf_ng_128, 129, &ng_128, tables->window_g);
         if (bits_ng_1 > bits) {
             bits = bits_ng_1;
         }
@@ -332,11 +395,11 @@ static void secp256k1_ecmult_strauss_wnaf(const struct secp256k1_strauss_state *
             }
         }
         if (i < bits_ng_1 && (n = wnaf_ng_1[i])) {
-            secp256k1_ecmult_table_get_ge_storage(&tmpa, secp256k1_pre_g, n, WINDOW_G);
+            secp256k1_ecmult_table_get_ge_storage(&tmpa, tables->pre_g, n, tables->window_g);
             secp256k1_gej_add_zinv_var(r, r, &tmpa, &Z);
         }
         if (i < bits_ng_128 && (n = wnaf_ng_128[i])) {
-            secp256k1_ecmult_table_get_ge_storage(&tmpa, secp256k1_pre_g_128, n, WINDOW_G);
+            secp256k1_ecmult_table_get_ge_storage(&tmpa, tables->pre_g_128, n, tables->window_g);
             secp256k1_gej_add_zinv_var(r, r, &tmpa, &Z);
         }
     }
@@ -346,7 +409,7 @@ static void secp256k1_ecmult_strauss_wnaf(const struct secp256k1_strauss_state *
     }
 }
 
-static void secp256k1_ecmult(secp256k1_gej *r, const secp256k1_gej *a, const secp256k1_scalar *na, const secp256k1_scalar *ng) {
+static void secp256k1_ecmult_with_tables(const secp256k1_ecmult_tables *tables, secp256k1_gej *r, const secp256k1_gej *a, const secp256k1_scalar *na, const secp256k1_scalar *ng) {
     secp256k1_fe aux[ECMULT_TABLE_SIZE(WINDOW_A)];
     secp256k1_ge pre_a[ECMULT_TABLE_SIZE(WINDOW_A)];
     struct secp256k1_strauss_point_state ps[1];
@@ -355,7 +418,209 @@ static void secp256k1_ecmult(secp256k1_gej *r, const secp256k1_gej *a, const sec
     state.aux = aux;
     state.pre_a = pre_a;
     state.ps = ps;
-    secp256k1_ecmult_strauss_wnaf(&state, r, 1, a, na, ng);
+    secp256k1_ecmult_strauss_wnaf(tables, &state, r, 1, a, na, ng);
+}
+
+static void secp256k1_ecmult(secp256k1_gej *r, const secp256k1_gej *a, const secp256k1_scalar *na, const secp256k1_scalar *ng) {
+    secp256k1_ecmult_tables tables;
+
+    secp256k1_ecmult_tables_set_default(&tables);
+    secp256k1_ecmult_with_tables(&tables, r, a, na, ng);
+}
+
+static void secp256k1_ecmult_interleaved(const secp256k1_ecmult_tables *tables, secp256k1_gej *r, const secp256k1_gej *a, const secp256k1_scalar *na, const secp256k1_scalar *ng, size_t n) {
+    secp256k1_ge pre_a[ECMULT_INTERLEAVE_MAX][ECMULT_TABLE_SIZE(WINDOW_A)];
+    /* aux[k] holds the z-ratios, and then the pre_a[k][i].x * BETA values. */
+    secp256k1_fe aux[ECMULT_INTERLEAVE_MAX][ECMULT_TABLE_SIZE(WINDOW_A)];
+    secp256k1_fe Z[ECMULT_INTERLEAVE_MAX];
+    struct secp256k1_strauss_point_state ps[ECMULT_INTERLEAVE_MAX];
+    int wnaf_ng_1[ECMULT_INTERLEAVE_MAX][129];
+    int bits_ng_1[ECMULT_INTERLEAVE_MAX];
+    int wnaf_ng_128[ECMULT_INTERLEAVE_MAX][129];
+    int bits_ng_128[ECMULT_INTERLEAVE_MAX];
+    secp256k1_ge tmpg_1[ECMULT_INTERLEAVE_MAX];
+    secp256k1_ge tmpg_128[ECMULT_INTERLEAVE_MAX];
+    secp256k1_ge tmpa;
+    int bits = 0;
+    int i, m;
+    size_t k;
+
+    VERIFY_CHECK(n >= 1 && n <= ECMULT_INTERLEAVE_MAX);
+    /* The precomputation is the same as in secp256k1_ecmult_strauss_wnaf with
+     * a single point, done separately for every multiplication. */
+    for (k = 0; k < n; k++) {
+        secp256k1_scalar na_1, na_lam, ng_1, ng_128;
+
+        secp256k1_fe_set_int(&Z[k], 1);
+        ps[k].bits_na_1 = 0;
+        ps[k].bits_na_lam = 0;
+        if (!secp256k1_scalar_is_zero(&na[k]) && !secp256k1_gej_is_infinity(&a[k])) {
+            secp256k1_scalar_split_lambda(&na_1, &na_lam, &na[k]);
+            ps[k].bits_na_1   = secp256k1_ecmult_wnaf(ps[k].wnaf_na_1,   129, &na_1,   WINDOW_A);
+            ps[k].bits_na_lam = secp256k1_ecmult_wnaf(ps[k].wnaf_na_lam, 129, &na_lam, WINDOW_A);
+            secp256k1_ecmult_odd_multiples_table(ECMULT_TABLE_SIZE(WINDOW_A), pre_a[k], aux[k], &Z[k], &a[k]);
+            secp256k1_ge_table_set_globalz(ECMULT_TABLE_SIZE(WINDOW_A), pre_a[k], aux[k]);
+            for (i = 0; i < ECMULT_TABLE_SIZE(WINDOW_A); i++) {
+                secp256k1_fe_mul(&aux[k][i], &pre_a[k][i].x, &secp256k1_const_beta);
+            }
+        }
+        secp256k1_scalar_split_128(&ng_1, &ng_128, &ng[k]);
+        bits_ng_1[k]   = secp256k1_ecmult_wnaf(wnaf_ng_1[k],   129, &ng_1,   tables->window_g);
+        bits_ng_128[k] = secp256k1_ecmult_wnaf(wnaf_ng_128[k], 129, &ng_128, tables->window_g);
+        if (ps[k].bits_na_1 > bits) {
+            bits = ps[k].bits_na_1;
+        }
+        if (ps[k].bits_na_lam > bits) {
+            bits = ps[k].bits_na_lam;
+        }
+        if (bits_ng_1[k] > bits) {
+            bits = bits_ng_1[k];
+        }
+        if (bits_ng_128[k] > bits) {
+            bits = bits_ng_128[k];
+        }
+        secp256k1_gej_set_infinity(&r[k]);
+    }
+
+    /* Every step below touches all n accumulators before the next one depends
+     * on the previous result, so the independent dependency chains of
+     * different multiplications overlap. The entries of the G tables, which
+     * are too large to stay in the L1 cache, are loaded before the doublings,
+     * which hides the latency of the loads. */
+    for (i = bits - 1; i >= 0; i--) {
+        for (k = 0; k < n; k++) {
+            if (i < bits_ng_1[k] && (m = wnaf_ng_1[k][i])) {
+                secp256k1_ecmult_table_get_ge_storage(&tmpg_1[k], tables->pre_g, m, tables->window_g);
+            }
+            if (i < bits_ng_128[k] && (m = wnaf_ng_128[k][i])) {
+                secp256k1_ecmult_table_get_ge_storage(&tmpg_128[k], tables->pre_g_128, m, tables->window_g);
+            }
+        }
+        for (k = 0; k < n; k++) {
+            secp256k1_gej_double_var(&r[k], &r[k], NULL);
+        }
+        for (k = 0; k < n; k++) {
+            if (i < bits_ng_1[k] && wnaf_ng_1[k][i]) {
+                secp256k1_gej_add_zinv_var(&r[k], &r[k], &tmpg_1[k], &Z[k]);
+            }
+        }
+        for (k = 0; k < n; k++) {
+            if (i < bits_ng_128[k] && wnaf_ng_128[k][i]) {
+                secp256k1_gej_add_zinv_var(&r[k], &r[k], &tmpg_128[k], &Z[k]);
+            }
+        }
+        for (k = 0; k < n; k++) {
+            if (i < ps[k].bits_na_1 && (m = ps[k].wnaf_na_1[i])) {
+                secp256k1_ecmult_table_get_ge(&tmpa, pre_a[k], m, WINDOW_A);
+                secp256k1_gej_add_ge_var(&r[k], &r[k], &tmpa, NULL);
+            }
+        }
+        for (k = 0; k < n; k++) {
+            if (i < ps[k].bits_na_lam && (m = ps[k].wnaf_na_lam[i])) {
+                secp256k1_ecmult_table_get_ge_lambda(&tmpa, pre_a[k], aux[k], m, WINDOW_A);
+                secp256k1_gej_add_ge_var(&r[k], &r[k], &tmpa, NULL);
+            }
+        }
+    }
+
+    for (k = 0; k < n; k++) {
+        if (!r[k].infinity) {
+            secp256k1_fe_mul(&r[k].z, &r[k].z, &Z[k]);
+        }
+    }
+}
+
+static int secp256k1_ecmult_point_table_build(const secp256k1_callback *error_callback, secp256k1_ecmult_point_table *table, const secp256k1_ge *a, int window) {
+    secp256k1_ge_storage *pre;
+    secp256k1_gej aj;
+    int i;
+
+    VERIFY_CHECK(!secp256k1_ge_is_infinity(a));
+    VERIFY_CHECK(window >= 2 && window <= 24);
+    /* Both tables live in a single allocation, pre_lam right after pre. */
+    pre = (secp256k1_ge_storage *)checked_malloc(error_callback, 2 * ECMULT_TABLE_SIZE(window) * sizeof(secp256k1_ge_storage));
+    if (pre == NULL) {
+        return 0;
+    }
+    secp256k1_gej_set_ge(&aj, a);
+    secp256k1_ecmult_compute_table(pre, window, &aj);
+    for (i = 0; i < ECMULT_TABLE_SIZE(window); i++) {
+        secp256k1_ge p;
+        secp256k1_ge_from_storage(&p, &pre[i]);
+        secp256k1_ge_mul_lambda(&p, &p);
+        secp256k1_ge_to_storage(&pre[ECMULT_TABLE_SIZE(window) + i], &p);
+    }
+    table->pre = pre;
+    table->pre_lam = pre + ECMULT_TABLE_SIZE(window);
+    table->window = window;
+    return 1;
+}
+
+static void secp256k1_ecmult_point_table_free(secp256k1_ecmult_point_table *table) {
+    free(table->pre);
+    table->pre = NULL;
+    table->pre_lam = NULL;
+}
+
+static void secp256k1_ecmult_with_point_table(const secp256k1_ecmult_tables *tables, const secp256k1_ecmult_point_table *table, secp256k1_gej *r, const secp256k1_scalar *na, const secp256k1_scalar *ng) {
+    secp256k1_ge tmpa;
+    /* Split A factors. */
+    secp256k1_scalar na_1, na_lam;
+    int wnaf_na_1[129];
+    int bits_na_1 = 0;
+    int wnaf_na_lam[129];
+    int bits_na_lam = 0;
+    /* Split G factors. */
+    secp256k1_scalar ng_1, ng_128;
+    int wnaf_ng_1[129];
+    int bits_ng_1 = 0;
+    int wnaf_ng_128[129];
+    int bits_ng_128 = 0;
+    int i;
+    int bits;
+
+    /* split na into na_1 and na_lam (where na = na_1 + na_lam*lambda, and na_1 and na_lam are ~128 bit) */
+    secp256k1_scalar_split_lambda(&na_1, &na_lam, na);
+    bits_na_1   = secp256k1_ecmult_wnaf(wnaf_na_1,   129, &na_1,   table->window);
+    bits_na_lam = secp256k1_ecmult_wnaf(wnaf_na_lam, 129, &na_lam, table->window);
+    bits = bits_na_1 > bits_na_lam ? bits_na_1 : bits_na_lam;
+
+    if (ng) {
+        /* split ng into ng_1 and ng_128 (where gn = gn_1 + gn_128*2^128, and gn_1 and gn_128 are ~128 bit) */
+        secp256k1_scalar_split_128(&ng_1, &ng_128, ng);
+        bits_ng_1   = secp256k1_ecmult_wnaf(wnaf_ng_1,   129, &ng_1,   tables->window_g);
+        bits_ng_128 = secp256k1_ecmult_wnaf(wnaf_ng_128, 129, &ng_128, tables->window_g);
+        if (bits_ng_1 > bits) {
+            bits = bits_ng_1;
+        }
+        if (bits_ng_128 > bits) {
+            bits = bits_ng_128;
+        }
+    }
+
+    /* All table entries are affine, so unlike in secp256k1_ecmult_strauss_wnaf
+     * there is no common Z denominator to correct for. */
+    secp256k1_gej_set_infinity(r);
+    for (i = bits - 1; i >= 0; i--) {
+        int n;
+        secp256k1_gej_double_var(r, r, NULL);
+        if (i < bits_na_1 && (n = wnaf_na_1[i])) {
+            secp256k1_ecmult_table_get_ge_storage(&tmpa, table->pre, n, table->window);
+            secp256k1_gej_add_ge_var(r, r, &tmpa, NULL);
+        }
+        if (i < bits_na_lam && (n = wnaf_na_lam[i])) {
+            secp256k1_ecmult_table_get_ge_storage(&tmpa, table->pre_lam, n, table->window);
+            secp256k1_gej_add_ge_var(r, r, &tmpa, NULL);
+        }
+        if (i < bits_ng_1 && (n = wnaf_ng_1[i])) {
+            secp256k1_ecmult_table_get_ge_storage(&tmpa, tables->pre_g, n, tables->window_g);
+            secp256k1_gej_add_ge_var(r, r, &tmpa, NULL);
+        }
+        if (i < bits_ng_128 && (n = wnaf_ng_128[i])) {
+            secp256k1_ecmult_table_get_ge_storage(&tmpa, tables->pre_g_128, n, tables->window_g);
+            secp256k1_gej_add_ge_var(r, r, &tmpa, NULL);
+        }
+    }
 }
 
 static size_t secp256k1_strauss_scratch_size(size_t n_points) {
@@ -363,9 +628,40 @@ static size_t secp256k1_strauss_scratch_size(size_t n_points) {
     return n_points*point_size;
 }
 
-static int secp256k1_ecmult_strauss_batch(const secp256k1_callback* error_callback, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, void *cbdata, size_t n_points, size_t cb_offset) {
+static void secp256k1_ecmult_multi_input_init_callback(secp256k1_ecmult_multi_input *input, secp256k1_ecmult_multi_callback cb, void *cbdata) {
+    input->cb = cb;
+    input->cbdata = cbdata;
+    input->scalars32 = NULL;
+    input->points64 = NULL;
+}
+
+static void secp256k1_ecmult_multi_input_init_bytes(secp256k1_ecmult_multi_input *input, const unsigned char *scalars32, const unsigned char *points64) {
+    secp256k1_ecmult_multi_input_init_callback(input, NULL, NULL);
+    input->scalars32 = scalars32;
+    input->points64 = points64;
+}
+
+/* Obtains the idx-th scalar and point of input. Returns 0 if the callback
+ * fails, the scalar overflows or the point is all zeros. */
+static SECP256K1_INLINE int secp256k1_ecmult_multi_input_load(const secp256k1_ecmult_multi_input *input, secp256k1_scalar *sc, secp256k1_ge *pt, size_t idx) {
+    int overflow;
+
+    if (input->cb != NULL) {
+        return input->cb(sc, pt, idx, input->cbdata);
+    }
+    secp256k1_scalar_set_b32(sc, &input->scalars32[32*idx], &overflow);
+    if (overflow) {
+        return 0;
+    }
+    secp256k1_ge_from_bytes(pt, &input->points64[64*idx]);
+    /* No point on the curve has x = 0. */
+    return !secp256k1_fe_is_zero(&pt->x);
+}
+
+static int secp256k1_ecmult_strauss_batch(const secp256k1_callback* error_callback, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, const secp256k1_ecmult_multi_input *input, size_t n_points, size_t cb_offset) {
     secp256k1_gej* points;
     secp256k1_scalar* scalars;
+    secp256k1_ecmult_tables tables;
     struct secp256k1_strauss_state state;
     size_t i;
     const size_t scratch_checkpoint = secp256k1_scratch_checkpoint(error_callback, scratch);
@@ -391,20 +687,23 @@ static int secp256k1_ecmult_strauss_batch(const secp256k1_callback* error_callba
 
     for (i = 0; i < n_points; i++) {
         secp256k1_ge point;
-        if (!cb(&scalars[i], &point, i+cb_offset, cbdata)) {
+        if (!secp256k1_ecmult_multi_input_load(input, &scalars[i], &point, i+cb_offset)) {
             secp256k1_scratch_apply_checkpoint(error_callback, scratch, scratch_checkpoint);
             return 0;
         }
         secp256k1_gej_set_ge(&points[i], &point);
     }
-    secp256k1_ecmult_strauss_wnaf(&state, r, n_points, points, scalars, inp_g_sc);
+    secp256k1_ecmult_tables_set_default(&tables);
+    secp256k1_ecmult_strauss_wnaf(&tables, &state, r, n_points, points, scalars, inp_g_sc);
     secp256k1_scratch_apply_checkpoint(error_callback, scratch, scratch_checkpoint);
     return 1;
 }
 
 /* Wrapper for secp256k1_ecmult_multi_func interface */
 static int secp256k1_ecmult_strauss_batch_single(const secp256k1_callback* error_callback, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, void *cbdata, size_t n) {
-    return secp256k1_ecmult_strauss_batch(error_callback, scratch, r, inp_g_sc, cb, cbdata, n, 0);
+    secp256k1_ecmult_multi_input input;
+    secp256k1_ecmult_multi_input_init_callback(&input, cb, cbdata);
+    return secp256k1_ecmult_strauss_batch(error_callback, scratch, r, inp_g_sc, &input, n, 0);
 }
 
 static size_t secp256k1_strauss_max_points(const secp256k1_callback* error_callback, secp256k1_scratch *scratch) {
@@ -485,11 +784,189 @@ struct secp256k1_pippenger_point_state {
     size_t input_pos;
 };
 
+/* Affine part of a bucket */
+struct secp256k1_pippenger_affine_bucket {
+    secp256k1_ge sum;
+    /* The last batch in which an addition to this bucket was scheduled */
+    int batch;
+};
+
+/* Addition of a point to a bucket scheduled for the current batch */
+struct secp256k1_pippenger_affine_addition {
+    secp256k1_ge p;
+    /* The product of the denominators of the additions scheduled so far in
+     * this batch, including this one */
+    secp256k1_fe prod;
+    int bucket;
+};
+
 struct secp256k1_pippenger_state {
     int *wnaf_na;
     struct secp256k1_pippenger_point_state* ps;
+    /* NULL unless buckets are accumulated in affine coordinates */
+    struct secp256k1_pippenger_affine_bucket *affine;
+    struct secp256k1_pippenger_affine_addition *additions;
+    int *queue;
+    int batch;
+    size_t n_additions;
+    size_t n_queued;
 };
 
+/* Number of additions to affine buckets sharing an inversion. Scheduling
+ * additions to only a quarter of the buckets at once keeps the number of
+ * points that have to wait for their bucket low. At most as many points are
+ * queued. */
+#define PIPPENGER_AFFINE_BATCH(bucket_window) ((size_t)1 << ((bucket_window) - 2))
+
+/* Adds the scheduled additions to the affine buckets, inverting their
+ * denominators with a single field inversion using Montgomery's trick. An
+ * addition then costs about 6M instead of the 11M of secp256k1_gej_add_ge_var. */
+static void secp256k1_ecmult_pippenger_affine_flush(struct secp256k1_pippenger_state *state) {
+    struct secp256k1_pippenger_affine_addition *additions = state->additions;
+    size_t k = state->n_additions;
+    secp256k1_fe inv;
+
+    if (k > 0) {
+        secp256k1_fe_inv_var(&inv, &additions[k - 1].prod);
+    }
+    /* Walk the additions backwards, peeling the inverse of each denominator
+     * off the inverse of the product. */
+    while (k-- > 0) {
+        secp256k1_ge *sum = &state->affine[additions[k].bucket].sum;
+        secp256k1_ge *p = &additions[k].p;
+        secp256k1_fe d, dinv, lambda, t;
+
+        secp256k1_fe_negate(&d, &sum->x, 1);
+        secp256k1_fe_add(&d, &p->x);
+        if (k > 0) {
+            secp256k1_fe_mul(&dinv, &inv, &additions[k - 1].prod);
+            secp256k1_fe_mul(&inv, &inv, &d);
+        } else {
+            dinv = inv;
+        }
+
+        /* lambda = (y2 - y1)/(x2 - x1), x3 = lambda^2 - x1 - x2,
+         * y3 = lambda*(x1 - x3) - y1 */
+        secp256k1_fe_negate(&t, &sum->y, 1);
+        secp256k1_fe_add(&t, &p->y);
+        secp256k1_fe_mul(&lambda, &t, &dinv);
+        secp256k1_fe_sqr(&t, &lambda);
+        secp256k1_fe_add(&p->x, &sum->x);
+        secp256k1_fe_negate(&p->x, &p->x, SECP256K1_GE_X_MAGNITUDE_MAX + 1);
+        secp256k1_fe_add(&t, &p->x);
+        secp256k1_fe_normalize_weak(&t);
+        secp256k1_fe_negate(&d, &t, 1);
+        secp256k1_fe_add(&d, &sum->x);
+        secp256k1_fe_mul(&lambda, &lambda, &d);
+        secp256k1_fe_negate(&d, &sum->y, 1);
+        secp256k1_fe_add(&lambda, &d);
+        secp256k1_fe_normalize_weak(&lambda);
+        sum->x = t;
+        sum->y = lambda;
+    }
+    state->n_additions = 0;
+    state->batch++;
+}
+
+/* Adds the point with index np, multiplied by the sign of its nonzero wnaf
+ * digit n, to its bucket. Unless the affine bucket is empty, the addition is
+ * scheduled for the current batch. A point whose bucket already has an
+ * addition scheduled is queued for a later batch instead. A point whose x
+ * coordinate equals the one of the affine bucket is added to the Jacobian
+ * bucket, because the affine formula doesn't handle doubling. */
+static void secp256k1_ecmult_pippenger_affine_add(secp256k1_gej *buckets, struct secp256k1_pippenger_state *state, const secp256k1_ge *pt, int np, int n) {
+    struct secp256k1_pippenger_affine_addition *addition = &state->additions[state->n_additions];
+    int idx = n > 0 ? (n - 1)/2 : -(n + 1)/2;
+    secp256k1_ge *sum = &state->affine[idx].sum;
+    secp256k1_fe d;
+
+    if (state->affine[idx].batch == state->batch) {
+        state->queue[state->n_queued++] = np;
+        return;
+    }
+    if (n > 0) {
+        addition->p = pt[state->ps[np].input_pos];
+    } else {
+        secp256k1_ge_neg(&addition->p, &pt[state->ps[np].input_pos]);
+    }
+    if (secp256k1_ge_is_infinity(sum)) {
+        *sum = addition->p;
+        secp256k1_fe_normalize_weak(&sum->x);
+        secp256k1_fe_normalize_weak(&sum->y);
+        return;
+    }
+    if (secp256k1_fe_equal(&sum->x, &addition->p.x)) {
+        secp256k1_gej_add_ge_var(&buckets[idx], &buckets[idx], &addition->p, NULL);
+        return;
+    }
+    secp256k1_fe_negate(&d, &sum->x, 1);
+    secp256k1_fe_add(&d, &addition->p.x);
+    if (state->n_additions == 0) {
+        addition->prod = d;
+    } else {
+        secp256k1_fe_mul(&addition->prod, &addition[-1].prod, &d);
+    }
+    addition->bucket = idx;
+    state->affine[idx].batch = state->batch;
+    state->n_additions++;
+}
+
+/* Flushes the current batch and adds the queued points again, which can
+ * leave some of them queued. */
+static void secp256k1_ecmult_pippenger_affine_next_batch(secp256k1_gej *buckets, struct secp256k1_pippenger_state *state, const secp256k1_ge *pt, int bucket_window, size_t n_wnaf, int i) {
+    size_t n_queued = state->n_queued;
+    size_t k;
+
+    secp256k1_ecmult_pippenger_affine_flush(state);
+    state->n_queued = 0;
+    for (k = 0; k < n_queued; k++) {
+        int np = state->queue[k];
+        secp256k1_ecmult_pippenger_affine_add(buckets, state, pt, np, state->wnaf_na[np*n_wnaf + i]);
+        if (state->n_additions == PIPPENGER_AFFINE_BATCH(bucket_window)) {
+            secp256k1_ecmult_pippenger_affine_flush(state);
+        }
+    }
+}
+
+/* Adds the points with nonzero wnaf digits at position i to the buckets,
+ * keeping the buckets in affine coordinates, and finally adds the affine
+ * buckets to the Jacobian ones. */
+static void secp256k1_ecmult_pippenger_fill_affine(secp256k1_gej *buckets, int bucket_window, struct secp256k1_pippenger_state *state, const secp256k1_ge *pt, size_t no, int i) {
+    size_t n_wnaf = WNAF_SIZE(bucket_window+1);
+    size_t np;
+    int j;
+
+    for (j = 0; j < ECMULT_TABLE_SIZE(bucket_window+2); j++) {
+        secp256k1_ge_set_infinity(&state->affine[j].sum);
+        state->affine[j].batch = -1;
+    }
+    state->batch = 0;
+    state->n_additions = 0;
+    state->n_queued = 0;
+
+    for (np = 0; np < no; ++np) {
+        int n = state->wnaf_na[np*n_wnaf + i];
+        if (n == 0) {
+            continue;
+        }
+        secp256k1_ecmult_pippenger_affine_add(buckets, state, pt, np, n);
+        if (state->n_additions == PIPPENGER_AFFINE_BATCH(bucket_window) || state->n_queued == PIPPENGER_AFFINE_BATCH(bucket_window)) {
+            secp256k1_ecmult_pippenger_affine_next_batch(buckets, state, pt, bucket_window, n_wnaf, i);
+        }
+    }
+    /* Queued points always wait for a scheduled addition. */
+    while (state->n_additions > 0) {
+        secp256k1_ecmult_pippenger_affine_next_batch(buckets, state, pt, bucket_window, n_wnaf, i);
+    }
+    VERIFY_CHECK(state->n_queued == 0);
+
+    for (j = 0; j < ECMULT_TABLE_SIZE(bucket_window+2); j++) {
+        if (!secp256k1_ge_is_infinity(&state->affine[j].sum)) {
+            secp256k1_gej_add_ge_var(&buckets[j], &buckets[j], &state->affine[j].sum, NULL);
+        }
+    }
+}
+
 /*
  * pippenger_wnaf computes the result of a multi-point multiplication as
  * follows: The scalars are brought into wnaf with n_wnaf elements each. Then
@@ -539,6 +1016,9 @@ static int secp256k1_ecmult_pippenger_wnaf(secp256k1_gej *buckets, int bucket_wi
                     secp256k1_gej_add_ge_var(&buckets[0], &buckets[0], &tmp, NULL);
                 }
             }
+            if (state->affine != NULL) {
+                continue;
+            }
             if (n > 0) {
                 idx = (n - 1)/2;
                 secp256k1_gej_add_ge_var(&buckets[idx], &buckets[idx], &pt[point_state.input_pos], NULL);
@@ -548,6 +1028,9 @@ static int secp256k1_ecmult_pippenger_wnaf(secp256k1_gej *buckets, int bucket_wi
                 secp256k1_gej_add_ge_var(&buckets[idx], &buckets[idx], &tmp, NULL);
             }
         }
+        if (state->affine != NULL) {
+            secp256k1_ecmult_pippenger_fill_affine(buckets, bucket_window, state, pt, no, i);
+        }
 
         for(j = 0; j < bucket_window; j++) {
             secp256k1_gej_double_var(r, r, NULL);
@@ -574,55 +1057,47 @@ static int secp256k1_ecmult_pippenger_wnaf(secp256k1_gej *buckets, int bucket_wi
     return 1;
 }
 
+/* Initializer of the compiled-in secp256k1_ecmult_multi_params. Bucket_window
+ * of 8 is not used with endo. */
+#define ECMULT_MULTI_PARAMS_DEFAULT { \
+    ECMULT_PIPPENGER_THRESHOLD, \
+    { 1, 4, 20, 57, 136, 235, 1260, 1260, 4420, 7880, 16050, SIZE_MAX } \
+}
+
+static const secp256k1_ecmult_multi_params secp256k1_ecmult_multi_params_default = ECMULT_MULTI_PARAMS_DEFAULT;
+
+static void secp256k1_ecmult_multi_params_set_default(secp256k1_ecmult_multi_params *params) {
+    *params = secp256k1_ecmult_multi_params_default;
+}
+
+/**
+ * Returns the bucket_window (number of bits of a scalar represented by a set
+ * of buckets) that params choose for a given number of points.
+ */
+static int secp256k1_ecmult_multi_params_bucket_window(const secp256k1_ecmult_multi_params *params, size_t n) {
+    int bucket_window = 1;
+    while (bucket_window < PIPPENGER_MAX_BUCKET_WINDOW && n > params->pippenger_max_points[bucket_window - 1]) {
+        bucket_window++;
+    }
+    return bucket_window;
+}
+
 /**
  * Returns optimal bucket_window (number of bits of a scalar represented by a
  * set of buckets) for a given number of points.
  */
 static int secp256k1_pippenger_bucket_window(size_t n) {
-    if (n <= 1) {
-        return 1;
-    } else if (n <= 4) {
-        return 2;
-    } else if (n <= 20) {
-        return 3;
-    } else if (n <= 57) {
-        return 4;
-    } else if (n <= 136) {
-        return 5;
-    } else if (n <= 235) {
-        return 6;
-    } else if (n <= 1260) {
-        return 7;
-    } else if (n <= 4420) {
-        return 9;
-    } else if (n <= 7880) {
-        return 10;
-    } else if (n <= 16050) {
-        return 11;
-    } else {
-        return PIPPENGER_MAX_BUCKET_WINDOW;
-    }
+    return secp256k1_ecmult_multi_params_bucket_window(&secp256k1_ecmult_multi_params_default, n);
 }
 
 /**
  * Returns the maximum optimal number of points for a bucket_window.
  */
 static size_t secp256k1_pippenger_bucket_window_inv(int bucket_window) {
-    switch(bucket_window) {
-        case 1: return 1;
-        case 2: return 4;
-        case 3: return 20;
-        case 4: return 57;
-        case 5: return 136;
-        case 6: return 235;
-        case 7: return 1260;
-        case 8: return 1260;
-        case 9: return 4420;
-        case 10: return 7880;
-        case 11: return 16050;
-        case PIPPENGER_MAX_BUCKET_WINDOW: return SIZE_MAX;
+    if (bucket_window < 1 || bucket_window > PIPPENGER_MAX_BUCKET_WINDOW) {
+        return 0;
     }
-    return 0;
+    return secp256k1_ecmult_multi_params_default.pippenger_max_points[bucket_window - 1];
 }
 
 
@@ -641,17 +1116,38 @@ SECP256K1_INLINE static void secp256k1_ecmult_endo_split(secp256k1_scalar *s1, s
     }
 }
 
+static int secp256k1_pippenger_affine(int bucket_window) {
+    return bucket_window >= PIPPENGER_AFFINE_MIN_BUCKET_WINDOW;
+}
+
+/* Returns the scratch size required for the buckets of a given bucket_window. */
+static size_t secp256k1_pippenger_bucket_size(int bucket_window) {
+    size_t size = sizeof(secp256k1_gej) << bucket_window;
+    if (secp256k1_pippenger_affine(bucket_window)) {
+        size += sizeof(struct secp256k1_pippenger_affine_bucket) << bucket_window;
+        size += PIPPENGER_AFFINE_BATCH(bucket_window) * (sizeof(struct secp256k1_pippenger_affine_addition) + sizeof(int));
+    }
+    return size;
+}
+
+/* Returns the scratch size required per entry (i.e., per point after the
+ * endomorphism split) for a given bucket_window. */
+static size_t secp256k1_pippenger_entry_size(int bucket_window) {
+    return sizeof(secp256k1_ge) + sizeof(secp256k1_scalar) + sizeof(struct secp256k1_pippenger_point_state) + (WNAF_SIZE(bucket_window+1)+1)*sizeof(int);
+}
+
 /**
  * Returns the scratch size required for a given number of points (excluding
  * base point G) without considering alignment.
  */
 static size_t secp256k1_pippenger_scratch_size(size_t n_points, int bucket_window) {
     size_t entries = 2*n_points + 2;
-    size_t entry_size = sizeof(secp256k1_ge) + sizeof(secp256k1_scalar) + sizeof(struct secp256k1_pippenger_point_state) + (WNAF_SIZE(bucket_window+1)+1)*sizeof(int);
-    return (sizeof(secp256k1_gej) << bucket_window) + sizeof(struct secp256k1_pippenger_state) + entries * entry_size;
+    return secp256k1_pippenger_bucket_size(bucket_window) + sizeof(struct secp256k1_pippenger_state) + entries * secp256k1_pippenger_entry_size(bucket_window);
 }
 
-static int secp256k1_ecmult_pippenger_batch(const secp256k1_callback* error_callback, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, void *cbdata, size_t n_points, size_t cb_offset) {
+/* Like secp256k1_ecmult_pippenger_batch, but chooses the bucket window
+ * according to params. */
+static int secp256k1_ecmult_pippenger_batch_internal(const secp256k1_ecmult_multi_params *params, const secp256k1_callback* error_callback, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, const secp256k1_ecmult_multi_input *input, size_t n_points, size_t cb_offset) {
     const size_t scratch_checkpoint = secp256k1_scratch_checkpoint(error_callback, scratch);
     /* Use 2(n+1) with the endomorphism, when calculating batch
      * sizes. The reason for +1 is that we add the G scalar to the list of
@@ -669,7 +1165,7 @@ static int secp256k1_ecmult_pippenger_batch(const secp256k1_callback* error_call
     if (inp_g_sc == NULL && n_points == 0) {
         return 1;
     }
-    bucket_window = secp256k1_pippenger_bucket_window(n_points);
+    bucket_window = secp256k1_ecmult_multi_params_bucket_window(params, n_points);
 
     /* We allocate PIPPENGER_SCRATCH_OBJECTS objects on the scratch space. If
      * these allocations change, make sure to update the
@@ -689,6 +1185,16 @@ static int secp256k1_ecmult_pippenger_batch(const secp256k1_callback* error_call
         secp256k1_scratch_apply_checkpoint(error_callback, scratch, scratch_checkpoint);
         return 0;
     }
+    state_space->affine = NULL;
+    if (secp256k1_pippenger_affine(bucket_window)) {
+        state_space->affine = (struct secp256k1_pippenger_affine_bucket *) secp256k1_scratch_alloc(error_callback, scratch, ((size_t)1 << bucket_window) * sizeof(*state_space->affine));
+        state_space->additions = (struct secp256k1_pippenger_affine_addition *) secp256k1_scratch_alloc(error_callback, scratch, PIPPENGER_AFFINE_BATCH(bucket_window) * sizeof(*state_space->additions));
+        state_space->queue = (int *) secp256k1_scratch_alloc(error_callback, scratch, PIPPENGER_AFFINE_BATCH(bucket_window) * sizeof(int));
+        if (state_space->affine == NULL || state_space->additions == NULL || state_space->queue == NULL) {
+            secp256k1_scratch_apply_checkpoint(error_callback, scratch, scratch_checkpoint);
+            return 0;
+        }
+    }
 
     if (inp_g_sc != NULL) {
         scalars[0] = *inp_g_sc;
@@ -699,7 +1205,7 @@ static int secp256k1_ecmult_pippenger_batch(const secp256k1_callback* error_call
     }
 
     while (point_idx < n_points) {
-        if (!cb(&scalars[idx], &points[idx], point_idx + cb_offset, cbdata)) {
+        if (!secp256k1_ecmult_multi_input_load(input, &scalars[idx], &points[idx], point_idx + cb_offset)) {
             secp256k1_scratch_apply_checkpoint(error_callback, scratch, scratch_checkpoint);
             return 0;
         }
@@ -714,6 +1220,12 @@ static int secp256k1_ecmult_pippenger_batch(const secp256k1_callback* error_call
     return 1;
 }
 
+static int secp256k1_ecmult_pippenger_batch(const secp256k1_callback* error_callback, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, void *cbdata, size_t n_points, size_t cb_offset) {
+    secp256k1_ecmult_multi_input input;
+    secp256k1_ecmult_multi_input_init_callback(&input, cb, cbdata);
+    return secp256k1_ecmult_pippenger_batch_internal(&secp256k1_ecmult_multi_params_default, error_callback, scratch, r, inp_g_sc, &input, n_points, cb_offset);
+}
+
 /* Wrapper for secp256k1_ecmult_multi_func interface */
 static int secp256k1_ecmult_pippenger_batch_single(const secp256k1_callback* error_callback, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, void *cbdata, size_t n) {
     return secp256k1_ecmult_pippenger_batch(error_callback, scratch, r, inp_g_sc, cb, cbdata, n, 0);
@@ -721,23 +1233,22 @@ static int secp256k1_ecmult_pippenger_batch_single(const secp256k1_callback* err
 
 /**
  * Returns the maximum number of points in addition to G that can be used with
- * a given scratch space. The function ensures that fewer points may also be
- * used.
+ * a given scratch space and the bucket windows chosen by params. The function
+ * ensures that fewer points may also be used.
  */
-static size_t secp256k1_pippenger_max_points(const secp256k1_callback* error_callback, secp256k1_scratch *scratch) {
+static size_t secp256k1_pippenger_max_points(const secp256k1_ecmult_multi_params *params, const secp256k1_callback* error_callback, secp256k1_scratch *scratch) {
     size_t max_alloc = secp256k1_scratch_max_allocation(error_callback, scratch, PIPPENGER_SCRATCH_OBJECTS);
     int bucket_window;
     size_t res = 0;
 
     for (bucket_window = 1; bucket_window <= PIPPENGER_MAX_BUCKET_WINDOW; bucket_window++) {
         size_t n_points;
-        size_t max_points = secp256k1_pippenger_bucket_window_inv(bucket_window);
+        size_t max_points = params->pippenger_max_points[bucket_window - 1];
         size_t space_for_points;
         size_t space_overhead;
-        size_t entry_size = sizeof(secp256k1_ge) + sizeof(secp256k1_scalar) + sizeof(struct secp256k1_pippenger_point_state) + (WNAF_SIZE(bucket_window+1)+1)*sizeof(int);
+        size_t entry_size = 2*secp256k1_pippenger_entry_size(bucket_window);
 
-        entry_size = 2*entry_size;
-        space_overhead = (sizeof(secp256k1_gej) << bucket_window) + entry_size + sizeof(struct secp256k1_pippenger_state);
+        space_overhead = secp256k1_pippenger_bucket_size(bucket_window) + entry_size + sizeof(struct secp256k1_pippenger_state);
         if (space_overhead > max_alloc) {
             break;
         }
@@ -758,9 +1269,26 @@ static size_t secp256k1_pippenger_max_points(const secp256k1_callback* error_cal
     return res;
 }
 
+/* Returns the scratch space size (including alignment overhead) with which
+ * secp256k1_ecmult_multi_var processes up to n_points points in a single
+ * batch. */
+static size_t secp256k1_ecmult_multi_scratch_size_internal(size_t n_points) {
+    size_t n_strauss, strauss, pippenger;
+
+    if (n_points > ECMULT_MAX_POINTS_PER_BATCH) {
+        n_points = ECMULT_MAX_POINTS_PER_BATCH;
+    }
+    /* Fewer points than the threshold are multiplied with Strauss' algorithm,
+     * so make room for both. */
+    n_strauss = n_points < ECMULT_PIPPENGER_THRESHOLD ? n_points : ECMULT_PIPPENGER_THRESHOLD - 1;
+    strauss = secp256k1_strauss_scratch_size(n_strauss) + STRAUSS_SCRATCH_OBJECTS * ALIGNMENT;
+    pippenger = secp256k1_pippenger_scratch_size(n_points, secp256k1_pippenger_bucket_window(n_points)) + PIPPENGER_SCRATCH_OBJECTS * ALIGNMENT;
+    return strauss > pippenger ? strauss : pippenger;
+}
+
 /* Computes ecmult_multi by simply multiplying and adding each point. Does not
  * require a scratch space */
-static int secp256k1_ecmult_multi_simple_var(secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, void *cbdata, size_t n_points) {
+static int secp256k1_ecmult_multi_simple_var(secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, const secp256k1_ecmult_multi_input *input, size_t n_points) {
     size_t point_idx;
     secp256k1_gej tmpj;
 
@@ -772,7 +1300,7 @@ static int secp256k1_ecmult_multi_simple_var(secp256k1_gej *r, const secp256k1_s
         secp256k1_ge point;
         secp256k1_gej pointj;
         secp256k1_scalar scalar;
-        if (!cb(&scalar, &point, point_idx, cbdata)) {
+        if (!secp256k1_ecmult_multi_input_load(input, &scalar, &point, point_idx)) {
             return 0;
         }
         /* r += scalar*point */
@@ -804,10 +1332,10 @@ static int secp256k1_ecmult_multi_batch_size_helper(size_t *n_batches, size_t *n
 }
 
 typedef int (*secp256k1_ecmult_multi_func)(const secp256k1_callback* error_callback, secp256k1_scratch*, secp256k1_gej*, const secp256k1_scalar*, secp256k1_ecmult_multi_callback cb, void*, size_t);
-static int secp256k1_ecmult_multi_var(const secp256k1_callback* error_callback, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, void *cbdata, size_t n) {
+static int secp256k1_ecmult_multi_var_input(const secp256k1_ecmult_multi_params *params, const secp256k1_callback* error_callback, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, const secp256k1_ecmult_multi_input *input, size_t n) {
     size_t i;
 
-    int (*f)(const secp256k1_callback* error_callback, secp256k1_scratch*, secp256k1_gej*, const secp256k1_scalar*, secp256k1_ecmult_multi_callback cb, void*, size_t, size_t);
+    int pippenger;
     size_t n_batches;
     size_t n_batch_points;
 
@@ -819,29 +1347,31 @@ static int secp256k1_ecmult_multi_var(const secp256k1_callback* error_callback,
         return 1;
     }
     if (scratch == NULL) {
-        return secp256k1_ecmult_multi_simple_var(r, inp_g_sc, cb, cbdata, n);
+        return secp256k1_ecmult_multi_simple_var(r, inp_g_sc, input, n);
     }
 
     /* Compute the batch sizes for Pippenger's algorithm given a scratch space. If it's greater than
      * a threshold use Pippenger's algorithm. Otherwise use Strauss' algorithm.
      * As a first step check if there's enough space for Pippenger's algo (which requires less space
      * than Strauss' algo) and if not, use the simple algorithm. */
-    if (!secp256k1_ecmult_multi_batch_size_helper(&n_batches, &n_batch_points, secp256k1_pippenger_max_points(error_callback, scratch), n)) {
-        return secp256k1_ecmult_multi_simple_var(r, inp_g_sc, cb, cbdata, n);
+    if (!secp256k1_ecmult_multi_batch_size_helper(&n_batches, &n_batch_points, secp256k1_pippenger_max_points(params, error_callback, scratch), n)) {
+        return secp256k1_ecmult_multi_simple_var(r, inp_g_sc, input, n);
     }
-    if (n_batch_points >= ECMULT_PIPPENGER_THRESHOLD) {
-        f = secp256k1_ecmult_pippenger_batch;
-    } else {
+    pippenger = n_batch_points >= params->pippenger_threshold;
+    if (!pippenger) {
         if (!secp256k1_ecmult_multi_batch_size_helper(&n_batches, &n_batch_points, secp256k1_strauss_max_points(error_callback, scratch), n)) {
-            return secp256k1_ecmult_multi_simple_var(r, inp_g_sc, cb, cbdata, n);
+            return secp256k1_ecmult_multi_simple_var(r, inp_g_sc, input, n);
         }
-        f = secp256k1_ecmult_strauss_batch;
     }
     for(i = 0; i < n_batches; i++) {
         size_t nbp = n < n_batch_points ? n : n_batch_points;
         size_t offset = n_batch_points*i;
         secp256k1_gej tmp;
-        if (!f(error_callback, scratch, &tmp, i == 0 ? inp_g_sc : NULL, cb, cbdata, nbp, offset)) {
+        if (pippenger) {
+            if (!secp256k1_ecmult_pippenger_batch_internal(params, error_callback, scratch, &tmp, i == 0 ? inp_g_sc : NULL, input, nbp, offset)) {
+                return 0;
+            }
+        } else if (!secp256k1_ecmult_strauss_batch(error_callback, scratch, &tmp, i == 0 ? inp_g_sc : NULL, input, nbp, offset)) {
             return 0;
         }
         secp256k1_gej_add_var(r, r, &tmp, NULL);
@@ -850,4 +1380,597 @@ static int secp256k1_ecmult_multi_var(const secp256k1_callback* error_callback,
     return 1;
 }
 
+static int secp256k1_ecmult_multi_var_with_params(const secp256k1_ecmult_multi_params *params, const secp256k1_callback* error_callback, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, void *cbdata, size_t n) {
+    secp256k1_ecmult_multi_input input;
+    secp256k1_ecmult_multi_input_init_callback(&input, cb, cbdata);
+    return secp256k1_ecmult_multi_var_input(params, error_callback, scratch, r, inp_g_sc, &input, n);
+}
+
+static int secp256k1_ecmult_multi_var(const secp256k1_callback* error_callback, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, void *cbdata, size_t n) {
+    return secp256k1_ecmult_multi_var_with_params(&secp256k1_ecmult_multi_params_default, error_callback, scratch, r, inp_g_sc, cb, cbdata, n);
+}
+
+static size_t secp256k1_ecmult_fixed_bases_max_points(int window, int chunks) {
+    /* Every point is stored along with chunks tables of its odd multiples. */
+    return SIZE_MAX / ((1 + (size_t)chunks * ECMULT_TABLE_SIZE(window)) * sizeof(secp256k1_ge_storage));
+}
+
+static int secp256k1_ecmult_fixed_bases_build(const secp256k1_callback *error_callback, secp256k1_ecmult_fixed_bases *bases, const secp256k1_ge *points, size_t n, int window, int chunks) {
+    const int bits = CEIL_DIV(129, chunks);
+    const size_t table_size = ECMULT_TABLE_SIZE(window);
+    const size_t n_pre = (size_t)chunks * table_size;
+    secp256k1_ge_storage *storage;
+    secp256k1_gej *prej;
+    secp256k1_ge *pre;
+    size_t i;
+
+    VERIFY_CHECK(window >= 2 && window <= 16);
+    VERIFY_CHECK(chunks >= 1 && chunks <= ECMULT_FIXED_BASES_MAX_CHUNKS);
+    if (n > secp256k1_ecmult_fixed_bases_max_points(window, chunks)) {
+        return 0;
+    }
+    /* The points and all tables live in a single allocation, the tables right after the points. */
+    storage = (secp256k1_ge_storage *)checked_malloc(error_callback, n * (1 + n_pre) * sizeof(secp256k1_ge_storage));
+    prej = (secp256k1_gej *)checked_malloc(error_callback, n_pre * sizeof(secp256k1_gej));
+    pre = (secp256k1_ge *)checked_malloc(error_callback, n_pre * sizeof(secp256k1_ge));
+    if (storage == NULL || prej == NULL || pre == NULL) {
+        free(storage);
+        free(prej);
+        free(pre);
+        return 0;
+    }
+
+    for (i = 0; i < n; i++) {
+        secp256k1_gej aj, dj;
+        secp256k1_ge d;
+        size_t j;
+        int c, k;
+
+        VERIFY_CHECK(!secp256k1_ge_is_infinity(&points[i]));
+        secp256k1_ge_to_storage(&storage[i], &points[i]);
+        secp256k1_gej_set_ge(&aj, &points[i]);
+        for (c = 0; c < chunks; c++) {
+            /* Here aj = 2^(c*bits)*A_i. Compute its odd multiples in Jacobian
+             * coordinates, so that a single inversion per point converts all
+             * of its tables to affine coordinates. */
+            secp256k1_gej_double_var(&dj, &aj, NULL);
+            secp256k1_ge_set_gej_var(&d, &dj);
+            prej[c * table_size] = aj;
+            for (j = 1; j < table_size; j++) {
+                secp256k1_gej_add_ge_var(&prej[c * table_size + j], &prej[c * table_size + j - 1], &d, NULL);
+            }
+            for (k = 0; k < bits; k++) {
+                secp256k1_gej_double_var(&aj, &aj, NULL);
+            }
+        }
+        secp256k1_ge_set_all_gej_var(pre, prej, n_pre);
+        for (j = 0; j < n_pre; j++) {
+            secp256k1_ge_to_storage(&storage[n + i * n_pre + j], &pre[j]);
+        }
+    }
+    free(prej);
+    free(pre);
+
+    bases->n = n;
+    bases->window = window;
+    bases->chunks = chunks;
+    bases->points = storage;
+    bases->pre = storage + n;
+    return 1;
+}
+
+static void secp256k1_ecmult_fixed_bases_free(secp256k1_ecmult_fixed_bases *bases) {
+    free(bases->points);
+    bases->points = NULL;
+    bases->pre = NULL;
+    bases->n = 0;
+}
+
+/* The number of ints holding the wNAF digits of one point in
+ * secp256k1_ecmult_fixed_bases_strauss for tables with the given number of chunks. */
+static size_t secp256k1_ecmult_fixed_bases_wnaf_size(int chunks) {
+    return 2 * (size_t)chunks * CEIL_DIV(129, chunks);
+}
+
+/* Returns the scratch space size with which secp256k1_ecmult_multi_fixed_var
+ * processes n_points points with tables of the given number of chunks in a
+ * single batch (for up to ECMULT_MAX_POINTS_PER_BATCH points). */
+static size_t secp256k1_ecmult_multi_fixed_scratch_size_internal(size_t n_points, int chunks) {
+    if (n_points >= ECMULT_FIXED_BASES_PIPPENGER_THRESHOLD) {
+        return secp256k1_ecmult_multi_scratch_size_internal(n_points);
+    }
+    return n_points * secp256k1_ecmult_fixed_bases_wnaf_size(chunks) * sizeof(int) + ALIGNMENT;
+}
+
+/* Returns whether secp256k1_ecmult_multi_fixed_var uses Pippenger's algorithm
+ * on the points themselves with the given scratch space. */
+static int secp256k1_ecmult_fixed_bases_use_pippenger(const secp256k1_ecmult_multi_params *params, const secp256k1_callback* error_callback, secp256k1_scratch *scratch, const secp256k1_ecmult_fixed_bases *bases) {
+    /* For this many points, looking up the tables mostly misses the cache, and
+     * Pippenger's algorithm on the points themselves is faster. */
+    return scratch != NULL && bases->n >= ECMULT_FIXED_BASES_PIPPENGER_THRESHOLD
+        && secp256k1_pippenger_max_points(params, error_callback, scratch) >= bases->n;
+}
+
+/* Returns the number of points whose wNAF digits fit into the scratch space at
+ * once in secp256k1_ecmult_multi_fixed_var, or 1 if the scratch space is NULL
+ * or too small for more than one point. */
+static size_t secp256k1_ecmult_fixed_bases_batch_points(const secp256k1_callback* error_callback, secp256k1_scratch *scratch, const secp256k1_ecmult_fixed_bases *bases) {
+    size_t max_points;
+
+    if (scratch == NULL || bases->n <= 1) {
+        return 1;
+    }
+    max_points = secp256k1_scratch_max_allocation(error_callback, scratch, 1) / (secp256k1_ecmult_fixed_bases_wnaf_size(bases->chunks) * sizeof(int));
+    if (max_points <= 1) {
+        return 1;
+    }
+    return max_points < bases->n ? max_points : bases->n;
+}
+
+/* Adds sum(s_i*A_i) for i in [offset, offset + n) to r, using wnaf to hold the
+ * wNAF digits of the n points. Returns 0 if a scalar overflows. */
+static int secp256k1_ecmult_fixed_bases_strauss(const secp256k1_ecmult_fixed_bases *bases, secp256k1_gej *r, const unsigned char *scalars32, size_t offset, size_t n, int *wnaf) {
+    const int chunks = bases->chunks;
+    const int bits = CEIL_DIV(129, chunks);
+    const int len = chunks * bits;
+    const size_t wnaf_size = secp256k1_ecmult_fixed_bases_wnaf_size(chunks);
+    const size_t tables_size = (size_t)chunks * ECMULT_TABLE_SIZE(bases->window);
+    secp256k1_gej acc;
+    secp256k1_ge tmpa;
+    size_t j;
+    int i;
+
+    for (j = 0; j < n; j++) {
+        secp256k1_scalar s, s_1, s_lam;
+        int overflow;
+        int k;
+
+        secp256k1_scalar_set_b32(&s, &scalars32[32 * (offset + j)], &overflow);
+        if (overflow) {
+            return 0;
+        }
+        /* Split s into s_1 and s_lam (where s = s_1 + s_lam*lambda, and s_1 and s_lam are ~128 bit),
+         * and pad their wNAFs with zeros to chunks*bits digits. */
+        secp256k1_scalar_split_lambda(&s_1, &s_lam, &s);
+        secp256k1_ecmult_wnaf(&wnaf[j * wnaf_size], 129, &s_1, bases->window);
+        secp256k1_ecmult_wnaf(&wnaf[j * wnaf_size + len], 129, &s_lam, bases->window);
+        for (k = 129; k < len; k++) {
+            wnaf[j * wnaf_size + k] = 0;
+            wnaf[j * wnaf_size + len + k] = 0;
+        }
+    }
+
+    /* Digit c*bits + i of a point is looked up in the table of 2^(c*bits)*A_i,
+     * so only the digits i < bits require doublings. */
+    secp256k1_gej_set_infinity(&acc);
+    for (i = bits - 1; i >= 0; i--) {
+        secp256k1_gej_double_var(&acc, &acc, NULL);
+        for (j = 0; j < n; j++) {
+            const int *wnaf_1 = &wnaf[j * wnaf_size];
+            const int *wnaf_lam = wnaf_1 + len;
+            const secp256k1_ge_storage *pre = &bases->pre[(offset + j) * tables_size];
+            int c;
+            for (c = 0; c < chunks; c++) {
+                int d;
+                if ((d = wnaf_1[c * bits + i])) {
+                    secp256k1_ecmult_table_get_ge_storage(&tmpa, &pre[c * ECMULT_TABLE_SIZE(bases->window)], d, bases->window);
+                    secp256k1_gej_add_ge_var(&acc, &acc, &tmpa, NULL);
+                }
+                if ((d = wnaf_lam[c * bits + i])) {
+                    secp256k1_ecmult_table_get_ge_storage(&tmpa, &pre[c * ECMULT_TABLE_SIZE(bases->window)], d, bases->window);
+                    secp256k1_ge_mul_lambda(&tmpa, &tmpa);
+                    secp256k1_gej_add_ge_var(&acc, &acc, &tmpa, NULL);
+                }
+            }
+        }
+    }
+    secp256k1_gej_add_var(r, r, &acc, NULL);
+    return 1;
+}
+
+typedef struct {
+    const secp256k1_ecmult_fixed_bases *bases;
+    const unsigned char *scalars32;
+} secp256k1_ecmult_fixed_bases_cbdata;
+
+static int secp256k1_ecmult_fixed_bases_callback(secp256k1_scalar *sc, secp256k1_ge *pt, size_t idx, void *data) {
+    const secp256k1_ecmult_fixed_bases_cbdata *cbdata = (const secp256k1_ecmult_fixed_bases_cbdata *)data;
+    int overflow;
+
+    secp256k1_scalar_set_b32(sc, &cbdata->scalars32[32 * idx], &overflow);
+    if (overflow) {
+        return 0;
+    }
+    secp256k1_ge_from_storage(pt, &cbdata->bases->points[idx]);
+    return 1;
+}
+
+static int secp256k1_ecmult_multi_fixed_var(const secp256k1_ecmult_multi_params *params, const secp256k1_ecmult_tables *tables, const secp256k1_callback* error_callback, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, const secp256k1_ecmult_fixed_bases *bases, const unsigned char *scalars32) {
+    const size_t wnaf_size = secp256k1_ecmult_fixed_bases_wnaf_size(bases->chunks);
+    int wnaf_single[2 * (129 + ECMULT_FIXED_BASES_MAX_CHUNKS - 1)];
+    int *wnaf = wnaf_single;
+    size_t n_batch_points;
+    size_t scratch_checkpoint = 0;
+    size_t offset;
+    int ret = 1;
+
+    VERIFY_CHECK(wnaf_size <= sizeof(wnaf_single) / sizeof(wnaf_single[0]));
+    if (secp256k1_ecmult_fixed_bases_use_pippenger(params, error_callback, scratch, bases)) {
+        secp256k1_ecmult_fixed_bases_cbdata cbdata;
+        secp256k1_ecmult_multi_input input;
+        cbdata.bases = bases;
+        cbdata.scalars32 = scalars32;
+        secp256k1_ecmult_multi_input_init_callback(&input, secp256k1_ecmult_fixed_bases_callback, &cbdata);
+        return secp256k1_ecmult_pippenger_batch_internal(params, error_callback, scratch, r, inp_g_sc, &input, bases->n, 0);
+    }
+
+    secp256k1_gej_set_infinity(r);
+    if (inp_g_sc != NULL) {
+        secp256k1_ecmult_with_tables(tables, r, r, &secp256k1_scalar_zero, inp_g_sc);
+    }
+    n_batch_points = secp256k1_ecmult_fixed_bases_batch_points(error_callback, scratch, bases);
+    if (n_batch_points > 1) {
+        scratch_checkpoint = secp256k1_scratch_checkpoint(error_callback, scratch);
+        wnaf = (int *)secp256k1_scratch_alloc(error_callback, scratch, n_batch_points * wnaf_size * sizeof(int));
+        VERIFY_CHECK(wnaf != NULL);
+    }
+
+    for (offset = 0; ret && offset < bases->n; offset += n_batch_points) {
+        size_t n = bases->n - offset < n_batch_points ? bases->n - offset : n_batch_points;
+        ret = secp256k1_ecmult_fixed_bases_strauss(bases, r, scalars32, offset, n, wnaf);
+    }
+
+    if (wnaf != wnaf_single) {
+        secp256k1_scratch_apply_checkpoint(error_callback, scratch, scratch_checkpoint);
+    }
+    return ret;
+}
+
+/* A range of points multiplied by one task of secp256k1_ecmult_multi_var_parallel. */
+struct secp256k1_ecmult_multi_task {
+    secp256k1_scratch scratch;
+    secp256k1_gej r;
+    const secp256k1_scalar *inp_g_sc;
+    size_t offset;
+    size_t n;
+    int ret;
+};
+
+struct secp256k1_ecmult_multi_tasks {
+    const secp256k1_ecmult_multi_params *params;
+    const secp256k1_callback *error_callback;
+    secp256k1_ecmult_multi_callback *cb;
+    void *cbdata;
+    struct secp256k1_ecmult_multi_task *task;
+};
+
+struct secp256k1_ecmult_multi_task_cbdata {
+    const struct secp256k1_ecmult_multi_tasks *tasks;
+    size_t offset;
+};
+
+static int secp256k1_ecmult_multi_task_callback(secp256k1_scalar *sc, secp256k1_ge *pt, size_t idx, void *data) {
+    const struct secp256k1_ecmult_multi_task_cbdata *cbdata = (const struct secp256k1_ecmult_multi_task_cbdata *)data;
+    return cbdata->tasks->cb(sc, pt, cbdata->offset + idx, cbdata->tasks->cbdata);
+}
+
+static void secp256k1_ecmult_multi_task_run(void *task_data, size_t idx) {
+    const struct secp256k1_ecmult_multi_tasks *tasks = (const struct secp256k1_ecmult_multi_tasks *)task_data;
+    struct secp256k1_ecmult_multi_task *task = &tasks->task[idx];
+    struct secp256k1_ecmult_multi_task_cbdata cbdata;
+
+    cbdata.tasks = tasks;
+    cbdata.offset = task->offset;
+    task->ret = secp256k1_ecmult_multi_var_with_params(tasks->params, tasks->error_callback, &task->scratch, &task->r, task->inp_g_sc, secp256k1_ecmult_multi_task_callback, &cbdata, task->n);
+}
+
+/* Returns the scratch space size with which secp256k1_ecmult_multi_var_parallel
+ * lets each of n_tasks tasks process its points in a single batch. */
+static size_t secp256k1_ecmult_multi_parallel_scratch_size_internal(size_t n_points, size_t n_tasks) {
+    size_t n_task_points;
+
+    VERIFY_CHECK(n_tasks > 0);
+    n_task_points = CEIL_DIV(n_points, n_tasks);
+    return ROUND_TO_ALIGN(n_tasks * sizeof(struct secp256k1_ecmult_multi_task))
+           + n_tasks * ROUND_TO_ALIGN(secp256k1_ecmult_multi_scratch_size_internal(n_task_points));
+}
+
+static int secp256k1_ecmult_multi_var_parallel(const secp256k1_ecmult_multi_params *params, const secp256k1_callback* error_callback, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, void *cbdata, size_t n, secp256k1_ecmult_task_runner runner, void *runner_data, size_t n_tasks) {
+    struct secp256k1_ecmult_multi_tasks tasks;
+    size_t scratch_checkpoint;
+    size_t share, offset;
+    size_t i;
+    size_t max_tasks;
+    int ret = 1;
+
+    /* Don't bother splitting up ranges that would be too small for Pippenger's
+     * algorithm: rounding down makes every range at least as large as the
+     * threshold. */
+    max_tasks = n / params->pippenger_threshold;
+    if (n_tasks > max_tasks) {
+        n_tasks = max_tasks;
+    }
+    if (scratch == NULL || n_tasks <= 1 || n_tasks > SIZE_MAX / sizeof(struct secp256k1_ecmult_multi_task)) {
+        return secp256k1_ecmult_multi_var_with_params(params, error_callback, scratch, r, inp_g_sc, cb, cbdata, n);
+    }
+
+    scratch_checkpoint = secp256k1_scratch_checkpoint(error_callback, scratch);
+    tasks.task = (struct secp256k1_ecmult_multi_task *)secp256k1_scratch_alloc(error_callback, scratch, n_tasks * sizeof(struct secp256k1_ecmult_multi_task));
+    if (tasks.task == NULL) {
+        return secp256k1_ecmult_multi_var_with_params(params, error_callback, scratch, r, inp_g_sc, cb, cbdata, n);
+    }
+    /* Round down, so that all shares fit even though allocations are aligned. */
+    share = secp256k1_scratch_max_allocation(error_callback, scratch, 0) / n_tasks / ALIGNMENT * ALIGNMENT;
+    tasks.params = params;
+    tasks.error_callback = error_callback;
+    tasks.cb = cb;
+    tasks.cbdata = cbdata;
+    offset = 0;
+    for (i = 0; i < n_tasks; i++) {
+        struct secp256k1_ecmult_multi_task *task = &tasks.task[i];
+        /* Hand out the points as evenly as possible. */
+        size_t n_task_points = n / n_tasks + (i < n % n_tasks);
+        int ok = secp256k1_scratch_alloc_child(error_callback, scratch, &task->scratch, share);
+        VERIFY_CHECK(ok);
+        (void)ok;
+        task->inp_g_sc = i == 0 ? inp_g_sc : NULL;
+        task->offset = offset;
+        task->n = n_task_points;
+        task->ret = 0;
+        offset += n_task_points;
+    }
+    VERIFY_CHECK(offset == n);
+
+    runner(secp256k1_ecmult_multi_task_run, &tasks, n_tasks, runner_data);
+
+    secp256k1_gej_set_infinity(r);
+    for (i = 0; i < n_tasks; i++) {
+        ret &= tasks.task[i].ret;
+        secp256k1_gej_add_var(r, r, &tasks.task[i].r, NULL);
+    }
+    secp256k1_scratch_apply_checkpoint(error_callback, scratch, scratch_checkpoint);
+    return ret;
+}
+
+static void secp256k1_ecmult_multi_params_to_bytes(unsigned char *buf, const secp256k1_ecmult_multi_params *params) {
+    int i;
+
+    buf[0] = PIPPENGER_MAX_BUCKET_WINDOW;
+    secp256k1_write_be32(&buf[1], params->pippenger_threshold >= 0xFFFFFFFF ? 0xFFFFFFFF : (uint32_t)params->pippenger_threshold);
+    for (i = 0; i < PIPPENGER_MAX_BUCKET_WINDOW; i++) {
+        size_t max_points = params->pippenger_max_points[i];
+        secp256k1_write_be32(&buf[5 + 4*i], max_points >= 0xFFFFFFFF ? 0xFFFFFFFF : (uint32_t)max_points);
+    }
+}
+
+static int secp256k1_ecmult_multi_params_from_bytes(secp256k1_ecmult_multi_params *params, const unsigned char *buf) {
+    secp256k1_ecmult_multi_params res;
+    int i;
+
+    if (buf[0] != PIPPENGER_MAX_BUCKET_WINDOW) {
+        return 0;
+    }
+    res.pippenger_threshold = secp256k1_read_be32(&buf[1]);
+    if (res.pippenger_threshold == 0) {
+        return 0;
+    }
+    for (i = 0; i < PIPPENGER_MAX_BUCKET_WINDOW; i++) {
+        uint32_t max_points = secp256k1_read_be32(&buf[5 + 4*i]);
+        res.pippenger_max_points[i] = max_points == 0xFFFFFFFF ? SIZE_MAX : max_points;
+        if (i > 0 && res.pippenger_max_points[i] < res.pippenger_max_points[i - 1]) {
+            return 0;
+        }
+    }
+    if (res.pippenger_max_points[PIPPENGER_MAX_BUCKET_WINDOW - 1] != SIZE_MAX) {
+        return 0;
+    }
+    *params = res;
+    return 1;
+}
+
+/* Every measurement of secp256k1_ecmult_multi_params_calibrate repeats a
+ * multiplication until at least this many clock ticks have passed. */
+#define ECMULT_CALIBRATION_MIN_TICKS ((clock_t)(CLOCKS_PER_SEC / 200) + 1)
+
+/* Every measurement is repeated this many times, and the minimum is used. */
+#define ECMULT_CALIBRATION_ROUNDS 5
+
+/* Largest number of points that a measurement multiplies */
+#define ECMULT_CALIBRATION_MAX_POINTS ((size_t)2 << PIPPENGER_MAX_BUCKET_WINDOW)
+
+/* Largest pippenger_threshold that calibration results in */
+#define ECMULT_CALIBRATION_MAX_THRESHOLD 1024
+
+typedef struct {
+    const secp256k1_scalar *sc;
+    const secp256k1_ge *pt;
+} secp256k1_ecmult_calibration_data;
+
+/* Cost of a multiplication of n points, modelled as fixed + n*per_point */
+typedef struct {
+    int64_t fixed;
+    int64_t per_point;
+} secp256k1_ecmult_calibration_cost;
+
+/* Returns the small (j = 0) or large (j = 1) number of points with which
+ * Strauss' algorithm (bucket_window = 0) or Pippenger's algorithm with the given
+ * bucket_window is measured. */
+static size_t secp256k1_ecmult_calibration_points(int bucket_window, int j) {
+    if (bucket_window == 0) {
+        return j ? 128 : 16;
+    }
+    return j ? (size_t)2 << bucket_window : (size_t)1 << (bucket_window - 1);
+}
+
+static int secp256k1_ecmult_calibration_callback(secp256k1_scalar *sc, secp256k1_ge *pt, size_t idx, void *cbdata) {
+    const secp256k1_ecmult_calibration_data *data = (const secp256k1_ecmult_calibration_data *)cbdata;
+    *sc = data->sc[idx];
+    *pt = data->pt[idx];
+    return 1;
+}
+
+/* Returns the CPU time of a multiplication of n points, in units of 2^-16
+ * clock ticks, using Strauss' algorithm if bucket_window is 0 and Pippenger's
+ * algorithm with the given bucket_window otherwise, or -1 if the clock doesn't
+ * work. */
+static int64_t secp256k1_ecmult_calibration_measure(const secp256k1_callback *error_callback, secp256k1_scratch *scratch, const secp256k1_ecmult_calibration_data *data, int bucket_window, size_t n) {
+    secp256k1_ecmult_multi_params params;
+    secp256k1_ecmult_multi_input input;
+    clock_t start = clock();
+    clock_t elapsed;
+    int64_t count = 0;
+    int i;
+
+    if (start == (clock_t)-1) {
+        return -1;
+    }
+    secp256k1_ecmult_multi_input_init_callback(&input, secp256k1_ecmult_calibration_callback, (void *)data);
+    /* Make Pippenger's algorithm use bucket_window for any number of points. */
+    params.pippenger_threshold = 1;
+    for (i = 0; i < PIPPENGER_MAX_BUCKET_WINDOW; i++) {
+        params.pippenger_max_points[i] = i + 1 < bucket_window ? 0 : SIZE_MAX;
+    }
+    do {
+        secp256k1_gej r;
+        int ret;
+        if (bucket_window == 0) {
+            ret = secp256k1_ecmult_strauss_batch(error_callback, scratch, &r, NULL, &input, n, 0);
+        } else {
+            ret = secp256k1_ecmult_pippenger_batch_internal(&params, error_callback, scratch, &r, NULL, &input, n, 0);
+        }
+        VERIFY_CHECK(ret);
+        (void)ret;
+        count++;
+        elapsed = clock() - start;
+        /* Give up on a clock that doesn't advance. */
+        if (elapsed == 0 && count == 65536) {
+            return -1;
+        }
+    } while (elapsed < ECMULT_CALIBRATION_MIN_TICKS);
+    return (int64_t)elapsed * 65536 / count;
+}
+
+/* Fits a cost model to the times t1 and t2 of multiplications of n1 and
+ * n2 > n1 points. */
+static void secp256k1_ecmult_calibration_cost_fit(secp256k1_ecmult_calibration_cost *cost, int64_t t1, int64_t t2, size_t n1, size_t n2) {
+    /* Don't let measurement noise result in negative costs. */
+    cost->per_point = t2 > t1 ? (t2 - t1) / (int64_t)(n2 - n1) : 0;
+    cost->fixed = t1 > cost->per_point * (int64_t)n1 ? t1 - cost->per_point * (int64_t)n1 : 0;
+}
+
+static int64_t secp256k1_ecmult_calibration_cost_eval(const secp256k1_ecmult_calibration_cost *cost, size_t n) {
+    return cost->fixed + cost->per_point * (int64_t)n;
+}
+
+static int secp256k1_ecmult_multi_params_calibrate(const secp256k1_callback *error_callback, secp256k1_ecmult_multi_params *params) {
+    static const secp256k1_scalar s = SECP256K1_SCALAR_CONST(
+        0x8e1b4c3fUL, 0x2a6e90d1UL, 0x5f37c2b8UL, 0xd04a19e6UL,
+        0x73c5e8a2UL, 0x1b9f604dUL, 0xc62d7b95UL, 0x4ae3170fUL
+    );
+    /* The minimum times measured with the small and the large number of points
+     * for Strauss' algorithm (index 0) and every bucket window */
+    int64_t t[PIPPENGER_MAX_BUCKET_WINDOW + 1][2];
+    secp256k1_ecmult_calibration_cost strauss;
+    secp256k1_ecmult_calibration_cost pippenger[PIPPENGER_MAX_BUCKET_WINDOW];
+    secp256k1_ecmult_calibration_data data;
+    secp256k1_ecmult_multi_params res;
+    secp256k1_scalar *sc;
+    secp256k1_ge *pt;
+    secp256k1_scratch *scratch;
+    secp256k1_gej pj;
+    size_t scratch_size;
+    size_t i, n;
+    int w, v, j;
+    int round;
+    int ret;
+
+    scratch_size = secp256k1_strauss_scratch_size(secp256k1_ecmult_calibration_points(0, 1)) + STRAUSS_SCRATCH_OBJECTS*ALIGNMENT;
+    for (w = 1; w <= PIPPENGER_MAX_BUCKET_WINDOW; w++) {
+        size_t size = secp256k1_pippenger_scratch_size(secp256k1_ecmult_calibration_points(w, 1), w) + PIPPENGER_SCRATCH_OBJECTS*ALIGNMENT;
+        scratch_size = size > scratch_size ? size : scratch_size;
+    }
+    sc = (secp256k1_scalar *)checked_malloc(error_callback, ECMULT_CALIBRATION_MAX_POINTS * sizeof(*sc));
+    pt = (secp256k1_ge *)checked_malloc(error_callback, ECMULT_CALIBRATION_MAX_POINTS * sizeof(*pt));
+    scratch = secp256k1_scratch_create(error_callback, scratch_size);
+    ret = sc != NULL && pt != NULL && scratch != NULL;
+
+    if (ret) {
+        /* Multiply consecutive multiples of G with powers of a random-looking
+         * scalar. */
+        secp256k1_gej_set_ge(&pj, &secp256k1_ge_const_g);
+        for (i = 0; i < ECMULT_CALIBRATION_MAX_POINTS; i++) {
+            secp256k1_gej tmp;
+            if (i == 0) {
+                sc[i] = s;
+            } else {
+                secp256k1_scalar_mul(&sc[i], &sc[i - 1], &s);
+            }
+            secp256k1_gej_add_ge_var(&pj, &pj, &secp256k1_ge_const_g, NULL);
+            tmp = pj;
+            secp256k1_ge_set_gej_var(&pt[i], &tmp);
+        }
+        data.sc = sc;
+        data.pt = pt;
+
+        /* Measure everything once per round, so that a temporary slowdown of
+         * the machine doesn't distort the comparison. */
+        for (round = 0; ret && round < ECMULT_CALIBRATION_ROUNDS; round++) {
+            for (w = 0; ret && w <= PIPPENGER_MAX_BUCKET_WINDOW; w++) {
+                for (j = 0; ret && j < 2; j++) {
+                    int64_t cur = secp256k1_ecmult_calibration_measure(error_callback, scratch, &data, w, secp256k1_ecmult_calibration_points(w, j));
+                    ret = cur >= 0;
+                    if (round == 0 || cur < t[w][j]) {
+                        t[w][j] = cur;
+                    }
+                }
+            }
+        }
+    }
+    free(sc);
+    free(pt);
+    if (scratch != NULL) {
+        secp256k1_scratch_destroy(error_callback, scratch);
+    }
+    if (!ret) {
+        return 0;
+    }
+    for (w = 0; w <= PIPPENGER_MAX_BUCKET_WINDOW; w++) {
+        secp256k1_ecmult_calibration_cost_fit(w == 0 ? &strauss : &pippenger[w - 1], t[w][0], t[w][1], secp256k1_ecmult_calibration_points(w, 0), secp256k1_ecmult_calibration_points(w, 1));
+    }
+
+    /* Use every bucket window for as many points as no larger one is faster,
+     * but keep the maximum number of points non-decreasing. */
+    n = 0;
+    for (w = 1; w < PIPPENGER_MAX_BUCKET_WINDOW; w++) {
+        size_t max_points = ECMULT_MAX_POINTS_PER_BATCH;
+        for (v = w + 1; v <= PIPPENGER_MAX_BUCKET_WINDOW; v++) {
+            const secp256k1_ecmult_calibration_cost *a = &pippenger[w - 1];
+            const secp256k1_ecmult_calibration_cost *b = &pippenger[v - 1];
+            if (b->per_point < a->per_point) {
+                /* The number of points up to which a is at most as expensive as b */
+                int64_t crossover = (b->fixed - a->fixed) / (a->per_point - b->per_point);
+                if (crossover < (int64_t)max_points) {
+                    max_points = crossover > 0 ? (size_t)crossover : 0;
+                }
+            }
+        }
+        n = max_points > n ? max_points : n;
+        res.pippenger_max_points[w - 1] = n;
+    }
+    res.pippenger_max_points[PIPPENGER_MAX_BUCKET_WINDOW - 1] = SIZE_MAX;
+
+    /* Use Pippenger's algorithm from the smallest number of points on for which
+     * it's at least as fast as Strauss' algorithm. */
+    for (n = 1; n < ECMULT_CALIBRATION_MAX_THRESHOLD; n++) {
+        const secp256k1_ecmult_calibration_cost *cost = &pippenger[secp256k1_ecmult_multi_params_bucket_window(&res, n) - 1];
+        if (secp256k1_ecmult_calibration_cost_eval(cost, n) <= secp256k1_ecmult_calibration_cost_eval(&strauss, n)) {
+            break;
+        }
+    }
+    res.pippenger_threshold = n;
+
+    *params = res;
+    return 1;
+}
+
 #endif /* SECP256K1_ECMULT_IMPL_H */
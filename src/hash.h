@@ -21,6 +21,19 @@ static void secp256k1_sha256_write(secp256k1_sha256 *hash, const unsigned char *
 static void secp256k1_sha256_finalize(secp256k1_sha256 *hash, unsigned char *out32);
 static void secp256k1_sha256_clear(secp256k1_sha256 *hash);
 
+/* The number of hashes that secp256k1_sha256_write_many and
+ * secp256k1_sha256_finalize_many process at once. */
+#define SECP256K1_SHA256_MAX_LANES 8
+
+/** Writes the lens[i] bytes at data[i] to hashes[i] for all i < n, like
+ *  secp256k1_sha256_write, but transforms the blocks of independent hashes in
+ *  parallel where the CPU supports it. */
+static void secp256k1_sha256_write_many(secp256k1_sha256 *hashes, const unsigned char * const *data, const size_t *lens, size_t n);
+
+/** Finalizes hashes[i] into out32 + 32*i for all i < n, like
+ *  secp256k1_sha256_finalize. */
+static void secp256k1_sha256_finalize_many(secp256k1_sha256 *hashes, unsigned char *out32, size_t n);
+
 typedef struct {
     secp256k1_sha256 inner, outer;
 } secp256k1_hmac_sha256;
@@ -14,6 +14,10 @@
 #include <stdint.h>
 #include <string.h>
 
+#ifdef USE_ASM_X86_64
+#include "hash_x86_64_impl.h"
+#endif
+
 #define Ch(x,y,z) ((z) ^ ((x) & ((y) ^ (z))))
 #define Maj(x,y,z) (((x) & (y)) | ((z) & ((x) | (y))))
 #define Sigma0(x) (((x) >> 2 | (x) << 30) ^ ((x) >> 13 | (x) << 19) ^ ((x) >> 22 | (x) << 10))
@@ -41,7 +45,7 @@ static void secp256k1_sha256_initialize(secp256k1_sha256 *hash) {
 }
 
 /** Perform one SHA-256 transformation, processing 16 big endian 32-bit words. */
-static void secp256k1_sha256_transform(uint32_t* s, const unsigned char* buf) {
+static void secp256k1_sha256_transform_portable(uint32_t* s, const unsigned char* buf) {
     uint32_t a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7];
     uint32_t w0, w1, w2, w3, w4, w5, w6, w7, w8, w9, w10, w11, w12, w13, w14, w15;
 
@@ -123,6 +127,16 @@ static void secp256k1_sha256_transform(uint32_t* s, const unsigned char* buf) {
     s[7] += h;
 }
 
+static void secp256k1_sha256_transform(uint32_t* s, const unsigned char* buf) {
+#ifdef USE_ASM_X86_64
+    if (secp256k1_sha256_shani_available()) {
+        secp256k1_sha256_transform_shani(s, buf);
+        return;
+    }
+#endif
+    secp256k1_sha256_transform_portable(s, buf);
+}
+
 static void secp256k1_sha256_write(secp256k1_sha256 *hash, const unsigned char *data, size_t len) {
     size_t bufsize = hash->bytes & 0x3F;
     hash->bytes += len;
@@ -148,16 +162,137 @@ static void secp256k1_sha256_finalize(secp256k1_sha256 *hash, unsigned char *out
     int i;
     /* The maximum message size of SHA256 is 2^64-1 bits. */
     VERIFY_CHECK(hash->bytes < ((uint64_t)1 << 61));
-    secp256k1_write_be32(&sizedesc[0], hash->bytes >> 29);
-    secp256k1_write_be32(&sizedesc[4], hash->bytes << 3);
-    secp256k1_sha256_write(hash, pad, 1 + ((119 - (hash->bytes % 64)) % 64));
-    secp256k1_sha256_write(hash, sizedesc, 8);
+    if ((hash->bytes & 0x3F) == 32) {
+        /* Most hashes in the library end 32 bytes into a block, e.g., 32-byte
+         * inputs after a tag midstate or an HMAC key block, and Schnorr
+         * challenges of 32-byte messages. Their padding is the second half of
+         * the last block, so complete the buffer in place. */
+        memcpy(&hash->buf[32], pad, 24);
+        secp256k1_write_be32(&hash->buf[56], hash->bytes >> 29);
+        secp256k1_write_be32(&hash->buf[60], hash->bytes << 3);
+        secp256k1_sha256_transform(hash->s, hash->buf);
+    } else {
+        secp256k1_write_be32(&sizedesc[0], hash->bytes >> 29);
+        secp256k1_write_be32(&sizedesc[4], hash->bytes << 3);
+        secp256k1_sha256_write(hash, pad, 1 + ((119 - (hash->bytes % 64)) % 64));
+        secp256k1_sha256_write(hash, sizedesc, 8);
+    }
     for (i = 0; i < 8; i++) {
         secp256k1_write_be32(&out32[4*i], hash->s[i]);
         hash->s[i] = 0;
     }
 }
 
+/** Perform the SHA-256 transformations of s[i] with the 64-byte blocks at
+ *  blocks + 64*i for all i < n, where n is at most SECP256K1_SHA256_MAX_LANES. */
+static void secp256k1_sha256_transform_many(uint32_t * const *s, const unsigned char *blocks, size_t n) {
+    size_t i;
+    VERIFY_CHECK(n <= SECP256K1_SHA256_MAX_LANES);
+#ifdef USE_ASM_X86_64
+    /* With the SHA extensions, consecutive independent transformations already
+     * overlap in the pipeline, which is faster than eight AVX2 lanes. Without
+     * them, the AVX2 lanes are faster than the portable code from three
+     * transformations on. */
+    if (n >= 3 && !secp256k1_sha256_shani_available() && secp256k1_sha256_avx2_available()) {
+        secp256k1_sha256_transform_avx2(s, blocks, n);
+        return;
+    }
+#endif
+    for (i = 0; i < n; i++) {
+        secp256k1_sha256_transform(s[i], &blocks[64*i]);
+    }
+}
+
+static void secp256k1_sha256_write_many(secp256k1_sha256 *hashes, const unsigned char * const *data, const size_t *lens, size_t n) {
+    unsigned char blocks[64 * SECP256K1_SHA256_MAX_LANES];
+    uint32_t *s[SECP256K1_SHA256_MAX_LANES];
+    size_t nblocks[SECP256K1_SHA256_MAX_LANES];
+    size_t lanes, maxblocks, block, active, bufsize, done, i;
+
+    while (n > 0) {
+        lanes = n < SECP256K1_SHA256_MAX_LANES ? n : SECP256K1_SHA256_MAX_LANES;
+        maxblocks = 0;
+        for (i = 0; i < lanes; i++) {
+            nblocks[i] = ((hashes[i].bytes & 0x3F) + lens[i]) / 64;
+            if (nblocks[i] > maxblocks) {
+                maxblocks = nblocks[i];
+            }
+        }
+        /* Transform the blocks with the same index in all hashes at once. */
+        for (block = 0; block < maxblocks; block++) {
+            active = 0;
+            for (i = 0; i < lanes; i++) {
+                if (block >= nblocks[i]) {
+                    continue;
+                }
+                bufsize = hashes[i].bytes & 0x3F;
+                if (block == 0) {
+                    memcpy(&blocks[64*active], hashes[i].buf, bufsize);
+                    memcpy(&blocks[64*active + bufsize], data[i], 64 - bufsize);
+                } else {
+                    memcpy(&blocks[64*active], &data[i][64*block - bufsize], 64);
+                }
+                s[active] = hashes[i].s;
+                active++;
+            }
+            secp256k1_sha256_transform_many(s, blocks, active);
+        }
+        /* Buffer what remains. */
+        for (i = 0; i < lanes; i++) {
+            bufsize = hashes[i].bytes & 0x3F;
+            hashes[i].bytes += lens[i];
+            VERIFY_CHECK(hashes[i].bytes >= lens[i]);
+            if (nblocks[i] == 0) {
+                if (lens[i]) {
+                    memcpy(&hashes[i].buf[bufsize], data[i], lens[i]);
+                }
+            } else {
+                done = 64*nblocks[i] - bufsize;
+                if (lens[i] > done) {
+                    memcpy(hashes[i].buf, &data[i][done], lens[i] - done);
+                }
+            }
+        }
+        hashes += lanes;
+        data += lanes;
+        lens += lanes;
+        n -= lanes;
+    }
+}
+
+static void secp256k1_sha256_finalize_many(secp256k1_sha256 *hashes, unsigned char *out32, size_t n) {
+    /* The padding of each hash, i.e., the 0x80 byte, zeros and the size. */
+    unsigned char pads[SECP256K1_SHA256_MAX_LANES][72];
+    const unsigned char *data[SECP256K1_SHA256_MAX_LANES];
+    size_t lens[SECP256K1_SHA256_MAX_LANES];
+    size_t lanes, i, j;
+
+    while (n > 0) {
+        lanes = n < SECP256K1_SHA256_MAX_LANES ? n : SECP256K1_SHA256_MAX_LANES;
+        for (i = 0; i < lanes; i++) {
+            /* The maximum message size of SHA256 is 2^64-1 bits. */
+            VERIFY_CHECK(hashes[i].bytes < ((uint64_t)1 << 61));
+            lens[i] = 1 + ((119 - (hashes[i].bytes % 64)) % 64);
+            memset(pads[i], 0, lens[i]);
+            pads[i][0] = 0x80;
+            secp256k1_write_be32(&pads[i][lens[i]], hashes[i].bytes >> 29);
+            secp256k1_write_be32(&pads[i][lens[i] + 4], hashes[i].bytes << 3);
+            lens[i] += 8;
+            data[i] = pads[i];
+        }
+        secp256k1_sha256_write_many(hashes, data, lens, lanes);
+        for (i = 0; i < lanes; i++) {
+            for (j = 0; j < 8; j++) {
+                secp256k1_write_be32(&out32[32*i + 4*j], hashes[i].s[j]);
+                hashes[i].s[j] = 0;
+            }
+        }
+        hashes += lanes;
+        out32 += 32 * lanes;
+        n -= lanes;
+    }
+}
+
 /* Initializes a sha256 struct and writes the 64 byte string
  * SHA256(tag)||SHA256(tag) into it. */
 static void secp256k1_sha256_initialize_tagged(secp256k1_sha256 *hash, const unsigned char *tag, size_t taglen) {
@@ -0,0 +1,474 @@
+/***********************************************************************
+ * Distributed under the MIT software license, see the accompanying    *
+ * file COPYING or https://www.opensource.org/licenses/mit-license.php.*
+ ***********************************************************************/
+
+/**
+ * SHA-256 transformation using the x86 SHA extensions (SHA-NI), which are
+ * available on Intel CPUs since Goldmont and Ice Lake and on AMD CPUs since
+ * Zen. Whether the CPU supports them is determined at runtime, so the library
+ * still runs on CPUs without them. The instruction sequence follows Intel's
+ * reference implementation ("Intel SHA Extensions", July 2013).
+ *
+ * CPUs without the SHA extensions but with AVX2 can instead perform eight
+ * independent transformations at once, one in each 32-bit lane of the YMM
+ * registers.
+ */
+
+#ifndef SECP256K1_HASH_X86_64_IMPL_H
+#define SECP256K1_HASH_X86_64_IMPL_H
+
+#include <stdint.h>
+
+#include "util.h"
+
+static const uint32_t secp256k1_sha256_x86_k[64] = {
+    0x428a2f98ul, 0x71374491ul, 0xb5c0fbcful, 0xe9b5dba5ul,
+    0x3956c25bul, 0x59f111f1ul, 0x923f82a4ul, 0xab1c5ed5ul,
+    0xd807aa98ul, 0x12835b01ul, 0x243185beul, 0x550c7dc3ul,
+    0x72be5d74ul, 0x80deb1feul, 0x9bdc06a7ul, 0xc19bf174ul,
+    0xe49b69c1ul, 0xefbe4786ul, 0x0fc19dc6ul, 0x240ca1ccul,
+    0x2de92c6ful, 0x4a7484aaul, 0x5cb0a9dcul, 0x76f988daul,
+    0x983e5152ul, 0xa831c66dul, 0xb00327c8ul, 0xbf597fc7ul,
+    0xc6e00bf3ul, 0xd5a79147ul, 0x06ca6351ul, 0x14292967ul,
+    0x27b70a85ul, 0x2e1b2138ul, 0x4d2c6dfcul, 0x53380d13ul,
+    0x650a7354ul, 0x766a0abbul, 0x81c2c92eul, 0x92722c85ul,
+    0xa2bfe8a1ul, 0xa81a664bul, 0xc24b8b70ul, 0xc76c51a3ul,
+    0xd192e819ul, 0xd6990624ul, 0xf40e3585ul, 0x106aa070ul,
+    0x19a4c116ul, 0x1e376c08ul, 0x2748774cul, 0x34b0bcb5ul,
+    0x391c0cb3ul, 0x4ed8aa4aul, 0x5b9cca4ful, 0x682e6ff3ul,
+    0x748f82eeul, 0x78a5636ful, 0x84c87814ul, 0x8cc70208ul,
+    0x90befffaul, 0xa4506cebul, 0xbef9a3f7ul, 0xc67178f2ul
+};
+
+/* pshufb mask that converts the big endian message words to little endian. */
+static const unsigned char secp256k1_sha256_shani_bswap_mask[16] = {
+    3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12
+};
+
+/* Flags for the CPU features used by the implementations in this file. */
+#define SECP256K1_SHA256_X86_DETECTED 1
+#define SECP256K1_SHA256_X86_SHANI 2
+#define SECP256K1_SHA256_X86_AVX2 4
+
+/* The CPU features as a combination of the flags above, or 0 if they have not
+ * been determined yet. Threads may determine them concurrently, but they all
+ * store the same value. */
+static int secp256k1_sha256_x86_features = 0;
+
+static int secp256k1_sha256_x86_detect(void) {
+    uint32_t eax, ebx, ecx, edx, xcr0;
+    int features = SECP256K1_SHA256_X86_DETECTED;
+    int avx;
+
+    __asm__ ("cpuid" : "=a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx) : "a"(0), "c"(0));
+    if (eax < 7) {
+        return features;
+    }
+    /* SSSE3 is CPUID.1:ECX bit 9. AVX requires CPUID.1:ECX bits 27 (OSXSAVE)
+     * and 28 (AVX), and the OS must save the XMM and YMM registers (XCR0 bits
+     * 1 and 2). */
+    __asm__ ("cpuid" : "=a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx) : "a"(1), "c"(0));
+    if (!((ecx >> 9) & 1)) {
+        return features;
+    }
+    avx = 0;
+    if (((ecx >> 27) & 3) == 3) {
+        __asm__ ("xgetbv" : "=a"(xcr0), "=d"(edx) : "c"(0));
+        avx = (xcr0 & 6) == 6;
+    }
+    /* SHA is CPUID.(EAX=7,ECX=0):EBX bit 29, AVX2 is bit 5. */
+    __asm__ ("cpuid" : "=a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx) : "a"(7), "c"(0));
+    if ((ebx >> 29) & 1) {
+        features |= SECP256K1_SHA256_X86_SHANI;
+    }
+    if (avx && ((ebx >> 5) & 1)) {
+        features |= SECP256K1_SHA256_X86_AVX2;
+    }
+    return features;
+}
+
+static int secp256k1_sha256_x86_get_features(void) {
+    int features = __atomic_load_n(&secp256k1_sha256_x86_features, __ATOMIC_RELAXED);
+    if (EXPECT(features == 0, 0)) {
+        features = secp256k1_sha256_x86_detect();
+        __atomic_store_n(&secp256k1_sha256_x86_features, features, __ATOMIC_RELAXED);
+    }
+    return features;
+}
+
+/** Returns whether the CPU supports the SHA extensions and SSSE3. */
+static int secp256k1_sha256_shani_available(void) {
+    return (secp256k1_sha256_x86_get_features() & SECP256K1_SHA256_X86_SHANI) != 0;
+}
+
+/** Returns whether the CPU and the OS support AVX2. */
+static int secp256k1_sha256_avx2_available(void) {
+    return (secp256k1_sha256_x86_get_features() & SECP256K1_SHA256_X86_AVX2) != 0;
+}
+
+/** Perform one SHA-256 transformation like secp256k1_sha256_transform, using
+ *  the SHA extensions. Must only be called if secp256k1_sha256_shani_available
+ *  returns 1. */
+static void secp256k1_sha256_transform_shani(uint32_t* s, const unsigned char* buf) {
+    __asm__ __volatile__(
+    /* Load the state, and rearrange it from (A,B,C,D), (E,F,G,H) into the
+     * (A,B,E,F), (C,D,G,H) layout used by sha256rnds2. */
+    "movdqu 0(%0), %%xmm1\n"
+    "movdqu 16(%0), %%xmm2\n"
+    "movdqa %%xmm1, %%xmm7\n"
+    "punpcklqdq %%xmm2, %%xmm1\n"
+    "punpckhqdq %%xmm7, %%xmm2\n"
+    "pshufd $0x1B, %%xmm1, %%xmm1\n"
+    "pshufd $0xB1, %%xmm2, %%xmm2\n"
+    "movdqu 0(%3), %%xmm8\n"
+    "movdqa %%xmm1, %%xmm9\n"
+    "movdqa %%xmm2, %%xmm10\n"
+    /* Every group of four rounds adds the round constants to four message
+     * words, and computes four words of the message schedule ahead. */
+    /* Rounds 0 to 3 */
+    "movdqu 0(%1), %%xmm3\n"
+    "pshufb %%xmm8, %%xmm3\n"
+    "movdqu 0(%2), %%xmm0\n"
+    "paddd %%xmm3, %%xmm0\n"
+    "sha256rnds2 %%xmm1, %%xmm2\n"
+    "punpckhqdq %%xmm0, %%xmm0\n"
+    "sha256rnds2 %%xmm2, %%xmm1\n"
+    /* Rounds 4 to 7 */
+    "movdqu 16(%1), %%xmm4\n"
+    "pshufb %%xmm8, %%xmm4\n"
+    "movdqu 16(%2), %%xmm0\n"
+    "paddd %%xmm4, %%xmm0\n"
+    "sha256rnds2 %%xmm1, %%xmm2\n"
+    "punpckhqdq %%xmm0, %%xmm0\n"
+    "sha256rnds2 %%xmm2, %%xmm1\n"
+    "sha256msg1 %%xmm4, %%xmm3\n"
+    /* Rounds 8 to 11 */
+    "movdqu 32(%1), %%xmm5\n"
+    "pshufb %%xmm8, %%xmm5\n"
+    "movdqu 32(%2), %%xmm0\n"
+    "paddd %%xmm5, %%xmm0\n"
+    "sha256rnds2 %%xmm1, %%xmm2\n"
+    "punpckhqdq %%xmm0, %%xmm0\n"
+    "sha256rnds2 %%xmm2, %%xmm1\n"
+    "sha256msg1 %%xmm5, %%xmm4\n"
+    /* Rounds 12 to 15 */
+    "movdqu 48(%1), %%xmm6\n"
+    "pshufb %%xmm8, %%xmm6\n"
+    "movdqu 48(%2), %%xmm0\n"
+    "paddd %%xmm6, %%xmm0\n"
+    "sha256rnds2 %%xmm1, %%xmm2\n"
+    "movdqa %%xmm6, %%xmm7\n"
+    "palignr $4, %%xmm5, %%xmm7\n"
+    "paddd %%xmm7, %%xmm3\n"
+    "sha256msg2 %%xmm6, %%xmm3\n"
+    "punpckhqdq %%xmm0, %%xmm0\n"
+    "sha256rnds2 %%xmm2, %%xmm1\n"
+    "sha256msg1 %%xmm6, %%xmm5\n"
+    /* Rounds 16 to 19 */
+    "movdqu 64(%2), %%xmm0\n"
+    "paddd %%xmm3, %%xmm0\n"
+    "sha256rnds2 %%xmm1, %%xmm2\n"
+    "movdqa %%xmm3, %%xmm7\n"
+    "palignr $4, %%xmm6, %%xmm7\n"
+    "paddd %%xmm7, %%xmm4\n"
+    "sha256msg2 %%xmm3, %%xmm4\n"
+    "punpckhqdq %%xmm0, %%xmm0\n"
+    "sha256rnds2 %%xmm2, %%xmm1\n"
+    "sha256msg1 %%xmm3, %%xmm6\n"
+    /* Rounds 20 to 23 */
+    "movdqu 80(%2), %%xmm0\n"
+    "paddd %%xmm4, %%xmm0\n"
+    "sha256rnds2 %%xmm1, %%xmm2\n"
+    "movdqa %%xmm4, %%xmm7\n"
+    "palignr $4, %%xmm3, %%xmm7\n"
+    "paddd %%xmm7, %%xmm5\n"
+    "sha256msg2 %%xmm4, %%xmm5\n"
+    "punpckhqdq %%xmm0, %%xmm0\n"
+    "sha256rnds2 %%xmm2, %%xmm1\n"
+    "sha256msg1 %%xmm4, %%xmm3\n"
+    /* Rounds 24 to 27 */
+    "movdqu 96(%2), %%xmm0\n"
+    "paddd %%xmm5, %%xmm0\n"
+    "sha256rnds2 %%xmm1, %%xmm2\n"
+    "movdqa %%xmm5, %%xmm7\n"
+    "palignr $4, %%xmm4, %%xmm7\n"
+    "paddd %%xmm7, %%xmm6\n"
+    "sha256msg2 %%xmm5, %%xmm6\n"
+    "punpckhqdq %%xmm0, %%xmm0\n"
+    "sha256rnds2 %%xmm2, %%xmm1\n"
+    "sha256msg1 %%xmm5, %%xmm4\n"
+    /* Rounds 28 to 31 */
+    "movdqu 112(%2), %%xmm0\n"
+    "paddd %%xmm6, %%xmm0\n"
+    "sha256rnds2 %%xmm1, %%xmm2\n"
+    "movdqa %%xmm6, %%xmm7\n"
+    "palignr $4, %%xmm5, %%xmm7\n"
+    "paddd %%xmm7, %%xmm3\n"
+    "sha256msg2 %%xmm6, %%xmm3\n"
+    "punpckhqdq %%xmm0, %%xmm0\n"
+    "sha256rnds2 %%xmm2, %%xmm1\n"
+    "sha256msg1 %%xmm6, %%xmm5\n"
+    /* Rounds 32 to 35 */
+    "movdqu 128(%2), %%xmm0\n"
+    "paddd %%xmm3, %%xmm0\n"
+    "sha256rnds2 %%xmm1, %%xmm2\n"
+    "movdqa %%xmm3, %%xmm7\n"
+    "palignr $4, %%xmm6, %%xmm7\n"
+    "paddd %%xmm7, %%xmm4\n"
+    "sha256msg2 %%xmm3, %%xmm4\n"
+    "punpckhqdq %%xmm0, %%xmm0\n"
+    "sha256rnds2 %%xmm2, %%xmm1\n"
+    "sha256msg1 %%xmm3, %%xmm6\n"
+    /* Rounds 36 to 39 */
+    "movdqu 144(%2), %%xmm0\n"
+    "paddd %%xmm4, %%xmm0\n"
+    "sha256rnds2 %%xmm1, %%xmm2\n"
+    "movdqa %%xmm4, %%xmm7\n"
+    "palignr $4, %%xmm3, %%xmm7\n"
+    "paddd %%xmm7, %%xmm5\n"
+    "sha256msg2 %%xmm4, %%xmm5\n"
+    "punpckhqdq %%xmm0, %%xmm0\n"
+    "sha256rnds2 %%xmm2, %%xmm1\n"
+    "sha256msg1 %%xmm4, %%xmm3\n"
+    /* Rounds 40 to 43 */
+    "movdqu 160(%2), %%xmm0\n"
+    "paddd %%xmm5, %%xmm0\n"
+    "sha256rnds2 %%xmm1, %%xmm2\n"
+    "movdqa %%xmm5, %%xmm7\n"
+    "palignr $4, %%xmm4, %%xmm7\n"
+    "paddd %%xmm7, %%xmm6\n"
+    "sha256msg2 %%xmm5, %%xmm6\n"
+    "punpckhqdq %%xmm0, %%xmm0\n"
+    "sha256rnds2 %%xmm2, %%xmm1\n"
+    "sha256msg1 %%xmm5, %%xmm4\n"
+    /* Rounds 44 to 47 */
+    "movdqu 176(%2), %%xmm0\n"
+    "paddd %%xmm6, %%xmm0\n"
+    "sha256rnds2 %%xmm1, %%xmm2\n"
+    "movdqa %%xmm6, %%xmm7\n"
+    "palignr $4, %%xmm5, %%xmm7\n"
+    "paddd %%xmm7, %%xmm3\n"
+    "sha256msg2 %%xmm6, %%xmm3\n"
+    "punpckhqdq %%xmm0, %%xmm0\n"
+    "sha256rnds2 %%xmm2, %%xmm1\n"
+    "sha256msg1 %%xmm6, %%xmm5\n"
+    /* Rounds 48 to 51 */
+    "movdqu 192(%2), %%xmm0\n"
+    "paddd %%xmm3, %%xmm0\n"
+    "sha256rnds2 %%xmm1, %%xmm2\n"
+    "movdqa %%xmm3, %%xmm7\n"
+    "palignr $4, %%xmm6, %%xmm7\n"
+    "paddd %%xmm7, %%xmm4\n"
+    "sha256msg2 %%xmm3, %%xmm4\n"
+    "punpckhqdq %%xmm0, %%xmm0\n"
+    "sha256rnds2 %%xmm2, %%xmm1\n"
+    "sha256msg1 %%xmm3, %%xmm6\n"
+    /* Rounds 52 to 55 */
+    "movdqu 208(%2), %%xmm0\n"
+    "paddd %%xmm4, %%xmm0\n"
+    "sha256rnds2 %%xmm1, %%xmm2\n"
+    "movdqa %%xmm4, %%xmm7\n"
+    "palignr $4, %%xmm3, %%xmm7\n"
+    "paddd %%xmm7, %%xmm5\n"
+    "sha256msg2 %%xmm4, %%xmm5\n"
+    "punpckhqdq %%xmm0, %%xmm0\n"
+    "sha256rnds2 %%xmm2, %%xmm1\n"
+    /* Rounds 56 to 59 */
+    "movdqu 224(%2), %%xmm0\n"
+    "paddd %%xmm5, %%xmm0\n"
+    "sha256rnds2 %%xmm1, %%xmm2\n"
+    "movdqa %%xmm5, %%xmm7\n"
+    "palignr $4, %%xmm4, %%xmm7\n"
+    "paddd %%xmm7, %%xmm6\n"
+    "sha256msg2 %%xmm5, %%xmm6\n"
+    "punpckhqdq %%xmm0, %%xmm0\n"
+    "sha256rnds2 %%xmm2, %%xmm1\n"
+    /* Rounds 60 to 63 */
+    "movdqu 240(%2), %%xmm0\n"
+    "paddd %%xmm6, %%xmm0\n"
+    "sha256rnds2 %%xmm1, %%xmm2\n"
+    "punpckhqdq %%xmm0, %%xmm0\n"
+    "sha256rnds2 %%xmm2, %%xmm1\n"
+    /* Add the state from before the rounds, and restore the layout. */
+    "paddd %%xmm9, %%xmm1\n"
+    "paddd %%xmm10, %%xmm2\n"
+    "movdqa %%xmm1, %%xmm7\n"
+    "punpcklqdq %%xmm2, %%xmm1\n"
+    "punpckhqdq %%xmm7, %%xmm2\n"
+    "pshufd $0xB1, %%xmm1, %%xmm1\n"
+    "pshufd $0x1B, %%xmm2, %%xmm2\n"
+    "movdqu %%xmm2, 0(%0)\n"
+    "movdqu %%xmm1, 16(%0)\n"
+    :
+    : "r"(s), "r"(buf), "r"(secp256k1_sha256_x86_k), "r"(secp256k1_sha256_shani_bswap_mask)
+    : "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6", "xmm7", "xmm8", "xmm9", "xmm10", "cc", "memory"
+    );
+}
+
+/* One round of eight SHA-256 transformations in the lanes of the YMM registers
+ * a to h, using the round constant at (%1) and the message words at (%0), both
+ * offset by round i of the block of eight rounds. Clobbers ymm8 to ymm15. */
+#define SECP256K1_SHA256_AVX2_ROUND(a, b, c, d, e, f, g, h, i) \
+    /* h += k + w */ \
+    "vpbroadcastd 4*" i "(%1), %%ymm8\n" \
+    "vpaddd 32*" i "(%0), %%" h ", %%" h "\n" \
+    "vpaddd %%ymm8, %%" h ", %%" h "\n" \
+    /* ymm8 = Sigma1(e) */ \
+    "vpsrld $6, %%" e ", %%ymm8\n" \
+    "vpslld $26, %%" e ", %%ymm9\n" \
+    "vpsrld $11, %%" e ", %%ymm10\n" \
+    "vpslld $21, %%" e ", %%ymm11\n" \
+    "vpsrld $25, %%" e ", %%ymm12\n" \
+    "vpslld $7, %%" e ", %%ymm13\n" \
+    "vpxor %%ymm9, %%ymm8, %%ymm8\n" \
+    "vpxor %%ymm11, %%ymm10, %%ymm10\n" \
+    "vpxor %%ymm13, %%ymm12, %%ymm12\n" \
+    "vpxor %%ymm10, %%ymm8, %%ymm8\n" \
+    "vpxor %%ymm12, %%ymm8, %%ymm8\n" \
+    /* ymm9 = Ch(e, f, g) */ \
+    "vpxor %%" f ", %%" g ", %%ymm9\n" \
+    "vpand %%" e ", %%ymm9, %%ymm9\n" \
+    "vpxor %%" g ", %%ymm9, %%ymm9\n" \
+    /* h += Sigma1(e) + Ch(e, f, g), d += h */ \
+    "vpaddd %%ymm9, %%" h ", %%" h "\n" \
+    "vpaddd %%ymm8, %%" h ", %%" h "\n" \
+    "vpaddd %%" h ", %%" d ", %%" d "\n" \
+    /* ymm10 = Sigma0(a) */ \
+    "vpsrld $2, %%" a ", %%ymm10\n" \
+    "vpslld $30, %%" a ", %%ymm11\n" \
+    "vpsrld $13, %%" a ", %%ymm12\n" \
+    "vpslld $19, %%" a ", %%ymm13\n" \
+    "vpsrld $22, %%" a ", %%ymm14\n" \
+    "vpslld $10, %%" a ", %%ymm15\n" \
+    "vpxor %%ymm11, %%ymm10, %%ymm10\n" \
+    "vpxor %%ymm13, %%ymm12, %%ymm12\n" \
+    "vpxor %%ymm15, %%ymm14, %%ymm14\n" \
+    "vpxor %%ymm12, %%ymm10, %%ymm10\n" \
+    "vpxor %%ymm14, %%ymm10, %%ymm10\n" \
+    /* ymm11 = Maj(a, b, c) */ \
+    "vpor %%" a ", %%" b ", %%ymm11\n" \
+    "vpand %%" a ", %%" b ", %%ymm12\n" \
+    "vpand %%" c ", %%ymm11, %%ymm11\n" \
+    "vpor %%ymm12, %%ymm11, %%ymm11\n" \
+    /* h += Sigma0(a) + Maj(a, b, c) */ \
+    "vpaddd %%ymm10, %%" h ", %%" h "\n" \
+    "vpaddd %%ymm11, %%" h ", %%" h "\n"
+
+/** Perform the SHA-256 transformations of s[i] with the 64-byte blocks at
+ *  blocks + 64*i for all i < n, like secp256k1_sha256_transform, using AVX2.
+ *  n must be between 1 and 8. Must only be called if
+ *  secp256k1_sha256_avx2_available returns 1. */
+static void secp256k1_sha256_transform_avx2(uint32_t * const *s, const unsigned char *blocks, size_t n) {
+    /* The states and the message schedules with the words of transformation
+     * i in lane i. Unused lanes repeat the first transformation. */
+    uint32_t st[8][8];
+    uint32_t w[64][8];
+    const uint32_t *k = secp256k1_sha256_x86_k;
+    uint32_t *wp = &w[0][0];
+    size_t i, j, lane;
+    uint32_t count;
+
+    VERIFY_CHECK(n >= 1 && n <= 8);
+    for (i = 0; i < 8; i++) {
+        lane = i < n ? i : 0;
+        for (j = 0; j < 8; j++) {
+            st[j][i] = s[lane][j];
+        }
+        for (j = 0; j < 16; j++) {
+            w[j][i] = secp256k1_read_be32(&blocks[64*lane + 4*j]);
+        }
+    }
+
+    __asm__ __volatile__(
+    /* Expand the message schedule: w[t] = sigma1(w[t-2]) + w[t-7] + sigma0(w[t-15]) + w[t-16]
+     * for t = 16..63, with %0 pointing at w[t-16]. */
+    "movl $48, %2\n"
+    "1:\n"
+    "vmovdqu 32(%0), %%ymm8\n"
+    "vpsrld $7, %%ymm8, %%ymm9\n"
+    "vpslld $25, %%ymm8, %%ymm10\n"
+    "vpsrld $18, %%ymm8, %%ymm11\n"
+    "vpslld $14, %%ymm8, %%ymm12\n"
+    "vpsrld $3, %%ymm8, %%ymm13\n"
+    "vpxor %%ymm10, %%ymm9, %%ymm9\n"
+    "vpxor %%ymm12, %%ymm11, %%ymm11\n"
+    "vpxor %%ymm13, %%ymm9, %%ymm9\n"
+    "vpxor %%ymm11, %%ymm9, %%ymm9\n"
+    "vmovdqu 448(%0), %%ymm8\n"
+    "vpsrld $17, %%ymm8, %%ymm10\n"
+    "vpslld $15, %%ymm8, %%ymm11\n"
+    "vpsrld $19, %%ymm8, %%ymm12\n"
+    "vpslld $13, %%ymm8, %%ymm13\n"
+    "vpsrld $10, %%ymm8, %%ymm14\n"
+    "vpxor %%ymm11, %%ymm10, %%ymm10\n"
+    "vpxor %%ymm13, %%ymm12, %%ymm12\n"
+    "vpxor %%ymm14, %%ymm10, %%ymm10\n"
+    "vpxor %%ymm12, %%ymm10, %%ymm10\n"
+    "vpaddd 0(%0), %%ymm9, %%ymm9\n"
+    "vpaddd 288(%0), %%ymm10, %%ymm10\n"
+    "vpaddd %%ymm10, %%ymm9, %%ymm9\n"
+    "vmovdqu %%ymm9, 512(%0)\n"
+    "add $32, %0\n"
+    "decl %2\n"
+    "jnz 1b\n"
+    "sub $1536, %0\n"
+
+    /* Load the states and perform the 64 rounds in blocks of 8. */
+    "vmovdqu 0(%3), %%ymm0\n"
+    "vmovdqu 32(%3), %%ymm1\n"
+    "vmovdqu 64(%3), %%ymm2\n"
+    "vmovdqu 96(%3), %%ymm3\n"
+    "vmovdqu 128(%3), %%ymm4\n"
+    "vmovdqu 160(%3), %%ymm5\n"
+    "vmovdqu 192(%3), %%ymm6\n"
+    "vmovdqu 224(%3), %%ymm7\n"
+    "movl $8, %2\n"
+    "2:\n"
+    SECP256K1_SHA256_AVX2_ROUND("ymm0", "ymm1", "ymm2", "ymm3", "ymm4", "ymm5", "ymm6", "ymm7", "0")
+    SECP256K1_SHA256_AVX2_ROUND("ymm7", "ymm0", "ymm1", "ymm2", "ymm3", "ymm4", "ymm5", "ymm6", "1")
+    SECP256K1_SHA256_AVX2_ROUND("ymm6", "ymm7", "ymm0", "ymm1", "ymm2", "ymm3", "ymm4", "ymm5", "2")
+    SECP256K1_SHA256_AVX2_ROUND("ymm5", "ymm6", "ymm7", "ymm0", "ymm1", "ymm2", "ymm3", "ymm4", "3")
+    SECP256K1_SHA256_AVX2_ROUND("ymm4", "ymm5", "ymm6", "ymm7", "ymm0", "ymm1", "ymm2", "ymm3", "4")
+    SECP256K1_SHA256_AVX2_ROUND("ymm3", "ymm4", "ymm5", "ymm6", "ymm7", "ymm0", "ymm1", "ymm2", "5")
+    SECP256K1_SHA256_AVX2_ROUND("ymm2", "ymm3", "ymm4", "ymm5", "ymm6", "ymm7", "ymm0", "ymm1", "6")
+    SECP256K1_SHA256_AVX2_ROUND("ymm1", "ymm2", "ymm3", "ymm4", "ymm5", "ymm6", "ymm7", "ymm0", "7")
+    "add $256, %0\n"
+    "add $32, %1\n"
+    "decl %2\n"
+    "jnz 2b\n"
+
+    /* Add the states to the results. */
+    "vpaddd 0(%3), %%ymm0, %%ymm0\n"
+    "vpaddd 32(%3), %%ymm1, %%ymm1\n"
+    "vpaddd 64(%3), %%ymm2, %%ymm2\n"
+    "vpaddd 96(%3), %%ymm3, %%ymm3\n"
+    "vpaddd 128(%3), %%ymm4, %%ymm4\n"
+    "vpaddd 160(%3), %%ymm5, %%ymm5\n"
+    "vpaddd 192(%3), %%ymm6, %%ymm6\n"
+    "vpaddd 224(%3), %%ymm7, %%ymm7\n"
+    "vmovdqu %%ymm0, 0(%3)\n"
+    "vmovdqu %%ymm1, 32(%3)\n"
+    "vmovdqu %%ymm2, 64(%3)\n"
+    "vmovdqu %%ymm3, 96(%3)\n"
+    "vmovdqu %%ymm4, 128(%3)\n"
+    "vmovdqu %%ymm5, 160(%3)\n"
+    "vmovdqu %%ymm6, 192(%3)\n"
+    "vmovdqu %%ymm7, 224(%3)\n"
+    "vzeroupper\n"
+    : "+r"(wp), "+r"(k), "=&r"(count)
+    : "r"(&st[0][0])
+    : "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6", "xmm7",
+      "xmm8", "xmm9", "xmm10", "xmm11", "xmm12", "xmm13", "xmm14", "xmm15", "cc", "memory"
+    );
+
+    for (i = 0; i < n; i++) {
+        for (j = 0; j < 8; j++) {
+            s[i][j] = st[j][i];
+        }
+    }
+}
+
+#undef SECP256K1_SHA256_AVX2_ROUND
+
+#endif /* SECP256K1_HASH_X86_64_IMPL_H */
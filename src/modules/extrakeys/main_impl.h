@@ -9,6 +9,7 @@
 
 #include "../../../include/secp256k1.h"
 #include "../../../include/secp256k1_extrakeys.h"
+#include "../../ecmult_batch.h"
 #include "../../util.h"
 
 static SECP256K1_INLINE int secp256k1_xonly_pubkey_load(const secp256k1_context* ctx, secp256k1_ge *ge, const secp256k1_xonly_pubkey *pubkey) {
@@ -153,6 +154,132 @@ int secp256k1_xonly_pubkey_tweak_add_check(const secp256k1_context* ctx, const u
             && secp256k1_fe_is_odd(&pk.y) == tweaked_pk_parity;
 }
 
+/* Adds the tweak check equation, multiplied by a randomizer a, to the batch:
+ *   a*P - a*Q + (a*t)*G = 0
+ * where P is the internal public key, t the tweak and Q the tweaked public
+ * key with the given parity. This equation holds iff the check succeeds.
+ * Returns 0 if the check fails for reasons that can be detected without a
+ * multiplication. */
+static int secp256k1_xonly_pubkey_tweak_add_check_batch_add(const secp256k1_context* ctx, secp256k1_ecmult_batch *batch, const unsigned char *tweaked_pubkey32, int tweaked_pk_parity, const secp256k1_xonly_pubkey *internal_pubkey, const unsigned char *tweak32) {
+    secp256k1_ge pk;
+    secp256k1_ge tweaked_pk;
+    secp256k1_fe tweaked_x;
+    secp256k1_scalar tweak;
+    secp256k1_scalar a;
+    unsigned char buf[33];
+    int overflow;
+
+    if (tweaked_pk_parity != 0 && tweaked_pk_parity != 1) {
+        return 0;
+    }
+    if (!secp256k1_fe_set_b32_limit(&tweaked_x, tweaked_pubkey32)) {
+        return 0;
+    }
+    if (!secp256k1_ge_set_xo_var(&tweaked_pk, &tweaked_x, tweaked_pk_parity)) {
+        return 0;
+    }
+    secp256k1_scalar_set_b32(&tweak, tweak32, &overflow);
+    if (overflow) {
+        return 0;
+    }
+    if (!secp256k1_xonly_pubkey_load(ctx, &pk, internal_pubkey)) {
+        return 0;
+    }
+
+    buf[0] = tweaked_pk_parity;
+    memcpy(&buf[1], tweaked_pubkey32, 32);
+    secp256k1_sha256_write(&batch->transcript, buf, 33);
+    secp256k1_fe_get_b32(buf, &pk.x);
+    secp256k1_sha256_write(&batch->transcript, buf, 32);
+    secp256k1_sha256_write(&batch->transcript, tweak32, 32);
+    secp256k1_ecmult_batch_randomizer(batch, &a);
+
+    secp256k1_ecmult_batch_reserve(&ctx->error_callback, batch, 2);
+    secp256k1_ecmult_batch_add(batch, &a, &pk);
+    secp256k1_scalar_mul(&tweak, &tweak, &a);
+    secp256k1_ecmult_batch_add_g(batch, &tweak);
+    secp256k1_scalar_negate(&a, &a);
+    secp256k1_ecmult_batch_add(batch, &a, &tweaked_pk);
+    return 1;
+}
+
+typedef struct {
+    const secp256k1_context *ctx;
+    const unsigned char * const *tweaked_pubkeys32;
+    const int *tweaked_pk_parities;
+    const secp256k1_xonly_pubkey * const *internal_pubkeys;
+    const unsigned char * const *tweaks32;
+} secp256k1_xonly_pubkey_tweak_add_check_batch_data;
+
+static int secp256k1_xonly_pubkey_tweak_add_check_batch_range(secp256k1_ecmult_batch *batch, size_t offset, size_t len, void *data) {
+    const secp256k1_xonly_pubkey_tweak_add_check_batch_data *d = (const secp256k1_xonly_pubkey_tweak_add_check_batch_data *)data;
+    size_t i;
+
+    for (i = offset; i < offset + len; i++) {
+        if (!secp256k1_xonly_pubkey_tweak_add_check_batch_add(d->ctx, batch, d->tweaked_pubkeys32[i], d->tweaked_pk_parities[i], d->internal_pubkeys[i], d->tweaks32[i])) {
+            return 0;
+        }
+    }
+    return secp256k1_ecmult_batch_verify(&d->ctx->error_callback, batch);
+}
+
+static int secp256k1_xonly_pubkey_tweak_add_check_batch_internal(const secp256k1_context* ctx, secp256k1_ecmult_batch *batch, size_t *invalid_idx, const unsigned char * const *tweaked_pubkeys32, const int *tweaked_pk_parities, const secp256k1_xonly_pubkey * const *internal_pubkeys, const unsigned char * const *tweaks32, size_t n_checks) {
+    secp256k1_xonly_pubkey_tweak_add_check_batch_data data;
+
+    data.ctx = ctx;
+    data.tweaked_pubkeys32 = tweaked_pubkeys32;
+    data.tweaked_pk_parities = tweaked_pk_parities;
+    data.internal_pubkeys = internal_pubkeys;
+    data.tweaks32 = tweaks32;
+    return secp256k1_ecmult_batch_find_invalid(batch, invalid_idx, secp256k1_xonly_pubkey_tweak_add_check_batch_range, &data, n_checks);
+}
+
+int secp256k1_xonly_pubkey_tweak_add_check_batch(const secp256k1_context* ctx, size_t *invalid_idx, const unsigned char * const *tweaked_pubkeys32, const int *tweaked_pk_parities, const secp256k1_xonly_pubkey * const *internal_pubkeys, const unsigned char * const *tweaks32, size_t n_checks) {
+    secp256k1_scratch *scratch;
+    secp256k1_ecmult_batch batch;
+    size_t max_terms;
+    size_t i;
+    int ret;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(n_checks == 0 || tweaked_pubkeys32 != NULL);
+    ARG_CHECK(n_checks == 0 || tweaked_pk_parities != NULL);
+    ARG_CHECK(n_checks == 0 || internal_pubkeys != NULL);
+    ARG_CHECK(n_checks == 0 || tweaks32 != NULL);
+    for (i = 0; i < n_checks; i++) {
+        ARG_CHECK(tweaked_pubkeys32[i] != NULL);
+        ARG_CHECK(internal_pubkeys[i] != NULL);
+        ARG_CHECK(tweaks32[i] != NULL);
+    }
+
+    if (n_checks == 0) {
+        return 1;
+    } else if (n_checks == 1) {
+        /* A batch of one is no faster than a single check. */
+        ret = secp256k1_xonly_pubkey_tweak_add_check(ctx, tweaked_pubkeys32[0], tweaked_pk_parities[0], internal_pubkeys[0], tweaks32[0]);
+        if (!ret && invalid_idx != NULL) {
+            *invalid_idx = 0;
+        }
+        return ret;
+    }
+
+    max_terms = n_checks < ECMULT_BATCH_MAX_TERMS / 2 ? 2 * n_checks : ECMULT_BATCH_MAX_TERMS;
+    scratch = secp256k1_scratch_create(&ctx->error_callback, secp256k1_ecmult_batch_scratch_size(max_terms));
+    if (scratch == NULL) {
+        return 0;
+    }
+    if (!secp256k1_ecmult_batch_init(&ctx->error_callback, &ctx->ecmult_multi_params, &batch, scratch, max_terms)) {
+        secp256k1_scratch_destroy(&ctx->error_callback, scratch);
+        return 0;
+    }
+
+    ret = secp256k1_xonly_pubkey_tweak_add_check_batch_internal(ctx, &batch, invalid_idx, tweaked_pubkeys32, tweaked_pk_parities, internal_pubkeys, tweaks32, n_checks);
+
+    secp256k1_ecmult_batch_clear(&ctx->error_callback, &batch);
+    secp256k1_scratch_destroy(&ctx->error_callback, scratch);
+    return ret;
+}
+
 static void secp256k1_keypair_save(secp256k1_keypair *keypair, const secp256k1_scalar *sk, secp256k1_ge *pk) {
     secp256k1_scalar_get_b32(&keypair->data[0], sk);
     secp256k1_pubkey_save((secp256k1_pubkey *)&keypair->data[32], pk);
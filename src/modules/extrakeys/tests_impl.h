@@ -245,6 +245,86 @@ static void test_xonly_pubkey_tweak_check(void) {
     CHECK(secp256k1_memcmp_var(&output_pk, zeros64, sizeof(output_pk)) == 0);
 }
 
+#define N_CHECKS 64
+static void test_xonly_pubkey_tweak_check_batch(void) {
+    unsigned char sk[32];
+    unsigned char overflows[32];
+    secp256k1_pubkey output_pk;
+    secp256k1_xonly_pubkey output_xonly_pk;
+    secp256k1_xonly_pubkey internal_pk[N_CHECKS];
+    const secp256k1_xonly_pubkey *internal_pk_ptr[N_CHECKS];
+    unsigned char tweaked_pk[N_CHECKS][32];
+    const unsigned char *tweaked_pk_ptr[N_CHECKS];
+    int pk_parity[N_CHECKS];
+    unsigned char tweak[N_CHECKS][32];
+    const unsigned char *tweak_ptr[N_CHECKS];
+    size_t n_checks = 2 + testrand_int(N_CHECKS - 1);
+    size_t invalid_idx;
+    size_t i;
+
+    memset(overflows, 0xff, sizeof(overflows));
+    for (i = 0; i < N_CHECKS; i++) {
+        secp256k1_pubkey pk;
+        testrand256(sk);
+        testrand256(tweak[i]);
+        CHECK(secp256k1_ec_pubkey_create(CTX, &pk, sk) == 1);
+        CHECK(secp256k1_xonly_pubkey_from_pubkey(CTX, &internal_pk[i], NULL, &pk) == 1);
+        CHECK(secp256k1_xonly_pubkey_tweak_add(CTX, &output_pk, &internal_pk[i], tweak[i]) == 1);
+        CHECK(secp256k1_xonly_pubkey_from_pubkey(CTX, &output_xonly_pk, &pk_parity[i], &output_pk) == 1);
+        CHECK(secp256k1_xonly_pubkey_serialize(CTX, tweaked_pk[i], &output_xonly_pk) == 1);
+        internal_pk_ptr[i] = &internal_pk[i];
+        tweaked_pk_ptr[i] = tweaked_pk[i];
+        tweak_ptr[i] = tweak[i];
+    }
+
+    CHECK(secp256k1_xonly_pubkey_tweak_add_check_batch(CTX, NULL, tweaked_pk_ptr, pk_parity, internal_pk_ptr, tweak_ptr, n_checks) == 1);
+    CHECK(secp256k1_xonly_pubkey_tweak_add_check_batch(CTX, NULL, NULL, NULL, NULL, NULL, 0) == 1);
+    CHECK(secp256k1_xonly_pubkey_tweak_add_check_batch(CTX, NULL, tweaked_pk_ptr, pk_parity, internal_pk_ptr, tweak_ptr, 1) == 1);
+    CHECK_ILLEGAL(CTX, secp256k1_xonly_pubkey_tweak_add_check_batch(CTX, NULL, NULL, pk_parity, internal_pk_ptr, tweak_ptr, n_checks));
+    CHECK_ILLEGAL(CTX, secp256k1_xonly_pubkey_tweak_add_check_batch(CTX, NULL, tweaked_pk_ptr, NULL, internal_pk_ptr, tweak_ptr, n_checks));
+    CHECK_ILLEGAL(CTX, secp256k1_xonly_pubkey_tweak_add_check_batch(CTX, NULL, tweaked_pk_ptr, pk_parity, NULL, tweak_ptr, n_checks));
+    CHECK_ILLEGAL(CTX, secp256k1_xonly_pubkey_tweak_add_check_batch(CTX, NULL, tweaked_pk_ptr, pk_parity, internal_pk_ptr, NULL, n_checks));
+    tweak_ptr[n_checks - 1] = NULL;
+    CHECK_ILLEGAL(CTX, secp256k1_xonly_pubkey_tweak_add_check_batch(CTX, NULL, tweaked_pk_ptr, pk_parity, internal_pk_ptr, tweak_ptr, n_checks));
+    tweak_ptr[n_checks - 1] = tweak[n_checks - 1];
+
+    /* Every kind of failing check is found */
+    for (i = 0; i < 5; i++) {
+        size_t idx = testrand_int(n_checks);
+        int parity = pk_parity[idx];
+        switch (i) {
+        case 0:
+            /* Wrong pk_parity */
+            pk_parity[idx] = !parity;
+            break;
+        case 1:
+            /* Invalid pk_parity value */
+            pk_parity[idx] = 2;
+            break;
+        case 2:
+            /* Wrong tweak */
+            tweak_ptr[idx] = tweak[(idx + 1) % n_checks];
+            break;
+        case 3:
+            /* Overflowing tweak */
+            tweak_ptr[idx] = overflows;
+            break;
+        case 4:
+            /* Tweaked pubkey not on the curve or wrong */
+            tweaked_pk_ptr[idx] = overflows;
+            break;
+        }
+        CHECK(secp256k1_xonly_pubkey_tweak_add_check(CTX, tweaked_pk_ptr[idx], pk_parity[idx], internal_pk_ptr[idx], tweak_ptr[idx]) == 0);
+        CHECK(secp256k1_xonly_pubkey_tweak_add_check_batch(CTX, &invalid_idx, tweaked_pk_ptr, pk_parity, internal_pk_ptr, tweak_ptr, n_checks) == 0);
+        CHECK(invalid_idx == idx);
+        pk_parity[idx] = parity;
+        tweak_ptr[idx] = tweak[idx];
+        tweaked_pk_ptr[idx] = tweaked_pk[idx];
+    }
+    CHECK(secp256k1_xonly_pubkey_tweak_add_check_batch(CTX, &invalid_idx, tweaked_pk_ptr, pk_parity, internal_pk_ptr, tweak_ptr, n_checks) == 1);
+}
+#undef N_CHECKS
+
 /* Starts with an initial pubkey and recursively creates N_PUBKEYS - 1
  * additional pubkeys by calling tweak_add. Then verifies every tweak starting
  * from the last pubkey. */
@@ -472,6 +552,7 @@ static void run_extrakeys_tests(void) {
     test_xonly_pubkey();
     test_xonly_pubkey_tweak();
     test_xonly_pubkey_tweak_check();
+    test_xonly_pubkey_tweak_check_batch();
     test_xonly_pubkey_tweak_recursive();
     test_xonly_pubkey_comparison();
 
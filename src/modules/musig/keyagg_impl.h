@@ -110,24 +110,30 @@ static void secp256k1_musig_keyaggcoef_sha256(secp256k1_sha256 *sha) {
     sha->bytes = 64;
 }
 
+/* Initializes SHA256 with the state after hashing the KeyAgg coefficient tag
+ * and pks_hash, which is the same for the KeyAgg coefficients of all keys. */
+static void secp256k1_musig_keyaggcoef_sha256_pks_hash(secp256k1_sha256 *sha, const unsigned char *pks_hash) {
+    secp256k1_musig_keyaggcoef_sha256(sha);
+    secp256k1_sha256_write(sha, pks_hash, 32);
+}
+
 /* Compute KeyAgg coefficient which is constant 1 for the second pubkey and
  * otherwise tagged_hash(pks_hash, pk) where pks_hash is the hash of public keys.
- * second_pk is the point at infinity in case there is no second_pk. Assumes
- * that pk is not the point at infinity and that the Y-coordinates of pk and
- * second_pk are normalized. */
-static void secp256k1_musig_keyaggcoef_internal(secp256k1_scalar *r, const unsigned char *pks_hash, secp256k1_ge *pk, const secp256k1_ge *second_pk) {
+ * sha_pks_hash must be initialized with
+ * secp256k1_musig_keyaggcoef_sha256_pks_hash. second_pk is the point at
+ * infinity in case there is no second_pk. Assumes that pk is not the point at
+ * infinity and that the Y-coordinates of pk and second_pk are normalized. */
+static void secp256k1_musig_keyaggcoef_internal(secp256k1_scalar *r, const secp256k1_sha256 *sha_pks_hash, secp256k1_ge *pk, const secp256k1_ge *second_pk) {
     VERIFY_CHECK(!secp256k1_ge_is_infinity(pk));
 
     if (!secp256k1_ge_is_infinity(second_pk)
           && secp256k1_ge_eq_var(pk, second_pk)) {
         secp256k1_scalar_set_int(r, 1);
     } else {
-        secp256k1_sha256 sha;
+        secp256k1_sha256 sha = *sha_pks_hash;
         unsigned char buf[33];
         size_t buflen = sizeof(buf);
         int ret;
-        secp256k1_musig_keyaggcoef_sha256(&sha);
-        secp256k1_sha256_write(&sha, pks_hash, 32);
         ret = secp256k1_eckey_pubkey_serialize(pk, buf, &buflen, 1);
 #ifdef VERIFY
         /* Serialization does not fail since the pk is not the point at infinity
@@ -142,41 +148,113 @@ static void secp256k1_musig_keyaggcoef_internal(secp256k1_scalar *r, const unsig
     }
 }
 
+/* Computes the KeyAgg coefficients r[i] of the n keys pks[i] like
+ * secp256k1_musig_keyaggcoef_internal, hashing up to
+ * SECP256K1_SHA256_MAX_LANES of them in parallel. */
+static void secp256k1_musig_keyaggcoef_many(secp256k1_scalar *r, const secp256k1_sha256 *sha_pks_hash, const secp256k1_ge *pks, const secp256k1_ge *second_pk, size_t n) {
+    secp256k1_sha256 sha[SECP256K1_SHA256_MAX_LANES];
+    unsigned char bufs[SECP256K1_SHA256_MAX_LANES][33];
+    unsigned char out[SECP256K1_SHA256_MAX_LANES][32];
+    const unsigned char *data[SECP256K1_SHA256_MAX_LANES];
+    size_t lens[SECP256K1_SHA256_MAX_LANES];
+    size_t lanes, i;
+
+    while (n > 0) {
+        lanes = n < SECP256K1_SHA256_MAX_LANES ? n : SECP256K1_SHA256_MAX_LANES;
+        /* Hash all keys, even the second one whose coefficient is 1, so that
+         * the hashes stay in their lanes. */
+        for (i = 0; i < lanes; i++) {
+            secp256k1_ge pk = pks[i];
+            int ret;
+            VERIFY_CHECK(!secp256k1_ge_is_infinity(&pk));
+            lens[i] = sizeof(bufs[i]);
+            ret = secp256k1_eckey_pubkey_serialize(&pk, bufs[i], &lens[i], 1);
+#ifdef VERIFY
+            VERIFY_CHECK(ret && lens[i] == sizeof(bufs[i]));
+#else
+            (void) ret;
+#endif
+            sha[i] = *sha_pks_hash;
+            data[i] = bufs[i];
+        }
+        secp256k1_sha256_write_many(sha, data, lens, lanes);
+        secp256k1_sha256_finalize_many(sha, &out[0][0], lanes);
+        for (i = 0; i < lanes; i++) {
+            if (!secp256k1_ge_is_infinity(second_pk)
+                  && secp256k1_ge_eq_var(&pks[i], second_pk)) {
+                secp256k1_scalar_set_int(&r[i], 1);
+            } else {
+                secp256k1_scalar_set_b32(&r[i], out[i], NULL);
+            }
+        }
+        r += lanes;
+        pks += lanes;
+        n -= lanes;
+    }
+}
+
 /* Assumes that pk is not the point at infinity and that the Y-coordinates of pk
  * and cache_i->second_pk are normalized. */
 static void secp256k1_musig_keyaggcoef(secp256k1_scalar *r, const secp256k1_keyagg_cache_internal *cache_i, secp256k1_ge *pk) {
-    secp256k1_musig_keyaggcoef_internal(r, cache_i->pks_hash, pk, &cache_i->second_pk);
+    secp256k1_sha256 sha;
+    secp256k1_musig_keyaggcoef_sha256_pks_hash(&sha, cache_i->pks_hash);
+    secp256k1_musig_keyaggcoef_internal(r, &sha, pk, &cache_i->second_pk);
 }
 
 typedef struct {
     const secp256k1_context *ctx;
     /* pks_hash is the hash of the public keys */
     unsigned char pks_hash[32];
+    /* Hash state shared by the KeyAgg coefficients of all keys */
+    secp256k1_sha256 sha_pks_hash;
     const secp256k1_pubkey * const* pks;
+    size_t n_pks;
     secp256k1_ge second_pk;
+    /* The keys with indices cache_start to cache_start + cache_len - 1 and
+     * their KeyAgg coefficients, which are computed together so that their
+     * hashes can be computed in parallel */
+    size_t cache_start;
+    size_t cache_len;
+    secp256k1_ge cache_pt[SECP256K1_SHA256_MAX_LANES];
+    secp256k1_scalar cache_sc[SECP256K1_SHA256_MAX_LANES];
 } secp256k1_musig_pubkey_agg_ecmult_data;
 
 /* Callback for batch EC multiplication to compute keyaggcoef_0*P0 + keyaggcoef_1*P1 + ...  */
 static int secp256k1_musig_pubkey_agg_callback(secp256k1_scalar *sc, secp256k1_ge *pt, size_t idx, void *data) {
     secp256k1_musig_pubkey_agg_ecmult_data *ctx = (secp256k1_musig_pubkey_agg_ecmult_data *) data;
-    int ret;
-    ret = secp256k1_pubkey_load(ctx->ctx, pt, ctx->pks[idx]);
+
+    if (idx < ctx->cache_start || idx >= ctx->cache_start + ctx->cache_len) {
+        /* The multiplication asks for the keys in order, so compute the
+         * coefficients of the following keys as well. */
+        size_t len = ctx->n_pks - idx < SECP256K1_SHA256_MAX_LANES ? ctx->n_pks - idx : SECP256K1_SHA256_MAX_LANES;
+        size_t i;
+        for (i = 0; i < len; i++) {
+            int ret;
+            ret = secp256k1_pubkey_load(ctx->ctx, &ctx->cache_pt[i], ctx->pks[idx + i]);
 #ifdef VERIFY
-    /* pubkey_load can't fail because the same pks have already been loaded in
-     * `musig_compute_pks_hash` (and we test this). */
-    VERIFY_CHECK(ret);
+            /* pubkey_load can't fail because the same pks have already been loaded in
+             * `musig_compute_pks_hash` (and we test this). */
+            VERIFY_CHECK(ret);
 #else
-    (void) ret;
+            (void) ret;
 #endif
-    secp256k1_musig_keyaggcoef_internal(sc, ctx->pks_hash, pt, &ctx->second_pk);
+        }
+        secp256k1_musig_keyaggcoef_many(ctx->cache_sc, &ctx->sha_pks_hash, ctx->cache_pt, &ctx->second_pk, len);
+        ctx->cache_start = idx;
+        ctx->cache_len = len;
+    }
+    *pt = ctx->cache_pt[idx - ctx->cache_start];
+    *sc = ctx->cache_sc[idx - ctx->cache_start];
     return 1;
 }
 
 int secp256k1_musig_pubkey_agg(const secp256k1_context* ctx, secp256k1_xonly_pubkey *agg_pk, secp256k1_musig_keyagg_cache *keyagg_cache, const secp256k1_pubkey * const* pubkeys, size_t n_pubkeys) {
     secp256k1_musig_pubkey_agg_ecmult_data ecmult_data;
+    secp256k1_scratch *scratch = NULL;
     secp256k1_gej pkj;
     secp256k1_ge pkp;
     size_t i;
+    int ret;
 
     VERIFY_CHECK(ctx != NULL);
     if (agg_pk != NULL) {
@@ -187,6 +265,9 @@ int secp256k1_musig_pubkey_agg(const secp256k1_context* ctx, secp256k1_xonly_pub
 
     ecmult_data.ctx = ctx;
     ecmult_data.pks = pubkeys;
+    ecmult_data.n_pks = n_pubkeys;
+    ecmult_data.cache_start = 0;
+    ecmult_data.cache_len = 0;
 
     secp256k1_ge_set_infinity(&ecmult_data.second_pk);
     for (i = 1; i < n_pubkeys; i++) {
@@ -203,9 +284,18 @@ int secp256k1_musig_pubkey_agg(const secp256k1_context* ctx, secp256k1_xonly_pub
     if (!secp256k1_musig_compute_pks_hash(ctx, ecmult_data.pks_hash, pubkeys, n_pubkeys)) {
         return 0;
     }
-    /* TODO: actually use optimized ecmult_multi algorithms by providing a
-     * scratch space */
-    if (!secp256k1_ecmult_multi_var(&ctx->error_callback, NULL, &pkj, NULL, secp256k1_musig_pubkey_agg_callback, (void *) &ecmult_data, n_pubkeys)) {
+    secp256k1_musig_keyaggcoef_sha256_pks_hash(&ecmult_data.sha_pks_hash, ecmult_data.pks_hash);
+    /* Strauss' and Pippenger's algorithm need a scratch space, but share the
+     * doublings between all keys. Like any other allocation, a failure to
+     * allocate the scratch space invokes the error callback. A single key is
+     * multiplied without a scratch space. */
+    if (n_pubkeys > 1) {
+        size_t n_scratch_points = n_pubkeys < ECMULT_MAX_SCRATCH_POINTS ? n_pubkeys : ECMULT_MAX_SCRATCH_POINTS;
+        scratch = secp256k1_scratch_create(&ctx->error_callback, secp256k1_ecmult_multi_scratch_size_internal(n_scratch_points));
+    }
+    ret = secp256k1_ecmult_multi_var_with_params(&ctx->ecmult_multi_params, &ctx->error_callback, scratch, &pkj, NULL, secp256k1_musig_pubkey_agg_callback, (void *) &ecmult_data, n_pubkeys);
+    secp256k1_scratch_destroy(&ctx->error_callback, scratch);
+    if (!ret) {
         /* In order to reach this line with the current implementation of
          * ecmult_multi_var one would need to provide a callback that can
          * fail. */
@@ -15,6 +15,7 @@
 #include "keyagg.h"
 #include "session.h"
 #include "../../eckey.h"
+#include "../../ecmult_batch.h"
 #include "../../hash.h"
 #include "../../scalar.h"
 #include "../../util.h"
@@ -448,11 +449,11 @@ static int secp256k1_musig_nonce_gen_internal(const secp256k1_context* ctx, secp
     for (i = 0; i < 2; i++) {
         secp256k1_ecmult_gen(&ctx->ecmult_gen_ctx, &nonce_ptj[i], &k[i]);
         secp256k1_scalar_clear(&k[i]);
-        secp256k1_gej_clear(&nonce_ptj);
     }
     secp256k1_ge_set_all_gej(nonce_pts, nonce_ptj, 2);
     for (i = 0; i < 2; i++) {
         secp256k1_declassify(ctx, &nonce_pts[i], sizeof(nonce_pts[i]));
+        secp256k1_gej_clear(&nonce_ptj[i]);
     }
     /* None of the nonce_pts will be infinity because k != 0 with overwhelming
      * probability */
@@ -781,7 +782,7 @@ int secp256k1_musig_partial_sig_verify(const secp256k1_context* ctx, const secp2
     /* Compute -s*G + e*pkj + rj (e already includes the keyagg coefficient mu) */
     secp256k1_scalar_negate(&s, &s);
     secp256k1_gej_set_ge(&pkj, &pkp);
-    secp256k1_ecmult(&tmp, &pkj, &e, &s);
+    secp256k1_ecmult_with_tables(&ctx->ecmult_tables, &tmp, &pkj, &e, &s);
     if (session_i.fin_nonce_parity) {
         secp256k1_gej_neg(&rj, &rj);
     }
@@ -790,6 +791,162 @@ int secp256k1_musig_partial_sig_verify(const secp256k1_context* ctx, const secp2
     return secp256k1_gej_is_infinity(&tmp);
 }
 
+/* Adds the verification equation of a partial signature, multiplied by a
+ * randomizer a, to the batch:
+ *   a*R1 + (a*b)*R2 + (a*e*mu)*P - (a*s)*G = 0
+ * where R1 and R2 are negated if the final nonce has odd Y and e is negated
+ * according to the parity of the aggregate public key (see
+ * secp256k1_musig_partial_sig_verify). Returns 0 if the arguments are
+ * invalid. */
+static int secp256k1_musig_partial_sig_verify_batch_add(const secp256k1_context* ctx, secp256k1_ecmult_batch *batch, const secp256k1_musig_partial_sig *partial_sig, const secp256k1_musig_pubnonce *pubnonce, const secp256k1_pubkey *pubkey, const secp256k1_keyagg_cache_internal *cache_i, const secp256k1_musig_session_internal *session_i) {
+    secp256k1_scalar mu, e, s, a, b;
+    secp256k1_ge nonce_pts[2];
+    secp256k1_ge pkp;
+    unsigned char buf[64];
+
+    if (!secp256k1_musig_pubnonce_load(ctx, nonce_pts, pubnonce)) {
+        return 0;
+    }
+    if (!secp256k1_pubkey_load(ctx, &pkp, pubkey)) {
+        return 0;
+    }
+    if (!secp256k1_musig_partial_sig_load(ctx, &s, partial_sig)) {
+        return 0;
+    }
+
+    secp256k1_musig_keyaggcoef(&mu, cache_i, &pkp);
+    secp256k1_scalar_mul(&e, &session_i->challenge, &mu);
+    if (secp256k1_fe_is_odd(&cache_i->pk.y)
+            != cache_i->parity_acc) {
+        secp256k1_scalar_negate(&e, &e);
+    }
+
+    /* The session data is already in the transcript and e commits to the
+     * public key, so this determines the equation. */
+    secp256k1_scalar_get_b32(buf, &s);
+    secp256k1_sha256_write(&batch->transcript, buf, 32);
+    secp256k1_sha256_write(&batch->transcript, &pubnonce->data[4], 128);
+    secp256k1_ge_to_bytes(buf, &pkp);
+    secp256k1_sha256_write(&batch->transcript, buf, 64);
+    secp256k1_scalar_get_b32(buf, &e);
+    secp256k1_sha256_write(&batch->transcript, buf, 32);
+    secp256k1_ecmult_batch_randomizer(batch, &a);
+
+    secp256k1_ecmult_batch_reserve(&ctx->error_callback, batch, 3);
+    secp256k1_scalar_mul(&e, &e, &a);
+    secp256k1_ecmult_batch_add(batch, &e, &pkp);
+    if (session_i->fin_nonce_parity) {
+        secp256k1_scalar_negate(&a, &a);
+    }
+    secp256k1_scalar_mul(&b, &session_i->noncecoef, &a);
+    secp256k1_ecmult_batch_add(batch, &a, &nonce_pts[0]);
+    secp256k1_ecmult_batch_add(batch, &b, &nonce_pts[1]);
+    if (session_i->fin_nonce_parity) {
+        secp256k1_scalar_negate(&a, &a);
+    }
+    secp256k1_scalar_mul(&s, &s, &a);
+    secp256k1_scalar_negate(&s, &s);
+    secp256k1_ecmult_batch_add_g(batch, &s);
+    return 1;
+}
+
+typedef struct {
+    const secp256k1_context *ctx;
+    const secp256k1_musig_partial_sig * const *partial_sigs;
+    const secp256k1_musig_pubnonce * const *pubnonces;
+    const secp256k1_pubkey * const *pubkeys;
+    const secp256k1_keyagg_cache_internal *cache_i;
+    const secp256k1_musig_session_internal *session_i;
+} secp256k1_musig_partial_sig_verify_batch_data;
+
+static int secp256k1_musig_partial_sig_verify_batch_range(secp256k1_ecmult_batch *batch, size_t offset, size_t len, void *data) {
+    const secp256k1_musig_partial_sig_verify_batch_data *d = (const secp256k1_musig_partial_sig_verify_batch_data *)data;
+    size_t i;
+
+    for (i = offset; i < offset + len; i++) {
+        if (!secp256k1_musig_partial_sig_verify_batch_add(d->ctx, batch, d->partial_sigs[i], d->pubnonces[i], d->pubkeys[i], d->cache_i, d->session_i)) {
+            return 0;
+        }
+    }
+    return secp256k1_ecmult_batch_verify(&d->ctx->error_callback, batch);
+}
+
+static int secp256k1_musig_partial_sig_verify_batch_internal(const secp256k1_context* ctx, secp256k1_ecmult_batch *batch, size_t *invalid_idx, const secp256k1_musig_partial_sig * const *partial_sigs, const secp256k1_musig_pubnonce * const *pubnonces, const secp256k1_pubkey * const *pubkeys, const secp256k1_keyagg_cache_internal *cache_i, const secp256k1_musig_session_internal *session_i, size_t n_sigs) {
+    secp256k1_musig_partial_sig_verify_batch_data data;
+
+    data.ctx = ctx;
+    data.partial_sigs = partial_sigs;
+    data.pubnonces = pubnonces;
+    data.pubkeys = pubkeys;
+    data.cache_i = cache_i;
+    data.session_i = session_i;
+    return secp256k1_ecmult_batch_find_invalid(batch, invalid_idx, secp256k1_musig_partial_sig_verify_batch_range, &data, n_sigs);
+}
+
+int secp256k1_musig_partial_sig_verify_batch(const secp256k1_context* ctx, size_t *invalid_idx, const secp256k1_musig_partial_sig * const *partial_sigs, const secp256k1_musig_pubnonce * const *pubnonces, const secp256k1_pubkey * const *pubkeys, const secp256k1_musig_keyagg_cache *keyagg_cache, const secp256k1_musig_session *session, size_t n_sigs) {
+    secp256k1_keyagg_cache_internal cache_i;
+    secp256k1_musig_session_internal session_i;
+    secp256k1_scratch *scratch;
+    secp256k1_ecmult_batch batch;
+    unsigned char buf[32];
+    size_t max_terms;
+    size_t i;
+    int ret;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(n_sigs == 0 || partial_sigs != NULL);
+    ARG_CHECK(n_sigs == 0 || pubnonces != NULL);
+    ARG_CHECK(n_sigs == 0 || pubkeys != NULL);
+    ARG_CHECK(keyagg_cache != NULL);
+    ARG_CHECK(session != NULL);
+    for (i = 0; i < n_sigs; i++) {
+        ARG_CHECK(partial_sigs[i] != NULL);
+        ARG_CHECK(pubnonces[i] != NULL);
+        ARG_CHECK(pubkeys[i] != NULL);
+    }
+
+    if (n_sigs == 0) {
+        return 1;
+    } else if (n_sigs == 1) {
+        /* A batch of one is no faster than a single verification. */
+        ret = secp256k1_musig_partial_sig_verify(ctx, partial_sigs[0], pubnonces[0], pubkeys[0], keyagg_cache, session);
+        if (!ret && invalid_idx != NULL) {
+            *invalid_idx = 0;
+        }
+        return ret;
+    }
+
+    if (!secp256k1_musig_session_load(ctx, &session_i, session)) {
+        return 0;
+    }
+    if (!secp256k1_keyagg_cache_load(ctx, &cache_i, keyagg_cache)) {
+        return 0;
+    }
+
+    max_terms = n_sigs < ECMULT_BATCH_MAX_TERMS / 3 ? 3 * n_sigs : ECMULT_BATCH_MAX_TERMS - ECMULT_BATCH_MAX_TERMS % 3;
+    scratch = secp256k1_scratch_create(&ctx->error_callback, secp256k1_ecmult_batch_scratch_size(max_terms));
+    if (scratch == NULL) {
+        return 0;
+    }
+    if (!secp256k1_ecmult_batch_init(&ctx->error_callback, &ctx->ecmult_multi_params, &batch, scratch, max_terms)) {
+        secp256k1_scratch_destroy(&ctx->error_callback, scratch);
+        return 0;
+    }
+
+    /* Commit to the parts of the equations that all signers share. */
+    secp256k1_sha256_write(&batch.transcript, session_i.fin_nonce, 32);
+    buf[0] = session_i.fin_nonce_parity;
+    secp256k1_sha256_write(&batch.transcript, buf, 1);
+    secp256k1_scalar_get_b32(buf, &session_i.noncecoef);
+    secp256k1_sha256_write(&batch.transcript, buf, 32);
+
+    ret = secp256k1_musig_partial_sig_verify_batch_internal(ctx, &batch, invalid_idx, partial_sigs, pubnonces, pubkeys, &cache_i, &session_i, n_sigs);
+
+    secp256k1_ecmult_batch_clear(&ctx->error_callback, &batch);
+    secp256k1_scratch_destroy(&ctx->error_callback, scratch);
+    return ret;
+}
+
 int secp256k1_musig_partial_sig_agg(const secp256k1_context* ctx, unsigned char *sig64, const secp256k1_musig_session *session, const secp256k1_musig_partial_sig * const* partial_sigs, size_t n_sigs) {
     size_t i;
     secp256k1_musig_session_internal session_i;
@@ -471,6 +471,29 @@ static void musig_api_tests(void) {
     CHECK(secp256k1_musig_partial_sig_verify(CTX, &partial_sig[0], &pubnonce[0], &pk[0], &keyagg_cache, &session) == 1);
     CHECK(secp256k1_musig_partial_sig_verify(CTX, &partial_sig[1], &pubnonce[1], &pk[1], &keyagg_cache, &session) == 1);
 
+    /** Batch partial signature verification */
+    {
+        size_t invalid_idx = 7;
+        CHECK(secp256k1_musig_partial_sig_verify_batch(CTX, &invalid_idx, partial_sig_ptr, pubnonce_ptr, pk_ptr, &keyagg_cache, &session, 2) == 1);
+        CHECK(invalid_idx == 7);
+        CHECK(secp256k1_musig_partial_sig_verify_batch(CTX, NULL, partial_sig_ptr, pubnonce_ptr, pk_ptr, &keyagg_cache, &session, 1) == 1);
+        CHECK(secp256k1_musig_partial_sig_verify_batch(CTX, NULL, NULL, NULL, NULL, &keyagg_cache, &session, 0) == 1);
+        CHECK(secp256k1_musig_partial_sig_verify_batch(CTX, &invalid_idx, partial_sig_ptr, &pubnonce_ptr[1], &pk_ptr[1], &keyagg_cache, &session, 1) == 0);
+        CHECK(invalid_idx == 0);
+        invalid_idx = 7;
+        CHECK(secp256k1_musig_partial_sig_verify_batch(CTX, &invalid_idx, partial_sig_ptr, inf_pubnonce_ptr, pk_ptr, &keyagg_cache, &session, 2) == 0);
+        CHECK(invalid_idx == 0);
+        CHECK_ILLEGAL(CTX, secp256k1_musig_partial_sig_verify_batch(CTX, NULL, NULL, pubnonce_ptr, pk_ptr, &keyagg_cache, &session, 2));
+        CHECK_ILLEGAL(CTX, secp256k1_musig_partial_sig_verify_batch(CTX, NULL, invalid_partial_sig_ptr, pubnonce_ptr, pk_ptr, &keyagg_cache, &session, 2));
+        CHECK_ILLEGAL(CTX, secp256k1_musig_partial_sig_verify_batch(CTX, NULL, partial_sig_ptr, NULL, pk_ptr, &keyagg_cache, &session, 2));
+        CHECK_ILLEGAL(CTX, secp256k1_musig_partial_sig_verify_batch(CTX, NULL, partial_sig_ptr, pubnonce_ptr, NULL, &keyagg_cache, &session, 2));
+        CHECK_ILLEGAL(CTX, secp256k1_musig_partial_sig_verify_batch(CTX, NULL, partial_sig_ptr, pubnonce_ptr, invalid_pk_ptr2, &keyagg_cache, &session, 2));
+        CHECK_ILLEGAL(CTX, secp256k1_musig_partial_sig_verify_batch(CTX, NULL, partial_sig_ptr, pubnonce_ptr, pk_ptr, NULL, &session, 2));
+        CHECK_ILLEGAL(CTX, secp256k1_musig_partial_sig_verify_batch(CTX, NULL, partial_sig_ptr, pubnonce_ptr, pk_ptr, &invalid_keyagg_cache, &session, 2));
+        CHECK_ILLEGAL(CTX, secp256k1_musig_partial_sig_verify_batch(CTX, NULL, partial_sig_ptr, pubnonce_ptr, pk_ptr, &keyagg_cache, NULL, 2));
+        CHECK_ILLEGAL(CTX, secp256k1_musig_partial_sig_verify_batch(CTX, NULL, partial_sig_ptr, pubnonce_ptr, pk_ptr, &keyagg_cache, &invalid_session, 2));
+    }
+
     /** Signature aggregation and verification */
     CHECK(secp256k1_musig_partial_sig_agg(CTX, pre_sig, &session, partial_sig_ptr, 2) == 1);
     CHECK_ILLEGAL(CTX, secp256k1_musig_partial_sig_agg(CTX, NULL, &session, partial_sig_ptr, 2));
@@ -554,6 +577,100 @@ static void sha256_tag_test_internal(secp256k1_sha256 *sha_tagged, unsigned char
     test_sha256_eq(&sha, sha_tagged);
 }
 
+#define N_SIGNERS 24
+/* Checks that batch verification of partial signatures accepts the partial
+ * signatures of a session and finds the first one that doesn't verify. */
+static void musig_partial_sig_verify_batch_test(void) {
+    unsigned char sk[32];
+    secp256k1_keypair keypair[N_SIGNERS];
+    secp256k1_pubkey pk[N_SIGNERS];
+    const secp256k1_pubkey *pk_ptr[N_SIGNERS];
+    secp256k1_musig_secnonce secnonce[N_SIGNERS];
+    secp256k1_musig_pubnonce pubnonce[N_SIGNERS];
+    const secp256k1_musig_pubnonce *pubnonce_ptr[N_SIGNERS];
+    secp256k1_musig_partial_sig partial_sig[N_SIGNERS];
+    const secp256k1_musig_partial_sig *partial_sig_ptr[N_SIGNERS];
+    secp256k1_musig_aggnonce aggnonce;
+    secp256k1_musig_keyagg_cache keyagg_cache;
+    secp256k1_musig_session session;
+    unsigned char msg[32];
+    size_t n_signers = 2 + testrand_int(N_SIGNERS - 1);
+    size_t invalid_idx;
+    size_t i, j;
+
+    testrand256(msg);
+    for (i = 0; i < n_signers; i++) {
+        testrand256(sk);
+        CHECK(create_keypair_and_pk(&keypair[i], &pk[i], sk));
+        CHECK(secp256k1_musig_nonce_gen_counter(CTX, &secnonce[i], &pubnonce[i], i, &keypair[i], NULL, NULL, NULL) == 1);
+        pk_ptr[i] = &pk[i];
+        pubnonce_ptr[i] = &pubnonce[i];
+        partial_sig_ptr[i] = &partial_sig[i];
+    }
+    CHECK(secp256k1_musig_pubkey_agg(CTX, NULL, &keyagg_cache, pk_ptr, n_signers) == 1);
+    CHECK(secp256k1_musig_nonce_agg(CTX, &aggnonce, pubnonce_ptr, n_signers) == 1);
+    CHECK(secp256k1_musig_nonce_process(CTX, &session, &aggnonce, msg, &keyagg_cache) == 1);
+    for (i = 0; i < n_signers; i++) {
+        CHECK(secp256k1_musig_partial_sign(CTX, &partial_sig[i], &secnonce[i], &keypair[i], &keyagg_cache, &session) == 1);
+    }
+    CHECK(secp256k1_musig_partial_sig_verify_batch(CTX, &invalid_idx, partial_sig_ptr, pubnonce_ptr, pk_ptr, &keyagg_cache, &session, n_signers) == 1);
+
+    /* Swapping two partial signatures makes both of them invalid */
+    i = testrand_int(n_signers);
+    j = (i + 1 + testrand_int(n_signers - 1)) % n_signers;
+    partial_sig_ptr[i] = &partial_sig[j];
+    partial_sig_ptr[j] = &partial_sig[i];
+    CHECK(secp256k1_musig_partial_sig_verify_batch(CTX, &invalid_idx, partial_sig_ptr, pubnonce_ptr, pk_ptr, &keyagg_cache, &session, n_signers) == 0);
+    CHECK(invalid_idx == (i < j ? i : j));
+    CHECK(secp256k1_musig_partial_sig_verify_batch(CTX, NULL, partial_sig_ptr, pubnonce_ptr, pk_ptr, &keyagg_cache, &session, n_signers) == 0);
+    partial_sig_ptr[i] = &partial_sig[i];
+    partial_sig_ptr[j] = &partial_sig[j];
+
+    /* A signer that sends another signer's nonce is detected */
+    pubnonce_ptr[j] = &pubnonce[i];
+    CHECK(secp256k1_musig_partial_sig_verify_batch(CTX, &invalid_idx, partial_sig_ptr, pubnonce_ptr, pk_ptr, &keyagg_cache, &session, n_signers) == 0);
+    CHECK(invalid_idx == j);
+    CHECK(secp256k1_musig_partial_sig_verify(CTX, partial_sig_ptr[j], pubnonce_ptr[j], pk_ptr[j], &keyagg_cache, &session) == 0);
+}
+#undef N_SIGNERS
+
+#define N_KEYS (2*ECMULT_PIPPENGER_THRESHOLD)
+/* Checks that aggregating many keys, which uses Pippenger's algorithm, gives
+ * the same result as multiplying the keys by their coefficients one by one. */
+static void musig_pubkey_agg_many_test(void) {
+    secp256k1_pubkey pk[N_KEYS];
+    const secp256k1_pubkey *pk_ptr[N_KEYS];
+    secp256k1_musig_keyagg_cache keyagg_cache;
+    secp256k1_keyagg_cache_internal cache_i;
+    secp256k1_gej expected;
+    size_t n_keys = ECMULT_PIPPENGER_THRESHOLD + testrand_int(N_KEYS - ECMULT_PIPPENGER_THRESHOLD + 1);
+    size_t i;
+
+    for (i = 0; i < n_keys; i++) {
+        testutil_random_pubkey_test(&pk[i]);
+        /* Include some duplicate keys */
+        pk_ptr[i] = (i > 0 && testrand_bits(2) == 0) ? pk_ptr[testrand_int(i)] : &pk[i];
+    }
+    CHECK(secp256k1_musig_pubkey_agg(CTX, NULL, &keyagg_cache, pk_ptr, n_keys) == 1);
+    CHECK(secp256k1_keyagg_cache_load(CTX, &cache_i, &keyagg_cache) == 1);
+
+    /* The coefficients are hashed one by one here, while pubkey_agg hashes
+     * them in parallel. */
+    secp256k1_gej_set_infinity(&expected);
+    for (i = 0; i < n_keys; i++) {
+        secp256k1_ge pkp;
+        secp256k1_gej pkj;
+        secp256k1_scalar coef;
+        CHECK(secp256k1_pubkey_load(CTX, &pkp, pk_ptr[i]) == 1);
+        secp256k1_musig_keyaggcoef(&coef, &cache_i, &pkp);
+        secp256k1_gej_set_ge(&pkj, &pkp);
+        secp256k1_ecmult(&pkj, &pkj, &coef, NULL);
+        secp256k1_gej_add_var(&expected, &expected, &pkj, NULL);
+    }
+    CHECK(secp256k1_gej_eq_ge_var(&expected, &cache_i.pk));
+}
+#undef N_KEYS
+
 /* Checks that the initialized tagged hashes have the expected
  * state. */
 static void sha256_tag_test(void) {
@@ -1123,6 +1240,8 @@ static void run_musig_tests(void) {
         musig_simple_test();
     }
     musig_api_tests();
+    musig_pubkey_agg_many_test();
+    musig_partial_sig_verify_batch_test();
     musig_nonce_test();
     for (i = 0; i < COUNT; i++) {
         /* Run multiple times to ensure that pk and nonce have different y
@@ -9,10 +9,18 @@
 
 #include "../../../include/secp256k1_recovery.h"
 
+#define RECOVER_BATCH_SIZE 64
+
 typedef struct {
     secp256k1_context *ctx;
     unsigned char msg[32];
     unsigned char sig[64];
+    unsigned char msgs[RECOVER_BATCH_SIZE][32];
+    const unsigned char *msg_ptrs[RECOVER_BATCH_SIZE];
+    secp256k1_ecdsa_recoverable_signature sigs[RECOVER_BATCH_SIZE];
+    const secp256k1_ecdsa_recoverable_signature *sig_ptrs[RECOVER_BATCH_SIZE];
+    secp256k1_pubkey pubkeys[RECOVER_BATCH_SIZE];
+    const secp256k1_pubkey *pubkey_ptrs[RECOVER_BATCH_SIZE];
 } bench_recover_data;
 
 static void bench_recover(void* arg, int iters) {
@@ -48,6 +56,44 @@ static void bench_recover_setup(void* arg) {
     }
 }
 
+static void bench_recover_batch(void* arg, int iters) {
+    int i;
+    bench_recover_data *data = (bench_recover_data*)arg;
+
+    for (i = 0; i < iters; i += RECOVER_BATCH_SIZE) {
+        size_t n = iters - i < RECOVER_BATCH_SIZE ? iters - i : RECOVER_BATCH_SIZE;
+        CHECK(secp256k1_ecdsa_recover_batch(data->ctx, data->pubkeys, NULL, data->sig_ptrs, data->msg_ptrs, n));
+    }
+}
+
+static void bench_recoverable_verify_batch(void* arg, int iters) {
+    int i;
+    bench_recover_data *data = (bench_recover_data*)arg;
+
+    for (i = 0; i < iters; i += RECOVER_BATCH_SIZE) {
+        size_t n = iters - i < RECOVER_BATCH_SIZE ? iters - i : RECOVER_BATCH_SIZE;
+        CHECK(secp256k1_ecdsa_recoverable_verify_batch(data->ctx, NULL, data->sig_ptrs, data->msg_ptrs, data->pubkey_ptrs, n));
+    }
+}
+
+static void bench_recover_batch_setup(void* arg) {
+    int i, j;
+    bench_recover_data *data = (bench_recover_data*)arg;
+
+    for (i = 0; i < RECOVER_BATCH_SIZE; i++) {
+        unsigned char sk[32];
+        for (j = 0; j < 32; j++) {
+            data->msgs[i][j] = 1 + i + j;
+            sk[j] = 65 + i + j;
+        }
+        CHECK(secp256k1_ecdsa_sign_recoverable(data->ctx, &data->sigs[i], data->msgs[i], sk, NULL, NULL));
+        CHECK(secp256k1_ec_pubkey_create(data->ctx, &data->pubkeys[i], sk));
+        data->msg_ptrs[i] = data->msgs[i];
+        data->sig_ptrs[i] = &data->sigs[i];
+        data->pubkey_ptrs[i] = &data->pubkeys[i];
+    }
+}
+
 static void run_recovery_bench(int iters, int argc, char** argv) {
     bench_recover_data data;
     int d = argc == 1;
@@ -55,6 +101,8 @@ static void run_recovery_bench(int iters, int argc, char** argv) {
     data.ctx = secp256k1_context_create(SECP256K1_CONTEXT_NONE);
 
     if (d || have_flag(argc, argv, "ecdsa") || have_flag(argc, argv, "recover") || have_flag(argc, argv, "ecdsa_recover")) run_benchmark("ecdsa_recover", bench_recover, bench_recover_setup, NULL, &data, 10, iters);
+    if (d || have_flag(argc, argv, "ecdsa") || have_flag(argc, argv, "recover") || have_flag(argc, argv, "ecdsa_recover_batch")) run_benchmark("ecdsa_recover_batch", bench_recover_batch, bench_recover_batch_setup, NULL, &data, 10, iters);
+    if (d || have_flag(argc, argv, "ecdsa") || have_flag(argc, argv, "verify") || have_flag(argc, argv, "ecdsa_recoverable_verify_batch")) run_benchmark("ecdsa_recoverable_verify_batch", bench_recoverable_verify_batch, bench_recover_batch_setup, NULL, &data, 10, iters);
 
     secp256k1_context_destroy(data.ctx);
 }
@@ -8,6 +8,7 @@
 #define SECP256K1_MODULE_RECOVERY_MAIN_H
 
 #include "../../../include/secp256k1_recovery.h"
+#include "../../ecmult_batch.h"
 
 static void secp256k1_ecdsa_recoverable_signature_load(const secp256k1_context* ctx, secp256k1_scalar* r, secp256k1_scalar* s, int* recid, const secp256k1_ecdsa_recoverable_signature* sig) {
     (void)ctx;
@@ -84,13 +85,12 @@ int secp256k1_ecdsa_recoverable_signature_convert(const secp256k1_context* ctx,
     return 1;
 }
 
-static int secp256k1_ecdsa_sig_recover(const secp256k1_scalar *sigr, const secp256k1_scalar* sigs, secp256k1_ge *pubkey, const secp256k1_scalar *message, int recid) {
+/* Computes the point R with x-coordinate r (plus the group order if recid & 2)
+ * and the parity given by recid & 1. Returns 0 if the signature is invalid for
+ * reasons that can be detected without a multiplication. */
+static int secp256k1_ecdsa_sig_recover_nonce(const secp256k1_scalar *sigr, const secp256k1_scalar* sigs, secp256k1_ge *x, int recid) {
     unsigned char brx[32];
     secp256k1_fe fx;
-    secp256k1_ge x;
-    secp256k1_gej xj;
-    secp256k1_scalar rn, u1, u2;
-    secp256k1_gej qj;
     int r;
 
     if (secp256k1_scalar_is_zero(sigr) || secp256k1_scalar_is_zero(sigs)) {
@@ -107,7 +107,16 @@ static int secp256k1_ecdsa_sig_recover(const secp256k1_scalar *sigr, const secp2
         }
         secp256k1_fe_add(&fx, &secp256k1_ecdsa_const_order_as_fe);
     }
-    if (!secp256k1_ge_set_xo_var(&x, &fx, recid & 1)) {
+    return secp256k1_ge_set_xo_var(x, &fx, recid & 1);
+}
+
+static int secp256k1_ecdsa_sig_recover(const secp256k1_ecmult_tables *tables, const secp256k1_scalar *sigr, const secp256k1_scalar* sigs, secp256k1_ge *pubkey, const secp256k1_scalar *message, int recid) {
+    secp256k1_ge x;
+    secp256k1_gej xj;
+    secp256k1_scalar rn, u1, u2;
+    secp256k1_gej qj;
+
+    if (!secp256k1_ecdsa_sig_recover_nonce(sigr, sigs, &x, recid)) {
         return 0;
     }
     secp256k1_gej_set_ge(&xj, &x);
@@ -115,7 +124,7 @@ static int secp256k1_ecdsa_sig_recover(const secp256k1_scalar *sigr, const secp2
     secp256k1_scalar_mul(&u1, &rn, message);
     secp256k1_scalar_negate(&u1, &u1);
     secp256k1_scalar_mul(&u2, &rn, sigs);
-    secp256k1_ecmult(&qj, &xj, &u2, &u1);
+    secp256k1_ecmult_with_tables(tables, &qj, &xj, &u2, &u1);
     secp256k1_ge_set_gej_var(pubkey, &qj);
     return !secp256k1_gej_is_infinity(&qj);
 }
@@ -147,7 +156,7 @@ int secp256k1_ecdsa_recover(const secp256k1_context* ctx, secp256k1_pubkey *pubk
     secp256k1_ecdsa_recoverable_signature_load(ctx, &r, &s, &recid, signature);
     VERIFY_CHECK(recid >= 0 && recid < 4);  /* should have been caught in parse_compact */
     secp256k1_scalar_set_b32(&m, msghash32, NULL);
-    if (secp256k1_ecdsa_sig_recover(&r, &s, &q, &m, recid)) {
+    if (secp256k1_ecdsa_sig_recover(&ctx->ecmult_tables, &r, &s, &q, &m, recid)) {
         secp256k1_pubkey_save(pubkey, &q);
         return 1;
     } else {
@@ -156,4 +165,204 @@ int secp256k1_ecdsa_recover(const secp256k1_context* ctx, secp256k1_pubkey *pubk
     }
 }
 
+/* Number of signatures that share their scalar and field inversions in
+ * secp256k1_ecdsa_recover_batch. */
+#define ECDSA_RECOVER_BATCH_SIZE 16
+
+/* Recovers up to ECDSA_RECOVER_BATCH_SIZE public keys like
+ * secp256k1_ecdsa_recover, but computes the inverses of all r values with a
+ * single scalar inversion and converts all results to affine coordinates with
+ * a single field inversion. Returns 1 if all public keys were recovered. */
+static int secp256k1_ecdsa_recover_batch_chunk(const secp256k1_context* ctx, secp256k1_pubkey *pubkeys, int *results, const secp256k1_ecdsa_recoverable_signature * const *signatures, const unsigned char * const *msghash32s, size_t n_sigs) {
+    secp256k1_scalar r[ECDSA_RECOVER_BATCH_SIZE];
+    secp256k1_scalar s[ECDSA_RECOVER_BATCH_SIZE];
+    secp256k1_scalar rn[ECDSA_RECOVER_BATCH_SIZE];
+    secp256k1_ge x[ECDSA_RECOVER_BATCH_SIZE];
+    secp256k1_gej qj[ECDSA_RECOVER_BATCH_SIZE];
+    size_t idx[ECDSA_RECOVER_BATCH_SIZE];
+    size_t n_valid = 0;
+    size_t i;
+    int ret = 1;
+
+    VERIFY_CHECK(n_sigs <= ECDSA_RECOVER_BATCH_SIZE);
+    for (i = 0; i < n_sigs; i++) {
+        int recid;
+        secp256k1_ecdsa_recoverable_signature_load(ctx, &r[n_valid], &s[n_valid], &recid, signatures[i]);
+        VERIFY_CHECK(recid >= 0 && recid < 4);  /* should have been caught in parse_compact */
+        memset(&pubkeys[i], 0, sizeof(pubkeys[i]));
+        if (results != NULL) {
+            results[i] = 0;
+        }
+        if (secp256k1_ecdsa_sig_recover_nonce(&r[n_valid], &s[n_valid], &x[n_valid], recid)) {
+            idx[n_valid] = i;
+            n_valid++;
+        } else {
+            ret = 0;
+        }
+    }
+
+    if (n_valid == 0) {
+        return 0;
+    }
+    secp256k1_scalar_inverse_all_var(rn, r, n_valid);
+    for (i = 0; i < n_valid; i++) {
+        secp256k1_gej xj;
+        secp256k1_scalar m, u1, u2;
+        secp256k1_scalar_set_b32(&m, msghash32s[idx[i]], NULL);
+        secp256k1_gej_set_ge(&xj, &x[i]);
+        secp256k1_scalar_mul(&u1, &rn[i], &m);
+        secp256k1_scalar_negate(&u1, &u1);
+        secp256k1_scalar_mul(&u2, &rn[i], &s[i]);
+        secp256k1_ecmult_with_tables(&ctx->ecmult_tables, &qj[i], &xj, &u2, &u1);
+    }
+    secp256k1_ge_set_all_gej_var(x, qj, n_valid);
+
+    for (i = 0; i < n_valid; i++) {
+        if (secp256k1_ge_is_infinity(&x[i])) {
+            ret = 0;
+            continue;
+        }
+        secp256k1_pubkey_save(&pubkeys[idx[i]], &x[i]);
+        if (results != NULL) {
+            results[idx[i]] = 1;
+        }
+    }
+    return ret;
+}
+
+int secp256k1_ecdsa_recover_batch(const secp256k1_context* ctx, secp256k1_pubkey *pubkeys, int *results, const secp256k1_ecdsa_recoverable_signature * const *signatures, const unsigned char * const *msghash32s, size_t n_sigs) {
+    size_t offset;
+    size_t i;
+    int ret = 1;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(n_sigs == 0 || pubkeys != NULL);
+    ARG_CHECK(n_sigs == 0 || signatures != NULL);
+    ARG_CHECK(n_sigs == 0 || msghash32s != NULL);
+    for (i = 0; i < n_sigs; i++) {
+        ARG_CHECK(signatures[i] != NULL);
+        ARG_CHECK(msghash32s[i] != NULL);
+    }
+
+    for (offset = 0; offset < n_sigs; offset += ECDSA_RECOVER_BATCH_SIZE) {
+        size_t len = n_sigs - offset < ECDSA_RECOVER_BATCH_SIZE ? n_sigs - offset : ECDSA_RECOVER_BATCH_SIZE;
+        ret &= secp256k1_ecdsa_recover_batch_chunk(ctx, &pubkeys[offset], results == NULL ? NULL : &results[offset], &signatures[offset], &msghash32s[offset], len);
+    }
+    return ret;
+}
+
+/* Adds the verification equation of a signature, multiplied by a randomizer a,
+ * to the batch:
+ *   (a*s)*R - (a*r)*P - (a*m)*G = 0
+ * where R is the point determined by r and the recovery id. This equation
+ * holds iff the signature is valid and the recovery id is correct. Returns 0
+ * if the signature is invalid for reasons that can be detected without a
+ * multiplication. */
+static int secp256k1_ecdsa_recoverable_verify_batch_add(const secp256k1_context* ctx, secp256k1_ecmult_batch *batch, const secp256k1_ecdsa_recoverable_signature *signature, const unsigned char *msghash32, const secp256k1_pubkey *pubkey) {
+    secp256k1_scalar r, s, m, a;
+    secp256k1_ge x;
+    secp256k1_ge q;
+    unsigned char buf[65];
+    int recid;
+
+    secp256k1_ecdsa_recoverable_signature_load(ctx, &r, &s, &recid, signature);
+    VERIFY_CHECK(recid >= 0 && recid < 4);  /* should have been caught in parse_compact */
+    if (secp256k1_scalar_is_high(&s)) {
+        return 0;
+    }
+    if (!secp256k1_pubkey_load(ctx, &q, pubkey)) {
+        return 0;
+    }
+    if (!secp256k1_ecdsa_sig_recover_nonce(&r, &s, &x, recid)) {
+        return 0;
+    }
+    secp256k1_scalar_set_b32(&m, msghash32, NULL);
+
+    secp256k1_scalar_get_b32(&buf[0], &r);
+    secp256k1_scalar_get_b32(&buf[32], &s);
+    buf[64] = recid;
+    secp256k1_sha256_write(&batch->transcript, buf, 65);
+    secp256k1_ge_to_bytes(buf, &q);
+    secp256k1_sha256_write(&batch->transcript, buf, 64);
+    secp256k1_scalar_get_b32(buf, &m);
+    secp256k1_sha256_write(&batch->transcript, buf, 32);
+    secp256k1_ecmult_batch_randomizer(batch, &a);
+
+    secp256k1_ecmult_batch_reserve(&ctx->error_callback, batch, 2);
+    secp256k1_scalar_mul(&s, &s, &a);
+    secp256k1_ecmult_batch_add(batch, &s, &x);
+    secp256k1_scalar_negate(&a, &a);
+    secp256k1_scalar_mul(&r, &r, &a);
+    secp256k1_ecmult_batch_add(batch, &r, &q);
+    secp256k1_scalar_mul(&m, &m, &a);
+    secp256k1_ecmult_batch_add_g(batch, &m);
+    return 1;
+}
+
+typedef struct {
+    const secp256k1_context *ctx;
+    const secp256k1_ecdsa_recoverable_signature * const *signatures;
+    const unsigned char * const *msghash32s;
+    const secp256k1_pubkey * const *pubkeys;
+} secp256k1_ecdsa_recoverable_verify_batch_data;
+
+static int secp256k1_ecdsa_recoverable_verify_batch_range(secp256k1_ecmult_batch *batch, size_t offset, size_t len, void *data) {
+    const secp256k1_ecdsa_recoverable_verify_batch_data *d = (const secp256k1_ecdsa_recoverable_verify_batch_data *)data;
+    size_t i;
+
+    for (i = offset; i < offset + len; i++) {
+        if (!secp256k1_ecdsa_recoverable_verify_batch_add(d->ctx, batch, d->signatures[i], d->msghash32s[i], d->pubkeys[i])) {
+            return 0;
+        }
+    }
+    return secp256k1_ecmult_batch_verify(&d->ctx->error_callback, batch);
+}
+
+static int secp256k1_ecdsa_recoverable_verify_batch_internal(const secp256k1_context* ctx, secp256k1_ecmult_batch *batch, size_t *invalid_idx, const secp256k1_ecdsa_recoverable_signature * const *signatures, const unsigned char * const *msghash32s, const secp256k1_pubkey * const *pubkeys, size_t n_sigs) {
+    secp256k1_ecdsa_recoverable_verify_batch_data data;
+
+    data.ctx = ctx;
+    data.signatures = signatures;
+    data.msghash32s = msghash32s;
+    data.pubkeys = pubkeys;
+    return secp256k1_ecmult_batch_find_invalid(batch, invalid_idx, secp256k1_ecdsa_recoverable_verify_batch_range, &data, n_sigs);
+}
+
+int secp256k1_ecdsa_recoverable_verify_batch(const secp256k1_context* ctx, size_t *invalid_idx, const secp256k1_ecdsa_recoverable_signature * const *signatures, const unsigned char * const *msghash32s, const secp256k1_pubkey * const *pubkeys, size_t n_sigs) {
+    secp256k1_scratch *scratch;
+    secp256k1_ecmult_batch batch;
+    size_t max_terms;
+    size_t i;
+    int ret;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(n_sigs == 0 || signatures != NULL);
+    ARG_CHECK(n_sigs == 0 || msghash32s != NULL);
+    ARG_CHECK(n_sigs == 0 || pubkeys != NULL);
+    for (i = 0; i < n_sigs; i++) {
+        ARG_CHECK(signatures[i] != NULL);
+        ARG_CHECK(msghash32s[i] != NULL);
+        ARG_CHECK(pubkeys[i] != NULL);
+    }
+
+    if (n_sigs == 0) {
+        return 1;
+    }
+
+    max_terms = n_sigs < ECMULT_BATCH_MAX_TERMS / 2 ? 2 * n_sigs : ECMULT_BATCH_MAX_TERMS;
+    scratch = secp256k1_scratch_create(&ctx->error_callback, secp256k1_ecmult_batch_scratch_size(max_terms));
+    if (scratch == NULL) {
+        return 0;
+    }
+    if (!secp256k1_ecmult_batch_init(&ctx->error_callback, &ctx->ecmult_multi_params, &batch, scratch, max_terms)) {
+        secp256k1_scratch_destroy(&ctx->error_callback, scratch);
+        return 0;
+    }
+
+    ret = secp256k1_ecdsa_recoverable_verify_batch_internal(ctx, &batch, invalid_idx, signatures, msghash32s, pubkeys, n_sigs);
+
+    secp256k1_ecmult_batch_clear(&ctx->error_callback, &batch);
+    secp256k1_scratch_destroy(&ctx->error_callback, scratch);
+    return ret;
+}
+
 #endif /* SECP256K1_MODULE_RECOVERY_MAIN_H */
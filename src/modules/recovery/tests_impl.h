@@ -70,6 +70,49 @@ static void test_ecdsa_recovery_api(void) {
     CHECK_ILLEGAL(CTX, secp256k1_ecdsa_recover(CTX, &recpubkey, NULL, message));
     CHECK_ILLEGAL(CTX, secp256k1_ecdsa_recover(CTX, &recpubkey, &recsig, NULL));
 
+    /* Check NULLs for batch recovery */
+    {
+        const secp256k1_ecdsa_recoverable_signature *recsig_ptr[2];
+        const unsigned char *message_ptr[2];
+        secp256k1_pubkey recpubkeys[2];
+        int results[2];
+        recsig_ptr[0] = recsig_ptr[1] = &recsig;
+        message_ptr[0] = message_ptr[1] = message;
+        CHECK(secp256k1_ecdsa_recover_batch(CTX, recpubkeys, results, recsig_ptr, message_ptr, 2) == 1);
+        CHECK(results[0] == 1 && results[1] == 1);
+        CHECK(secp256k1_memcmp_var(&recpubkeys[0], &recpubkey, sizeof(recpubkey)) == 0);
+        CHECK(secp256k1_memcmp_var(&recpubkeys[1], &recpubkey, sizeof(recpubkey)) == 0);
+        CHECK(secp256k1_ecdsa_recover_batch(CTX, recpubkeys, NULL, recsig_ptr, message_ptr, 2) == 1);
+        CHECK(secp256k1_ecdsa_recover_batch(CTX, NULL, NULL, NULL, NULL, 0) == 1);
+        CHECK_ILLEGAL(CTX, secp256k1_ecdsa_recover_batch(CTX, NULL, results, recsig_ptr, message_ptr, 2));
+        CHECK_ILLEGAL(CTX, secp256k1_ecdsa_recover_batch(CTX, recpubkeys, results, NULL, message_ptr, 2));
+        CHECK_ILLEGAL(CTX, secp256k1_ecdsa_recover_batch(CTX, recpubkeys, results, recsig_ptr, NULL, 2));
+        recsig_ptr[1] = NULL;
+        CHECK_ILLEGAL(CTX, secp256k1_ecdsa_recover_batch(CTX, recpubkeys, results, recsig_ptr, message_ptr, 2));
+        recsig_ptr[1] = &recsig;
+        message_ptr[1] = NULL;
+        CHECK_ILLEGAL(CTX, secp256k1_ecdsa_recover_batch(CTX, recpubkeys, results, recsig_ptr, message_ptr, 2));
+    }
+
+    /* Check NULLs for batch verification */
+    {
+        const secp256k1_ecdsa_recoverable_signature *recsig_ptr[2];
+        const unsigned char *message_ptr[2];
+        const secp256k1_pubkey *pubkey_ptr[2];
+        size_t invalid_idx = 2;
+        recsig_ptr[0] = recsig_ptr[1] = &recsig;
+        message_ptr[0] = message_ptr[1] = message;
+        pubkey_ptr[0] = pubkey_ptr[1] = &pubkey;
+        CHECK(secp256k1_ecdsa_recoverable_verify_batch(CTX, &invalid_idx, recsig_ptr, message_ptr, pubkey_ptr, 2) == 1);
+        CHECK(invalid_idx == 2);
+        CHECK(secp256k1_ecdsa_recoverable_verify_batch(CTX, NULL, NULL, NULL, NULL, 0) == 1);
+        CHECK_ILLEGAL(CTX, secp256k1_ecdsa_recoverable_verify_batch(CTX, NULL, NULL, message_ptr, pubkey_ptr, 2));
+        CHECK_ILLEGAL(CTX, secp256k1_ecdsa_recoverable_verify_batch(CTX, NULL, recsig_ptr, NULL, pubkey_ptr, 2));
+        CHECK_ILLEGAL(CTX, secp256k1_ecdsa_recoverable_verify_batch(CTX, NULL, recsig_ptr, message_ptr, NULL, 2));
+        pubkey_ptr[1] = NULL;
+        CHECK_ILLEGAL(CTX, secp256k1_ecdsa_recoverable_verify_batch(CTX, NULL, recsig_ptr, message_ptr, pubkey_ptr, 2));
+    }
+
     /* Check NULLs for conversion */
     CHECK(secp256k1_ecdsa_sign(CTX, &normal_sig, message, privkey, NULL, NULL) == 1);
     CHECK_ILLEGAL(CTX, secp256k1_ecdsa_recoverable_signature_convert(CTX, NULL, &recsig));
@@ -150,6 +193,147 @@ static void test_ecdsa_recovery_end_to_end(void) {
           secp256k1_memcmp_var(&pubkey, &recpubkey, sizeof(pubkey)) != 0);
 }
 
+#define N_SIGS 40
+/* Checks that batch recovery gives the same results as recovering the
+ * public keys one by one. */
+static void test_ecdsa_recovery_batch(void) {
+    unsigned char privkey[32];
+    unsigned char msg[N_SIGS][32];
+    const unsigned char *msg_ptr[N_SIGS];
+    unsigned char sig64[64];
+    secp256k1_ecdsa_recoverable_signature rsig[N_SIGS];
+    const secp256k1_ecdsa_recoverable_signature *rsig_ptr[N_SIGS];
+    secp256k1_pubkey pubkey[N_SIGS];
+    secp256k1_pubkey recpubkey;
+    int results[N_SIGS];
+    size_t n_sigs = testrand_int(N_SIGS + 1);
+    int all_valid = 1;
+    int batch_ret;
+    size_t i;
+
+    for (i = 0; i < N_SIGS; i++) {
+        msg_ptr[i] = msg[i];
+        rsig_ptr[i] = &rsig[i];
+    }
+    for (i = 0; i < n_sigs; i++) {
+        int recid;
+        testrand256_test(privkey);
+        testrand256_test(msg[i]);
+        if (secp256k1_ecdsa_sign_recoverable(CTX, &rsig[i], msg[i], privkey, NULL, NULL) == 0) {
+            /* Invalid secret key */
+            testrand256(privkey);
+            CHECK(secp256k1_ecdsa_sign_recoverable(CTX, &rsig[i], msg[i], privkey, NULL, NULL) == 1);
+        }
+        switch (testrand_int(4)) {
+        case 0:
+            /* Change the recovery id, which either fails or recovers
+             * another key */
+            CHECK(secp256k1_ecdsa_recoverable_signature_serialize_compact(CTX, sig64, &recid, &rsig[i]) == 1);
+            CHECK(secp256k1_ecdsa_recoverable_signature_parse_compact(CTX, &rsig[i], sig64, testrand_int(4)) == 1);
+            break;
+        case 1:
+            /* Random signature, which fails to recover about half of the
+             * time */
+            testrand256(sig64);
+            testrand256(&sig64[32]);
+            if (testrand_bits(2) == 0) {
+                memset(sig64, 0, 32);
+            }
+            secp256k1_ecdsa_recoverable_signature_parse_compact(CTX, &rsig[i], sig64, testrand_int(4));
+            break;
+        }
+    }
+
+    memset(results, 0xff, sizeof(results));
+    batch_ret = secp256k1_ecdsa_recover_batch(CTX, pubkey, results, rsig_ptr, msg_ptr, n_sigs);
+    for (i = 0; i < n_sigs; i++) {
+        int ret = secp256k1_ecdsa_recover(CTX, &recpubkey, &rsig[i], msg[i]);
+        CHECK(ret == results[i]);
+        CHECK(secp256k1_memcmp_var(&recpubkey, &pubkey[i], sizeof(recpubkey)) == 0);
+        all_valid &= ret;
+    }
+    CHECK(batch_ret == all_valid);
+    CHECK(secp256k1_ecdsa_recover_batch(CTX, pubkey, NULL, rsig_ptr, msg_ptr, n_sigs) == all_valid);
+}
+#undef N_SIGS
+
+#define N_SIGS 40
+/* Checks that batch verification accepts exactly the signatures that verify
+ * and recover the public key, and finds the first one that doesn't. */
+static void test_ecdsa_recoverable_verify_batch(void) {
+    unsigned char privkey[32];
+    unsigned char msg[N_SIGS][32];
+    const unsigned char *msg_ptr[N_SIGS];
+    unsigned char sig64[64];
+    secp256k1_ecdsa_recoverable_signature rsig[N_SIGS];
+    const secp256k1_ecdsa_recoverable_signature *rsig_ptr[N_SIGS];
+    secp256k1_pubkey pubkey[N_SIGS];
+    const secp256k1_pubkey *pubkey_ptr[N_SIGS];
+    size_t n_sigs = 1 + testrand_int(N_SIGS);
+    size_t first_invalid = n_sigs;
+    size_t invalid_idx;
+    size_t i;
+
+    for (i = 0; i < N_SIGS; i++) {
+        msg_ptr[i] = msg[i];
+        rsig_ptr[i] = &rsig[i];
+        pubkey_ptr[i] = &pubkey[i];
+    }
+    for (i = 0; i < n_sigs; i++) {
+        secp256k1_ecdsa_signature sig;
+        secp256k1_pubkey recpubkey;
+        secp256k1_scalar s;
+        int recid;
+        int valid;
+        testrand256_test(msg[i]);
+        do {
+            testrand256_test(privkey);
+        } while (!secp256k1_ec_seckey_verify(CTX, privkey));
+        CHECK(secp256k1_ec_pubkey_create(CTX, &pubkey[i], privkey) == 1);
+        CHECK(secp256k1_ecdsa_sign_recoverable(CTX, &rsig[i], msg[i], privkey, NULL, NULL) == 1);
+        CHECK(secp256k1_ecdsa_recoverable_signature_serialize_compact(CTX, sig64, &recid, &rsig[i]) == 1);
+        /* Corrupt a few signatures */
+        switch (testrand_int(4 * n_sigs)) {
+        case 0:
+            /* Wrong recovery id */
+            CHECK(secp256k1_ecdsa_recoverable_signature_parse_compact(CTX, &rsig[i], sig64, (recid + 1 + testrand_int(3)) % 4) == 1);
+            break;
+        case 1:
+            /* High S, which recovers the same key with the other parity */
+            secp256k1_scalar_set_b32(&s, &sig64[32], NULL);
+            secp256k1_scalar_negate(&s, &s);
+            secp256k1_scalar_get_b32(&sig64[32], &s);
+            CHECK(secp256k1_ecdsa_recoverable_signature_parse_compact(CTX, &rsig[i], sig64, recid ^ 1) == 1);
+            break;
+        case 2:
+            /* Wrong message */
+            msg[i][0] ^= 1;
+            break;
+        }
+        CHECK(secp256k1_ecdsa_recoverable_signature_convert(CTX, &sig, &rsig[i]) == 1);
+        valid = secp256k1_ecdsa_verify(CTX, &sig, msg[i], &pubkey[i])
+                && secp256k1_ecdsa_recover(CTX, &recpubkey, &rsig[i], msg[i])
+                && secp256k1_memcmp_var(&recpubkey, &pubkey[i], sizeof(recpubkey)) == 0;
+        if (!valid && first_invalid == n_sigs) {
+            first_invalid = i;
+        }
+    }
+
+    invalid_idx = N_SIGS;
+    CHECK(secp256k1_ecdsa_recoverable_verify_batch(CTX, &invalid_idx, rsig_ptr, msg_ptr, pubkey_ptr, n_sigs) == (first_invalid == n_sigs));
+    CHECK(invalid_idx == (first_invalid == n_sigs ? N_SIGS : first_invalid));
+    CHECK(secp256k1_ecdsa_recoverable_verify_batch(CTX, NULL, rsig_ptr, msg_ptr, pubkey_ptr, n_sigs) == (first_invalid == n_sigs));
+
+    /* A signature with the wrong public key is found */
+    if (n_sigs > 1) {
+        size_t j = testrand_int(n_sigs);
+        pubkey_ptr[j] = &pubkey[(j + 1) % n_sigs];
+        CHECK(secp256k1_ecdsa_recoverable_verify_batch(CTX, &invalid_idx, rsig_ptr, msg_ptr, pubkey_ptr, n_sigs) == 0);
+        CHECK(invalid_idx == (first_invalid < j ? first_invalid : j));
+    }
+}
+#undef N_SIGS
+
 /* Tests several edge cases. */
 static void test_ecdsa_recovery_edge_cases(void) {
     const unsigned char msg32[32] = {
@@ -332,6 +516,12 @@ static void run_recovery_tests(void) {
     for (i = 0; i < 64*COUNT; i++) {
         test_ecdsa_recovery_end_to_end();
     }
+    for (i = 0; i < COUNT; i++) {
+        test_ecdsa_recovery_batch();
+    }
+    for (i = 0; i < COUNT; i++) {
+        test_ecdsa_recoverable_verify_batch();
+    }
     test_ecdsa_recovery_edge_cases();
 }
 
@@ -19,6 +19,9 @@ typedef struct {
     const unsigned char **pk;
     const unsigned char **sigs;
     const unsigned char **msgs;
+    size_t *msglens;
+    secp256k1_xonly_pubkey *xonly_pks;
+    const secp256k1_xonly_pubkey **xonly_pk_ptrs;
 } bench_schnorrsig_data;
 
 static void bench_schnorrsig_sign(void* arg, int iters) {
@@ -45,6 +48,31 @@ static void bench_schnorrsig_verify(void* arg, int iters) {
     }
 }
 
+static void bench_schnorrsig_verify_batch(void* arg, int iters) {
+    bench_schnorrsig_data *data = (bench_schnorrsig_data *)arg;
+
+    CHECK(secp256k1_schnorrsig_verify_batch(data->ctx, NULL, data->sigs, data->msgs, data->msglens, data->xonly_pk_ptrs, iters));
+}
+
+static void bench_schnorrsig_verify_many(void* arg, int iters) {
+    bench_schnorrsig_data *data = (bench_schnorrsig_data *)arg;
+
+    CHECK(secp256k1_schnorrsig_verify_many(data->ctx, NULL, data->sigs, data->msgs, data->msglens, data->xonly_pk_ptrs, iters));
+}
+
+static void bench_schnorrsig_verify_queue(void* arg, int iters) {
+    bench_schnorrsig_data *data = (bench_schnorrsig_data *)arg;
+    secp256k1_schnorrsig_verify_queue *queue = secp256k1_schnorrsig_verify_queue_create(data->ctx, 1024);
+    int i;
+
+    CHECK(queue != NULL);
+    for (i = 0; i < iters; i++) {
+        CHECK(secp256k1_schnorrsig_verify_queue_add(data->ctx, queue, data->sigs[i], data->msgs[i], MSGLEN, &data->xonly_pks[i], NULL, NULL));
+    }
+    CHECK(secp256k1_schnorrsig_verify_queue_flush(data->ctx, queue));
+    secp256k1_schnorrsig_verify_queue_destroy(data->ctx, queue);
+}
+
 static void run_schnorrsig_bench(int iters, int argc, char** argv) {
     int i;
     bench_schnorrsig_data data;
@@ -55,6 +83,9 @@ static void run_schnorrsig_bench(int iters, int argc, char** argv) {
     data.pk = (const unsigned char **)malloc(iters * sizeof(unsigned char *));
     data.msgs = (const unsigned char **)malloc(iters * sizeof(unsigned char *));
     data.sigs = (const unsigned char **)malloc(iters * sizeof(unsigned char *));
+    data.msglens = (size_t *)malloc(iters * sizeof(size_t));
+    data.xonly_pks = (secp256k1_xonly_pubkey *)malloc(iters * sizeof(secp256k1_xonly_pubkey));
+    data.xonly_pk_ptrs = (const secp256k1_xonly_pubkey **)malloc(iters * sizeof(secp256k1_xonly_pubkey *));
 
     CHECK(MSGLEN >= 4);
     for (i = 0; i < iters; i++) {
@@ -75,15 +106,22 @@ static void run_schnorrsig_bench(int iters, int argc, char** argv) {
         data.pk[i] = pk_char;
         data.msgs[i] = msg;
         data.sigs[i] = sig;
+        data.msglens[i] = MSGLEN;
+        data.xonly_pk_ptrs[i] = &data.xonly_pks[i];
 
         CHECK(secp256k1_keypair_create(data.ctx, keypair, sk));
         CHECK(secp256k1_schnorrsig_sign_custom(data.ctx, sig, msg, MSGLEN, keypair, NULL));
         CHECK(secp256k1_keypair_xonly_pub(data.ctx, &pk, NULL, keypair));
         CHECK(secp256k1_xonly_pubkey_serialize(data.ctx, pk_char, &pk) == 1);
+        /* Signatures verified together use parsed public keys, so that parsing is not timed. */
+        CHECK(secp256k1_xonly_pubkey_parse(data.ctx, &data.xonly_pks[i], pk_char) == 1);
     }
 
     if (d || have_flag(argc, argv, "schnorrsig") || have_flag(argc, argv, "sign") || have_flag(argc, argv, "schnorrsig_sign")) run_benchmark("schnorrsig_sign", bench_schnorrsig_sign, NULL, NULL, (void *) &data, 10, iters);
     if (d || have_flag(argc, argv, "schnorrsig") || have_flag(argc, argv, "verify") || have_flag(argc, argv, "schnorrsig_verify")) run_benchmark("schnorrsig_verify", bench_schnorrsig_verify, NULL, NULL, (void *) &data, 10, iters);
+    if (d || have_flag(argc, argv, "schnorrsig") || have_flag(argc, argv, "verify") || have_flag(argc, argv, "schnorrsig_verify_many")) run_benchmark("schnorrsig_verify_many", bench_schnorrsig_verify_many, NULL, NULL, (void *) &data, 10, iters);
+    if (d || have_flag(argc, argv, "schnorrsig") || have_flag(argc, argv, "verify") || have_flag(argc, argv, "schnorrsig_verify_batch")) run_benchmark("schnorrsig_verify_batch", bench_schnorrsig_verify_batch, NULL, NULL, (void *) &data, 10, iters);
+    if (d || have_flag(argc, argv, "schnorrsig") || have_flag(argc, argv, "verify") || have_flag(argc, argv, "schnorrsig_verify_queue")) run_benchmark("schnorrsig_verify_queue", bench_schnorrsig_verify_queue, NULL, NULL, (void *) &data, 10, iters);
 
     for (i = 0; i < iters; i++) {
         free((void *)data.keypairs[i]);
@@ -97,6 +135,9 @@ static void run_schnorrsig_bench(int iters, int argc, char** argv) {
     free((void *)data.pk);
     free((void *)data.msgs);
     free((void *)data.sigs);
+    free(data.msglens);
+    free(data.xonly_pks);
+    free((void *)data.xonly_pk_ptrs);
 
     secp256k1_context_destroy(data.ctx);
 }
@@ -10,6 +10,7 @@
 #include "../../../include/secp256k1.h"
 #include "../../../include/secp256k1_schnorrsig.h"
 #include "../../hash.h"
+#include "../../ecmult_batch.h"
 
 /* Initializes SHA256 with fixed midstate. This midstate was computed by applying
  * SHA256 to SHA256("BIP0340/nonce")||SHA256("BIP0340/nonce"). */
@@ -49,15 +50,12 @@ static const unsigned char bip340_algo[] = {'B', 'I', 'P', '0', '3', '4', '0', '
 
 static const unsigned char schnorrsig_extraparams_magic[4] = SECP256K1_SCHNORRSIG_EXTRAPARAMS_MAGIC;
 
-static int nonce_function_bip340(unsigned char *nonce32, const unsigned char *msg, size_t msglen, const unsigned char *key32, const unsigned char *xonly_pk32, const unsigned char *algo, size_t algolen, void *data) {
+/* Computes the masked key key32 xor TaggedHash("BIP0340/aux", data) of BIP-340,
+ * where data is the auxiliary randomness (or NULL, meaning 32 zero bytes). */
+static void secp256k1_nonce_function_bip340_masked_key(unsigned char *masked_key, const unsigned char *key32, const void *data) {
     secp256k1_sha256 sha;
-    unsigned char masked_key[32];
     int i;
 
-    if (algo == NULL) {
-        return 0;
-    }
-
     if (data != NULL) {
         secp256k1_nonce_function_bip340_sha256_tagged_aux(&sha);
         secp256k1_sha256_write(&sha, data, 32);
@@ -77,6 +75,17 @@ static int nonce_function_bip340(unsigned char *nonce32, const unsigned char *ms
             masked_key[i] = key32[i] ^ ZERO_MASK[i];
         }
     }
+}
+
+static int nonce_function_bip340(unsigned char *nonce32, const unsigned char *msg, size_t msglen, const unsigned char *key32, const unsigned char *xonly_pk32, const unsigned char *algo, size_t algolen, void *data) {
+    secp256k1_sha256 sha;
+    unsigned char masked_key[32];
+
+    if (algo == NULL) {
+        return 0;
+    }
+
+    secp256k1_nonce_function_bip340_masked_key(masked_key, key32, data);
 
     /* Tag the hash with algo which is important to avoid nonce reuse across
      * algorithms. If this nonce function is used in BIP-340 signing as defined
@@ -132,6 +141,37 @@ static void secp256k1_schnorrsig_challenge(secp256k1_scalar* e, const unsigned c
     secp256k1_scalar_set_b32(e, buf, NULL);
 }
 
+/* Computes the challenges e[i] of n signatures like
+ * secp256k1_schnorrsig_challenge, hashing up to SECP256K1_SHA256_MAX_LANES of
+ * them in parallel. */
+static void secp256k1_schnorrsig_challenge_many(secp256k1_scalar *e, const unsigned char * const *r32, const unsigned char * const *msgs, const size_t *msglens, const unsigned char * const *pubkeys32, size_t n) {
+    secp256k1_sha256 sha[SECP256K1_SHA256_MAX_LANES];
+    unsigned char buf[SECP256K1_SHA256_MAX_LANES][32];
+    size_t lens[SECP256K1_SHA256_MAX_LANES];
+    size_t lanes, i;
+
+    while (n > 0) {
+        lanes = n < SECP256K1_SHA256_MAX_LANES ? n : SECP256K1_SHA256_MAX_LANES;
+        for (i = 0; i < lanes; i++) {
+            secp256k1_schnorrsig_sha256_tagged(&sha[i]);
+            lens[i] = 32;
+        }
+        secp256k1_sha256_write_many(sha, r32, lens, lanes);
+        secp256k1_sha256_write_many(sha, pubkeys32, lens, lanes);
+        secp256k1_sha256_write_many(sha, msgs, msglens, lanes);
+        secp256k1_sha256_finalize_many(sha, &buf[0][0], lanes);
+        for (i = 0; i < lanes; i++) {
+            secp256k1_scalar_set_b32(&e[i], buf[i], NULL);
+        }
+        e += lanes;
+        r32 += lanes;
+        msgs += lanes;
+        msglens += lanes;
+        pubkeys32 += lanes;
+        n -= lanes;
+    }
+}
+
 static int secp256k1_schnorrsig_sign_internal(const secp256k1_context* ctx, unsigned char *sig64, const unsigned char *msg, size_t msglen, const secp256k1_keypair *keypair, secp256k1_nonce_function_hardened noncefp, void *ndata) {
     secp256k1_scalar sk;
     secp256k1_scalar e;
@@ -220,14 +260,43 @@ int secp256k1_schnorrsig_sign_custom(const secp256k1_context* ctx, unsigned char
     return secp256k1_schnorrsig_sign_internal(ctx, sig64, msg, msglen, keypair, noncefp, ndata);
 }
 
+/* Checks whether r is the point with even Y and X coordinate rx. */
+static int secp256k1_schnorrsig_check_r_ge(const secp256k1_fe *rx, secp256k1_ge *r) {
+    if (secp256k1_ge_is_infinity(r)) {
+        return 0;
+    }
+
+    secp256k1_fe_normalize_var(&r->y);
+    return !secp256k1_fe_is_odd(&r->y) &&
+           secp256k1_fe_equal(rx, &r->x);
+}
+
+/* Checks whether rj is the point with even Y and X coordinate rx. */
+static int secp256k1_schnorrsig_check_r(const secp256k1_fe *rx, secp256k1_gej *rj) {
+    secp256k1_ge r;
+
+    secp256k1_ge_set_gej_var(&r, rj);
+    return secp256k1_schnorrsig_check_r_ge(rx, &r);
+}
+
+/* Checks whether s*G - e*P is the point with even Y and X coordinate rx. */
+static int secp256k1_schnorrsig_verify_internal(const secp256k1_context* ctx, const secp256k1_fe *rx, const secp256k1_scalar *s, const secp256k1_scalar *e, const secp256k1_ge *pk) {
+    secp256k1_scalar nege;
+    secp256k1_gej rj;
+    secp256k1_gej pkj;
+
+    /* Compute rj =  s*G + (-e)*pkj */
+    secp256k1_scalar_negate(&nege, e);
+    secp256k1_gej_set_ge(&pkj, pk);
+    secp256k1_ecmult_with_tables(&ctx->ecmult_tables, &rj, &pkj, &nege, s);
+    return secp256k1_schnorrsig_check_r(rx, &rj);
+}
+
 int secp256k1_schnorrsig_verify(const secp256k1_context* ctx, const unsigned char *sig64, const unsigned char *msg, size_t msglen, const secp256k1_xonly_pubkey *pubkey) {
     secp256k1_scalar s;
     secp256k1_scalar e;
-    secp256k1_gej rj;
     secp256k1_ge pk;
-    secp256k1_gej pkj;
     secp256k1_fe rx;
-    secp256k1_ge r;
     unsigned char buf[32];
     int overflow;
 
@@ -253,19 +322,795 @@ int secp256k1_schnorrsig_verify(const secp256k1_context* ctx, const unsigned cha
     secp256k1_fe_get_b32(buf, &pk.x);
     secp256k1_schnorrsig_challenge(&e, &sig64[0], msg, msglen, buf);
 
-    /* Compute rj =  s*G + (-e)*pkj */
-    secp256k1_scalar_negate(&e, &e);
-    secp256k1_gej_set_ge(&pkj, &pk);
-    secp256k1_ecmult(&rj, &pkj, &e, &s);
+    return secp256k1_schnorrsig_verify_internal(ctx, &rx, &s, &e, &pk);
+}
+
+int secp256k1_schnorrsig_verify_prepared(const secp256k1_context* ctx, const unsigned char *sig64, const unsigned char *msg, size_t msglen, const secp256k1_prepared_pubkey *prepared) {
+    secp256k1_scalar s;
+    secp256k1_scalar e;
+    secp256k1_gej rj;
+    secp256k1_fe rx;
+    unsigned char buf[32];
+    int overflow;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(sig64 != NULL);
+    ARG_CHECK(msg != NULL || msglen == 0);
+    ARG_CHECK(prepared != NULL);
+
+    if (!secp256k1_fe_set_b32_limit(&rx, &sig64[0])) {
+        return 0;
+    }
+
+    secp256k1_scalar_set_b32(&s, &sig64[32], &overflow);
+    if (overflow) {
+        return 0;
+    }
+
+    /* Compute e. */
+    secp256k1_fe_get_b32(buf, &prepared->pubkey.x);
+    secp256k1_schnorrsig_challenge(&e, &sig64[0], msg, msglen, buf);
+
+    /* Compute rj = s*G + (-e)*pk, where pk is the prepared point with even Y.
+     * If the prepared point Q has odd Y, pk = -Q and (-e)*pk = e*Q. */
+    if (!secp256k1_fe_is_odd(&prepared->pubkey.y)) {
+        secp256k1_scalar_negate(&e, &e);
+    }
+    secp256k1_ecmult_with_point_table(&ctx->ecmult_tables, &prepared->table, &rj, &e, &s);
+    return secp256k1_schnorrsig_check_r(&rx, &rj);
+}
+
+/* Verifies up to ECMULT_INTERLEAVE_MAX signatures like
+ * secp256k1_schnorrsig_verify, but computes their multiplications at once and
+ * converts the results to affine coordinates with a single inversion. Returns
+ * 1 if all signatures are correct. */
+static int secp256k1_schnorrsig_verify_many_chunk(const secp256k1_context* ctx, int *results, const unsigned char * const *sigs64, const unsigned char * const *msgs, const size_t *msglens, const secp256k1_xonly_pubkey * const *pubkeys, size_t n_sigs) {
+    secp256k1_fe rx[ECMULT_INTERLEAVE_MAX];
+    secp256k1_scalar s[ECMULT_INTERLEAVE_MAX];
+    secp256k1_scalar e[ECMULT_INTERLEAVE_MAX];
+    secp256k1_gej pkj[ECMULT_INTERLEAVE_MAX];
+    secp256k1_gej rj[ECMULT_INTERLEAVE_MAX];
+    secp256k1_ge r[ECMULT_INTERLEAVE_MAX];
+    unsigned char pk32[ECMULT_INTERLEAVE_MAX][32];
+    const unsigned char *r32s[ECMULT_INTERLEAVE_MAX];
+    const unsigned char *pk32s[ECMULT_INTERLEAVE_MAX];
+    const unsigned char *valid_msgs[ECMULT_INTERLEAVE_MAX];
+    size_t valid_msglens[ECMULT_INTERLEAVE_MAX];
+    size_t idx[ECMULT_INTERLEAVE_MAX];
+    size_t n_valid = 0;
+    size_t i;
+    int ret = 1;
+
+    VERIFY_CHECK(n_sigs <= ECMULT_INTERLEAVE_MAX);
+    for (i = 0; i < n_sigs; i++) {
+        secp256k1_ge pk;
+        int overflow;
+
+        if (results != NULL) {
+            results[i] = 0;
+        }
+        secp256k1_scalar_set_b32(&s[n_valid], &sigs64[i][32], &overflow);
+        if (!secp256k1_fe_set_b32_limit(&rx[n_valid], &sigs64[i][0]) || overflow ||
+            !secp256k1_xonly_pubkey_load(ctx, &pk, pubkeys[i])) {
+            ret = 0;
+            continue;
+        }
+        secp256k1_fe_get_b32(pk32[n_valid], &pk.x);
+        secp256k1_gej_set_ge(&pkj[n_valid], &pk);
+        r32s[n_valid] = &sigs64[i][0];
+        pk32s[n_valid] = pk32[n_valid];
+        valid_msgs[n_valid] = msgs[i];
+        valid_msglens[n_valid] = msglens[i];
+        idx[n_valid] = i;
+        n_valid++;
+    }
+    if (n_valid == 0) {
+        return ret;
+    }
+
+    secp256k1_schnorrsig_challenge_many(e, r32s, valid_msgs, valid_msglens, pk32s, n_valid);
+    for (i = 0; i < n_valid; i++) {
+        secp256k1_scalar_negate(&e[i], &e[i]);
+    }
+
+    /* Compute rj[i] = s[i]*G + (-e[i])*pkj[i] */
+    secp256k1_ecmult_interleaved(&ctx->ecmult_tables, rj, pkj, e, s, n_valid);
+    secp256k1_ge_set_all_gej_var(r, rj, n_valid);
+    for (i = 0; i < n_valid; i++) {
+        if (secp256k1_schnorrsig_check_r_ge(&rx[i], &r[i])) {
+            if (results != NULL) {
+                results[idx[i]] = 1;
+            }
+        } else {
+            ret = 0;
+        }
+    }
+    return ret;
+}
+
+int secp256k1_schnorrsig_verify_many(const secp256k1_context* ctx, int *results, const unsigned char * const *sigs64, const unsigned char * const *msgs, const size_t *msglens, const secp256k1_xonly_pubkey * const *pubkeys, size_t n_sigs) {
+    size_t offset;
+    size_t i;
+    int ret = 1;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(n_sigs == 0 || sigs64 != NULL);
+    ARG_CHECK(n_sigs == 0 || msgs != NULL);
+    ARG_CHECK(n_sigs == 0 || msglens != NULL);
+    ARG_CHECK(n_sigs == 0 || pubkeys != NULL);
+    for (i = 0; i < n_sigs; i++) {
+        ARG_CHECK(sigs64[i] != NULL);
+        ARG_CHECK(msgs[i] != NULL || msglens[i] == 0);
+        ARG_CHECK(pubkeys[i] != NULL);
+    }
+
+    for (offset = 0; offset < n_sigs; offset += ECMULT_INTERLEAVE_MAX) {
+        size_t len = n_sigs - offset < ECMULT_INTERLEAVE_MAX ? n_sigs - offset : ECMULT_INTERLEAVE_MAX;
+        ret &= secp256k1_schnorrsig_verify_many_chunk(ctx, results == NULL ? NULL : &results[offset], &sigs64[offset], &msgs[offset], &msglens[offset], &pubkeys[offset], len);
+    }
+    return ret;
+}
+
+/* A signature with everything needed to add it to a batch. */
+typedef struct {
+    unsigned char sig64[64];
+    unsigned char pk32[32];
+    secp256k1_ge r;
+    secp256k1_ge pk;
+    secp256k1_scalar s;
+    secp256k1_scalar e;
+} secp256k1_schnorrsig_batch_sig;
+
+/* Parses a signature without computing its challenge. Returns 0 if the
+ * signature is invalid for reasons that can be detected without a
+ * multiplication. */
+static int secp256k1_schnorrsig_batch_sig_parse(const secp256k1_context* ctx, secp256k1_schnorrsig_batch_sig *sig, const unsigned char *sig64, const secp256k1_xonly_pubkey *pubkey) {
+    secp256k1_fe rx;
+    int overflow;
+
+    if (!secp256k1_fe_set_b32_limit(&rx, &sig64[0])) {
+        return 0;
+    }
+    if (!secp256k1_ge_set_xo_var(&sig->r, &rx, 0)) {
+        return 0;
+    }
+
+    secp256k1_scalar_set_b32(&sig->s, &sig64[32], &overflow);
+    if (overflow) {
+        return 0;
+    }
+
+    if (!secp256k1_xonly_pubkey_load(ctx, &sig->pk, pubkey)) {
+        return 0;
+    }
+
+    secp256k1_fe_get_b32(sig->pk32, &sig->pk.x);
+    memcpy(sig->sig64, sig64, 64);
+    return 1;
+}
+
+/* Parses a signature and computes its challenge. Returns 0 if the signature is
+ * invalid for reasons that can be detected without a multiplication. */
+static int secp256k1_schnorrsig_batch_sig_load(const secp256k1_context* ctx, secp256k1_schnorrsig_batch_sig *sig, const unsigned char *sig64, const unsigned char *msg, size_t msglen, const secp256k1_xonly_pubkey *pubkey) {
+    if (!secp256k1_schnorrsig_batch_sig_parse(ctx, sig, sig64, pubkey)) {
+        return 0;
+    }
+    secp256k1_schnorrsig_challenge(&sig->e, &sig->sig64[0], msg, msglen, sig->pk32);
+    return 1;
+}
+
+/* Parses up to SECP256K1_SHA256_MAX_LANES signatures and computes their
+ * challenges in parallel. Returns 0 if any signature is invalid for reasons
+ * that can be detected without a multiplication. */
+static int secp256k1_schnorrsig_batch_sig_load_many(const secp256k1_context* ctx, secp256k1_schnorrsig_batch_sig *sigs, const unsigned char * const *sigs64, const unsigned char * const *msgs, const size_t *msglens, const secp256k1_xonly_pubkey * const *pubkeys, size_t n_sigs) {
+    secp256k1_scalar e[SECP256K1_SHA256_MAX_LANES];
+    const unsigned char *r32s[SECP256K1_SHA256_MAX_LANES];
+    const unsigned char *pk32s[SECP256K1_SHA256_MAX_LANES];
+    size_t i;
+
+    VERIFY_CHECK(n_sigs <= SECP256K1_SHA256_MAX_LANES);
+    for (i = 0; i < n_sigs; i++) {
+        if (!secp256k1_schnorrsig_batch_sig_parse(ctx, &sigs[i], sigs64[i], pubkeys[i])) {
+            return 0;
+        }
+        r32s[i] = &sigs[i].sig64[0];
+        pk32s[i] = sigs[i].pk32;
+    }
+    secp256k1_schnorrsig_challenge_many(e, r32s, msgs, msglens, pk32s, n_sigs);
+    for (i = 0; i < n_sigs; i++) {
+        sigs[i].e = e[i];
+    }
+    return 1;
+}
+
+/* Adds the verification equation of a signature, multiplied by a randomizer a,
+ * to the batch:
+ *   a*R + (a*e)*P - (a*s)*G = 0
+ * where R is the point with x-coordinate r and even y. This equation holds iff
+ * the signature is valid. */
+static void secp256k1_schnorrsig_verify_batch_add_sig(const secp256k1_context* ctx, secp256k1_ecmult_batch *batch, const secp256k1_schnorrsig_batch_sig *sig) {
+    secp256k1_scalar e;
+    secp256k1_scalar s;
+    secp256k1_scalar a;
+    unsigned char buf[32];
+
+    /* Since e commits to the message, the randomizer doesn't need to hash the
+     * message again. */
+    secp256k1_sha256_write(&batch->transcript, sig->sig64, 64);
+    secp256k1_sha256_write(&batch->transcript, sig->pk32, 32);
+    secp256k1_scalar_get_b32(buf, &sig->e);
+    secp256k1_sha256_write(&batch->transcript, buf, 32);
+    secp256k1_ecmult_batch_randomizer(batch, &a);
+
+    secp256k1_ecmult_batch_reserve(&ctx->error_callback, batch, 2);
+    secp256k1_ecmult_batch_add(batch, &a, &sig->r);
+    secp256k1_scalar_mul(&e, &sig->e, &a);
+    secp256k1_ecmult_batch_add(batch, &e, &sig->pk);
+    secp256k1_scalar_mul(&s, &sig->s, &a);
+    secp256k1_scalar_negate(&s, &s);
+    secp256k1_ecmult_batch_add_g(batch, &s);
+}
+
+typedef struct {
+    const secp256k1_context *ctx;
+    const unsigned char * const *sigs64;
+    const unsigned char * const *msgs;
+    const size_t *msglens;
+    const secp256k1_xonly_pubkey * const *pubkeys;
+} secp256k1_schnorrsig_verify_batch_data;
+
+static int secp256k1_schnorrsig_verify_batch_range(secp256k1_ecmult_batch *batch, size_t offset, size_t len, void *data) {
+    const secp256k1_schnorrsig_verify_batch_data *d = (const secp256k1_schnorrsig_verify_batch_data *)data;
+    secp256k1_schnorrsig_batch_sig sigs[SECP256K1_SHA256_MAX_LANES];
+    size_t end = offset + len;
+    size_t n, i;
+
+    for (; offset < end; offset += n) {
+        n = end - offset < SECP256K1_SHA256_MAX_LANES ? end - offset : SECP256K1_SHA256_MAX_LANES;
+        if (!secp256k1_schnorrsig_batch_sig_load_many(d->ctx, sigs, &d->sigs64[offset], &d->msgs[offset], &d->msglens[offset], &d->pubkeys[offset], n)) {
+            return 0;
+        }
+        for (i = 0; i < n; i++) {
+            secp256k1_schnorrsig_verify_batch_add_sig(d->ctx, batch, &sigs[i]);
+        }
+    }
+    return secp256k1_ecmult_batch_verify(&d->ctx->error_callback, batch);
+}
+
+static int secp256k1_schnorrsig_verify_batch_internal(const secp256k1_context* ctx, secp256k1_ecmult_batch *batch, size_t *invalid_idx, const unsigned char * const *sigs64, const unsigned char * const *msgs, const size_t *msglens, const secp256k1_xonly_pubkey * const *pubkeys, size_t n_sigs) {
+    secp256k1_schnorrsig_verify_batch_data data;
+
+    data.ctx = ctx;
+    data.sigs64 = sigs64;
+    data.msgs = msgs;
+    data.msglens = msglens;
+    data.pubkeys = pubkeys;
+    return secp256k1_ecmult_batch_find_invalid(batch, invalid_idx, secp256k1_schnorrsig_verify_batch_range, &data, n_sigs);
+}
+
+int secp256k1_schnorrsig_verify_batch(const secp256k1_context* ctx, size_t *invalid_idx, const unsigned char * const *sigs64, const unsigned char * const *msgs, const size_t *msglens, const secp256k1_xonly_pubkey * const *pubkeys, size_t n_sigs) {
+    secp256k1_scratch *scratch;
+    secp256k1_ecmult_batch batch;
+    size_t max_terms;
+    size_t i;
+    int ret;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(n_sigs == 0 || sigs64 != NULL);
+    ARG_CHECK(n_sigs == 0 || msgs != NULL);
+    ARG_CHECK(n_sigs == 0 || msglens != NULL);
+    ARG_CHECK(n_sigs == 0 || pubkeys != NULL);
+    for (i = 0; i < n_sigs; i++) {
+        ARG_CHECK(sigs64[i] != NULL);
+        ARG_CHECK(msgs[i] != NULL || msglens[i] == 0);
+        ARG_CHECK(pubkeys[i] != NULL);
+    }
+
+    if (n_sigs == 0) {
+        return 1;
+    } else if (n_sigs == 1) {
+        /* A batch of one is no faster than a single verification. */
+        ret = secp256k1_schnorrsig_verify(ctx, sigs64[0], msgs[0], msglens[0], pubkeys[0]);
+        if (!ret && invalid_idx != NULL) {
+            *invalid_idx = 0;
+        }
+        return ret;
+    }
+
+    max_terms = n_sigs < ECMULT_BATCH_MAX_TERMS / 2 ? 2 * n_sigs : ECMULT_BATCH_MAX_TERMS;
+    scratch = secp256k1_scratch_create(&ctx->error_callback, secp256k1_ecmult_batch_scratch_size(max_terms));
+    if (scratch == NULL) {
+        return 0;
+    }
+    if (!secp256k1_ecmult_batch_init(&ctx->error_callback, &ctx->ecmult_multi_params, &batch, scratch, max_terms)) {
+        secp256k1_scratch_destroy(&ctx->error_callback, scratch);
+        return 0;
+    }
+
+    ret = secp256k1_schnorrsig_verify_batch_internal(ctx, &batch, invalid_idx, sigs64, msgs, msglens, pubkeys, n_sigs);
+
+    secp256k1_ecmult_batch_clear(&ctx->error_callback, &batch);
+    secp256k1_scratch_destroy(&ctx->error_callback, scratch);
+    return ret;
+}
+
+typedef struct {
+    secp256k1_schnorrsig_batch_sig sig;
+    /* 0 if the signature is known to be invalid */
+    int result;
+    secp256k1_schnorrsig_verify_callback callback;
+    void *callback_data;
+} secp256k1_schnorrsig_verify_job;
+
+struct secp256k1_schnorrsig_verify_queue_struct {
+    secp256k1_scratch *scratch;
+    secp256k1_ecmult_batch batch;
+    secp256k1_schnorrsig_verify_job *jobs;
+    size_t len;
+    size_t capacity;
+};
+
+secp256k1_schnorrsig_verify_queue *secp256k1_schnorrsig_verify_queue_create(const secp256k1_context* ctx, size_t max_sigs) {
+    const size_t base_alloc = ROUND_TO_ALIGN(sizeof(secp256k1_schnorrsig_verify_queue));
+    secp256k1_schnorrsig_verify_queue *queue;
+    size_t max_terms;
+
+    VERIFY_CHECK(ctx != NULL);
+    if (max_sigs == 0 || max_sigs > (SIZE_MAX - base_alloc) / sizeof(secp256k1_schnorrsig_verify_job)) {
+        return NULL;
+    }
+
+    queue = (secp256k1_schnorrsig_verify_queue *)checked_malloc(&ctx->error_callback, base_alloc + max_sigs * sizeof(secp256k1_schnorrsig_verify_job));
+    if (queue == NULL) {
+        return NULL;
+    }
+    max_terms = max_sigs < ECMULT_BATCH_MAX_TERMS / 2 ? 2 * max_sigs : ECMULT_BATCH_MAX_TERMS;
+    queue->scratch = secp256k1_scratch_create(&ctx->error_callback, secp256k1_ecmult_batch_scratch_size(max_terms));
+    if (queue->scratch == NULL) {
+        free(queue);
+        return NULL;
+    }
+    if (!secp256k1_ecmult_batch_init(&ctx->error_callback, &ctx->ecmult_multi_params, &queue->batch, queue->scratch, max_terms)) {
+        secp256k1_scratch_destroy(&ctx->error_callback, queue->scratch);
+        free(queue);
+        return NULL;
+    }
+    queue->jobs = (secp256k1_schnorrsig_verify_job *)(void *)((char *)queue + base_alloc);
+    queue->len = 0;
+    queue->capacity = max_sigs;
+    return queue;
+}
+
+void secp256k1_schnorrsig_verify_queue_destroy(const secp256k1_context* ctx, secp256k1_schnorrsig_verify_queue *queue) {
+    VERIFY_CHECK(ctx != NULL);
+    if (queue != NULL) {
+        secp256k1_ecmult_batch_clear(&ctx->error_callback, &queue->batch);
+        secp256k1_scratch_destroy(&ctx->error_callback, queue->scratch);
+        free(queue);
+    }
+}
+
+/* Batch verifies the n jobs starting at offset. */
+static int secp256k1_schnorrsig_verify_queue_range(const secp256k1_context* ctx, secp256k1_schnorrsig_verify_queue *queue, size_t offset, size_t n) {
+    size_t i;
+
+    secp256k1_ecmult_batch_reset(&queue->batch);
+    for (i = offset; i < offset + n; i++) {
+        if (!queue->jobs[i].result) {
+            return 0;
+        }
+        secp256k1_schnorrsig_verify_batch_add_sig(ctx, &queue->batch, &queue->jobs[i].sig);
+    }
+    return secp256k1_ecmult_batch_verify(&ctx->error_callback, &queue->batch);
+}
+
+/* Sets the results of the n jobs starting at offset by bisecting the range
+ * until the incorrect signatures are isolated. If known_invalid is set, the
+ * range is already known to contain an incorrect signature. Returns 1 if all
+ * signatures in the range are correct. */
+static int secp256k1_schnorrsig_verify_queue_check(const secp256k1_context* ctx, secp256k1_schnorrsig_verify_queue *queue, size_t offset, size_t n, int known_invalid) {
+    size_t half;
+    size_t i;
+    int left;
+
+    if (!known_invalid && secp256k1_schnorrsig_verify_queue_range(ctx, queue, offset, n)) {
+        for (i = offset; i < offset + n; i++) {
+            queue->jobs[i].result = 1;
+        }
+        return 1;
+    }
+    if (n == 1) {
+        queue->jobs[offset].result = 0;
+        return 0;
+    }
+    /* If the left half is correct, the incorrect signature must be in the
+     * right half. */
+    half = n / 2;
+    left = secp256k1_schnorrsig_verify_queue_check(ctx, queue, offset, half, 0);
+    secp256k1_schnorrsig_verify_queue_check(ctx, queue, offset + half, n - half, left);
+    return 0;
+}
+
+int secp256k1_schnorrsig_verify_queue_flush(const secp256k1_context* ctx, secp256k1_schnorrsig_verify_queue *queue) {
+    size_t i;
+    int ret = 1;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(queue != NULL);
+
+    if (queue->len == 1) {
+        /* A batch of one is no faster than a single verification. */
+        const secp256k1_schnorrsig_batch_sig *sig = &queue->jobs[0].sig;
+
+        if (queue->jobs[0].result) {
+            queue->jobs[0].result = secp256k1_schnorrsig_verify_internal(ctx, &sig->r.x, &sig->s, &sig->e, &sig->pk);
+        }
+        ret = queue->jobs[0].result;
+    } else if (queue->len > 1) {
+        ret = secp256k1_schnorrsig_verify_queue_check(ctx, queue, 0, queue->len, 0);
+    }
+
+    for (i = 0; i < queue->len; i++) {
+        if (queue->jobs[i].callback != NULL) {
+            queue->jobs[i].callback(queue->jobs[i].result, queue->jobs[i].callback_data);
+        }
+    }
+    queue->len = 0;
+    return ret;
+}
+
+int secp256k1_schnorrsig_verify_queue_add(const secp256k1_context* ctx, secp256k1_schnorrsig_verify_queue *queue, const unsigned char *sig64, const unsigned char *msg, size_t msglen, const secp256k1_xonly_pubkey *pubkey, secp256k1_schnorrsig_verify_callback callback, void *callback_data) {
+    secp256k1_schnorrsig_verify_job *job;
+    secp256k1_ge pk;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(queue != NULL);
+    ARG_CHECK(sig64 != NULL);
+    ARG_CHECK(msg != NULL || msglen == 0);
+    ARG_CHECK(pubkey != NULL);
+    if (!secp256k1_xonly_pubkey_load(ctx, &pk, pubkey)) {
+        return 0;
+    }
+
+    if (queue->len == queue->capacity) {
+        secp256k1_schnorrsig_verify_queue_flush(ctx, queue);
+    }
+    job = &queue->jobs[queue->len];
+    job->result = secp256k1_schnorrsig_batch_sig_load(ctx, &job->sig, sig64, msg, msglen, pubkey);
+    job->callback = callback;
+    job->callback_data = callback_data;
+    queue->len++;
+    return 1;
+}
+
+static const unsigned char secp256k1_schnorrsig_stream_magic[4] = { 0x5c, 0x41, 0x7e, 0xd2 };
+
+#define SECP256K1_SCHNORRSIG_STREAM_VERIFY 1
+#define SECP256K1_SCHNORRSIG_STREAM_SIGN_NONCE 2
+#define SECP256K1_SCHNORRSIG_STREAM_SIGN_CHALLENGE 3
+
+typedef struct {
+    /* One of the SECP256K1_SCHNORRSIG_STREAM_* phases. */
+    unsigned char phase;
+    /* Whether the nonce point R of a signature being created has an odd Y. */
+    unsigned char r_odd;
+    /* The hash that the message is currently written to: the challenge hash,
+     * or the nonce hash in the first pass of signing. */
+    secp256k1_sha256 sha;
+    /* When signing, the nonce hash after masked key and public key, which is
+     * written the message again in the second pass to check that it is the
+     * same message. */
+    secp256k1_sha256 sha_nonce;
+    /* When verifying, the signature. When signing, R.x and the (negated if
+     * R.y is odd) nonce k after the first pass. */
+    unsigned char sig64[64];
+    /* When verifying, the serialized public key point. When signing, the
+     * (negated if P.y is odd) secret key and the x-only public key. */
+    unsigned char key64[64];
+} secp256k1_schnorrsig_stream_internal;
+
+static void secp256k1_schnorrsig_sha256_save(unsigned char *out104, const secp256k1_sha256 *sha) {
+    int i;
+
+    for (i = 0; i < 8; i++) {
+        secp256k1_write_be32(&out104[4*i], sha->s[i]);
+    }
+    memcpy(&out104[32], sha->buf, 64);
+    secp256k1_write_be64(&out104[96], sha->bytes);
+}
+
+static void secp256k1_schnorrsig_sha256_load(secp256k1_sha256 *sha, const unsigned char *in104) {
+    int i;
+
+    for (i = 0; i < 8; i++) {
+        sha->s[i] = secp256k1_read_be32(&in104[4*i]);
+    }
+    memcpy(sha->buf, &in104[32], 64);
+    sha->bytes = secp256k1_read_be64(&in104[96]);
+}
+
+/* A stream consists of
+ * - 4 byte stream magic
+ * - 1 byte phase
+ * - 1 byte parity of R
+ * - 104 byte hash state sha (state words, buffer, length)
+ * - 104 byte hash state sha_nonce
+ * - 64 byte sig64
+ * - 64 byte key64
+ */
+static void secp256k1_schnorrsig_stream_save(secp256k1_schnorrsig_stream *stream, const secp256k1_schnorrsig_stream_internal *stream_i) {
+    unsigned char *ptr = stream->data;
+
+    VERIFY_CHECK(sizeof(stream->data) == 4 + 1 + 1 + 104 + 104 + 64 + 64);
+    memcpy(ptr, secp256k1_schnorrsig_stream_magic, 4);
+    ptr += 4;
+    *ptr = stream_i->phase;
+    ptr += 1;
+    *ptr = stream_i->r_odd;
+    ptr += 1;
+    secp256k1_schnorrsig_sha256_save(ptr, &stream_i->sha);
+    ptr += 104;
+    secp256k1_schnorrsig_sha256_save(ptr, &stream_i->sha_nonce);
+    ptr += 104;
+    memcpy(ptr, stream_i->sig64, 64);
+    ptr += 64;
+    memcpy(ptr, stream_i->key64, 64);
+}
+
+static int secp256k1_schnorrsig_stream_load(const secp256k1_context* ctx, secp256k1_schnorrsig_stream_internal *stream_i, const secp256k1_schnorrsig_stream *stream) {
+    const unsigned char *ptr = stream->data;
+
+    ARG_CHECK(secp256k1_memcmp_var(ptr, secp256k1_schnorrsig_stream_magic, 4) == 0);
+    ptr += 4;
+    stream_i->phase = *ptr;
+    ptr += 1;
+    stream_i->r_odd = *ptr;
+    ptr += 1;
+    secp256k1_schnorrsig_sha256_load(&stream_i->sha, ptr);
+    ptr += 104;
+    secp256k1_schnorrsig_sha256_load(&stream_i->sha_nonce, ptr);
+    ptr += 104;
+    memcpy(stream_i->sig64, ptr, 64);
+    ptr += 64;
+    memcpy(stream_i->key64, ptr, 64);
+    return 1;
+}
+
+/* If flag is true, invalidate the stream; otherwise leave it. Constant-time. */
+static void secp256k1_schnorrsig_stream_invalidate(const secp256k1_context* ctx, secp256k1_schnorrsig_stream *stream, int flag) {
+    secp256k1_memczero(stream->data, sizeof(stream->data), flag);
+    /* The flag argument is usually classified, which makes the whole stream
+     * classified. However, the magic, phase, parity of R and the lengths of the
+     * hashed data are public and need to be declassified to be branched on. */
+    secp256k1_declassify(ctx, stream->data, 4 + 1 + 1);
+    secp256k1_declassify(ctx, &stream->data[6 + 96], 8);
+    secp256k1_declassify(ctx, &stream->data[6 + 104 + 96], 8);
+}
+
+static void secp256k1_schnorrsig_stream_internal_clear(secp256k1_schnorrsig_stream_internal *stream_i) {
+    secp256k1_memclear(stream_i, sizeof(*stream_i));
+}
+
+int secp256k1_schnorrsig_verify_stream_init(const secp256k1_context* ctx, secp256k1_schnorrsig_stream *stream, const unsigned char *sig64, const secp256k1_xonly_pubkey *pubkey) {
+    secp256k1_schnorrsig_stream_internal stream_i;
+    secp256k1_ge pk;
+    unsigned char buf[32];
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(stream != NULL);
+    memset(stream->data, 0, sizeof(stream->data));
+    ARG_CHECK(sig64 != NULL);
+    ARG_CHECK(pubkey != NULL);
+
+    if (!secp256k1_xonly_pubkey_load(ctx, &pk, pubkey)) {
+        return 0;
+    }
+
+    /* tagged hash(r.x, pk.x, msg) as in secp256k1_schnorrsig_challenge */
+    memset(&stream_i, 0, sizeof(stream_i));
+    stream_i.phase = SECP256K1_SCHNORRSIG_STREAM_VERIFY;
+    secp256k1_fe_get_b32(buf, &pk.x);
+    secp256k1_schnorrsig_sha256_tagged(&stream_i.sha);
+    secp256k1_sha256_write(&stream_i.sha, &sig64[0], 32);
+    secp256k1_sha256_write(&stream_i.sha, buf, 32);
+    memcpy(stream_i.sig64, sig64, 64);
+    secp256k1_ge_to_bytes(stream_i.key64, &pk);
+    secp256k1_schnorrsig_stream_save(stream, &stream_i);
+    return 1;
+}
+
+int secp256k1_schnorrsig_stream_write(const secp256k1_context* ctx, secp256k1_schnorrsig_stream *stream, const unsigned char *data, size_t len) {
+    secp256k1_schnorrsig_stream_internal stream_i;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(stream != NULL);
+    ARG_CHECK(data != NULL || len == 0);
+
+    if (!secp256k1_schnorrsig_stream_load(ctx, &stream_i, stream)) {
+        return 0;
+    }
+    ARG_CHECK(stream_i.phase == SECP256K1_SCHNORRSIG_STREAM_VERIFY
+        || stream_i.phase == SECP256K1_SCHNORRSIG_STREAM_SIGN_NONCE
+        || stream_i.phase == SECP256K1_SCHNORRSIG_STREAM_SIGN_CHALLENGE);
+
+    secp256k1_sha256_write(&stream_i.sha, data, len);
+    if (stream_i.phase == SECP256K1_SCHNORRSIG_STREAM_SIGN_CHALLENGE) {
+        secp256k1_sha256_write(&stream_i.sha_nonce, data, len);
+    }
+    secp256k1_schnorrsig_stream_save(stream, &stream_i);
+    secp256k1_schnorrsig_stream_internal_clear(&stream_i);
+    return 1;
+}
+
+int secp256k1_schnorrsig_verify_stream_finish(const secp256k1_context* ctx, secp256k1_schnorrsig_stream *stream) {
+    secp256k1_schnorrsig_stream_internal stream_i;
+    secp256k1_scalar s;
+    secp256k1_scalar e;
+    secp256k1_ge pk;
+    secp256k1_fe rx;
+    unsigned char buf[32];
+    int overflow;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(stream != NULL);
+
+    if (!secp256k1_schnorrsig_stream_load(ctx, &stream_i, stream)) {
+        return 0;
+    }
+    ARG_CHECK(stream_i.phase == SECP256K1_SCHNORRSIG_STREAM_VERIFY);
+    memset(stream->data, 0, sizeof(stream->data));
+
+    if (!secp256k1_fe_set_b32_limit(&rx, &stream_i.sig64[0])) {
+        return 0;
+    }
+
+    secp256k1_scalar_set_b32(&s, &stream_i.sig64[32], &overflow);
+    if (overflow) {
+        return 0;
+    }
+
+    secp256k1_ge_from_bytes(&pk, stream_i.key64);
+    secp256k1_sha256_finalize(&stream_i.sha, buf);
+    secp256k1_scalar_set_b32(&e, buf, NULL);
+    return secp256k1_schnorrsig_verify_internal(ctx, &rx, &s, &e, &pk);
+}
+
+int secp256k1_schnorrsig_sign_stream_init(const secp256k1_context* ctx, secp256k1_schnorrsig_stream *stream, const secp256k1_keypair *keypair, const unsigned char *aux_rand32) {
+    secp256k1_schnorrsig_stream_internal stream_i;
+    secp256k1_scalar sk;
+    secp256k1_ge pk;
+    unsigned char masked_key[32];
+    int ret = 1;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(secp256k1_ecmult_gen_context_is_built(&ctx->ecmult_gen_ctx));
+    ARG_CHECK(stream != NULL);
+    ARG_CHECK(keypair != NULL);
+
+    ret &= secp256k1_keypair_load(ctx, &sk, &pk, keypair);
+    /* Because we are signing for a x-only pubkey, the secret key is negated
+     * before signing if the point corresponding to the secret key does not
+     * have an even Y. */
+    if (secp256k1_fe_is_odd(&pk.y)) {
+        secp256k1_scalar_negate(&sk, &sk);
+    }
+
+    memset(&stream_i, 0, sizeof(stream_i));
+    stream_i.phase = SECP256K1_SCHNORRSIG_STREAM_SIGN_NONCE;
+    secp256k1_scalar_get_b32(&stream_i.key64[0], &sk);
+    secp256k1_fe_get_b32(&stream_i.key64[32], &pk.x);
+
+    /* Hash masked-key||pk as nonce_function_bip340 does. The message follows in
+     * the first pass, and is written to a copy of this state in the second. */
+    secp256k1_nonce_function_bip340_masked_key(masked_key, &stream_i.key64[0], aux_rand32);
+    secp256k1_nonce_function_bip340_sha256_tagged(&stream_i.sha);
+    secp256k1_sha256_write(&stream_i.sha, masked_key, 32);
+    secp256k1_sha256_write(&stream_i.sha, &stream_i.key64[32], 32);
+    stream_i.sha_nonce = stream_i.sha;
+
+    secp256k1_schnorrsig_stream_save(stream, &stream_i);
+    secp256k1_schnorrsig_stream_invalidate(ctx, stream, !ret);
+    secp256k1_schnorrsig_stream_internal_clear(&stream_i);
+    secp256k1_scalar_clear(&sk);
+    secp256k1_memclear(masked_key, sizeof(masked_key));
+    return ret;
+}
+
+int secp256k1_schnorrsig_sign_stream_second_pass(const secp256k1_context* ctx, secp256k1_schnorrsig_stream *stream) {
+    secp256k1_schnorrsig_stream_internal stream_i;
+    secp256k1_scalar k;
+    secp256k1_gej rj;
+    secp256k1_ge r;
+    unsigned char buf[32];
+    int ret = 1;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(secp256k1_ecmult_gen_context_is_built(&ctx->ecmult_gen_ctx));
+    ARG_CHECK(stream != NULL);
 
-    secp256k1_ge_set_gej_var(&r, &rj);
-    if (secp256k1_ge_is_infinity(&r)) {
+    if (!secp256k1_schnorrsig_stream_load(ctx, &stream_i, stream)) {
         return 0;
     }
+    ARG_CHECK(stream_i.phase == SECP256K1_SCHNORRSIG_STREAM_SIGN_NONCE);
+
+    secp256k1_sha256_finalize(&stream_i.sha, buf);
+    secp256k1_scalar_set_b32(&k, buf, NULL);
+    ret &= !secp256k1_scalar_is_zero(&k);
+    secp256k1_scalar_cmov(&k, &secp256k1_scalar_one, !ret);
+
+    secp256k1_ecmult_gen(&ctx->ecmult_gen_ctx, &rj, &k);
+    secp256k1_ge_set_gej(&r, &rj);
 
+    /* We declassify r to allow using it as a branch point. This is fine
+     * because r is not a secret. */
+    secp256k1_declassify(ctx, &r, sizeof(r));
     secp256k1_fe_normalize_var(&r.y);
-    return !secp256k1_fe_is_odd(&r.y) &&
-           secp256k1_fe_equal(&rx, &r.x);
+    stream_i.r_odd = secp256k1_fe_is_odd(&r.y);
+    if (stream_i.r_odd) {
+        secp256k1_scalar_negate(&k, &k);
+    }
+    secp256k1_fe_normalize_var(&r.x);
+    secp256k1_fe_get_b32(&stream_i.sig64[0], &r.x);
+    secp256k1_scalar_get_b32(&stream_i.sig64[32], &k);
+
+    /* tagged hash(r.x, pk.x, msg) as in secp256k1_schnorrsig_challenge */
+    stream_i.phase = SECP256K1_SCHNORRSIG_STREAM_SIGN_CHALLENGE;
+    secp256k1_schnorrsig_sha256_tagged(&stream_i.sha);
+    secp256k1_sha256_write(&stream_i.sha, &stream_i.sig64[0], 32);
+    secp256k1_sha256_write(&stream_i.sha, &stream_i.key64[32], 32);
+
+    secp256k1_schnorrsig_stream_save(stream, &stream_i);
+    secp256k1_schnorrsig_stream_invalidate(ctx, stream, !ret);
+    secp256k1_schnorrsig_stream_internal_clear(&stream_i);
+    secp256k1_scalar_clear(&k);
+    secp256k1_gej_clear(&rj);
+    secp256k1_memclear(buf, sizeof(buf));
+    return ret;
+}
+
+int secp256k1_schnorrsig_sign_stream_finish(const secp256k1_context* ctx, unsigned char *sig64, secp256k1_schnorrsig_stream *stream) {
+    secp256k1_schnorrsig_stream_internal stream_i;
+    secp256k1_scalar sk;
+    secp256k1_scalar e;
+    secp256k1_scalar k;
+    secp256k1_scalar k_check;
+    unsigned char buf[32];
+    int ret = 1;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(sig64 != NULL);
+    ARG_CHECK(stream != NULL);
+
+    if (!secp256k1_schnorrsig_stream_load(ctx, &stream_i, stream)) {
+        return 0;
+    }
+    ARG_CHECK(stream_i.phase == SECP256K1_SCHNORRSIG_STREAM_SIGN_CHALLENGE);
+    secp256k1_memclear(stream->data, sizeof(stream->data));
+
+    /* Derive the nonce again from the message of the second pass. If it is not
+     * the nonce of the first pass, the messages differ and the signature would
+     * combine the nonce of one message with the challenge of another. */
+    secp256k1_sha256_finalize(&stream_i.sha_nonce, buf);
+    secp256k1_scalar_set_b32(&k_check, buf, NULL);
+    secp256k1_scalar_cond_negate(&k_check, stream_i.r_odd);
+    secp256k1_scalar_set_b32(&k, &stream_i.sig64[32], NULL);
+    ret &= secp256k1_scalar_eq(&k, &k_check);
+
+    secp256k1_sha256_finalize(&stream_i.sha, buf);
+    secp256k1_scalar_set_b32(&e, buf, NULL);
+    secp256k1_scalar_set_b32(&sk, &stream_i.key64[0], NULL);
+    secp256k1_scalar_mul(&e, &e, &sk);
+    secp256k1_scalar_add(&e, &e, &k);
+    memcpy(&sig64[0], &stream_i.sig64[0], 32);
+    secp256k1_scalar_get_b32(&sig64[32], &e);
+
+    secp256k1_memczero(sig64, 64, !ret);
+    secp256k1_schnorrsig_stream_internal_clear(&stream_i);
+    secp256k1_scalar_clear(&k);
+    secp256k1_scalar_clear(&k_check);
+    secp256k1_scalar_clear(&sk);
+    secp256k1_memclear(buf, sizeof(buf));
+    return ret;
 }
 
 #endif
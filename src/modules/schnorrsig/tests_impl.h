@@ -115,6 +115,12 @@ static void test_schnorrsig_api(void) {
     unsigned char sig[64];
     secp256k1_schnorrsig_extraparams extraparams = SECP256K1_SCHNORRSIG_EXTRAPARAMS_INIT;
     secp256k1_schnorrsig_extraparams invalid_extraparams = {{ 0 }, NULL, NULL};
+    const unsigned char *sigs[2];
+    const unsigned char *msgs[2];
+    size_t msglens[2];
+    const secp256k1_xonly_pubkey *pks[2];
+    size_t invalid_idx;
+    int results[2];
 
     testrand256(sk1);
     testrand256(sk2);
@@ -152,7 +158,72 @@ static void test_schnorrsig_api(void) {
     CHECK_ILLEGAL(CTX, secp256k1_schnorrsig_verify(CTX, sig, NULL, sizeof(msg), &pk[0]));
     CHECK(secp256k1_schnorrsig_verify(CTX, sig, NULL, 0, &pk[0]) == 0);
     CHECK_ILLEGAL(CTX, secp256k1_schnorrsig_verify(CTX, sig, msg, sizeof(msg), NULL));
+
+    {
+        secp256k1_pubkey full_pk;
+        secp256k1_prepared_pubkey *prepared;
+
+        CHECK(secp256k1_keypair_pub(CTX, &full_pk, &keypairs[0]) == 1);
+        prepared = secp256k1_prepared_pubkey_create(CTX, &full_pk);
+        CHECK(prepared != NULL);
+        CHECK(secp256k1_schnorrsig_verify_prepared(CTX, sig, msg, sizeof(msg), prepared) == 1);
+        CHECK_ILLEGAL(CTX, secp256k1_schnorrsig_verify_prepared(CTX, NULL, msg, sizeof(msg), prepared));
+        CHECK_ILLEGAL(CTX, secp256k1_schnorrsig_verify_prepared(CTX, sig, NULL, sizeof(msg), prepared));
+        CHECK(secp256k1_schnorrsig_verify_prepared(CTX, sig, NULL, 0, prepared) == 0);
+        CHECK_ILLEGAL(CTX, secp256k1_schnorrsig_verify_prepared(CTX, sig, msg, sizeof(msg), NULL));
+        secp256k1_prepared_pubkey_destroy(CTX, prepared);
+    }
     CHECK_ILLEGAL(CTX, secp256k1_schnorrsig_verify(CTX, sig, msg, sizeof(msg), &zero_pk));
+
+    sigs[0] = sigs[1] = sig;
+    msgs[0] = msgs[1] = msg;
+    msglens[0] = msglens[1] = sizeof(msg);
+    pks[0] = pks[1] = &pk[0];
+    CHECK(secp256k1_schnorrsig_verify_batch(CTX, &invalid_idx, sigs, msgs, msglens, pks, 2) == 1);
+    CHECK(secp256k1_schnorrsig_verify_batch(CTX, NULL, sigs, msgs, msglens, pks, 2) == 1);
+    CHECK(secp256k1_schnorrsig_verify_batch(CTX, NULL, NULL, NULL, NULL, NULL, 0) == 1);
+    CHECK_ILLEGAL(CTX, secp256k1_schnorrsig_verify_batch(CTX, NULL, NULL, msgs, msglens, pks, 2));
+    CHECK_ILLEGAL(CTX, secp256k1_schnorrsig_verify_batch(CTX, NULL, sigs, NULL, msglens, pks, 2));
+    CHECK_ILLEGAL(CTX, secp256k1_schnorrsig_verify_batch(CTX, NULL, sigs, msgs, NULL, pks, 2));
+    CHECK_ILLEGAL(CTX, secp256k1_schnorrsig_verify_batch(CTX, NULL, sigs, msgs, msglens, NULL, 2));
+    sigs[1] = NULL;
+    CHECK_ILLEGAL(CTX, secp256k1_schnorrsig_verify_batch(CTX, NULL, sigs, msgs, msglens, pks, 2));
+    sigs[1] = sig;
+    msgs[1] = NULL;
+    CHECK_ILLEGAL(CTX, secp256k1_schnorrsig_verify_batch(CTX, NULL, sigs, msgs, msglens, pks, 2));
+    msglens[1] = 0;
+    CHECK(secp256k1_schnorrsig_verify_batch(CTX, &invalid_idx, sigs, msgs, msglens, pks, 2) == 0);
+    CHECK(invalid_idx == 1);
+    msgs[1] = msg;
+    msglens[1] = sizeof(msg);
+    pks[1] = NULL;
+    CHECK_ILLEGAL(CTX, secp256k1_schnorrsig_verify_batch(CTX, NULL, sigs, msgs, msglens, pks, 2));
+    pks[1] = &zero_pk;
+    CHECK_ILLEGAL(CTX, secp256k1_schnorrsig_verify_batch(CTX, NULL, sigs, msgs, msglens, pks, 2));
+
+    pks[1] = &pk[0];
+    CHECK(secp256k1_schnorrsig_verify_many(CTX, results, sigs, msgs, msglens, pks, 2) == 1);
+    CHECK(results[0] == 1 && results[1] == 1);
+    CHECK(secp256k1_schnorrsig_verify_many(CTX, NULL, sigs, msgs, msglens, pks, 2) == 1);
+    CHECK(secp256k1_schnorrsig_verify_many(CTX, NULL, NULL, NULL, NULL, NULL, 0) == 1);
+    CHECK_ILLEGAL(CTX, secp256k1_schnorrsig_verify_many(CTX, results, NULL, msgs, msglens, pks, 2));
+    CHECK_ILLEGAL(CTX, secp256k1_schnorrsig_verify_many(CTX, results, sigs, NULL, msglens, pks, 2));
+    CHECK_ILLEGAL(CTX, secp256k1_schnorrsig_verify_many(CTX, results, sigs, msgs, NULL, pks, 2));
+    CHECK_ILLEGAL(CTX, secp256k1_schnorrsig_verify_many(CTX, results, sigs, msgs, msglens, NULL, 2));
+    sigs[1] = NULL;
+    CHECK_ILLEGAL(CTX, secp256k1_schnorrsig_verify_many(CTX, results, sigs, msgs, msglens, pks, 2));
+    sigs[1] = sig;
+    msgs[1] = NULL;
+    CHECK_ILLEGAL(CTX, secp256k1_schnorrsig_verify_many(CTX, results, sigs, msgs, msglens, pks, 2));
+    msglens[1] = 0;
+    CHECK(secp256k1_schnorrsig_verify_many(CTX, results, sigs, msgs, msglens, pks, 2) == 0);
+    CHECK(results[0] == 1 && results[1] == 0);
+    msgs[1] = msg;
+    msglens[1] = sizeof(msg);
+    pks[1] = NULL;
+    CHECK_ILLEGAL(CTX, secp256k1_schnorrsig_verify_many(CTX, results, sigs, msgs, msglens, pks, 2));
+    pks[1] = &zero_pk;
+    CHECK_ILLEGAL(CTX, secp256k1_schnorrsig_verify_many(CTX, results, sigs, msgs, msglens, pks, 2));
 }
 
 /* Checks that hash initialized by secp256k1_schnorrsig_sha256_tagged has the
@@ -167,6 +238,18 @@ static void test_schnorrsig_sha256_tagged(void) {
     test_sha256_eq(&sha, &sha_optimized);
 }
 
+/* Writes msg to a stream in chunks of random lengths. */
+static void schnorrsig_stream_write_chunks(secp256k1_schnorrsig_stream *stream, const unsigned char *msg, size_t msglen) {
+    size_t len;
+
+    while (msglen > 0) {
+        len = testrand_int(msglen) + 1;
+        CHECK(secp256k1_schnorrsig_stream_write(CTX, stream, msg, len) == 1);
+        msg += len;
+        msglen -= len;
+    }
+}
+
 /* Helper function for schnorrsig_bip_vectors
  * Signs the message and checks that it's the same as expected_sig. */
 static void test_schnorrsig_bip_vectors_check_signing(const unsigned char *sk, const unsigned char *pk_serialized, const unsigned char *aux_rand, const unsigned char *msg, size_t msglen, const unsigned char *expected_sig) {
@@ -185,6 +268,17 @@ static void test_schnorrsig_bip_vectors_check_signing(const unsigned char *sk, c
         CHECK(secp256k1_schnorrsig_sign32(CTX, sig, msg, &keypair, aux_rand));
         CHECK(secp256k1_memcmp_var(sig, expected_sig, 64) == 0);
     }
+    {
+        secp256k1_schnorrsig_stream stream;
+
+        memset(sig, 0, 64);
+        CHECK(secp256k1_schnorrsig_sign_stream_init(CTX, &stream, &keypair, aux_rand));
+        schnorrsig_stream_write_chunks(&stream, msg, msglen);
+        CHECK(secp256k1_schnorrsig_sign_stream_second_pass(CTX, &stream));
+        schnorrsig_stream_write_chunks(&stream, msg, msglen);
+        CHECK(secp256k1_schnorrsig_sign_stream_finish(CTX, sig, &stream));
+        CHECK(secp256k1_memcmp_var(sig, expected_sig, 64) == 0);
+    }
 
     CHECK(secp256k1_xonly_pubkey_parse(CTX, &pk_expected, pk_serialized));
     CHECK(secp256k1_keypair_xonly_pub(CTX, &pk, NULL, &keypair));
@@ -192,13 +286,82 @@ static void test_schnorrsig_bip_vectors_check_signing(const unsigned char *sk, c
     CHECK(secp256k1_schnorrsig_verify(CTX, sig, msg, msglen, &pk));
 }
 
+/* Stores the result in the int pointed to by data, which must be -1, so that
+ * every callback can only be called once. */
+static void schnorrsig_verify_queue_test_callback(int result, void *data) {
+    int *res = (int *)data;
+    CHECK(*res == -1);
+    *res = result;
+}
+
 /* Helper function for schnorrsig_bip_vectors
- * Checks that both verify and verify_batch (TODO) return the same value as expected. */
+ * Checks that verify, verify_many, verify_batch, a verify_queue and a
+ * verification stream return the same value as expected. */
 static void test_schnorrsig_bip_vectors_check_verify(const unsigned char *pk_serialized, const unsigned char *msg, size_t msglen, const unsigned char *sig, int expected) {
     secp256k1_xonly_pubkey pk;
+    const unsigned char *sigs[2];
+    const unsigned char *msgs[2];
+    size_t msglens[2];
+    const secp256k1_xonly_pubkey *pks[2];
+    size_t invalid_idx = 2;
+    size_t i;
 
     CHECK(secp256k1_xonly_pubkey_parse(CTX, &pk, pk_serialized));
     CHECK(expected == secp256k1_schnorrsig_verify(CTX, sig, msg, msglen, &pk));
+    {
+        secp256k1_schnorrsig_stream stream;
+
+        CHECK(secp256k1_schnorrsig_verify_stream_init(CTX, &stream, sig, &pk));
+        schnorrsig_stream_write_chunks(&stream, msg, msglen);
+        CHECK(expected == secp256k1_schnorrsig_verify_stream_finish(CTX, &stream));
+    }
+
+    /* Prepared public keys with either Y coordinate */
+    for (i = 0; i < 2; i++) {
+        unsigned char pk33[33];
+        secp256k1_pubkey full_pk;
+        secp256k1_prepared_pubkey *prepared;
+
+        pk33[0] = SECP256K1_TAG_PUBKEY_EVEN + i;
+        memcpy(&pk33[1], pk_serialized, 32);
+        CHECK(secp256k1_ec_pubkey_parse(CTX, &full_pk, pk33, sizeof(pk33)));
+        prepared = secp256k1_prepared_pubkey_create(CTX, &full_pk);
+        CHECK(prepared != NULL);
+        CHECK(expected == secp256k1_schnorrsig_verify_prepared(CTX, sig, msg, msglen, prepared));
+        secp256k1_prepared_pubkey_destroy(CTX, prepared);
+    }
+
+    /* A batch of two is the smallest one that is not verified individually */
+    for (i = 0; i < 2; i++) {
+        sigs[i] = sig;
+        msgs[i] = msg;
+        msglens[i] = msglen;
+        pks[i] = &pk;
+    }
+    CHECK(expected == secp256k1_schnorrsig_verify_batch(CTX, &invalid_idx, sigs, msgs, msglens, pks, 2));
+    CHECK(invalid_idx == (expected ? 2 : 0));
+    {
+        int results[2] = { -1, -1 };
+        CHECK(expected == secp256k1_schnorrsig_verify_many(CTX, results, sigs, msgs, msglens, pks, 2));
+        CHECK(results[0] == expected && results[1] == expected);
+    }
+
+    /* Queues of one and two signatures */
+    for (i = 1; i <= 2; i++) {
+        secp256k1_schnorrsig_verify_queue *queue = secp256k1_schnorrsig_verify_queue_create(CTX, 2);
+        int results[2] = { -1, -1 };
+        size_t j;
+
+        CHECK(queue != NULL);
+        for (j = 0; j < i; j++) {
+            CHECK(secp256k1_schnorrsig_verify_queue_add(CTX, queue, sig, msg, msglen, &pk, schnorrsig_verify_queue_test_callback, &results[j]));
+        }
+        CHECK(expected == secp256k1_schnorrsig_verify_queue_flush(CTX, queue));
+        for (j = 0; j < i; j++) {
+            CHECK(results[j] == expected);
+        }
+        secp256k1_schnorrsig_verify_queue_destroy(CTX, queue);
+    }
 }
 
 /* Test vectors according to BIP-340 ("Schnorr Signatures for secp256k1"). See
@@ -850,12 +1013,17 @@ static void test_schnorrsig_sign(void) {
 
 #define N_SIGS 3
 /* Creates N_SIGS valid signatures and verifies them with verify and
- * verify_batch (TODO). Then flips some bits and checks that verification now
+ * verify_batch. Then flips some bits and checks that verification now
  * fails. */
 static void test_schnorrsig_sign_verify(void) {
     unsigned char sk[32];
     unsigned char msg[N_SIGS][32];
     unsigned char sig[N_SIGS][64];
+    const unsigned char *sig_ptr[N_SIGS];
+    const unsigned char *msg_ptr[N_SIGS];
+    size_t msglens[N_SIGS];
+    const secp256k1_xonly_pubkey *pk_ptr[N_SIGS];
+    size_t invalid_idx;
     size_t i;
     secp256k1_keypair keypair;
     secp256k1_xonly_pubkey pk;
@@ -869,30 +1037,59 @@ static void test_schnorrsig_sign_verify(void) {
         testrand256(msg[i]);
         CHECK(secp256k1_schnorrsig_sign32(CTX, sig[i], msg[i], &keypair, NULL));
         CHECK(secp256k1_schnorrsig_verify(CTX, sig[i], msg[i], sizeof(msg[i]), &pk));
+        sig_ptr[i] = sig[i];
+        msg_ptr[i] = msg[i];
+        msglens[i] = sizeof(msg[i]);
+        pk_ptr[i] = &pk;
+    }
+    CHECK(secp256k1_schnorrsig_verify_batch(CTX, NULL, sig_ptr, msg_ptr, msglens, pk_ptr, N_SIGS));
+    {
+        /* The signatures verify with the prepared public key of the keypair,
+         * whose Y coordinate may be odd */
+        secp256k1_pubkey full_pk;
+        secp256k1_prepared_pubkey *prepared;
+
+        CHECK(secp256k1_keypair_pub(CTX, &full_pk, &keypair));
+        prepared = secp256k1_prepared_pubkey_create(CTX, &full_pk);
+        CHECK(prepared != NULL);
+        for (i = 0; i < N_SIGS; i++) {
+            CHECK(secp256k1_schnorrsig_verify_prepared(CTX, sig[i], msg[i], sizeof(msg[i]), prepared));
+            msg[i][0] ^= 1;
+            CHECK(!secp256k1_schnorrsig_verify_prepared(CTX, sig[i], msg[i], sizeof(msg[i]), prepared));
+            msg[i][0] ^= 1;
+        }
+        secp256k1_prepared_pubkey_destroy(CTX, prepared);
     }
 
     {
         /* Flip a few bits in the signature and in the message and check that
-         * verify and verify_batch (TODO) fail */
+         * verify and verify_batch fail */
         size_t sig_idx = testrand_int(N_SIGS);
         size_t byte_idx = testrand_bits(5);
         unsigned char xorbyte = testrand_int(254)+1;
         sig[sig_idx][byte_idx] ^= xorbyte;
         CHECK(!secp256k1_schnorrsig_verify(CTX, sig[sig_idx], msg[sig_idx], sizeof(msg[sig_idx]), &pk));
+        CHECK(!secp256k1_schnorrsig_verify_batch(CTX, &invalid_idx, sig_ptr, msg_ptr, msglens, pk_ptr, N_SIGS));
+        CHECK(invalid_idx == sig_idx);
         sig[sig_idx][byte_idx] ^= xorbyte;
 
         byte_idx = testrand_bits(5);
         sig[sig_idx][32+byte_idx] ^= xorbyte;
         CHECK(!secp256k1_schnorrsig_verify(CTX, sig[sig_idx], msg[sig_idx], sizeof(msg[sig_idx]), &pk));
+        CHECK(!secp256k1_schnorrsig_verify_batch(CTX, &invalid_idx, sig_ptr, msg_ptr, msglens, pk_ptr, N_SIGS));
+        CHECK(invalid_idx == sig_idx);
         sig[sig_idx][32+byte_idx] ^= xorbyte;
 
         byte_idx = testrand_bits(5);
         msg[sig_idx][byte_idx] ^= xorbyte;
         CHECK(!secp256k1_schnorrsig_verify(CTX, sig[sig_idx], msg[sig_idx], sizeof(msg[sig_idx]), &pk));
+        CHECK(!secp256k1_schnorrsig_verify_batch(CTX, &invalid_idx, sig_ptr, msg_ptr, msglens, pk_ptr, N_SIGS));
+        CHECK(invalid_idx == sig_idx);
         msg[sig_idx][byte_idx] ^= xorbyte;
 
         /* Check that above bitflips have been reversed correctly */
         CHECK(secp256k1_schnorrsig_verify(CTX, sig[sig_idx], msg[sig_idx], sizeof(msg[sig_idx]), &pk));
+        CHECK(secp256k1_schnorrsig_verify_batch(CTX, NULL, sig_ptr, msg_ptr, msglens, pk_ptr, N_SIGS));
     }
 
     /* Test overflowing s */
@@ -929,6 +1126,403 @@ static void test_schnorrsig_sign_verify(void) {
 }
 #undef N_SIGS
 
+#define N_SIGS 64
+/* Checks batch verification of many signatures against individual
+ * verification, including batches that run out of space and have to be
+ * verified in several parts. */
+static void test_schnorrsig_verify_batch(void) {
+    unsigned char msg[N_SIGS][64];
+    unsigned char sig[N_SIGS][64];
+    secp256k1_xonly_pubkey pk[N_SIGS];
+    const unsigned char *sig_ptr[N_SIGS];
+    const unsigned char *msg_ptr[N_SIGS];
+    size_t msglen[N_SIGS];
+    const secp256k1_xonly_pubkey *pk_ptr[N_SIGS];
+    /* Capacities of 2 and 3 fit a single signature, 5 fits two */
+    const size_t capacities[] = { 2, 3, 5, 2*N_SIGS };
+    size_t invalid_idx;
+    size_t i, j;
+
+    for (i = 0; i < N_SIGS; i++) {
+        unsigned char sk[32];
+        secp256k1_keypair keypair;
+
+        testrand256(sk);
+        testrand256(msg[i]);
+        testrand256(&msg[i][32]);
+        msglen[i] = testrand_int(sizeof(msg[i]) + 1);
+        CHECK(secp256k1_keypair_create(CTX, &keypair, sk));
+        CHECK(secp256k1_keypair_xonly_pub(CTX, &pk[i], NULL, &keypair));
+        CHECK(secp256k1_schnorrsig_sign_custom(CTX, sig[i], msg[i], msglen[i], &keypair, NULL));
+        sig_ptr[i] = sig[i];
+        msg_ptr[i] = msglen[i] == 0 ? NULL : msg[i];
+        pk_ptr[i] = &pk[i];
+    }
+    CHECK(secp256k1_schnorrsig_verify_batch(CTX, &invalid_idx, sig_ptr, msg_ptr, msglen, pk_ptr, N_SIGS));
+
+    for (i = 0; i < sizeof(capacities)/sizeof(capacities[0]); i++) {
+        secp256k1_scratch *scratch = secp256k1_scratch_create(&CTX->error_callback, secp256k1_ecmult_batch_scratch_size(capacities[i]));
+        secp256k1_ecmult_batch batch;
+        size_t idx1 = testrand_int(N_SIGS);
+        size_t idx2 = testrand_int(N_SIGS);
+        size_t n_sigs = 1 + testrand_int(N_SIGS);
+
+        CHECK(secp256k1_ecmult_batch_init(&CTX->error_callback, &secp256k1_ecmult_multi_params_default, &batch, scratch, capacities[i]));
+        CHECK(secp256k1_schnorrsig_verify_batch_internal(CTX, &batch, &invalid_idx, sig_ptr, msg_ptr, msglen, pk_ptr, N_SIGS));
+        CHECK(secp256k1_schnorrsig_verify_batch_internal(CTX, &batch, &invalid_idx, sig_ptr, msg_ptr, msglen, pk_ptr, n_sigs));
+
+        /* Invalidate up to two signatures, the first one must be found */
+        sig[idx1][32 + testrand_bits(5)] ^= 1 + testrand_int(255);
+        sig[idx2][testrand_bits(5)] ^= 1 + testrand_int(255);
+        for (j = 0; j < N_SIGS; j++) {
+            CHECK(secp256k1_schnorrsig_verify(CTX, sig[j], msg_ptr[j], msglen[j], &pk[j]) == (j != idx1 && j != idx2));
+        }
+        invalid_idx = N_SIGS;
+        CHECK(!secp256k1_schnorrsig_verify_batch_internal(CTX, &batch, &invalid_idx, sig_ptr, msg_ptr, msglen, pk_ptr, N_SIGS));
+        CHECK(invalid_idx == (idx1 < idx2 ? idx1 : idx2));
+        CHECK(!secp256k1_schnorrsig_verify_batch_internal(CTX, &batch, NULL, sig_ptr, msg_ptr, msglen, pk_ptr, N_SIGS));
+
+        /* Signatures after the invalid ones don't affect the result */
+        CHECK(secp256k1_schnorrsig_verify_batch_internal(CTX, &batch, &invalid_idx, sig_ptr, msg_ptr, msglen, pk_ptr, idx1 < idx2 ? idx1 : idx2));
+
+        secp256k1_ecmult_batch_clear(&CTX->error_callback, &batch);
+        secp256k1_scratch_destroy(&CTX->error_callback, scratch);
+
+        CHECK(!secp256k1_schnorrsig_verify_batch(CTX, &invalid_idx, sig_ptr, msg_ptr, msglen, pk_ptr, N_SIGS));
+        CHECK(invalid_idx == (idx1 < idx2 ? idx1 : idx2));
+        /* Restore the signatures */
+        for (j = 0; j < N_SIGS; j++) {
+            if (j == idx1 || j == idx2) {
+                secp256k1_keypair keypair;
+                unsigned char sk[32];
+                testrand256(sk);
+                CHECK(secp256k1_keypair_create(CTX, &keypair, sk));
+                CHECK(secp256k1_keypair_xonly_pub(CTX, &pk[j], NULL, &keypair));
+                CHECK(secp256k1_schnorrsig_sign_custom(CTX, sig[j], msg_ptr[j], msglen[j], &keypair, NULL));
+            }
+        }
+    }
+}
+#undef N_SIGS
+
+#define N_SIGS 11
+/* Checks that secp256k1_schnorrsig_verify_many gives the same results as
+ * verifying the signatures one by one. */
+static void test_schnorrsig_verify_many(void) {
+    unsigned char msg[N_SIGS][32];
+    unsigned char sig[N_SIGS][64];
+    secp256k1_xonly_pubkey pk[N_SIGS];
+    const unsigned char *sig_ptr[N_SIGS];
+    const unsigned char *msg_ptr[N_SIGS];
+    size_t msglen[N_SIGS];
+    const secp256k1_xonly_pubkey *pk_ptr[N_SIGS];
+    int results[N_SIGS];
+    size_t n_sigs = testrand_int(N_SIGS + 1);
+    int all_valid = 1;
+    int ret;
+    size_t i;
+
+    for (i = 0; i < n_sigs; i++) {
+        unsigned char sk[32];
+        secp256k1_keypair keypair;
+
+        testrand256(sk);
+        testrand256(msg[i]);
+        msglen[i] = testrand_int(sizeof(msg[i]) + 1);
+        CHECK(secp256k1_keypair_create(CTX, &keypair, sk));
+        CHECK(secp256k1_keypair_xonly_pub(CTX, &pk[i], NULL, &keypair));
+        CHECK(secp256k1_schnorrsig_sign_custom(CTX, sig[i], msg[i], msglen[i], &keypair, NULL));
+        switch (testrand_int(6)) {
+        case 0:
+            /* Wrong message */
+            msg[i][testrand_int(32)] ^= 1 + testrand_int(255);
+            msglen[i] = sizeof(msg[i]);
+            break;
+        case 1:
+            /* Wrong r or s */
+            sig[i][testrand_bits(6)] ^= 1 + testrand_int(255);
+            break;
+        case 2:
+            /* Overflowing r or s */
+            memset(&sig[i][testrand_bits(1) * 32], 0xFF, 32);
+            break;
+        }
+        sig_ptr[i] = sig[i];
+        msg_ptr[i] = msglen[i] == 0 ? NULL : msg[i];
+        pk_ptr[i] = &pk[i];
+    }
+
+    memset(results, 0xff, sizeof(results));
+    ret = secp256k1_schnorrsig_verify_many(CTX, results, sig_ptr, msg_ptr, msglen, pk_ptr, n_sigs);
+    for (i = 0; i < n_sigs; i++) {
+        int expected = secp256k1_schnorrsig_verify(CTX, sig[i], msg_ptr[i], msglen[i], &pk[i]);
+        CHECK(results[i] == expected);
+        all_valid &= expected;
+    }
+    CHECK(ret == all_valid);
+    CHECK(secp256k1_schnorrsig_verify_many(CTX, NULL, sig_ptr, msg_ptr, msglen, pk_ptr, n_sigs) == all_valid);
+}
+#undef N_SIGS
+
+#define N_SIGS 64
+/* Checks that a verification queue reports the same results as individual
+ * verification, for queues that are flushed explicitly and automatically. */
+static void test_schnorrsig_verify_queue(void) {
+    unsigned char msg[N_SIGS][32];
+    unsigned char sig[N_SIGS][64];
+    secp256k1_xonly_pubkey pk[N_SIGS];
+    int results[N_SIGS];
+    const size_t capacities[] = { 1, 2, 7, N_SIGS - 1, N_SIGS };
+    secp256k1_schnorrsig_verify_queue *queue;
+    size_t i, j;
+
+    for (i = 0; i < N_SIGS; i++) {
+        unsigned char sk[32];
+        secp256k1_keypair keypair;
+
+        testrand256(sk);
+        testrand256(msg[i]);
+        CHECK(secp256k1_keypair_create(CTX, &keypair, sk));
+        CHECK(secp256k1_keypair_xonly_pub(CTX, &pk[i], NULL, &keypair));
+        CHECK(secp256k1_schnorrsig_sign32(CTX, sig[i], msg[i], &keypair, NULL));
+    }
+    /* Invalidate a few signatures, some of them next to each other */
+    for (i = 0; i < 4; i++) {
+        size_t idx = testrand_int(N_SIGS);
+        sig[idx][testrand_bits(6)] ^= 1 + testrand_int(255);
+        if (i == 0 && idx + 1 < N_SIGS) {
+            msg[idx + 1][0] ^= 1;
+        }
+    }
+
+    for (i = 0; i < sizeof(capacities)/sizeof(capacities[0]); i++) {
+        int all_valid = 1;
+        int flushed;
+
+        queue = secp256k1_schnorrsig_verify_queue_create(CTX, capacities[i]);
+        CHECK(queue != NULL);
+        for (j = 0; j < N_SIGS; j++) {
+            results[j] = -1;
+            CHECK(secp256k1_schnorrsig_verify_queue_add(CTX, queue, sig[j], msg[j], sizeof(msg[j]), &pk[j], schnorrsig_verify_queue_test_callback, &results[j]));
+        }
+        flushed = secp256k1_schnorrsig_verify_queue_flush(CTX, queue);
+        for (j = 0; j < N_SIGS; j++) {
+            int expected = secp256k1_schnorrsig_verify(CTX, sig[j], msg[j], sizeof(msg[j]), &pk[j]);
+            CHECK(results[j] == expected);
+            if (N_SIGS - j <= (N_SIGS - 1) % capacities[i] + 1) {
+                /* This signature was in the queue when it was flushed */
+                all_valid &= expected;
+            }
+        }
+        CHECK(flushed == all_valid);
+        /* Flushing an empty queue succeeds */
+        CHECK(secp256k1_schnorrsig_verify_queue_flush(CTX, queue) == 1);
+        secp256k1_schnorrsig_verify_queue_destroy(CTX, queue);
+    }
+
+    /* Signatures without a callback still affect the result of flushing, and
+     * destroying a queue discards the signatures in it */
+    queue = secp256k1_schnorrsig_verify_queue_create(CTX, 4);
+    CHECK(queue != NULL);
+    for (i = 0; i < 2; i++) {
+        CHECK(secp256k1_schnorrsig_verify_queue_add(CTX, queue, sig[0], msg[1], sizeof(msg[1]), &pk[0], NULL, NULL));
+        CHECK(secp256k1_schnorrsig_verify_queue_add(CTX, queue, sig[1], msg[1], sizeof(msg[1]), &pk[0], NULL, NULL));
+        CHECK(secp256k1_schnorrsig_verify_queue_flush(CTX, queue) == 0);
+    }
+    results[0] = -1;
+    CHECK(secp256k1_schnorrsig_verify_queue_add(CTX, queue, sig[0], msg[0], sizeof(msg[0]), &pk[0], schnorrsig_verify_queue_test_callback, &results[0]));
+    secp256k1_schnorrsig_verify_queue_destroy(CTX, queue);
+    CHECK(results[0] == -1);
+}
+#undef N_SIGS
+
+static void test_schnorrsig_verify_queue_api(void) {
+    unsigned char sk[32];
+    unsigned char msg[32];
+    unsigned char sig[64];
+    secp256k1_keypair keypair;
+    secp256k1_xonly_pubkey pk;
+    secp256k1_xonly_pubkey zero_pk;
+    secp256k1_schnorrsig_verify_queue *queue;
+    int result = -1;
+
+    memset(&zero_pk, 0, sizeof(zero_pk));
+    testrand256(sk);
+    testrand256(msg);
+    CHECK(secp256k1_keypair_create(CTX, &keypair, sk));
+    CHECK(secp256k1_keypair_xonly_pub(CTX, &pk, NULL, &keypair));
+    CHECK(secp256k1_schnorrsig_sign32(CTX, sig, msg, &keypair, NULL));
+
+    CHECK(secp256k1_schnorrsig_verify_queue_create(CTX, 0) == NULL);
+    CHECK(secp256k1_schnorrsig_verify_queue_create(CTX, SIZE_MAX) == NULL);
+    queue = secp256k1_schnorrsig_verify_queue_create(CTX, 1);
+    CHECK(queue != NULL);
+
+    CHECK(secp256k1_schnorrsig_verify_queue_add(CTX, queue, sig, msg, sizeof(msg), &pk, schnorrsig_verify_queue_test_callback, &result) == 1);
+    CHECK_ILLEGAL(CTX, secp256k1_schnorrsig_verify_queue_add(CTX, NULL, sig, msg, sizeof(msg), &pk, NULL, NULL));
+    CHECK_ILLEGAL(CTX, secp256k1_schnorrsig_verify_queue_add(CTX, queue, NULL, msg, sizeof(msg), &pk, NULL, NULL));
+    CHECK_ILLEGAL(CTX, secp256k1_schnorrsig_verify_queue_add(CTX, queue, sig, NULL, sizeof(msg), &pk, NULL, NULL));
+    CHECK_ILLEGAL(CTX, secp256k1_schnorrsig_verify_queue_add(CTX, queue, sig, msg, sizeof(msg), NULL, NULL, NULL));
+    CHECK_ILLEGAL(CTX, secp256k1_schnorrsig_verify_queue_add(CTX, queue, sig, msg, sizeof(msg), &zero_pk, schnorrsig_verify_queue_test_callback, &result));
+    CHECK_ILLEGAL(CTX, secp256k1_schnorrsig_verify_queue_flush(CTX, NULL));
+    /* Illegal calls leave the queue untouched */
+    CHECK(result == -1);
+    CHECK(secp256k1_schnorrsig_verify_queue_flush(CTX, queue) == 1);
+    CHECK(result == 1);
+
+    /* An empty message can be NULL */
+    CHECK(secp256k1_schnorrsig_sign_custom(CTX, sig, NULL, 0, &keypair, NULL));
+    result = -1;
+    CHECK(secp256k1_schnorrsig_verify_queue_add(CTX, queue, sig, NULL, 0, &pk, schnorrsig_verify_queue_test_callback, &result) == 1);
+    CHECK(secp256k1_schnorrsig_verify_queue_flush(CTX, queue) == 1);
+    CHECK(result == 1);
+
+    secp256k1_schnorrsig_verify_queue_destroy(CTX, queue);
+    secp256k1_schnorrsig_verify_queue_destroy(CTX, NULL);
+}
+
+static void test_schnorrsig_stream_api(void) {
+    unsigned char sk[32];
+    unsigned char msg[32];
+    unsigned char sig[64];
+    unsigned char zeros64[64] = { 0 };
+    secp256k1_keypair keypair;
+    secp256k1_keypair invalid_keypair = {{ 0 }};
+    secp256k1_xonly_pubkey pk;
+    secp256k1_xonly_pubkey zero_pk;
+    secp256k1_schnorrsig_stream stream;
+    secp256k1_schnorrsig_stream invalid_stream;
+
+    testrand256(sk);
+    testrand256(msg);
+    CHECK(secp256k1_keypair_create(CTX, &keypair, sk));
+    CHECK(secp256k1_keypair_xonly_pub(CTX, &pk, NULL, &keypair));
+    memset(&zero_pk, 0, sizeof(zero_pk));
+    memset(&invalid_stream, 0, sizeof(invalid_stream));
+
+    CHECK(secp256k1_schnorrsig_sign_stream_init(CTX, &stream, &keypair, NULL) == 1);
+    CHECK_ILLEGAL(CTX, secp256k1_schnorrsig_sign_stream_init(CTX, NULL, &keypair, NULL));
+    CHECK_ILLEGAL(CTX, secp256k1_schnorrsig_sign_stream_init(CTX, &stream, NULL, NULL));
+    CHECK_ILLEGAL(STATIC_CTX, secp256k1_schnorrsig_sign_stream_init(STATIC_CTX, &stream, &keypair, NULL));
+    CHECK_ILLEGAL(CTX, secp256k1_schnorrsig_sign_stream_init(CTX, &stream, &invalid_keypair, NULL));
+    /* A stream is unusable after failed initialization */
+    CHECK_ILLEGAL(CTX, secp256k1_schnorrsig_stream_write(CTX, &stream, msg, sizeof(msg)));
+
+    CHECK(secp256k1_schnorrsig_sign_stream_init(CTX, &stream, &keypair, NULL) == 1);
+    CHECK(secp256k1_schnorrsig_stream_write(CTX, &stream, msg, sizeof(msg)) == 1);
+    CHECK(secp256k1_schnorrsig_stream_write(CTX, &stream, NULL, 0) == 1);
+    CHECK_ILLEGAL(CTX, secp256k1_schnorrsig_stream_write(CTX, NULL, msg, sizeof(msg)));
+    CHECK_ILLEGAL(CTX, secp256k1_schnorrsig_stream_write(CTX, &stream, NULL, sizeof(msg)));
+    CHECK_ILLEGAL(CTX, secp256k1_schnorrsig_stream_write(CTX, &invalid_stream, msg, sizeof(msg)));
+    /* Calls in the wrong phase */
+    CHECK_ILLEGAL(CTX, secp256k1_schnorrsig_sign_stream_finish(CTX, sig, &stream));
+    CHECK_ILLEGAL(CTX, secp256k1_schnorrsig_verify_stream_finish(CTX, &stream));
+    CHECK_ILLEGAL(CTX, secp256k1_schnorrsig_sign_stream_second_pass(CTX, NULL));
+    CHECK_ILLEGAL(CTX, secp256k1_schnorrsig_sign_stream_second_pass(CTX, &invalid_stream));
+    CHECK_ILLEGAL(STATIC_CTX, secp256k1_schnorrsig_sign_stream_second_pass(STATIC_CTX, &stream));
+    CHECK(secp256k1_schnorrsig_sign_stream_second_pass(CTX, &stream) == 1);
+    CHECK_ILLEGAL(CTX, secp256k1_schnorrsig_sign_stream_second_pass(CTX, &stream));
+    CHECK(secp256k1_schnorrsig_stream_write(CTX, &stream, msg, sizeof(msg)) == 1);
+    CHECK_ILLEGAL(CTX, secp256k1_schnorrsig_sign_stream_finish(CTX, NULL, &stream));
+    CHECK_ILLEGAL(CTX, secp256k1_schnorrsig_sign_stream_finish(CTX, sig, NULL));
+    CHECK_ILLEGAL(CTX, secp256k1_schnorrsig_sign_stream_finish(CTX, sig, &invalid_stream));
+    CHECK(secp256k1_schnorrsig_sign_stream_finish(CTX, sig, &stream) == 1);
+    /* The stream is cleared after finishing */
+    CHECK(secp256k1_memcmp_var(stream.data, invalid_stream.data, sizeof(stream.data)) == 0);
+    CHECK_ILLEGAL(CTX, secp256k1_schnorrsig_sign_stream_finish(CTX, sig, &stream));
+
+    CHECK(secp256k1_schnorrsig_verify_stream_init(CTX, &stream, sig, &pk) == 1);
+    CHECK_ILLEGAL(CTX, secp256k1_schnorrsig_verify_stream_init(CTX, NULL, sig, &pk));
+    CHECK_ILLEGAL(CTX, secp256k1_schnorrsig_verify_stream_init(CTX, &stream, NULL, &pk));
+    CHECK_ILLEGAL(CTX, secp256k1_schnorrsig_verify_stream_init(CTX, &stream, sig, NULL));
+    CHECK_ILLEGAL(CTX, secp256k1_schnorrsig_verify_stream_init(CTX, &stream, sig, &zero_pk));
+    /* A failed initialization leaves the stream invalid */
+    CHECK(secp256k1_memcmp_var(stream.data, invalid_stream.data, sizeof(stream.data)) == 0);
+    CHECK_ILLEGAL(CTX, secp256k1_schnorrsig_stream_write(CTX, &stream, msg, sizeof(msg)));
+    CHECK(secp256k1_schnorrsig_verify_stream_init(CTX, &stream, sig, &pk) == 1);
+    CHECK(secp256k1_schnorrsig_stream_write(CTX, &stream, msg, sizeof(msg)) == 1);
+    CHECK_ILLEGAL(CTX, secp256k1_schnorrsig_sign_stream_second_pass(CTX, &stream));
+    CHECK_ILLEGAL(CTX, secp256k1_schnorrsig_sign_stream_finish(CTX, sig, &stream));
+    CHECK_ILLEGAL(CTX, secp256k1_schnorrsig_verify_stream_finish(CTX, NULL));
+    CHECK_ILLEGAL(CTX, secp256k1_schnorrsig_verify_stream_finish(CTX, &invalid_stream));
+    CHECK(secp256k1_schnorrsig_verify_stream_finish(CTX, &stream) == 1);
+    CHECK_ILLEGAL(CTX, secp256k1_schnorrsig_verify_stream_finish(CTX, &stream));
+
+    /* Verification with a stream works with the static context */
+    CHECK(secp256k1_schnorrsig_verify_stream_init(STATIC_CTX, &stream, sig, &pk) == 1);
+    CHECK(secp256k1_schnorrsig_stream_write(STATIC_CTX, &stream, msg, sizeof(msg)) == 1);
+    CHECK(secp256k1_schnorrsig_verify_stream_finish(STATIC_CTX, &stream) == 1);
+
+    /* An incorrect signature */
+    CHECK(secp256k1_schnorrsig_verify_stream_init(CTX, &stream, zeros64, &pk) == 1);
+    CHECK(secp256k1_schnorrsig_stream_write(CTX, &stream, msg, sizeof(msg)) == 1);
+    CHECK(secp256k1_schnorrsig_verify_stream_finish(CTX, &stream) == 0);
+}
+
+/* Checks that signing and verifying with streams agree with
+ * secp256k1_schnorrsig_sign_custom and secp256k1_schnorrsig_verify for random
+ * messages split into random chunks. */
+static void test_schnorrsig_stream(void) {
+    unsigned char sk[32];
+    unsigned char aux_rand[32];
+    unsigned char msg[300];
+    unsigned char sig[64];
+    unsigned char sig_stream[64];
+    unsigned char zeros64[64] = { 0 };
+    size_t msglen;
+    secp256k1_keypair keypair;
+    secp256k1_xonly_pubkey pk;
+    secp256k1_schnorrsig_stream stream;
+    secp256k1_schnorrsig_stream stream_copy;
+    secp256k1_schnorrsig_extraparams extraparams = SECP256K1_SCHNORRSIG_EXTRAPARAMS_INIT;
+    int use_aux = testrand_bits(1);
+
+    testrand256(sk);
+    testrand256(aux_rand);
+    msglen = testrand_int(sizeof(msg) + 1);
+    testrand_bytes_test(msg, msglen);
+    CHECK(secp256k1_keypair_create(CTX, &keypair, sk));
+    CHECK(secp256k1_keypair_xonly_pub(CTX, &pk, NULL, &keypair));
+    extraparams.ndata = use_aux ? aux_rand : NULL;
+
+    CHECK(secp256k1_schnorrsig_sign_custom(CTX, sig, msg, msglen, &keypair, &extraparams));
+    CHECK(secp256k1_schnorrsig_sign_stream_init(CTX, &stream, &keypair, use_aux ? aux_rand : NULL));
+    schnorrsig_stream_write_chunks(&stream, msg, msglen);
+    CHECK(secp256k1_schnorrsig_sign_stream_second_pass(CTX, &stream));
+    stream_copy = stream;
+    schnorrsig_stream_write_chunks(&stream, msg, msglen);
+    CHECK(secp256k1_schnorrsig_sign_stream_finish(CTX, sig_stream, &stream));
+    CHECK(secp256k1_memcmp_var(sig, sig_stream, 64) == 0);
+
+    CHECK(secp256k1_schnorrsig_verify_stream_init(CTX, &stream, sig, &pk));
+    schnorrsig_stream_write_chunks(&stream, msg, msglen);
+    CHECK(secp256k1_schnorrsig_verify_stream_finish(CTX, &stream));
+
+    /* A different message in the second pass must not produce a signature */
+    if (msglen > 0) {
+        stream = stream_copy;
+        schnorrsig_stream_write_chunks(&stream, msg, msglen - 1);
+        CHECK(secp256k1_schnorrsig_sign_stream_finish(CTX, sig_stream, &stream) == 0);
+        CHECK(secp256k1_memcmp_var(sig_stream, zeros64, 64) == 0);
+
+        stream = stream_copy;
+        msg[testrand_int(msglen)] ^= 1 << testrand_int(8);
+        schnorrsig_stream_write_chunks(&stream, msg, msglen);
+        CHECK(secp256k1_schnorrsig_sign_stream_finish(CTX, sig_stream, &stream) == 0);
+        CHECK(secp256k1_memcmp_var(sig_stream, zeros64, 64) == 0);
+
+        /* The signature does not verify for the modified message */
+        CHECK(secp256k1_schnorrsig_verify_stream_init(CTX, &stream, sig, &pk));
+        schnorrsig_stream_write_chunks(&stream, msg, msglen);
+        CHECK(secp256k1_schnorrsig_verify_stream_finish(CTX, &stream) == 0);
+    } else {
+        stream = stream_copy;
+        CHECK(secp256k1_schnorrsig_stream_write(CTX, &stream, msg, 1));
+        CHECK(secp256k1_schnorrsig_sign_stream_finish(CTX, sig_stream, &stream) == 0);
+        CHECK(secp256k1_memcmp_var(sig_stream, zeros64, 64) == 0);
+    }
+}
+
 static void test_schnorrsig_taproot(void) {
     unsigned char sk[32];
     secp256k1_keypair keypair;
@@ -976,6 +1570,16 @@ static void run_schnorrsig_tests(void) {
         test_schnorrsig_sign();
         test_schnorrsig_sign_verify();
     }
+    test_schnorrsig_verify_batch();
+    for (i = 0; i < COUNT; i++) {
+        test_schnorrsig_verify_many();
+    }
+    test_schnorrsig_verify_queue_api();
+    test_schnorrsig_verify_queue();
+    test_schnorrsig_stream_api();
+    for (i = 0; i < COUNT; i++) {
+        test_schnorrsig_stream();
+    }
     test_schnorrsig_taproot();
 }
 
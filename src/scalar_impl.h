@@ -45,6 +45,26 @@ static void secp256k1_scalar_verify(const secp256k1_scalar *r) {
     (void)r;
 }
 
+static void secp256k1_scalar_inverse_all_var(secp256k1_scalar *r, const secp256k1_scalar *a, size_t len) {
+    secp256k1_scalar u;
+    size_t i;
+
+    if (len == 0) {
+        return;
+    }
+    /* Use the output as scratch space for the prefix products */
+    r[0] = a[0];
+    for (i = 1; i < len; i++) {
+        secp256k1_scalar_mul(&r[i], &r[i - 1], &a[i]);
+    }
+    secp256k1_scalar_inverse_var(&u, &r[len - 1]);
+    for (i = len - 1; i > 0; i--) {
+        secp256k1_scalar_mul(&r[i], &r[i - 1], &u);
+        secp256k1_scalar_mul(&u, &u, &a[i]);
+    }
+    r[0] = u;
+}
+
 #if defined(EXHAUSTIVE_TEST_ORDER)
 /* Begin of section generated by sage/gen_exhaustive_groups.sage. */
 #  if EXHAUSTIVE_TEST_ORDER == 7
@@ -8,7 +8,7 @@
 #define SECP256K1_SCRATCH_H
 
 /* The typedef is used internally; the struct name is used in the public API
- * (where it is exposed as a different typedef) */
+ * (where it is exposed as secp256k1_scratch_space) */
 typedef struct secp256k1_scratch_space_struct {
     /** guard against interpreting this object as other types */
     unsigned char magic[8];
@@ -21,8 +21,6 @@ typedef struct secp256k1_scratch_space_struct {
     size_t max_size;
 } secp256k1_scratch;
 
-typedef struct secp256k1_scratch_space_struct secp256k1_scratch_space;
-
 static secp256k1_scratch* secp256k1_scratch_create(const secp256k1_callback* error_callback, size_t max_size);
 
 static void secp256k1_scratch_destroy(const secp256k1_callback* error_callback, secp256k1_scratch* scratch);
@@ -41,4 +39,9 @@ static size_t secp256k1_scratch_max_allocation(const secp256k1_callback* error_c
 /** Returns a pointer into the most recently allocated frame, or NULL if there is insufficient available space */
 static void *secp256k1_scratch_alloc(const secp256k1_callback* error_callback, secp256k1_scratch* scratch, size_t n);
 
+/** Allocates n bytes on scratch and initializes child as a scratch space using
+ *  them. The child must not be destroyed. Returns 0 if there is insufficient
+ *  available space. */
+static int secp256k1_scratch_alloc_child(const secp256k1_callback* error_callback, secp256k1_scratch* scratch, secp256k1_scratch* child, size_t n);
+
 #endif
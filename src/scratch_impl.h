@@ -96,4 +96,17 @@ static void *secp256k1_scratch_alloc(const secp256k1_callback* error_callback, s
     return ret;
 }
 
+static int secp256k1_scratch_alloc_child(const secp256k1_callback* error_callback, secp256k1_scratch* scratch, secp256k1_scratch* child, size_t n) {
+    void *data = secp256k1_scratch_alloc(error_callback, scratch, n);
+
+    if (data == NULL) {
+        return 0;
+    }
+    memset(child, 0, sizeof(*child));
+    memcpy(child->magic, "scratch", 8);
+    child->data = data;
+    child->max_size = n;
+    return 1;
+}
+
 #endif
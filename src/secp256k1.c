@@ -35,6 +35,7 @@
 #include "hash_impl.h"
 #include "int128_impl.h"
 #include "scratch_impl.h"
+#include "ecmult_batch_impl.h"
 #include "selftest.h"
 #include "hsort_impl.h"
 
@@ -60,6 +61,8 @@
  * context_eq function. */
 struct secp256k1_context_struct {
     secp256k1_ecmult_gen_context ecmult_gen_ctx;
+    secp256k1_ecmult_tables ecmult_tables;
+    secp256k1_ecmult_multi_params ecmult_multi_params;
     secp256k1_callback illegal_callback;
     secp256k1_callback error_callback;
     int declassify;
@@ -67,6 +70,8 @@ struct secp256k1_context_struct {
 
 static const secp256k1_context secp256k1_context_static_ = {
     { 0 },
+    { secp256k1_pre_g, secp256k1_pre_g_128, WINDOW_G },
+    ECMULT_MULTI_PARAMS_DEFAULT,
     { secp256k1_default_illegal_callback_fn, 0 },
     { secp256k1_default_error_callback_fn, 0 },
     0
@@ -133,6 +138,8 @@ secp256k1_context* secp256k1_context_preallocated_create(void* prealloc, unsigne
     /* Flags have been checked by secp256k1_context_preallocated_size. */
     VERIFY_CHECK((flags & SECP256K1_FLAGS_TYPE_MASK) == SECP256K1_FLAGS_TYPE_CONTEXT);
     secp256k1_ecmult_gen_context_build(&ret->ecmult_gen_ctx);
+    secp256k1_ecmult_tables_set_default(&ret->ecmult_tables);
+    secp256k1_ecmult_multi_params_set_default(&ret->ecmult_multi_params);
     ret->declassify = !!(flags & SECP256K1_FLAGS_BIT_CONTEXT_DECLASSIFY);
 
     return ret;
@@ -149,6 +156,51 @@ secp256k1_context* secp256k1_context_create(unsigned int flags) {
     return ctx;
 }
 
+secp256k1_context* secp256k1_context_create_with_ecmult_window(unsigned int flags, unsigned int ecmult_window) {
+    secp256k1_context* ctx;
+
+    if (EXPECT(ecmult_window < 2 || ecmult_window > 24, 0)) {
+        secp256k1_callback_call(&default_illegal_callback,
+                                "Invalid ecmult window");
+        return NULL;
+    }
+
+    ctx = secp256k1_context_create(flags);
+    if (EXPECT(ctx == NULL, 0)) {
+        return NULL;
+    }
+    if (ecmult_window != WINDOW_G
+        && EXPECT(!secp256k1_ecmult_tables_build(&ctx->error_callback, &ctx->ecmult_tables, ecmult_window), 0)) {
+        secp256k1_context_destroy(ctx);
+        return NULL;
+    }
+
+    return ctx;
+}
+
+secp256k1_context* secp256k1_context_create_with_ecmult_gen_comb(unsigned int flags, unsigned int blocks, unsigned int teeth) {
+    secp256k1_context* ctx;
+
+    if (EXPECT(blocks > ECMULT_GEN_MAX_COMB_BLOCKS || teeth > ECMULT_GEN_MAX_COMB_TEETH
+               || !secp256k1_ecmult_gen_comb_params_valid(blocks, teeth), 0)) {
+        secp256k1_callback_call(&default_illegal_callback,
+                                "Invalid comb parameters");
+        return NULL;
+    }
+
+    ctx = secp256k1_context_create(flags);
+    if (EXPECT(ctx == NULL, 0)) {
+        return NULL;
+    }
+    if ((blocks != COMB_BLOCKS || teeth != COMB_TEETH)
+        && EXPECT(!secp256k1_ecmult_gen_context_build_comb(&ctx->ecmult_gen_ctx, &ctx->error_callback, &secp256k1_ge_const_g, blocks, teeth), 0)) {
+        secp256k1_context_destroy(ctx);
+        return NULL;
+    }
+
+    return ctx;
+}
+
 secp256k1_context* secp256k1_context_preallocated_clone(const secp256k1_context* ctx, void* prealloc) {
     secp256k1_context* ret;
     VERIFY_CHECK(ctx != NULL);
@@ -157,6 +209,9 @@ secp256k1_context* secp256k1_context_preallocated_clone(const secp256k1_context*
 
     ret = (secp256k1_context*)prealloc;
     *ret = *ctx;
+    /* Allocated tables belong to ctx, so the clone falls back to the default ones. */
+    secp256k1_ecmult_gen_context_set_default_table(&ret->ecmult_gen_ctx, 0);
+    secp256k1_ecmult_tables_set_default(&ret->ecmult_tables);
     return ret;
 }
 
@@ -170,6 +225,11 @@ secp256k1_context* secp256k1_context_clone(const secp256k1_context* ctx) {
     prealloc_size = secp256k1_context_preallocated_clone_size(ctx);
     ret = (secp256k1_context*)checked_malloc(&ctx->error_callback, prealloc_size);
     ret = secp256k1_context_preallocated_clone(ctx, ret);
+    if (ret != NULL) {
+        /* On allocation failure, the clone keeps the default tables. */
+        secp256k1_ecmult_gen_context_clone_table(&ret->ecmult_gen_ctx, &ctx->error_callback, &ctx->ecmult_gen_ctx);
+        secp256k1_ecmult_tables_clone(&ctx->error_callback, &ret->ecmult_tables, &ctx->ecmult_tables);
+    }
     return ret;
 }
 
@@ -192,6 +252,8 @@ void secp256k1_context_destroy(secp256k1_context* ctx) {
         return;
     }
 
+    secp256k1_ecmult_gen_context_set_default_table(&ctx->ecmult_gen_ctx, 1);
+    secp256k1_ecmult_tables_free(&ctx->ecmult_tables);
     secp256k1_context_preallocated_destroy(ctx);
     free(ctx);
 }
@@ -220,12 +282,12 @@ void secp256k1_context_set_error_callback(secp256k1_context* ctx, void (*fun)(co
     ctx->error_callback.data = data;
 }
 
-static secp256k1_scratch_space* secp256k1_scratch_space_create(const secp256k1_context* ctx, size_t max_size) {
+secp256k1_scratch_space* secp256k1_scratch_space_create(const secp256k1_context* ctx, size_t max_size) {
     VERIFY_CHECK(ctx != NULL);
     return secp256k1_scratch_create(&ctx->error_callback, max_size);
 }
 
-static void secp256k1_scratch_space_destroy(const secp256k1_context *ctx, secp256k1_scratch_space* scratch) {
+void secp256k1_scratch_space_destroy(const secp256k1_context *ctx, secp256k1_scratch_space* scratch) {
     VERIFY_CHECK(ctx != NULL);
     secp256k1_scratch_destroy(&ctx->error_callback, scratch);
 }
@@ -460,7 +522,143 @@ int secp256k1_ecdsa_verify(const secp256k1_context* ctx, const secp256k1_ecdsa_s
     secp256k1_ecdsa_signature_load(ctx, &r, &s, sig);
     return (!secp256k1_scalar_is_high(&s) &&
             secp256k1_pubkey_load(ctx, &q, pubkey) &&
-            secp256k1_ecdsa_sig_verify(&r, &s, &q, &m));
+            secp256k1_ecdsa_sig_verify(&ctx->ecmult_tables, &r, &s, &q, &m));
+}
+
+struct secp256k1_prepared_pubkey_struct {
+    secp256k1_ge pubkey;
+    secp256k1_ecmult_point_table table;
+};
+
+secp256k1_prepared_pubkey *secp256k1_prepared_pubkey_create(const secp256k1_context* ctx, const secp256k1_pubkey *pubkey) {
+    secp256k1_prepared_pubkey *prepared;
+    secp256k1_ge q;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(pubkey != NULL);
+    if (!secp256k1_pubkey_load(ctx, &q, pubkey)) {
+        return NULL;
+    }
+
+    prepared = (secp256k1_prepared_pubkey *)checked_malloc(&ctx->error_callback, sizeof(*prepared));
+    if (prepared == NULL) {
+        return NULL;
+    }
+    if (!secp256k1_ecmult_point_table_build(&ctx->error_callback, &prepared->table, &q, ECMULT_POINT_TABLE_WINDOW)) {
+        free(prepared);
+        return NULL;
+    }
+    prepared->pubkey = q;
+    return prepared;
+}
+
+void secp256k1_prepared_pubkey_destroy(const secp256k1_context* ctx, secp256k1_prepared_pubkey *prepared) {
+    VERIFY_CHECK(ctx != NULL);
+    (void)ctx;
+    if (prepared != NULL) {
+        secp256k1_ecmult_point_table_free(&prepared->table);
+        free(prepared);
+    }
+}
+
+int secp256k1_ecdsa_verify_prepared(const secp256k1_context* ctx, const secp256k1_ecdsa_signature *sig, const unsigned char *msghash32, const secp256k1_prepared_pubkey *prepared) {
+    secp256k1_scalar r, s;
+    secp256k1_scalar m;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(msghash32 != NULL);
+    ARG_CHECK(sig != NULL);
+    ARG_CHECK(prepared != NULL);
+
+    secp256k1_scalar_set_b32(&m, msghash32, NULL);
+    secp256k1_ecdsa_signature_load(ctx, &r, &s, sig);
+    return (!secp256k1_scalar_is_high(&s) &&
+            secp256k1_ecdsa_sig_verify_point_table(&ctx->ecmult_tables, &r, &s, &prepared->table, &m));
+}
+
+/* Number of signatures that share their scalar inversion in
+ * secp256k1_ecdsa_verify_many. */
+#define ECDSA_VERIFY_MANY_SIZE 16
+
+/* Verifies up to ECDSA_VERIFY_MANY_SIZE signatures like secp256k1_ecdsa_verify,
+ * but computes the inverses of all s values with a single scalar inversion,
+ * and the multiplications of up to ECMULT_INTERLEAVE_MAX signatures at once.
+ * Returns 1 if all signatures are correct. */
+static int secp256k1_ecdsa_verify_many_chunk(const secp256k1_context* ctx, int *results, const secp256k1_ecdsa_signature * const *sigs, const unsigned char * const *msghash32s, const secp256k1_pubkey * const *pubkeys, size_t n_sigs) {
+    secp256k1_scalar r[ECDSA_VERIFY_MANY_SIZE];
+    secp256k1_scalar s[ECDSA_VERIFY_MANY_SIZE];
+    secp256k1_scalar sn[ECDSA_VERIFY_MANY_SIZE];
+    secp256k1_ge q[ECDSA_VERIFY_MANY_SIZE];
+    size_t idx[ECDSA_VERIFY_MANY_SIZE];
+    size_t n_valid = 0;
+    size_t i;
+    int ret = 1;
+
+    VERIFY_CHECK(n_sigs <= ECDSA_VERIFY_MANY_SIZE);
+    for (i = 0; i < n_sigs; i++) {
+        secp256k1_ecdsa_signature_load(ctx, &r[n_valid], &s[n_valid], sigs[i]);
+        if (results != NULL) {
+            results[i] = 0;
+        }
+        if (!secp256k1_scalar_is_high(&s[n_valid]) &&
+            secp256k1_pubkey_load(ctx, &q[n_valid], pubkeys[i]) &&
+            !secp256k1_scalar_is_zero(&r[n_valid]) &&
+            !secp256k1_scalar_is_zero(&s[n_valid])) {
+            idx[n_valid] = i;
+            n_valid++;
+        } else {
+            ret = 0;
+        }
+    }
+
+    secp256k1_scalar_inverse_all_var(sn, s, n_valid);
+    for (i = 0; i < n_valid; i += ECMULT_INTERLEAVE_MAX) {
+        secp256k1_gej qj[ECMULT_INTERLEAVE_MAX];
+        secp256k1_gej pr[ECMULT_INTERLEAVE_MAX];
+        secp256k1_scalar u1[ECMULT_INTERLEAVE_MAX];
+        secp256k1_scalar u2[ECMULT_INTERLEAVE_MAX];
+        size_t n = n_valid - i < ECMULT_INTERLEAVE_MAX ? n_valid - i : ECMULT_INTERLEAVE_MAX;
+        size_t j;
+
+        for (j = 0; j < n; j++) {
+            secp256k1_scalar m;
+            secp256k1_scalar_set_b32(&m, msghash32s[idx[i + j]], NULL);
+            secp256k1_scalar_mul(&u1[j], &sn[i + j], &m);
+            secp256k1_scalar_mul(&u2[j], &sn[i + j], &r[i + j]);
+            secp256k1_gej_set_ge(&qj[j], &q[i + j]);
+        }
+        secp256k1_ecmult_interleaved(&ctx->ecmult_tables, pr, qj, u2, u1, n);
+        for (j = 0; j < n; j++) {
+            if (secp256k1_ecdsa_sig_check_r(&r[i + j], &pr[j])) {
+                if (results != NULL) {
+                    results[idx[i + j]] = 1;
+                }
+            } else {
+                ret = 0;
+            }
+        }
+    }
+    return ret;
+}
+
+int secp256k1_ecdsa_verify_many(const secp256k1_context* ctx, int *results, const secp256k1_ecdsa_signature * const *sigs, const unsigned char * const *msghash32s, const secp256k1_pubkey * const *pubkeys, size_t n_sigs) {
+    size_t offset;
+    size_t i;
+    int ret = 1;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(n_sigs == 0 || sigs != NULL);
+    ARG_CHECK(n_sigs == 0 || msghash32s != NULL);
+    ARG_CHECK(n_sigs == 0 || pubkeys != NULL);
+    for (i = 0; i < n_sigs; i++) {
+        ARG_CHECK(sigs[i] != NULL);
+        ARG_CHECK(msghash32s[i] != NULL);
+        ARG_CHECK(pubkeys[i] != NULL);
+    }
+
+    for (offset = 0; offset < n_sigs; offset += ECDSA_VERIFY_MANY_SIZE) {
+        size_t len = n_sigs - offset < ECDSA_VERIFY_MANY_SIZE ? n_sigs - offset : ECDSA_VERIFY_MANY_SIZE;
+        ret &= secp256k1_ecdsa_verify_many_chunk(ctx, results == NULL ? NULL : &results[offset], &sigs[offset], &msghash32s[offset], &pubkeys[offset], len);
+    }
+    return ret;
 }
 
 static SECP256K1_INLINE void buffer_append(unsigned char *buf, unsigned int *offset, const void *data, unsigned int len) {
@@ -766,6 +964,67 @@ int secp256k1_context_randomize(secp256k1_context* ctx, const unsigned char *see
     return 1;
 }
 
+struct secp256k1_prepared_generator_struct {
+    /* A comb table for the generator, used exactly like the one for G in a context. */
+    secp256k1_ecmult_gen_context ecmult_gen_ctx;
+};
+
+secp256k1_prepared_generator *secp256k1_prepared_generator_create(const secp256k1_context* ctx, const secp256k1_pubkey *generator) {
+    secp256k1_prepared_generator *prepared;
+    secp256k1_ge gen;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(generator != NULL);
+    if (!secp256k1_pubkey_load(ctx, &gen, generator)) {
+        return NULL;
+    }
+
+    prepared = (secp256k1_prepared_generator *)checked_malloc(&ctx->error_callback, sizeof(*prepared));
+    if (prepared == NULL) {
+        return NULL;
+    }
+    if (!secp256k1_ecmult_gen_context_build_comb(&prepared->ecmult_gen_ctx, &ctx->error_callback, &gen, COMB_BLOCKS, COMB_TEETH)) {
+        free(prepared);
+        return NULL;
+    }
+    return prepared;
+}
+
+void secp256k1_prepared_generator_destroy(const secp256k1_context* ctx, secp256k1_prepared_generator *prepared) {
+    VERIFY_CHECK(ctx != NULL);
+    (void)ctx;
+    if (prepared != NULL) {
+        secp256k1_ecmult_gen_context_free(&prepared->ecmult_gen_ctx);
+        free(prepared);
+    }
+}
+
+int secp256k1_prepared_generator_randomize(const secp256k1_context* ctx, secp256k1_prepared_generator *prepared, const unsigned char *seed32) {
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(prepared != NULL);
+
+    secp256k1_ecmult_gen_blind(&prepared->ecmult_gen_ctx, seed32);
+    return 1;
+}
+
+int secp256k1_prepared_generator_mul(const secp256k1_context* ctx, secp256k1_pubkey *result, const unsigned char *scalar32, const secp256k1_prepared_generator *prepared) {
+    secp256k1_ge p;
+    secp256k1_scalar scalar;
+    int ret = 0;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(result != NULL);
+    memset(result, 0, sizeof(*result));
+    ARG_CHECK(scalar32 != NULL);
+    ARG_CHECK(prepared != NULL);
+
+    ret = secp256k1_ec_pubkey_create_helper(&prepared->ecmult_gen_ctx, &scalar, &p, scalar32);
+    secp256k1_pubkey_save(result, &p);
+    secp256k1_memczero(result, sizeof(*result), !ret);
+
+    secp256k1_scalar_clear(&scalar);
+    return ret;
+}
+
 int secp256k1_ec_pubkey_combine(const secp256k1_context* ctx, secp256k1_pubkey *pubnonce, const secp256k1_pubkey * const *pubnonces, size_t n) {
     size_t i;
     secp256k1_gej Qj;
@@ -792,6 +1051,231 @@ int secp256k1_ec_pubkey_combine(const secp256k1_context* ctx, secp256k1_pubkey *
     return 1;
 }
 
+size_t secp256k1_ecmult_multi_scratch_size(size_t n_points) {
+    return secp256k1_ecmult_multi_scratch_size_internal(n_points);
+}
+
+typedef struct {
+    const secp256k1_context *ctx;
+    const unsigned char * const *scalars32;
+    const secp256k1_pubkey * const *points;
+} secp256k1_ecmult_multi_data;
+
+static int secp256k1_ecmult_multi_callback_api(secp256k1_scalar *sc, secp256k1_ge *pt, size_t idx, void *data) {
+    const secp256k1_ecmult_multi_data *ecmult_data = (const secp256k1_ecmult_multi_data *)data;
+    int overflow;
+
+    secp256k1_scalar_set_b32(sc, ecmult_data->scalars32[idx], &overflow);
+    if (overflow) {
+        return 0;
+    }
+    return secp256k1_pubkey_load(ecmult_data->ctx, pt, ecmult_data->points[idx]);
+}
+
+static int secp256k1_ecmult_multi_helper(const secp256k1_context* ctx, secp256k1_scratch_space *scratch, secp256k1_pubkey *result, const unsigned char *g_scalar32, const unsigned char * const *scalars32, const secp256k1_pubkey * const *points, size_t n_points, secp256k1_task_runner runner, void *runner_data, size_t n_tasks) {
+    secp256k1_ecmult_multi_data data;
+    secp256k1_scalar g_scalar;
+    secp256k1_gej rj;
+    secp256k1_ge r;
+    size_t i;
+    int overflow = 0;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(result != NULL);
+    memset(result, 0, sizeof(*result));
+    ARG_CHECK(n_points == 0 || scalars32 != NULL);
+    ARG_CHECK(n_points == 0 || points != NULL);
+    for (i = 0; i < n_points; i++) {
+        ARG_CHECK(scalars32[i] != NULL);
+        ARG_CHECK(points[i] != NULL);
+    }
+
+    if (g_scalar32 != NULL) {
+        secp256k1_scalar_set_b32(&g_scalar, g_scalar32, &overflow);
+        if (overflow) {
+            return 0;
+        }
+    }
+    data.ctx = ctx;
+    data.scalars32 = scalars32;
+    data.points = points;
+    if (runner != NULL) {
+        if (!secp256k1_ecmult_multi_var_parallel(&ctx->ecmult_multi_params, &ctx->error_callback, scratch, &rj, g_scalar32 != NULL ? &g_scalar : NULL, secp256k1_ecmult_multi_callback_api, &data, n_points, runner, runner_data, n_tasks)) {
+            return 0;
+        }
+    } else if (!secp256k1_ecmult_multi_var_with_params(&ctx->ecmult_multi_params, &ctx->error_callback, scratch, &rj, g_scalar32 != NULL ? &g_scalar : NULL, secp256k1_ecmult_multi_callback_api, &data, n_points)) {
+        return 0;
+    }
+    if (secp256k1_gej_is_infinity(&rj)) {
+        return 0;
+    }
+    secp256k1_ge_set_gej_var(&r, &rj);
+    secp256k1_pubkey_save(result, &r);
+    return 1;
+}
+
+int secp256k1_ecmult_multi(const secp256k1_context* ctx, secp256k1_scratch_space *scratch, secp256k1_pubkey *result, const unsigned char *g_scalar32, const unsigned char * const *scalars32, const secp256k1_pubkey * const *points, size_t n_points) {
+    return secp256k1_ecmult_multi_helper(ctx, scratch, result, g_scalar32, scalars32, points, n_points, NULL, NULL, 1);
+}
+
+int secp256k1_ecmult_multi_array(const secp256k1_context* ctx, secp256k1_scratch_space *scratch, secp256k1_pubkey *result, const unsigned char *g_scalar32, const unsigned char *scalars32, const secp256k1_pubkey *points, size_t n_points) {
+    secp256k1_ecmult_multi_input input;
+    secp256k1_scalar g_scalar;
+    secp256k1_gej rj;
+    secp256k1_ge r;
+    size_t i;
+    int overflow = 0;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(result != NULL);
+    memset(result, 0, sizeof(*result));
+    ARG_CHECK(n_points == 0 || scalars32 != NULL);
+    ARG_CHECK(n_points == 0 || points != NULL);
+
+    if (g_scalar32 != NULL) {
+        secp256k1_scalar_set_b32(&g_scalar, g_scalar32, &overflow);
+        if (overflow) {
+            return 0;
+        }
+    }
+    /* The points are read in place as the 64-byte encodings that
+     * secp256k1_pubkey_save writes. */
+    STATIC_ASSERT(sizeof(secp256k1_pubkey) == 64);
+    secp256k1_ecmult_multi_input_init_bytes(&input, scalars32, n_points > 0 ? points[0].data : NULL);
+    if (!secp256k1_ecmult_multi_var_input(&ctx->ecmult_multi_params, &ctx->error_callback, scratch, &rj, g_scalar32 != NULL ? &g_scalar : NULL, &input, n_points)) {
+        /* Invalid points are only looked for after the fact, so that valid
+         * ones are decoded just once. */
+        for (i = 0; i < n_points; i++) {
+            if (!secp256k1_pubkey_load(ctx, &r, &points[i])) {
+                break;
+            }
+        }
+        return 0;
+    }
+    if (secp256k1_gej_is_infinity(&rj)) {
+        return 0;
+    }
+    secp256k1_ge_set_gej_var(&r, &rj);
+    secp256k1_pubkey_save(result, &r);
+    return 1;
+}
+
+struct secp256k1_fixed_bases_struct {
+    secp256k1_ecmult_fixed_bases bases;
+};
+
+secp256k1_fixed_bases *secp256k1_fixed_bases_create(const secp256k1_context* ctx, const secp256k1_pubkey *points, size_t n_points) {
+    secp256k1_fixed_bases *ret;
+    secp256k1_ge *ge;
+    size_t i;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(points != NULL);
+    ARG_CHECK(n_points > 0);
+
+    /* This also keeps n_points * sizeof(*ge) from overflowing. */
+    if (n_points > secp256k1_ecmult_fixed_bases_max_points(ECMULT_FIXED_BASES_WINDOW, ECMULT_FIXED_BASES_CHUNKS)) {
+        return NULL;
+    }
+    ge = (secp256k1_ge *)checked_malloc(&ctx->error_callback, n_points * sizeof(*ge));
+    if (ge == NULL) {
+        return NULL;
+    }
+    for (i = 0; i < n_points; i++) {
+        if (!secp256k1_pubkey_load(ctx, &ge[i], &points[i])) {
+            free(ge);
+            return NULL;
+        }
+    }
+    ret = (secp256k1_fixed_bases *)checked_malloc(&ctx->error_callback, sizeof(*ret));
+    if (ret != NULL && !secp256k1_ecmult_fixed_bases_build(&ctx->error_callback, &ret->bases, ge, n_points, ECMULT_FIXED_BASES_WINDOW, ECMULT_FIXED_BASES_CHUNKS)) {
+        free(ret);
+        ret = NULL;
+    }
+    free(ge);
+    return ret;
+}
+
+void secp256k1_fixed_bases_destroy(const secp256k1_context* ctx, secp256k1_fixed_bases *bases) {
+    VERIFY_CHECK(ctx != NULL);
+    (void)ctx;
+    if (bases != NULL) {
+        secp256k1_ecmult_fixed_bases_free(&bases->bases);
+        free(bases);
+    }
+}
+
+size_t secp256k1_ecmult_multi_fixed_scratch_size(size_t n_points) {
+    return secp256k1_ecmult_multi_fixed_scratch_size_internal(n_points, ECMULT_FIXED_BASES_CHUNKS);
+}
+
+int secp256k1_ecmult_multi_fixed(const secp256k1_context* ctx, secp256k1_scratch_space *scratch, secp256k1_pubkey *result, const unsigned char *g_scalar32, const unsigned char *scalars32, const secp256k1_fixed_bases *bases) {
+    secp256k1_scalar g_scalar;
+    secp256k1_gej rj;
+    secp256k1_ge r;
+    int overflow = 0;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(result != NULL);
+    memset(result, 0, sizeof(*result));
+    ARG_CHECK(scalars32 != NULL);
+    ARG_CHECK(bases != NULL);
+
+    if (g_scalar32 != NULL) {
+        secp256k1_scalar_set_b32(&g_scalar, g_scalar32, &overflow);
+        if (overflow) {
+            return 0;
+        }
+    }
+    if (!secp256k1_ecmult_multi_fixed_var(&ctx->ecmult_multi_params, &ctx->ecmult_tables, &ctx->error_callback, scratch, &rj, g_scalar32 != NULL ? &g_scalar : NULL, &bases->bases, scalars32)) {
+        return 0;
+    }
+    if (secp256k1_gej_is_infinity(&rj)) {
+        return 0;
+    }
+    secp256k1_ge_set_gej_var(&r, &rj);
+    secp256k1_pubkey_save(result, &r);
+    return 1;
+}
+
+size_t secp256k1_ecmult_multi_parallel_scratch_size(size_t n_points, size_t n_tasks) {
+    return secp256k1_ecmult_multi_parallel_scratch_size_internal(n_points, n_tasks > 0 ? n_tasks : 1);
+}
+
+int secp256k1_ecmult_multi_parallel(const secp256k1_context* ctx, secp256k1_scratch_space *scratch, secp256k1_pubkey *result, const unsigned char *g_scalar32, const unsigned char * const *scalars32, const secp256k1_pubkey * const *points, size_t n_points, secp256k1_task_runner runner, void *runner_data, size_t n_tasks) {
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(result != NULL);
+    memset(result, 0, sizeof(*result));
+    ARG_CHECK(runner != NULL);
+    ARG_CHECK(n_tasks > 0);
+
+    return secp256k1_ecmult_multi_helper(ctx, scratch, result, g_scalar32, scalars32, points, n_points, runner, runner_data, n_tasks);
+}
+
+int secp256k1_context_tune_ecmult_multi(secp256k1_context* ctx) {
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(secp256k1_context_is_proper(ctx));
+
+    return secp256k1_ecmult_multi_params_calibrate(&ctx->error_callback, &ctx->ecmult_multi_params);
+}
+
+int secp256k1_context_serialize_ecmult_multi_tuning(const secp256k1_context* ctx, unsigned char *output) {
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(output != NULL);
+    STATIC_ASSERT(SECP256K1_ECMULT_MULTI_TUNING_SIZE == ECMULT_MULTI_PARAMS_SIZE);
+
+    secp256k1_ecmult_multi_params_to_bytes(output, &ctx->ecmult_multi_params);
+    return 1;
+}
+
+int secp256k1_context_parse_ecmult_multi_tuning(secp256k1_context* ctx, const unsigned char *input) {
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(secp256k1_context_is_proper(ctx));
+    ARG_CHECK(input != NULL);
+
+    return secp256k1_ecmult_multi_params_from_bytes(&ctx->ecmult_multi_params, input);
+}
+
 int secp256k1_tagged_sha256(const secp256k1_context* ctx, unsigned char *hash32, const unsigned char *tag, size_t taglen, const unsigned char *msg, size_t msglen) {
     secp256k1_sha256 sha;
     VERIFY_CHECK(ctx != NULL);
@@ -806,6 +1290,42 @@ int secp256k1_tagged_sha256(const secp256k1_context* ctx, unsigned char *hash32,
     return 1;
 }
 
+int secp256k1_tagged_sha256_midstate_init(const secp256k1_context* ctx, secp256k1_tagged_sha256_midstate *midstate, const unsigned char *tag, size_t taglen) {
+    secp256k1_sha256 sha;
+    int i;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(midstate != NULL);
+    ARG_CHECK(tag != NULL);
+
+    secp256k1_sha256_initialize_tagged(&sha, tag, taglen);
+    VERIFY_CHECK(sha.bytes == 64);
+    for (i = 0; i < 8; i++) {
+        secp256k1_write_be32(&midstate->data[4*i], sha.s[i]);
+    }
+    secp256k1_sha256_clear(&sha);
+    return 1;
+}
+
+int secp256k1_tagged_sha256_with_midstate(const secp256k1_context* ctx, unsigned char *hash32, const secp256k1_tagged_sha256_midstate *midstate, const unsigned char *msg, size_t msglen) {
+    secp256k1_sha256 sha;
+    int i;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(hash32 != NULL);
+    ARG_CHECK(midstate != NULL);
+    ARG_CHECK(msg != NULL);
+
+    /* Set the state after hashing the 64 bytes SHA256(tag)||SHA256(tag). */
+    secp256k1_sha256_initialize(&sha);
+    for (i = 0; i < 8; i++) {
+        sha.s[i] = secp256k1_read_be32(&midstate->data[4*i]);
+    }
+    sha.bytes = 64;
+    secp256k1_sha256_write(&sha, msg, msglen);
+    secp256k1_sha256_finalize(&sha, hash32);
+    secp256k1_sha256_clear(&sha);
+    return 1;
+}
+
 #ifdef ENABLE_MODULE_ECDH
 # include "modules/ecdh/main_impl.h"
 #endif
@@ -132,14 +132,27 @@ static void run_selftest_tests(void) {
 
 static int ecmult_gen_context_eq(const secp256k1_ecmult_gen_context *a, const secp256k1_ecmult_gen_context *b) {
     return a->built == b->built
+            && a->blocks == b->blocks
+            && a->teeth == b->teeth
+            && a->spacing == b->spacing
+            && (!a->built || secp256k1_ge_eq_var(&a->gen, &b->gen))
             && secp256k1_scalar_eq(&a->scalar_offset, &b->scalar_offset)
             && secp256k1_ge_eq_var(&a->ge_offset, &b->ge_offset)
             && secp256k1_fe_equal(&a->proj_blind, &b->proj_blind);
 }
 
+static int ecmult_tables_eq(const secp256k1_ecmult_tables *a, const secp256k1_ecmult_tables *b) {
+    size_t size = ECMULT_TABLE_SIZE(a->window_g) * sizeof(secp256k1_ge_storage);
+    return a->window_g == b->window_g
+            && (a->pre_g == b->pre_g || secp256k1_memcmp_var(a->pre_g, b->pre_g, size) == 0)
+            && (a->pre_g_128 == b->pre_g_128 || secp256k1_memcmp_var(a->pre_g_128, b->pre_g_128, size) == 0);
+}
+
 static int context_eq(const secp256k1_context *a, const secp256k1_context *b) {
     return a->declassify == b->declassify
             && ecmult_gen_context_eq(&a->ecmult_gen_ctx, &b->ecmult_gen_ctx)
+            && ecmult_tables_eq(&a->ecmult_tables, &b->ecmult_tables)
+            && secp256k1_memcmp_var(&a->ecmult_multi_params, &b->ecmult_multi_params, sizeof(a->ecmult_multi_params)) == 0
             && a->illegal_callback.fn == b->illegal_callback.fn
             && a->illegal_callback.data == b->illegal_callback.data
             && a->error_callback.fn == b->error_callback.fn
@@ -342,7 +355,7 @@ static void run_proper_context_tests(int use_prealloc) {
     CHECK(secp256k1_ecdsa_sig_sign(&my_ctx->ecmult_gen_ctx, &sigr, &sigs, &key, &msg, &nonce, NULL));
 
     /* try verifying */
-    CHECK(secp256k1_ecdsa_sig_verify(&sigr, &sigs, &pub, &msg));
+    CHECK(secp256k1_ecdsa_sig_verify(&my_ctx->ecmult_tables, &sigr, &sigs, &pub, &msg));
 
     /* cleanup */
     if (use_prealloc) {
@@ -358,6 +371,153 @@ static void run_proper_context_tests(int use_prealloc) {
     secp256k1_context_preallocated_destroy(NULL);
 }
 
+static void test_context_ecmult_window(unsigned int window) {
+    secp256k1_context *my_ctx, *ctx_clone, *ctx_prealloc_clone;
+    void *prealloc;
+    secp256k1_ecmult_tables default_tables;
+    secp256k1_ecdsa_signature sig;
+    secp256k1_pubkey pubkey;
+    unsigned char seckey[32];
+    unsigned char msg[32];
+    int i;
+
+    my_ctx = secp256k1_context_create_with_ecmult_window(SECP256K1_CONTEXT_NONE, window);
+    CHECK(my_ctx != NULL);
+    CHECK(my_ctx->ecmult_tables.window_g == (int)window);
+    CHECK(secp256k1_ecmult_tables_is_allocated(&my_ctx->ecmult_tables) == (window != WINDOW_G));
+    secp256k1_ecmult_tables_set_default(&default_tables);
+
+    /* The computed tables give the same results as the compiled-in ones. */
+    for (i = 0; i < COUNT; i++) {
+        secp256k1_gej a, r1, r2;
+        secp256k1_scalar na, ng;
+        testutil_random_gej_test(&a);
+        testutil_random_scalar_order_test(&na);
+        testutil_random_scalar_order_test(&ng);
+        secp256k1_ecmult_with_tables(&my_ctx->ecmult_tables, &r1, &a, &na, &ng);
+        secp256k1_ecmult_with_tables(&default_tables, &r2, &a, &na, &ng);
+        CHECK(secp256k1_gej_eq_var(&r1, &r2));
+        secp256k1_ecmult_with_tables(&my_ctx->ecmult_tables, &r1, NULL, &secp256k1_scalar_zero, &ng);
+        secp256k1_ecmult_with_tables(&default_tables, &r2, NULL, &secp256k1_scalar_zero, &ng);
+        CHECK(secp256k1_gej_eq_var(&r1, &r2));
+    }
+
+    testutil_random_scalar_order_b32(seckey);
+    testutil_random_scalar_order_b32(msg);
+    CHECK(secp256k1_ec_pubkey_create(my_ctx, &pubkey, seckey));
+    CHECK(secp256k1_ecdsa_sign(my_ctx, &sig, msg, seckey, NULL, NULL));
+    CHECK(secp256k1_ecdsa_verify(my_ctx, &sig, msg, &pubkey));
+    msg[0] ^= 1;
+    CHECK(!secp256k1_ecdsa_verify(my_ctx, &sig, msg, &pubkey));
+    msg[0] ^= 1;
+
+    /* Cloning copies the tables. */
+    ctx_clone = secp256k1_context_clone(my_ctx);
+    CHECK(context_eq(my_ctx, ctx_clone));
+    CHECK(!secp256k1_ecmult_tables_is_allocated(&my_ctx->ecmult_tables) || ctx_clone->ecmult_tables.pre_g != my_ctx->ecmult_tables.pre_g);
+    secp256k1_context_destroy(my_ctx);
+    CHECK(secp256k1_ecdsa_verify(ctx_clone, &sig, msg, &pubkey));
+
+    /* Preallocated clones use the compiled-in tables. */
+    prealloc = malloc(secp256k1_context_preallocated_clone_size(ctx_clone));
+    CHECK(prealloc != NULL);
+    ctx_prealloc_clone = secp256k1_context_preallocated_clone(ctx_clone, prealloc);
+    CHECK(ecmult_tables_eq(&ctx_prealloc_clone->ecmult_tables, &default_tables));
+    CHECK(secp256k1_ecdsa_verify(ctx_prealloc_clone, &sig, msg, &pubkey));
+    secp256k1_context_preallocated_destroy(ctx_prealloc_clone);
+    free(prealloc);
+    secp256k1_context_destroy(ctx_clone);
+}
+
+static void run_context_ecmult_window_tests(void) {
+    test_context_ecmult_window(2);
+    test_context_ecmult_window(WINDOW_G);
+    if (WINDOW_G < 24) {
+        test_context_ecmult_window(WINDOW_G + 1);
+    }
+}
+
+static void test_context_ecmult_gen_comb(int blocks, int teeth) {
+    secp256k1_context *my_ctx, *ctx_clone, *ctx_prealloc_clone;
+    void *prealloc;
+    secp256k1_pubkey pubkey, pubkey_ref;
+    secp256k1_ecdsa_signature sig, sig_ref;
+    unsigned char seckey[32];
+    unsigned char msg[32];
+    unsigned char seed[32];
+    int i;
+
+    CHECK(secp256k1_ecmult_gen_comb_params_valid(blocks, teeth));
+    my_ctx = secp256k1_context_create_with_ecmult_gen_comb(SECP256K1_CONTEXT_NONE, blocks, teeth);
+    CHECK(my_ctx != NULL);
+    CHECK(my_ctx->ecmult_gen_ctx.blocks == blocks);
+    CHECK(my_ctx->ecmult_gen_ctx.teeth == teeth);
+    CHECK(my_ctx->ecmult_gen_ctx.blocks * my_ctx->ecmult_gen_ctx.teeth * my_ctx->ecmult_gen_ctx.spacing >= 256);
+    CHECK(secp256k1_ecmult_gen_context_is_allocated(&my_ctx->ecmult_gen_ctx) == (blocks != COMB_BLOCKS || teeth != COMB_TEETH));
+
+    /* The computed table gives the same results as the compiled-in one, with and
+     * without blinding. */
+    for (i = 0; i < COUNT; i++) {
+        secp256k1_gej r1, r2;
+        secp256k1_scalar s;
+        if (i == COUNT / 2) {
+            testrand256(seed);
+            CHECK(secp256k1_context_randomize(my_ctx, seed));
+        }
+        testutil_random_scalar_order_test(&s);
+        secp256k1_ecmult_gen(&my_ctx->ecmult_gen_ctx, &r1, &s);
+        secp256k1_ecmult_gen(&CTX->ecmult_gen_ctx, &r2, &s);
+        CHECK(secp256k1_gej_eq_var(&r1, &r2));
+    }
+
+    testutil_random_scalar_order_b32(seckey);
+    testutil_random_scalar_order_b32(msg);
+    CHECK(secp256k1_ec_pubkey_create(my_ctx, &pubkey, seckey));
+    CHECK(secp256k1_ec_pubkey_create(CTX, &pubkey_ref, seckey));
+    CHECK(secp256k1_memcmp_var(&pubkey, &pubkey_ref, sizeof(pubkey)) == 0);
+    CHECK(secp256k1_ecdsa_sign(my_ctx, &sig, msg, seckey, NULL, NULL));
+    CHECK(secp256k1_ecdsa_sign(CTX, &sig_ref, msg, seckey, NULL, NULL));
+    CHECK(secp256k1_memcmp_var(&sig, &sig_ref, sizeof(sig)) == 0);
+
+    /* Cloning copies the table and the blinding. */
+    ctx_clone = secp256k1_context_clone(my_ctx);
+    CHECK(context_eq(my_ctx, ctx_clone));
+    CHECK(!secp256k1_ecmult_gen_context_is_allocated(&my_ctx->ecmult_gen_ctx) || ctx_clone->ecmult_gen_ctx.table != my_ctx->ecmult_gen_ctx.table);
+    secp256k1_context_destroy(my_ctx);
+    CHECK(secp256k1_ec_pubkey_create(ctx_clone, &pubkey, seckey));
+    CHECK(secp256k1_memcmp_var(&pubkey, &pubkey_ref, sizeof(pubkey)) == 0);
+
+    /* Preallocated clones use the compiled-in table, but keep the blinding. */
+    prealloc = malloc(secp256k1_context_preallocated_clone_size(ctx_clone));
+    CHECK(prealloc != NULL);
+    ctx_prealloc_clone = secp256k1_context_preallocated_clone(ctx_clone, prealloc);
+    CHECK(!secp256k1_ecmult_gen_context_is_allocated(&ctx_prealloc_clone->ecmult_gen_ctx));
+    CHECK(ctx_prealloc_clone->ecmult_gen_ctx.blocks == COMB_BLOCKS);
+    CHECK(ctx_prealloc_clone->ecmult_gen_ctx.teeth == COMB_TEETH);
+    CHECK(secp256k1_ge_eq_var(&ctx_prealloc_clone->ecmult_gen_ctx.ge_offset, &ctx_clone->ecmult_gen_ctx.ge_offset));
+    CHECK(secp256k1_ec_pubkey_create(ctx_prealloc_clone, &pubkey, seckey));
+    CHECK(secp256k1_memcmp_var(&pubkey, &pubkey_ref, sizeof(pubkey)) == 0);
+    secp256k1_context_preallocated_destroy(ctx_prealloc_clone);
+    free(prealloc);
+    secp256k1_context_destroy(ctx_clone);
+}
+
+static void run_context_ecmult_gen_comb_tests(void) {
+    CHECK(!secp256k1_ecmult_gen_comb_params_valid(0, 6));
+    CHECK(!secp256k1_ecmult_gen_comb_params_valid(11, 0));
+    CHECK(!secp256k1_ecmult_gen_comb_params_valid(ECMULT_GEN_MAX_COMB_BLOCKS + 1, 1));
+    CHECK(!secp256k1_ecmult_gen_comb_params_valid(1, ECMULT_GEN_MAX_COMB_TEETH + 1));
+    /* Too many blocks or teeth for the number of bits they cover. */
+    CHECK(!secp256k1_ecmult_gen_comb_params_valid(12, 6));
+    CHECK(!secp256k1_ecmult_gen_comb_params_valid(11, 7));
+
+    test_context_ecmult_gen_comb(COMB_BLOCKS, COMB_TEETH);
+    test_context_ecmult_gen_comb(1, 8);
+    test_context_ecmult_gen_comb(2, 5);
+    test_context_ecmult_gen_comb(43, 6);
+    test_context_ecmult_gen_comb(11, 12);
+}
+
 static void run_scratch_tests(void) {
     const size_t adj_alloc = ((500 + ALIGNMENT - 1) / ALIGNMENT) * ALIGNMENT;
 
@@ -455,10 +615,12 @@ static void run_sha256_known_output_tests(void) {
         "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
         "For this sample, this 63-byte string will be used as input data",
         "This is exactly 64 bytes long, not counting the terminating byte",
+        "This input is exactly 32 bytes!!",
+        "This input is exactly 96 bytes long, so its final block starts with 32 bytes of the input data!!",
         "aaaaa",
     };
     static const unsigned int repeat[] = {
-        1, 1, 1, 1, 1, 1, 1, 1, 1000000/5
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1000000/5
     };
     static const unsigned char outputs[][32] = {
         {0xe3, 0xb0, 0xc4, 0x42, 0x98, 0xfc, 0x1c, 0x14, 0x9a, 0xfb, 0xf4, 0xc8, 0x99, 0x6f, 0xb9, 0x24, 0x27, 0xae, 0x41, 0xe4, 0x64, 0x9b, 0x93, 0x4c, 0xa4, 0x95, 0x99, 0x1b, 0x78, 0x52, 0xb8, 0x55},
@@ -469,6 +631,8 @@ static void run_sha256_known_output_tests(void) {
         {0x24, 0x8d, 0x6a, 0x61, 0xd2, 0x06, 0x38, 0xb8, 0xe5, 0xc0, 0x26, 0x93, 0x0c, 0x3e, 0x60, 0x39, 0xa3, 0x3c, 0xe4, 0x59, 0x64, 0xff, 0x21, 0x67, 0xf6, 0xec, 0xed, 0xd4, 0x19, 0xdb, 0x06, 0xc1},
         {0xf0, 0x8a, 0x78, 0xcb, 0xba, 0xee, 0x08, 0x2b, 0x05, 0x2a, 0xe0, 0x70, 0x8f, 0x32, 0xfa, 0x1e, 0x50, 0xc5, 0xc4, 0x21, 0xaa, 0x77, 0x2b, 0xa5, 0xdb, 0xb4, 0x06, 0xa2, 0xea, 0x6b, 0xe3, 0x42},
         {0xab, 0x64, 0xef, 0xf7, 0xe8, 0x8e, 0x2e, 0x46, 0x16, 0x5e, 0x29, 0xf2, 0xbc, 0xe4, 0x18, 0x26, 0xbd, 0x4c, 0x7b, 0x35, 0x52, 0xf6, 0xb3, 0x82, 0xa9, 0xe7, 0xd3, 0xaf, 0x47, 0xc2, 0x45, 0xf8},
+        {0x1b, 0x0b, 0x89, 0x3f, 0x38, 0xe1, 0xea, 0xbf, 0x20, 0x31, 0xad, 0x22, 0x68, 0x57, 0x61, 0x2c, 0x15, 0xb9, 0xef, 0x52, 0x26, 0xd7, 0xce, 0x69, 0x5b, 0x61, 0x73, 0xcc, 0x01, 0x10, 0x37, 0xa0},
+        {0xbf, 0xd5, 0xa9, 0x6f, 0x11, 0x63, 0x1d, 0x2d, 0x2d, 0x39, 0xc9, 0x76, 0xb2, 0xa2, 0x0d, 0xa5, 0x60, 0xd6, 0xa1, 0x7c, 0x7f, 0x67, 0x13, 0x22, 0x8e, 0x4a, 0x12, 0x92, 0x5f, 0x7d, 0x9c, 0xa8},
         {0xcd, 0xc7, 0x6e, 0x5c, 0x99, 0x14, 0xfb, 0x92, 0x81, 0xa1, 0xc7, 0xe2, 0x84, 0xd7, 0x3e, 0x67, 0xf1, 0x80, 0x9a, 0x48, 0xa4, 0x97, 0x20, 0x0e, 0x04, 0x6d, 0x39, 0xcc, 0xc7, 0x11, 0x2c, 0xd0},
     };
     unsigned int i, ninputs;
@@ -608,6 +772,123 @@ static void run_sha256_counter_tests(void) {
     }
 }
 
+/* Checks that secp256k1_sha256_transform_many gives the same results as the
+ * portable transformation. */
+static void test_sha256_transform_many(void) {
+    uint32_t s1[SECP256K1_SHA256_MAX_LANES][8], s2[SECP256K1_SHA256_MAX_LANES][8];
+    uint32_t *s[SECP256K1_SHA256_MAX_LANES];
+    unsigned char blocks[64 * SECP256K1_SHA256_MAX_LANES];
+    size_t n = 1 + testrand_int(SECP256K1_SHA256_MAX_LANES);
+    size_t i, j;
+
+    for (i = 0; i < SECP256K1_SHA256_MAX_LANES; i++) {
+        for (j = 0; j < 8; j++) {
+            s1[i][j] = s2[i][j] = testrand32();
+        }
+        s[i] = s1[i];
+    }
+    testrand_bytes_test(blocks, sizeof(blocks));
+    secp256k1_sha256_transform_many(s, blocks, n);
+    for (i = 0; i < n; i++) {
+        secp256k1_sha256_transform_portable(s2[i], &blocks[64*i]);
+        CHECK(secp256k1_memcmp_var(s1[i], s2[i], sizeof(s1[i])) == 0);
+    }
+}
+
+/* Checks that secp256k1_sha256_write_many and secp256k1_sha256_finalize_many
+ * give the same results as hashing the messages one at a time, for messages
+ * with different lengths and buffered bytes. */
+static void test_sha256_write_finalize_many(void) {
+    enum { N = 2 * SECP256K1_SHA256_MAX_LANES + 1 };
+    secp256k1_sha256 hashes1[N], hashes2[N];
+    unsigned char msgs[N][400];
+    const unsigned char *data[N];
+    size_t lens[N];
+    unsigned char out1[N][32], out2[32];
+    size_t n = testrand_int(N + 1);
+    int equal = testrand_bits(1);
+    size_t i;
+    int j;
+
+    for (i = 0; i < N; i++) {
+        data[i] = msgs[i];
+        lens[i] = 0;
+    }
+    for (i = 0; i < n; i++) {
+        testrand_bytes_test(msgs[i], sizeof(msgs[i]));
+        secp256k1_sha256_initialize(&hashes1[i]);
+        secp256k1_sha256_write(&hashes1[i], msgs[i], testrand_int(131));
+        hashes2[i] = hashes1[i];
+    }
+    /* Write two chunks to each hash. Use equal lengths, as the batch
+     * verification does, half of the time. */
+    for (j = 0; j < 2; j++) {
+        for (i = 0; i < n; i++) {
+            lens[i] = equal && i > 0 ? lens[0] : testrand_int(135);
+            data[i] = &msgs[i][131 + 135*j];
+            secp256k1_sha256_write(&hashes2[i], data[i], lens[i]);
+        }
+        secp256k1_sha256_write_many(hashes1, data, lens, n);
+        for (i = 0; i < n; i++) {
+            CHECK(hashes1[i].bytes == hashes2[i].bytes);
+        }
+    }
+    secp256k1_sha256_finalize_many(hashes1, &out1[0][0], n);
+    for (i = 0; i < n; i++) {
+        secp256k1_sha256_finalize(&hashes2[i], out2);
+        CHECK(secp256k1_memcmp_var(out1[i], out2, 32) == 0);
+    }
+}
+
+/* Checks that the SHA-256 transformations chosen for this CPU give the same
+ * results as the portable one, and reruns the tests with known outputs
+ * without each of the CPU features that select them. */
+static void run_sha256_transform_tests(void) {
+    int i;
+
+    for (i = 0; i < COUNT; i++) {
+        uint32_t s1[8], s2[8];
+        unsigned char buf[64];
+        int j;
+
+        for (j = 0; j < 8; j++) {
+            s1[j] = s2[j] = testrand32();
+        }
+        testrand_bytes_test(buf, sizeof(buf));
+        secp256k1_sha256_transform(s1, buf);
+        secp256k1_sha256_transform_portable(s2, buf);
+        CHECK(secp256k1_memcmp_var(s1, s2, sizeof(s1)) == 0);
+        test_sha256_transform_many();
+        test_sha256_write_finalize_many();
+    }
+#ifdef USE_ASM_X86_64
+    {
+        static const int masks[3] = {
+            SECP256K1_SHA256_X86_SHANI,
+            SECP256K1_SHA256_X86_AVX2,
+            SECP256K1_SHA256_X86_SHANI | SECP256K1_SHA256_X86_AVX2
+        };
+        int features = secp256k1_sha256_x86_get_features();
+        int k;
+
+        for (k = 0; k < 3; k++) {
+            if ((features & masks[k]) == 0) {
+                continue;
+            }
+            secp256k1_sha256_x86_features = features & ~masks[k];
+            CHECK(secp256k1_sha256_x86_get_features() == (features & ~masks[k]));
+            run_sha256_known_output_tests();
+            run_sha256_counter_tests();
+            for (i = 0; i < COUNT; i++) {
+                test_sha256_transform_many();
+                test_sha256_write_finalize_many();
+            }
+        }
+        secp256k1_sha256_x86_features = features;
+    }
+#endif
+}
+
 /* Tests for the equality of two sha256 structs. This function only produces a
  * correct result if an integer multiple of 64 many bytes have been written
  * into the hash functions. This function is used by some module tests. */
@@ -728,6 +1009,43 @@ static void run_tagged_sha256_tests(void) {
     CHECK(secp256k1_memcmp_var(hash32, hash_expected, sizeof(hash32)) == 0);
 }
 
+static void run_tagged_sha256_midstate_tests(void) {
+    secp256k1_tagged_sha256_midstate midstate;
+    unsigned char tag[100];
+    unsigned char msg[200];
+    unsigned char hash32[32];
+    unsigned char hash_expected[32];
+    int i;
+
+    /* API test */
+    memset(tag, 0, sizeof(tag));
+    memset(msg, 0, sizeof(msg));
+    CHECK(secp256k1_tagged_sha256_midstate_init(CTX, &midstate, tag, 32) == 1);
+    CHECK_ILLEGAL(CTX, secp256k1_tagged_sha256_midstate_init(CTX, NULL, tag, 32));
+    CHECK_ILLEGAL(CTX, secp256k1_tagged_sha256_midstate_init(CTX, &midstate, NULL, 0));
+    CHECK(secp256k1_tagged_sha256_with_midstate(CTX, hash32, &midstate, msg, 32) == 1);
+    CHECK_ILLEGAL(CTX, secp256k1_tagged_sha256_with_midstate(CTX, NULL, &midstate, msg, 32));
+    CHECK_ILLEGAL(CTX, secp256k1_tagged_sha256_with_midstate(CTX, hash32, NULL, msg, 32));
+    CHECK_ILLEGAL(CTX, secp256k1_tagged_sha256_with_midstate(CTX, hash32, &midstate, NULL, 0));
+    /* The midstate for the BIP340 challenge tag is the one that
+     * secp256k1_schnorrsig_sha256_tagged sets. */
+    CHECK(secp256k1_tagged_sha256_midstate_init(CTX, &midstate, (const unsigned char*)"BIP0340/challenge", 17) == 1);
+    CHECK(secp256k1_read_be32(&midstate.data[0]) == 0x9cecba11ul);
+    CHECK(secp256k1_read_be32(&midstate.data[28]) == 0x33e9b66aul);
+
+    /* Compare with secp256k1_tagged_sha256 for random tags and messages. */
+    for (i = 0; i < COUNT; i++) {
+        size_t taglen = testrand_int(sizeof(tag) + 1);
+        size_t msglen = testrand_int(sizeof(msg) + 1);
+        testrand_bytes_test(tag, taglen);
+        testrand_bytes_test(msg, msglen);
+        CHECK(secp256k1_tagged_sha256_midstate_init(CTX, &midstate, tag, taglen) == 1);
+        CHECK(secp256k1_tagged_sha256_with_midstate(CTX, hash32, &midstate, msg, msglen) == 1);
+        CHECK(secp256k1_tagged_sha256(CTX, hash_expected, tag, taglen, msg, msglen) == 1);
+        CHECK(secp256k1_memcmp_var(hash32, hash_expected, sizeof(hash32)) == 0);
+    }
+}
+
 /***** MODINV TESTS *****/
 
 /* Compute the modular inverse of (odd) x mod 2^64. */
@@ -3560,6 +3878,29 @@ static void run_inverse_tests(void)
     }
 }
 
+static void run_inverse_all_tests(void) {
+    secp256k1_scalar x[16];
+    secp256k1_scalar xi[16];
+    secp256k1_scalar t;
+    size_t len, i;
+
+    for (len = 0; len <= 16; len++) {
+        for (i = 0; i < len; i++) {
+            testutil_random_scalar_order_test(&x[i]);
+        }
+        if (len > 1) {
+            /* Include the scalar 1 and duplicates */
+            x[testrand_int(len)] = secp256k1_scalar_one;
+            x[testrand_int(len)] = x[testrand_int(len)];
+        }
+        secp256k1_scalar_inverse_all_var(xi, x, len);
+        for (i = 0; i < len; i++) {
+            secp256k1_scalar_inverse_var(&t, &x[i]);
+            CHECK(secp256k1_scalar_eq(&t, &xi[i]));
+        }
+    }
+}
+
 /***** HSORT TESTS *****/
 
 static void test_heap_swap(void) {
@@ -4410,6 +4751,109 @@ static void run_ecmult_near_split_bound(void) {
     }
 }
 
+static void test_ecmult_point_table(int window) {
+    secp256k1_ecmult_point_table table;
+    secp256k1_ecmult_tables tables;
+    secp256k1_ge a;
+    secp256k1_gej aj, r1, r2;
+    secp256k1_scalar na, ng;
+    int i;
+
+    testutil_random_ge_test(&a);
+    secp256k1_gej_set_ge(&aj, &a);
+    secp256k1_ecmult_tables_set_default(&tables);
+    CHECK(secp256k1_ecmult_point_table_build(&CTX->error_callback, &table, &a, window));
+    CHECK(table.window == window);
+
+    for (i = 0; i < COUNT; i++) {
+        testutil_random_scalar_order_test(&na);
+        testutil_random_scalar_order_test(&ng);
+        secp256k1_ecmult(&r1, &aj, &na, &ng);
+        secp256k1_ecmult_with_point_table(&tables, &table, &r2, &na, &ng);
+        CHECK(secp256k1_gej_eq_var(&r1, &r2));
+        secp256k1_ecmult(&r1, &aj, &na, NULL);
+        secp256k1_ecmult_with_point_table(&tables, &table, &r2, &na, NULL);
+        CHECK(secp256k1_gej_eq_var(&r1, &r2));
+    }
+
+    /* Zero scalars */
+    secp256k1_ecmult_with_point_table(&tables, &table, &r2, &secp256k1_scalar_zero, NULL);
+    CHECK(secp256k1_gej_is_infinity(&r2));
+    secp256k1_ecmult_with_point_table(&tables, &table, &r2, &secp256k1_scalar_zero, &ng);
+    secp256k1_ecmult(&r1, &aj, &secp256k1_scalar_zero, &ng);
+    CHECK(secp256k1_gej_eq_var(&r1, &r2));
+    /* na*A + (-na)*A */
+    secp256k1_ecmult_with_tables(&tables, &r1, &aj, &na, NULL);
+    secp256k1_scalar_negate(&na, &na);
+    secp256k1_ecmult_with_point_table(&tables, &table, &r2, &na, NULL);
+    secp256k1_gej_add_var(&r1, &r1, &r2, NULL);
+    CHECK(secp256k1_gej_is_infinity(&r1));
+    /* Scalars near the bounds of the endomorphism split */
+    for (i = 0; i < (int)(sizeof(scalars_near_split_bounds) / sizeof(scalars_near_split_bounds[0])); i++) {
+        secp256k1_ecmult(&r1, &aj, &scalars_near_split_bounds[i], &scalars_near_split_bounds[i]);
+        secp256k1_ecmult_with_point_table(&tables, &table, &r2, &scalars_near_split_bounds[i], &scalars_near_split_bounds[i]);
+        CHECK(secp256k1_gej_eq_var(&r1, &r2));
+    }
+
+    secp256k1_ecmult_point_table_free(&table);
+}
+
+static void run_ecmult_point_table_tests(void) {
+    test_ecmult_point_table(2);
+    test_ecmult_point_table(WINDOW_A);
+    test_ecmult_point_table(ECMULT_POINT_TABLE_WINDOW);
+}
+
+static void test_ecmult_interleaved(size_t n) {
+    secp256k1_ecmult_tables tables;
+    secp256k1_gej a[ECMULT_INTERLEAVE_MAX];
+    secp256k1_gej r[ECMULT_INTERLEAVE_MAX];
+    secp256k1_gej r2;
+    secp256k1_scalar na[ECMULT_INTERLEAVE_MAX];
+    secp256k1_scalar ng[ECMULT_INTERLEAVE_MAX];
+    size_t k;
+
+    secp256k1_ecmult_tables_set_default(&tables);
+    for (k = 0; k < n; k++) {
+        testutil_random_gej_test(&a[k]);
+        testutil_random_scalar_order_test(&na[k]);
+        testutil_random_scalar_order_test(&ng[k]);
+        /* Zero scalars, infinity, and scalars near the bounds of the
+         * endomorphism split, mixed with ordinary multiplications */
+        switch (testrand_int(8)) {
+        case 0:
+            na[k] = secp256k1_scalar_zero;
+            break;
+        case 1:
+            ng[k] = secp256k1_scalar_zero;
+            break;
+        case 2:
+            secp256k1_gej_set_infinity(&a[k]);
+            break;
+        case 3:
+            na[k] = scalars_near_split_bounds[testrand_int(sizeof(scalars_near_split_bounds) / sizeof(scalars_near_split_bounds[0]))];
+            ng[k] = na[k];
+            break;
+        }
+    }
+    secp256k1_ecmult_interleaved(&tables, r, a, na, ng, n);
+    for (k = 0; k < n; k++) {
+        secp256k1_ecmult_with_tables(&tables, &r2, &a[k], &na[k], &ng[k]);
+        CHECK(secp256k1_gej_eq_var(&r[k], &r2));
+    }
+}
+
+static void run_ecmult_interleaved_tests(void) {
+    int i;
+    size_t n;
+
+    for (i = 0; i < COUNT; i++) {
+        for (n = 1; n <= ECMULT_INTERLEAVE_MAX; n++) {
+            test_ecmult_interleaved(n);
+        }
+    }
+}
+
 static void run_point_times_order(void) {
     int i;
     secp256k1_fe x = SECP256K1_FE_CONST(0, 0, 0, 0, 0, 0, 0, 2);
@@ -5081,6 +5525,85 @@ static void test_secp256k1_pippenger_bucket_window_inv(void) {
     }
 }
 
+static void test_ecmult_pippenger_affine_scalar(secp256k1_scalar *sc) {
+    unsigned char b32[32];
+    testrand256(b32);
+    memset(b32, 0, 16);
+    secp256k1_scalar_set_b32(sc, b32, NULL);
+}
+
+/* Runs pippenger_wnaf with affine buckets on inputs that put many points into
+ * the same bucket and add points to buckets holding the same or the negated
+ * point, and compares the result to individual multiplications. */
+static void test_ecmult_pippenger_affine(int bucket_window) {
+    const size_t num = 4 * PIPPENGER_AFFINE_BATCH(bucket_window) + 3;
+    secp256k1_scalar *sc = (secp256k1_scalar *)checked_malloc(&CTX->error_callback, num * sizeof(*sc));
+    secp256k1_ge *pt = (secp256k1_ge *)checked_malloc(&CTX->error_callback, num * sizeof(*pt));
+    secp256k1_gej *buckets = (secp256k1_gej *)checked_malloc(&CTX->error_callback, ((size_t)1 << bucket_window) * sizeof(*buckets));
+    struct secp256k1_pippenger_state state;
+    secp256k1_scalar shared;
+    secp256k1_gej expected, r;
+    size_t i;
+
+    CHECK(secp256k1_pippenger_affine(bucket_window));
+    state.wnaf_na = (int *)checked_malloc(&CTX->error_callback, num * WNAF_SIZE(bucket_window+1) * sizeof(int));
+    state.ps = (struct secp256k1_pippenger_point_state *)checked_malloc(&CTX->error_callback, num * sizeof(*state.ps));
+    state.affine = (struct secp256k1_pippenger_affine_bucket *)checked_malloc(&CTX->error_callback, ((size_t)1 << bucket_window) * sizeof(*state.affine));
+    state.additions = (struct secp256k1_pippenger_affine_addition *)checked_malloc(&CTX->error_callback, PIPPENGER_AFFINE_BATCH(bucket_window) * sizeof(*state.additions));
+    state.queue = (int *)checked_malloc(&CTX->error_callback, PIPPENGER_AFFINE_BATCH(bucket_window) * sizeof(int));
+
+    /* pippenger_wnaf expects scalars of at most 128 bits, as produced by the
+     * endomorphism split. */
+    test_ecmult_pippenger_affine_scalar(&shared);
+    secp256k1_gej_set_infinity(&expected);
+    for (i = 0; i < num; i++) {
+        secp256k1_gej tmp;
+
+        /* Start with a point and a copy of it, so the copy is added to a
+         * bucket holding the same point. */
+        switch (i < 2 ? 1 + i : testrand_int(4)) {
+        case 0:
+            testutil_random_ge_test(&pt[i]);
+            test_ecmult_pippenger_affine_scalar(&sc[i]);
+            break;
+        case 1:
+            /* Most points share a scalar, so their digits fall into the same
+             * buckets. */
+            testutil_random_ge_test(&pt[i]);
+            sc[i] = shared;
+            break;
+        case 2:
+            /* The same or the negated point with the same scalar */
+            pt[i] = pt[i - 1];
+            if (testrand_bits(1)) {
+                secp256k1_ge_neg(&pt[i], &pt[i]);
+            }
+            sc[i] = shared;
+            break;
+        default:
+            /* A scalar that shares the upper digits */
+            testutil_random_ge_test(&pt[i]);
+            sc[i] = shared;
+            secp256k1_scalar_cadd_bit(&sc[i], testrand_bits(4), 1);
+        }
+        secp256k1_gej_set_ge(&tmp, &pt[i]);
+        secp256k1_ecmult(&tmp, &tmp, &sc[i], NULL);
+        secp256k1_gej_add_var(&expected, &expected, &tmp, NULL);
+    }
+
+    CHECK(secp256k1_ecmult_pippenger_wnaf(buckets, bucket_window, &state, &r, sc, pt, num));
+    CHECK(secp256k1_gej_eq_var(&expected, &r));
+
+    free(state.wnaf_na);
+    free(state.ps);
+    free(state.affine);
+    free(state.additions);
+    free(state.queue);
+    free(buckets);
+    free(sc);
+    free(pt);
+}
+
 /**
  * Probabilistically test the function returning the maximum number of possible points
  * for a given scratch space.
@@ -5099,7 +5622,7 @@ static void test_ecmult_multi_pippenger_max_points(void) {
         scratch = secp256k1_scratch_create(&CTX->error_callback, scratch_size);
         CHECK(scratch != NULL);
         checkpoint = secp256k1_scratch_checkpoint(&CTX->error_callback, scratch);
-        n_points_supported = secp256k1_pippenger_max_points(&CTX->error_callback, scratch);
+        n_points_supported = secp256k1_pippenger_max_points(&secp256k1_ecmult_multi_params_default, &CTX->error_callback, scratch);
         if (n_points_supported == 0) {
             secp256k1_scratch_destroy(&CTX->error_callback, scratch);
             continue;
@@ -5231,12 +5754,725 @@ static void test_ecmult_multi_batching(void) {
     free(pt);
 }
 
+static void test_ecmult_multi_scratch_size(void) {
+    const size_t n_points[] = { 1, 2, ECMULT_PIPPENGER_THRESHOLD - 1, ECMULT_PIPPENGER_THRESHOLD, 1000, 20000 };
+    size_t i;
+
+    for (i = 0; i < sizeof(n_points)/sizeof(n_points[0]); i++) {
+        secp256k1_scratch *scratch = secp256k1_scratch_space_create(CTX, secp256k1_ecmult_multi_scratch_size(n_points[i]));
+        size_t n_batches, n_batch_points;
+        /* The points fit in a single batch of the algorithm secp256k1_ecmult_multi_var picks */
+        CHECK(secp256k1_ecmult_multi_batch_size_helper(&n_batches, &n_batch_points, secp256k1_pippenger_max_points(&secp256k1_ecmult_multi_params_default, &CTX->error_callback, scratch), n_points[i]));
+        CHECK(n_batches == 1);
+        if (n_points[i] < ECMULT_PIPPENGER_THRESHOLD) {
+            CHECK(secp256k1_strauss_max_points(&CTX->error_callback, scratch) >= n_points[i]);
+        }
+        secp256k1_scratch_space_destroy(CTX, scratch);
+    }
+    CHECK(secp256k1_ecmult_multi_scratch_size(SIZE_MAX) == secp256k1_ecmult_multi_scratch_size(ECMULT_MAX_POINTS_PER_BATCH));
+}
+
+#define N_POINTS 100
+static void test_ecmult_multi_api(void) {
+    secp256k1_scratch_space *scratch = secp256k1_scratch_space_create(CTX, secp256k1_ecmult_multi_scratch_size(N_POINTS));
+    unsigned char scalars[N_POINTS][32];
+    secp256k1_pubkey points[N_POINTS];
+    const unsigned char *scalar_ptrs[N_POINTS];
+    const secp256k1_pubkey *point_ptrs[N_POINTS];
+    unsigned char g_scalar[32];
+    unsigned char overflow_scalar[32];
+    secp256k1_scalar sc;
+    secp256k1_gej expected;
+    secp256k1_ge r;
+    secp256k1_pubkey result, g_result;
+    size_t i;
+
+    testutil_random_scalar_order(&sc);
+    secp256k1_scalar_get_b32(g_scalar, &sc);
+    secp256k1_gej_set_infinity(&expected);
+    secp256k1_ecmult(&expected, &expected, &secp256k1_scalar_zero, &sc);
+    memset(overflow_scalar, 0xFF, sizeof(overflow_scalar));
+
+    for (i = 0; i < N_POINTS; i++) {
+        secp256k1_gej pj, tmp;
+        secp256k1_ge p;
+
+        testutil_random_ge_test(&p);
+        testutil_random_scalar_order(&sc);
+        secp256k1_pubkey_save(&points[i], &p);
+        secp256k1_scalar_get_b32(scalars[i], &sc);
+        scalar_ptrs[i] = scalars[i];
+        point_ptrs[i] = &points[i];
+
+        secp256k1_gej_set_ge(&pj, &p);
+        secp256k1_ecmult(&tmp, &pj, &sc, NULL);
+        secp256k1_gej_add_var(&expected, &expected, &tmp, NULL);
+    }
+
+    /* With and without scratch space */
+    CHECK(secp256k1_ecmult_multi(CTX, scratch, &result, g_scalar, scalar_ptrs, point_ptrs, N_POINTS) == 1);
+    CHECK(secp256k1_pubkey_load(CTX, &r, &result));
+    CHECK(secp256k1_gej_eq_ge_var(&expected, &r));
+    CHECK(secp256k1_ecmult_multi(CTX, NULL, &result, g_scalar, scalar_ptrs, point_ptrs, N_POINTS) == 1);
+    CHECK(secp256k1_pubkey_load(CTX, &r, &result));
+    CHECK(secp256k1_gej_eq_ge_var(&expected, &r));
+
+    /* Only G, and only points */
+    CHECK(secp256k1_ecmult_multi(CTX, scratch, &result, g_scalar, NULL, NULL, 0) == 1);
+    CHECK(secp256k1_ec_pubkey_create(CTX, &g_result, g_scalar) == 1);
+    CHECK(secp256k1_ec_pubkey_cmp(CTX, &result, &g_result) == 0);
+    CHECK(secp256k1_ecmult_multi(CTX, scratch, &result, NULL, scalar_ptrs, point_ptrs, 1) == 1);
+    secp256k1_scalar_set_b32(&sc, scalars[0], NULL);
+    CHECK(secp256k1_pubkey_load(CTX, &r, &points[0]));
+    secp256k1_gej_set_ge(&expected, &r);
+    secp256k1_ecmult(&expected, &expected, &sc, NULL);
+    CHECK(secp256k1_pubkey_load(CTX, &r, &result));
+    CHECK(secp256k1_gej_eq_ge_var(&expected, &r));
+
+    /* Overflowing scalars and infinite results */
+    CHECK(secp256k1_ecmult_multi(CTX, scratch, &result, overflow_scalar, scalar_ptrs, point_ptrs, N_POINTS) == 0);
+    scalar_ptrs[N_POINTS - 1] = overflow_scalar;
+    CHECK(secp256k1_ecmult_multi(CTX, scratch, &result, g_scalar, scalar_ptrs, point_ptrs, N_POINTS) == 0);
+    scalar_ptrs[N_POINTS - 1] = scalars[N_POINTS - 1];
+    CHECK(secp256k1_ecmult_multi(CTX, scratch, &result, NULL, NULL, NULL, 0) == 0);
+    CHECK(secp256k1_ecmult_multi(CTX, scratch, &result, NULL, scalar_ptrs, point_ptrs, 0) == 0);
+    memset(scalars[1], 0, 32);
+    CHECK(secp256k1_ecmult_multi(CTX, scratch, &result, NULL, &scalar_ptrs[1], &point_ptrs[1], 1) == 0);
+    {
+        /* 1*P + (-1)*P */
+        const unsigned char *pair_scalars[2];
+        const secp256k1_pubkey *pair_points[2];
+        secp256k1_pubkey neg;
+        unsigned char one[32] = { 0 };
+        unsigned char minus_one[32];
+
+        one[31] = 1;
+        secp256k1_scalar_set_int(&sc, 1);
+        secp256k1_scalar_negate(&sc, &sc);
+        secp256k1_scalar_get_b32(minus_one, &sc);
+        pair_scalars[0] = one;
+        pair_scalars[1] = minus_one;
+        pair_points[0] = pair_points[1] = &points[0];
+        CHECK(secp256k1_ecmult_multi(CTX, scratch, &result, NULL, pair_scalars, pair_points, 2) == 0);
+        neg = points[0];
+        CHECK(secp256k1_ec_pubkey_negate(CTX, &neg));
+        pair_scalars[1] = one;
+        pair_points[1] = &neg;
+        CHECK(secp256k1_ecmult_multi(CTX, NULL, &result, NULL, pair_scalars, pair_points, 2) == 0);
+    }
+
+    /* Illegal arguments */
+    CHECK_ILLEGAL(CTX, secp256k1_ecmult_multi(CTX, scratch, NULL, g_scalar, scalar_ptrs, point_ptrs, N_POINTS));
+    CHECK_ILLEGAL(CTX, secp256k1_ecmult_multi(CTX, scratch, &result, g_scalar, NULL, point_ptrs, N_POINTS));
+    CHECK_ILLEGAL(CTX, secp256k1_ecmult_multi(CTX, scratch, &result, g_scalar, scalar_ptrs, NULL, N_POINTS));
+    scalar_ptrs[1] = NULL;
+    CHECK_ILLEGAL(CTX, secp256k1_ecmult_multi(CTX, scratch, &result, g_scalar, scalar_ptrs, point_ptrs, N_POINTS));
+    scalar_ptrs[1] = scalars[1];
+    point_ptrs[1] = NULL;
+    CHECK_ILLEGAL(CTX, secp256k1_ecmult_multi(CTX, scratch, &result, g_scalar, scalar_ptrs, point_ptrs, N_POINTS));
+
+    secp256k1_scratch_space_destroy(CTX, scratch);
+    secp256k1_scratch_space_destroy(CTX, NULL);
+}
+
+static void test_ecmult_multi_array_api(void) {
+    secp256k1_scratch_space *scratch = secp256k1_scratch_space_create(CTX, secp256k1_ecmult_multi_scratch_size(N_POINTS));
+    unsigned char scalars[N_POINTS][32];
+    secp256k1_pubkey points[N_POINTS];
+    const unsigned char *scalar_ptrs[N_POINTS];
+    const secp256k1_pubkey *point_ptrs[N_POINTS];
+    unsigned char g_scalar[32];
+    secp256k1_scalar sc;
+    secp256k1_pubkey expected, result;
+    size_t i;
+
+    testutil_random_scalar_order(&sc);
+    secp256k1_scalar_get_b32(g_scalar, &sc);
+    for (i = 0; i < N_POINTS; i++) {
+        secp256k1_ge p;
+
+        testutil_random_ge_test(&p);
+        testutil_random_scalar_order(&sc);
+        secp256k1_pubkey_save(&points[i], &p);
+        secp256k1_scalar_get_b32(scalars[i], &sc);
+        scalar_ptrs[i] = scalars[i];
+        point_ptrs[i] = &points[i];
+    }
+
+    /* Same results as secp256k1_ecmult_multi, with and without scratch space */
+    CHECK(secp256k1_ecmult_multi(CTX, scratch, &expected, g_scalar, scalar_ptrs, point_ptrs, N_POINTS) == 1);
+    CHECK(secp256k1_ecmult_multi_array(CTX, scratch, &result, g_scalar, scalars[0], points, N_POINTS) == 1);
+    CHECK(secp256k1_memcmp_var(&expected, &result, sizeof(result)) == 0);
+    CHECK(secp256k1_ecmult_multi_array(CTX, NULL, &result, g_scalar, scalars[0], points, N_POINTS) == 1);
+    CHECK(secp256k1_memcmp_var(&expected, &result, sizeof(result)) == 0);
+    CHECK(secp256k1_ecmult_multi(CTX, scratch, &expected, NULL, &scalar_ptrs[3], &point_ptrs[3], 5) == 1);
+    CHECK(secp256k1_ecmult_multi_array(CTX, scratch, &result, NULL, scalars[3], &points[3], 5) == 1);
+    CHECK(secp256k1_memcmp_var(&expected, &result, sizeof(result)) == 0);
+    CHECK(secp256k1_ecmult_multi(CTX, scratch, &expected, g_scalar, NULL, NULL, 0) == 1);
+    CHECK(secp256k1_ecmult_multi_array(CTX, scratch, &result, g_scalar, NULL, NULL, 0) == 1);
+    CHECK(secp256k1_memcmp_var(&expected, &result, sizeof(result)) == 0);
+
+    /* Overflowing scalars and infinite results */
+    memset(scalars[N_POINTS - 1], 0xFF, 32);
+    CHECK(secp256k1_ecmult_multi_array(CTX, scratch, &result, g_scalar, scalars[0], points, N_POINTS) == 0);
+    CHECK(secp256k1_ecmult_multi_array(CTX, NULL, &result, g_scalar, scalars[0], points, N_POINTS) == 0);
+    CHECK(secp256k1_ecmult_multi_array(CTX, scratch, &result, scalars[N_POINTS - 1], scalars[0], points, 1) == 0);
+    CHECK(secp256k1_ecmult_multi_array(CTX, scratch, &result, NULL, NULL, NULL, 0) == 0);
+    memset(scalars[0], 0, 32);
+    CHECK(secp256k1_ecmult_multi_array(CTX, scratch, &result, NULL, scalars[0], points, 1) == 0);
+
+    /* Illegal arguments */
+    CHECK_ILLEGAL(CTX, secp256k1_ecmult_multi_array(CTX, scratch, NULL, g_scalar, scalars[0], points, N_POINTS));
+    CHECK_ILLEGAL(CTX, secp256k1_ecmult_multi_array(CTX, scratch, &result, g_scalar, NULL, points, N_POINTS));
+    CHECK_ILLEGAL(CTX, secp256k1_ecmult_multi_array(CTX, scratch, &result, g_scalar, scalars[0], NULL, N_POINTS));
+    memset(&points[1], 0, sizeof(points[1]));
+    CHECK_ILLEGAL(CTX, secp256k1_ecmult_multi_array(CTX, scratch, &result, g_scalar, scalars[0], points, N_POINTS));
+
+    secp256k1_scratch_space_destroy(CTX, scratch);
+}
+
+/* Checks that passing points and scalars to secp256k1_ecmult_multi_var_input
+ * as bytes gives the same results as passing them through a callback. */
+static void test_ecmult_multi_input(size_t n, size_t scratch_size) {
+    secp256k1_scratch *scratch = scratch_size > 0 ? secp256k1_scratch_create(&CTX->error_callback, scratch_size) : NULL;
+    secp256k1_scalar *sc = (secp256k1_scalar *)checked_malloc(&CTX->error_callback, n * sizeof(*sc));
+    secp256k1_ge *pt = (secp256k1_ge *)checked_malloc(&CTX->error_callback, n * sizeof(*pt));
+    unsigned char *sc32 = (unsigned char *)checked_malloc(&CTX->error_callback, n * 32);
+    unsigned char *pt64 = (unsigned char *)checked_malloc(&CTX->error_callback, n * 64);
+    secp256k1_ecmult_multi_input input;
+    ecmult_multi_data data;
+    secp256k1_scalar g_sc;
+    secp256k1_gej expected, r;
+    size_t i;
+
+    testutil_random_scalar_order(&g_sc);
+    for (i = 0; i < n; i++) {
+        testutil_random_scalar_order(&sc[i]);
+        testutil_random_ge_test(&pt[i]);
+        secp256k1_scalar_get_b32(&sc32[32*i], &sc[i]);
+        secp256k1_ge_to_bytes(&pt64[64*i], &pt[i]);
+    }
+    data.sc = sc;
+    data.pt = pt;
+    CHECK(secp256k1_ecmult_multi_var(&CTX->error_callback, scratch, &expected, &g_sc, ecmult_multi_callback, &data, n));
+
+    secp256k1_ecmult_multi_input_init_bytes(&input, sc32, pt64);
+    CHECK(secp256k1_ecmult_multi_var_input(&secp256k1_ecmult_multi_params_default, &CTX->error_callback, scratch, &r, &g_sc, &input, n));
+    CHECK(secp256k1_gej_eq_var(&expected, &r));
+
+    /* An overflowing scalar anywhere makes the multiplication fail */
+    memset(&sc32[32*(n - 1)], 0xFF, 32);
+    CHECK(!secp256k1_ecmult_multi_var_input(&secp256k1_ecmult_multi_params_default, &CTX->error_callback, scratch, &r, &g_sc, &input, n));
+
+    /* So does an all-zero point */
+    secp256k1_scalar_get_b32(&sc32[32*(n - 1)], &sc[n - 1]);
+    memset(&pt64[64*(n - 1)], 0, 64);
+    CHECK(!secp256k1_ecmult_multi_var_input(&secp256k1_ecmult_multi_params_default, &CTX->error_callback, scratch, &r, &g_sc, &input, n));
+
+    if (scratch != NULL) {
+        secp256k1_scratch_destroy(&CTX->error_callback, scratch);
+    }
+    free(sc);
+    free(pt);
+    free(sc32);
+    free(pt64);
+}
+
+/* Checks secp256k1_ecmult_multi_fixed_var against secp256k1_ecmult_multi_var with
+ * a scratch space for scratch_points points in Strauss' algorithm (or none if 0). */
+static void test_ecmult_multi_fixed(size_t n, int window, int chunks, size_t scratch_points) {
+    secp256k1_scalar *sc = (secp256k1_scalar *)checked_malloc(&CTX->error_callback, n * sizeof(*sc));
+    secp256k1_ge *pt = (secp256k1_ge *)checked_malloc(&CTX->error_callback, n * sizeof(*pt));
+    unsigned char *sc32 = (unsigned char *)checked_malloc(&CTX->error_callback, n * 32);
+    secp256k1_scratch *scratch = NULL;
+    secp256k1_ecmult_fixed_bases bases;
+    ecmult_multi_data data;
+    secp256k1_scalar g_sc;
+    secp256k1_gej expected, r;
+    size_t i;
+
+    testutil_random_scalar_order(&g_sc);
+    for (i = 0; i < n; i++) {
+        testutil_random_scalar_order(&sc[i]);
+        testutil_random_ge_test(&pt[i]);
+    }
+    /* Edge cases: a zero scalar, and -1 */
+    secp256k1_scalar_set_int(&sc[0], 0);
+    secp256k1_scalar_negate(&sc[n - 1], &secp256k1_scalar_one);
+    for (i = 0; i < n; i++) {
+        secp256k1_scalar_get_b32(&sc32[32*i], &sc[i]);
+    }
+    CHECK(secp256k1_ecmult_fixed_bases_build(&CTX->error_callback, &bases, pt, n, window, chunks));
+    CHECK(bases.n == n);
+    if (scratch_points > 0) {
+        scratch = secp256k1_scratch_create(&CTX->error_callback, scratch_points * secp256k1_ecmult_fixed_bases_wnaf_size(chunks) * sizeof(int) + ALIGNMENT);
+    }
+
+    data.sc = sc;
+    data.pt = pt;
+    CHECK(secp256k1_ecmult_multi_var(&CTX->error_callback, NULL, &expected, &g_sc, ecmult_multi_callback, &data, n));
+    CHECK(secp256k1_ecmult_multi_fixed_var(&secp256k1_ecmult_multi_params_default, &CTX->ecmult_tables, &CTX->error_callback, scratch, &r, &g_sc, &bases, sc32));
+    CHECK(secp256k1_gej_eq_var(&expected, &r));
+    CHECK(secp256k1_ecmult_multi_var(&CTX->error_callback, NULL, &expected, NULL, ecmult_multi_callback, &data, n));
+    CHECK(secp256k1_ecmult_multi_fixed_var(&secp256k1_ecmult_multi_params_default, &CTX->ecmult_tables, &CTX->error_callback, scratch, &r, NULL, &bases, sc32));
+    CHECK(secp256k1_gej_eq_var(&expected, &r));
+
+    /* An overflowing scalar anywhere makes the multiplication fail */
+    memset(&sc32[32*(n - 1)], 0xFF, 32);
+    CHECK(!secp256k1_ecmult_multi_fixed_var(&secp256k1_ecmult_multi_params_default, &CTX->ecmult_tables, &CTX->error_callback, scratch, &r, &g_sc, &bases, sc32));
+
+    secp256k1_ecmult_fixed_bases_free(&bases);
+    if (scratch != NULL) {
+        secp256k1_scratch_destroy(&CTX->error_callback, scratch);
+    }
+    free(sc);
+    free(pt);
+    free(sc32);
+}
+
+static void test_ecmult_multi_fixed_large(void) {
+    /* With enough scratch space, this many points are multiplied with Pippenger's
+     * algorithm, and otherwise in batches with Strauss' algorithm. */
+    size_t n = ECMULT_FIXED_BASES_PIPPENGER_THRESHOLD;
+    secp256k1_scalar *sc = (secp256k1_scalar *)checked_malloc(&CTX->error_callback, n * sizeof(*sc));
+    secp256k1_ge *pt = (secp256k1_ge *)checked_malloc(&CTX->error_callback, n * sizeof(*pt));
+    unsigned char *sc32 = (unsigned char *)checked_malloc(&CTX->error_callback, n * 32);
+    secp256k1_scratch *scratch = secp256k1_scratch_create(&CTX->error_callback, secp256k1_ecmult_multi_scratch_size_internal(n));
+    secp256k1_scratch *scratch_small = secp256k1_scratch_create(&CTX->error_callback, secp256k1_ecmult_multi_scratch_size_internal(n / 4));
+    secp256k1_ecmult_fixed_bases bases;
+    ecmult_multi_data data;
+    secp256k1_scalar g_sc;
+    secp256k1_gej expected, r;
+    size_t i;
+
+    testutil_random_scalar_order(&g_sc);
+    for (i = 0; i < n; i++) {
+        testutil_random_scalar_order(&sc[i]);
+        testutil_random_ge_test(&pt[i]);
+        secp256k1_scalar_get_b32(&sc32[32*i], &sc[i]);
+    }
+    CHECK(secp256k1_ecmult_fixed_bases_build(&CTX->error_callback, &bases, pt, n, ECMULT_FIXED_BASES_WINDOW, ECMULT_FIXED_BASES_CHUNKS));
+    data.sc = sc;
+    data.pt = pt;
+    CHECK(secp256k1_ecmult_multi_var(&CTX->error_callback, scratch, &expected, &g_sc, ecmult_multi_callback, &data, n));
+    CHECK(secp256k1_ecmult_multi_fixed_var(&secp256k1_ecmult_multi_params_default, &CTX->ecmult_tables, &CTX->error_callback, scratch, &r, &g_sc, &bases, sc32));
+    CHECK(secp256k1_gej_eq_var(&expected, &r));
+    CHECK(secp256k1_ecmult_multi_fixed_var(&secp256k1_ecmult_multi_params_default, &CTX->ecmult_tables, &CTX->error_callback, scratch_small, &r, &g_sc, &bases, sc32));
+    CHECK(secp256k1_gej_eq_var(&expected, &r));
+    memset(&sc32[32*(n - 1)], 0xFF, 32);
+    CHECK(!secp256k1_ecmult_multi_fixed_var(&secp256k1_ecmult_multi_params_default, &CTX->ecmult_tables, &CTX->error_callback, scratch, &r, &g_sc, &bases, sc32));
+
+    secp256k1_ecmult_fixed_bases_free(&bases);
+    secp256k1_scratch_destroy(&CTX->error_callback, scratch);
+    secp256k1_scratch_destroy(&CTX->error_callback, scratch_small);
+    free(sc);
+    free(pt);
+    free(sc32);
+}
+
+/* Checks that secp256k1_ecmult_multi_fixed_scratch_size leaves room to
+ * process all points in a single batch. */
+static void test_ecmult_multi_fixed_scratch_size(void) {
+    const size_t ns[] = { 2, 20, 200, 500, ECMULT_FIXED_BASES_PIPPENGER_THRESHOLD - 1, ECMULT_FIXED_BASES_PIPPENGER_THRESHOLD, 2000 };
+    size_t i;
+
+    for (i = 0; i < sizeof(ns) / sizeof(ns[0]); i++) {
+        secp256k1_ecmult_fixed_bases bases;
+        secp256k1_scratch *scratch = secp256k1_scratch_create(&CTX->error_callback, secp256k1_ecmult_multi_fixed_scratch_size(ns[i]));
+
+        /* Only the number of points and chunks are needed to plan the batches */
+        memset(&bases, 0, sizeof(bases));
+        bases.n = ns[i];
+        bases.window = ECMULT_FIXED_BASES_WINDOW;
+        bases.chunks = ECMULT_FIXED_BASES_CHUNKS;
+        if (ns[i] >= ECMULT_FIXED_BASES_PIPPENGER_THRESHOLD) {
+            CHECK(secp256k1_ecmult_fixed_bases_use_pippenger(&secp256k1_ecmult_multi_params_default, &CTX->error_callback, scratch, &bases));
+        } else {
+            CHECK(!secp256k1_ecmult_fixed_bases_use_pippenger(&secp256k1_ecmult_multi_params_default, &CTX->error_callback, scratch, &bases));
+            CHECK(secp256k1_ecmult_fixed_bases_batch_points(&CTX->error_callback, scratch, &bases) == ns[i]);
+        }
+        secp256k1_scratch_destroy(&CTX->error_callback, scratch);
+    }
+}
+
+/* Checks that building tables whose size doesn't fit into a size_t fails
+ * before anything is allocated or read. */
+static void test_ecmult_fixed_bases_max_points(void) {
+    secp256k1_ecmult_fixed_bases bases;
+    int window, chunks;
+
+    for (window = 2; window <= 16; window++) {
+        for (chunks = 1; chunks <= ECMULT_FIXED_BASES_MAX_CHUNKS; chunks++) {
+            const size_t n_max = secp256k1_ecmult_fixed_bases_max_points(window, chunks);
+            const size_t entry_size = (1 + (size_t)chunks * ECMULT_TABLE_SIZE(window)) * sizeof(secp256k1_ge_storage);
+
+            CHECK(n_max > 0);
+            CHECK(n_max <= SIZE_MAX / entry_size);
+            CHECK(n_max + 1 > SIZE_MAX / entry_size);
+            CHECK(!secp256k1_ecmult_fixed_bases_build(&CTX->error_callback, &bases, NULL, n_max + 1, window, chunks));
+            CHECK(!secp256k1_ecmult_fixed_bases_build(&CTX->error_callback, &bases, NULL, SIZE_MAX, window, chunks));
+        }
+    }
+}
+
+static void test_ecmult_multi_fixed_api(void) {
+    secp256k1_scratch_space *scratch = secp256k1_scratch_space_create(CTX, secp256k1_ecmult_multi_fixed_scratch_size(N_POINTS));
+    unsigned char scalars[N_POINTS][32];
+    secp256k1_pubkey points[N_POINTS];
+    unsigned char g_scalar[32];
+    secp256k1_fixed_bases *bases;
+    secp256k1_scalar sc;
+    secp256k1_pubkey expected, result;
+    const size_t n_max = secp256k1_ecmult_fixed_bases_max_points(ECMULT_FIXED_BASES_WINDOW, ECMULT_FIXED_BASES_CHUNKS);
+    size_t i;
+
+    testutil_random_scalar_order(&sc);
+    secp256k1_scalar_get_b32(g_scalar, &sc);
+    for (i = 0; i < N_POINTS; i++) {
+        secp256k1_ge p;
+
+        testutil_random_ge_test(&p);
+        testutil_random_scalar_order(&sc);
+        secp256k1_pubkey_save(&points[i], &p);
+        secp256k1_scalar_get_b32(scalars[i], &sc);
+    }
+    bases = secp256k1_fixed_bases_create(CTX, points, N_POINTS);
+    CHECK(bases != NULL);
+
+    /* Same results as secp256k1_ecmult_multi_array, with and without scratch space */
+    CHECK(secp256k1_ecmult_multi_array(CTX, scratch, &expected, g_scalar, scalars[0], points, N_POINTS) == 1);
+    CHECK(secp256k1_ecmult_multi_fixed(CTX, scratch, &result, g_scalar, scalars[0], bases) == 1);
+    CHECK(secp256k1_memcmp_var(&expected, &result, sizeof(result)) == 0);
+    CHECK(secp256k1_ecmult_multi_fixed(CTX, NULL, &result, g_scalar, scalars[0], bases) == 1);
+    CHECK(secp256k1_memcmp_var(&expected, &result, sizeof(result)) == 0);
+    CHECK(secp256k1_ecmult_multi_array(CTX, scratch, &expected, NULL, scalars[0], points, N_POINTS) == 1);
+    CHECK(secp256k1_ecmult_multi_fixed(CTX, scratch, &result, NULL, scalars[0], bases) == 1);
+    CHECK(secp256k1_memcmp_var(&expected, &result, sizeof(result)) == 0);
+
+    /* Overflowing scalars and infinite results */
+    memset(g_scalar, 0xFF, 32);
+    CHECK(secp256k1_ecmult_multi_fixed(CTX, scratch, &result, g_scalar, scalars[0], bases) == 0);
+    memset(scalars, 0, sizeof(scalars));
+    CHECK(secp256k1_ecmult_multi_fixed(CTX, scratch, &result, NULL, scalars[0], bases) == 0);
+    memset(scalars[N_POINTS - 1], 0xFF, 32);
+    CHECK(secp256k1_ecmult_multi_fixed(CTX, scratch, &result, NULL, scalars[0], bases) == 0);
+
+    /* Illegal arguments */
+    CHECK_ILLEGAL(CTX, secp256k1_ecmult_multi_fixed(CTX, scratch, NULL, NULL, scalars[0], bases));
+    CHECK_ILLEGAL(CTX, secp256k1_ecmult_multi_fixed(CTX, scratch, &result, NULL, NULL, bases));
+    CHECK_ILLEGAL(CTX, secp256k1_ecmult_multi_fixed(CTX, scratch, &result, NULL, scalars[0], NULL));
+    CHECK_ILLEGAL_VOID(CTX, CHECK(secp256k1_fixed_bases_create(CTX, NULL, N_POINTS) == NULL));
+    CHECK_ILLEGAL_VOID(CTX, CHECK(secp256k1_fixed_bases_create(CTX, points, 0) == NULL));
+    /* Too many points for the size of the tables to fit into a size_t. The
+     * points are not read in that case. */
+    CHECK(secp256k1_fixed_bases_create(CTX, points, n_max + 1) == NULL);
+    CHECK(secp256k1_fixed_bases_create(CTX, points, SIZE_MAX) == NULL);
+    memset(&points[1], 0, sizeof(points[1]));
+    CHECK_ILLEGAL_VOID(CTX, CHECK(secp256k1_fixed_bases_create(CTX, points, N_POINTS) == NULL));
+
+    secp256k1_fixed_bases_destroy(CTX, bases);
+    secp256k1_fixed_bases_destroy(CTX, NULL);
+    secp256k1_scratch_space_destroy(CTX, scratch);
+}
+#undef N_POINTS
+
+/* Runs the tasks one after another in reverse order, counting them in *data. */
+static void ecmult_multi_test_runner(void (*task)(void *task_data, size_t idx), void *task_data, size_t n_tasks, void *data) {
+    size_t *count = (size_t *)data;
+    size_t i;
+
+    for (i = n_tasks; i > 0; i--) {
+        task(task_data, i - 1);
+    }
+    *count += n_tasks;
+}
+
+static int ecmult_multi_parallel_3(const secp256k1_callback* error_callback, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, void *cbdata, size_t n) {
+    size_t count = 0;
+    return secp256k1_ecmult_multi_var_parallel(&secp256k1_ecmult_multi_params_default, error_callback, scratch, r, inp_g_sc, cb, cbdata, n, ecmult_multi_test_runner, &count, 3);
+}
+
+static void test_ecmult_multi_parallel(void) {
+    const size_t n_points = 3 * ECMULT_PIPPENGER_THRESHOLD;
+    const size_t n_tasks[] = { 2, 3, 5, 100 };
+    secp256k1_scalar *sc = (secp256k1_scalar *)checked_malloc(&CTX->error_callback, n_points * sizeof(secp256k1_scalar));
+    secp256k1_ge *pt = (secp256k1_ge *)checked_malloc(&CTX->error_callback, n_points * sizeof(secp256k1_ge));
+    secp256k1_scalar sc_g;
+    secp256k1_gej expected, r;
+    secp256k1_scratch *scratch;
+    ecmult_multi_data data;
+    size_t i;
+
+    testutil_random_scalar_order(&sc_g);
+    for (i = 0; i < n_points; i++) {
+        testutil_random_ge_test(&pt[i]);
+        testutil_random_scalar_order(&sc[i]);
+    }
+    data.sc = sc;
+    data.pt = pt;
+    scratch = secp256k1_scratch_create(&CTX->error_callback, secp256k1_ecmult_multi_parallel_scratch_size_internal(n_points, 5));
+    CHECK(secp256k1_ecmult_multi_var(&CTX->error_callback, scratch, &expected, &sc_g, ecmult_multi_callback, &data, n_points));
+
+    for (i = 0; i < sizeof(n_tasks)/sizeof(n_tasks[0]); i++) {
+        size_t count = 0;
+        size_t checkpoint = secp256k1_scratch_checkpoint(&CTX->error_callback, scratch);
+        CHECK(secp256k1_ecmult_multi_var_parallel(&secp256k1_ecmult_multi_params_default, &CTX->error_callback, scratch, &r, &sc_g, ecmult_multi_callback, &data, n_points, ecmult_multi_test_runner, &count, n_tasks[i]));
+        CHECK(secp256k1_gej_eq_var(&expected, &r));
+        /* Ranges are never smaller than ECMULT_PIPPENGER_THRESHOLD points, so
+         * there are at most n_points / ECMULT_PIPPENGER_THRESHOLD of them. */
+        CHECK(count == (n_tasks[i] < 3 ? n_tasks[i] : 3));
+        CHECK(secp256k1_scratch_checkpoint(&CTX->error_callback, scratch) == checkpoint);
+    }
+
+    /* Without scratch space, or with a single task, the runner is not used */
+    for (i = 0; i < 2; i++) {
+        size_t count = 0;
+        CHECK(secp256k1_ecmult_multi_var_parallel(&secp256k1_ecmult_multi_params_default, &CTX->error_callback, i == 0 ? NULL : scratch, &r, &sc_g, ecmult_multi_callback, &data, n_points, ecmult_multi_test_runner, &count, i == 0 ? 5 : 1));
+        CHECK(secp256k1_gej_eq_var(&expected, &r));
+        CHECK(count == 0);
+    }
+
+    /* Without points, the runner is not used even for huge numbers of tasks */
+    {
+        size_t count = 0;
+        secp256k1_gej expected_g;
+        secp256k1_ecmult_gen(&CTX->ecmult_gen_ctx, &expected_g, &sc_g);
+        CHECK(secp256k1_ecmult_multi_var_parallel(&secp256k1_ecmult_multi_params_default, &CTX->error_callback, scratch, &r, &sc_g, ecmult_multi_callback, &data, 0, ecmult_multi_test_runner, &count, SIZE_MAX));
+        CHECK(secp256k1_gej_eq_var(&expected_g, &r));
+        CHECK(count == 0);
+    }
+
+    /* A failing callback in any task makes the whole computation fail */
+    {
+        size_t count = 0;
+        CHECK(!secp256k1_ecmult_multi_var_parallel(&secp256k1_ecmult_multi_params_default, &CTX->error_callback, scratch, &r, &sc_g, ecmult_multi_false_callback, &data, n_points, ecmult_multi_test_runner, &count, 3));
+        CHECK(count == 3);
+    }
+    secp256k1_scratch_destroy(&CTX->error_callback, scratch);
+
+    /* Tasks whose share of the scratch space is too small for a single point
+     * fall back to the simple algorithm */
+    scratch = secp256k1_scratch_create(&CTX->error_callback, 3 * sizeof(struct secp256k1_ecmult_multi_task) + 4 * ALIGNMENT);
+    {
+        size_t count = 0;
+        CHECK(secp256k1_ecmult_multi_var_parallel(&secp256k1_ecmult_multi_params_default, &CTX->error_callback, scratch, &r, &sc_g, ecmult_multi_callback, &data, n_points, ecmult_multi_test_runner, &count, 3));
+        CHECK(secp256k1_gej_eq_var(&expected, &r));
+        CHECK(count == 3);
+    }
+    secp256k1_scratch_destroy(&CTX->error_callback, scratch);
+
+    free(sc);
+    free(pt);
+}
+
+static void test_ecmult_multi_parallel_api(void) {
+    const size_t n_points = 2 * ECMULT_PIPPENGER_THRESHOLD + 1;
+    secp256k1_scratch_space *scratch = secp256k1_scratch_space_create(CTX, secp256k1_ecmult_multi_parallel_scratch_size(n_points, 2));
+    unsigned char (*scalars)[32] = (unsigned char (*)[32])checked_malloc(&CTX->error_callback, n_points * 32);
+    secp256k1_pubkey *points = (secp256k1_pubkey *)checked_malloc(&CTX->error_callback, n_points * sizeof(secp256k1_pubkey));
+    const unsigned char **scalar_ptrs = (const unsigned char **)checked_malloc(&CTX->error_callback, n_points * sizeof(*scalar_ptrs));
+    const secp256k1_pubkey **point_ptrs = (const secp256k1_pubkey **)checked_malloc(&CTX->error_callback, n_points * sizeof(*point_ptrs));
+    unsigned char g_scalar[32];
+    secp256k1_pubkey expected, result;
+    size_t count = 0;
+    size_t i;
+
+    testrand256(g_scalar);
+    for (i = 0; i < n_points; i++) {
+        secp256k1_scalar sc;
+        secp256k1_ge p;
+
+        testutil_random_ge_test(&p);
+        testutil_random_scalar_order(&sc);
+        secp256k1_pubkey_save(&points[i], &p);
+        secp256k1_scalar_get_b32(scalars[i], &sc);
+        scalar_ptrs[i] = scalars[i];
+        point_ptrs[i] = &points[i];
+    }
+    CHECK(secp256k1_ecmult_multi(CTX, scratch, &expected, g_scalar, scalar_ptrs, point_ptrs, n_points) == 1);
+
+    CHECK(secp256k1_ecmult_multi_parallel(CTX, scratch, &result, g_scalar, scalar_ptrs, point_ptrs, n_points, ecmult_multi_test_runner, &count, 2) == 1);
+    CHECK(secp256k1_memcmp_var(&expected, &result, sizeof(result)) == 0);
+    CHECK(count == 2);
+    CHECK(secp256k1_ecmult_multi_parallel(CTX, NULL, &result, g_scalar, scalar_ptrs, point_ptrs, n_points, ecmult_multi_test_runner, &count, 2) == 1);
+    CHECK(secp256k1_memcmp_var(&expected, &result, sizeof(result)) == 0);
+    CHECK(count == 2);
+
+    /* Without points, no task is run even for huge numbers of tasks */
+    count = 0;
+    CHECK(secp256k1_ecmult_multi_parallel(CTX, scratch, &result, g_scalar, NULL, NULL, 0, ecmult_multi_test_runner, &count, SIZE_MAX) == 1);
+    CHECK(secp256k1_ec_pubkey_create(CTX, &expected, g_scalar) == 1);
+    CHECK(secp256k1_memcmp_var(&expected, &result, sizeof(result)) == 0);
+    CHECK(count == 0);
+
+    /* Overflowing scalars */
+    scalar_ptrs[n_points - 1] = g_scalar;
+    memset(g_scalar, 0xFF, sizeof(g_scalar));
+    CHECK(secp256k1_ecmult_multi_parallel(CTX, scratch, &result, NULL, scalar_ptrs, point_ptrs, n_points, ecmult_multi_test_runner, &count, 2) == 0);
+    scalar_ptrs[n_points - 1] = scalars[n_points - 1];
+
+    /* Illegal arguments */
+    CHECK_ILLEGAL(CTX, secp256k1_ecmult_multi_parallel(CTX, scratch, NULL, NULL, scalar_ptrs, point_ptrs, n_points, ecmult_multi_test_runner, &count, 2));
+    CHECK_ILLEGAL(CTX, secp256k1_ecmult_multi_parallel(CTX, scratch, &result, NULL, scalar_ptrs, point_ptrs, n_points, NULL, &count, 2));
+    CHECK_ILLEGAL(CTX, secp256k1_ecmult_multi_parallel(CTX, scratch, &result, NULL, scalar_ptrs, point_ptrs, n_points, ecmult_multi_test_runner, &count, 0));
+    CHECK_ILLEGAL(CTX, secp256k1_ecmult_multi_parallel(CTX, scratch, &result, NULL, NULL, point_ptrs, n_points, ecmult_multi_test_runner, &count, 2));
+
+    CHECK(secp256k1_ecmult_multi_parallel_scratch_size(n_points, 0) == secp256k1_ecmult_multi_parallel_scratch_size(n_points, 1));
+    CHECK(secp256k1_ecmult_multi_parallel_scratch_size(n_points, 1) >= secp256k1_ecmult_multi_scratch_size(n_points));
+
+    secp256k1_scratch_space_destroy(CTX, scratch);
+    free(scalars);
+    free(points);
+    free(scalar_ptrs);
+    free(point_ptrs);
+}
+
+static secp256k1_ecmult_multi_params ecmult_multi_test_params;
+
+static int ecmult_multi_with_test_params(const secp256k1_callback* error_callback, secp256k1_scratch *scratch, secp256k1_gej *r, const secp256k1_scalar *inp_g_sc, secp256k1_ecmult_multi_callback cb, void *cbdata, size_t n) {
+    return secp256k1_ecmult_multi_var_with_params(&ecmult_multi_test_params, error_callback, scratch, r, inp_g_sc, cb, cbdata, n);
+}
+
+/* Checks the invariants that secp256k1_ecmult_multi_params_from_bytes enforces. */
+static void test_ecmult_multi_params_valid(const secp256k1_ecmult_multi_params *params) {
+    int i;
+
+    CHECK(params->pippenger_threshold >= 1);
+    for (i = 1; i < PIPPENGER_MAX_BUCKET_WINDOW; i++) {
+        CHECK(params->pippenger_max_points[i] >= params->pippenger_max_points[i - 1]);
+    }
+    CHECK(params->pippenger_max_points[PIPPENGER_MAX_BUCKET_WINDOW - 1] == SIZE_MAX);
+}
+
+static void test_ecmult_multi_params(secp256k1_scratch *scratch) {
+    unsigned char buf[ECMULT_MULTI_PARAMS_SIZE];
+    unsigned char buf2[ECMULT_MULTI_PARAMS_SIZE];
+    secp256k1_ecmult_multi_params params;
+    int i;
+
+    test_ecmult_multi_params_valid(&secp256k1_ecmult_multi_params_default);
+    secp256k1_ecmult_multi_params_set_default(&params);
+    CHECK(secp256k1_memcmp_var(&params, &secp256k1_ecmult_multi_params_default, sizeof(params)) == 0);
+    for (i = 1; i <= PIPPENGER_MAX_BUCKET_WINDOW; i++) {
+        CHECK(secp256k1_ecmult_multi_params_bucket_window(&params, secp256k1_pippenger_bucket_window_inv(i)) <= i);
+    }
+
+    /* Serialization round trip */
+    secp256k1_ecmult_multi_params_to_bytes(buf, &secp256k1_ecmult_multi_params_default);
+    memset(&params, 0, sizeof(params));
+    CHECK(secp256k1_ecmult_multi_params_from_bytes(&params, buf));
+    CHECK(secp256k1_memcmp_var(&params, &secp256k1_ecmult_multi_params_default, sizeof(params)) == 0);
+    secp256k1_ecmult_multi_params_to_bytes(buf2, &params);
+    CHECK(secp256k1_memcmp_var(buf, buf2, sizeof(buf)) == 0);
+
+    /* Invalid serializations leave params unchanged */
+    memcpy(buf2, buf, sizeof(buf));
+    buf2[0] = PIPPENGER_MAX_BUCKET_WINDOW + 1;
+    CHECK(!secp256k1_ecmult_multi_params_from_bytes(&params, buf2));
+    memcpy(buf2, buf, sizeof(buf));
+    memset(&buf2[1], 0, 4);
+    CHECK(!secp256k1_ecmult_multi_params_from_bytes(&params, buf2));
+    memcpy(buf2, buf, sizeof(buf));
+    memset(&buf2[5 + 4], 0, 4);
+    CHECK(!secp256k1_ecmult_multi_params_from_bytes(&params, buf2));
+    memcpy(buf2, buf, sizeof(buf));
+    buf2[ECMULT_MULTI_PARAMS_SIZE - 1] = 0xFE;
+    CHECK(!secp256k1_ecmult_multi_params_from_bytes(&params, buf2));
+    CHECK(secp256k1_memcmp_var(&params, &secp256k1_ecmult_multi_params_default, sizeof(params)) == 0);
+
+    /* Pippenger's algorithm for any number of points, with every bucket window
+     * used for some of them */
+    ecmult_multi_test_params.pippenger_threshold = 1;
+    for (i = 0; i < PIPPENGER_MAX_BUCKET_WINDOW; i++) {
+        ecmult_multi_test_params.pippenger_max_points[i] = i + 1;
+    }
+    ecmult_multi_test_params.pippenger_max_points[PIPPENGER_MAX_BUCKET_WINDOW - 1] = SIZE_MAX;
+    test_ecmult_multi_params_valid(&ecmult_multi_test_params);
+    test_ecmult_multi(scratch, ecmult_multi_with_test_params);
+
+    /* Strauss' algorithm for any number of points */
+    ecmult_multi_test_params = secp256k1_ecmult_multi_params_default;
+    ecmult_multi_test_params.pippenger_threshold = SIZE_MAX;
+    test_ecmult_multi(scratch, ecmult_multi_with_test_params);
+}
+
+static void test_ecmult_multi_tuning_api(secp256k1_scratch *scratch) {
+    secp256k1_context *ctx = secp256k1_context_create(SECP256K1_CONTEXT_NONE);
+    secp256k1_context *ctx_clone;
+    unsigned char def[SECP256K1_ECMULT_MULTI_TUNING_SIZE];
+    unsigned char tuned[SECP256K1_ECMULT_MULTI_TUNING_SIZE];
+    unsigned char out[SECP256K1_ECMULT_MULTI_TUNING_SIZE];
+    secp256k1_ecmult_multi_params params;
+
+    /* New contexts use the compiled-in parameters */
+    CHECK(secp256k1_context_serialize_ecmult_multi_tuning(ctx, def) == 1);
+    secp256k1_ecmult_multi_params_to_bytes(out, &secp256k1_ecmult_multi_params_default);
+    CHECK(secp256k1_memcmp_var(def, out, sizeof(out)) == 0);
+    CHECK(secp256k1_context_serialize_ecmult_multi_tuning(STATIC_CTX, out) == 1);
+    CHECK(secp256k1_memcmp_var(def, out, sizeof(out)) == 0);
+
+    /* Tuning results in valid parameters that give correct results */
+    CHECK(secp256k1_context_tune_ecmult_multi(ctx) == 1);
+    test_ecmult_multi_params_valid(&ctx->ecmult_multi_params);
+    CHECK(secp256k1_context_serialize_ecmult_multi_tuning(ctx, tuned) == 1);
+    CHECK(secp256k1_ecmult_multi_params_from_bytes(&params, tuned));
+    CHECK(secp256k1_memcmp_var(&params, &ctx->ecmult_multi_params, sizeof(params)) == 0);
+    ecmult_multi_test_params = ctx->ecmult_multi_params;
+    test_ecmult_multi(scratch, ecmult_multi_with_test_params);
+
+    /* Clones inherit the tuning */
+    ctx_clone = secp256k1_context_clone(ctx);
+    CHECK(secp256k1_context_serialize_ecmult_multi_tuning(ctx_clone, out) == 1);
+    CHECK(secp256k1_memcmp_var(tuned, out, sizeof(out)) == 0);
+
+    /* Restoring a tuning */
+    CHECK(secp256k1_context_parse_ecmult_multi_tuning(ctx_clone, def) == 1);
+    CHECK(secp256k1_context_serialize_ecmult_multi_tuning(ctx_clone, out) == 1);
+    CHECK(secp256k1_memcmp_var(def, out, sizeof(out)) == 0);
+    CHECK(secp256k1_context_parse_ecmult_multi_tuning(ctx_clone, tuned) == 1);
+    CHECK(context_eq(ctx, ctx_clone));
+    memcpy(out, tuned, sizeof(out));
+    out[0] = 0;
+    CHECK(secp256k1_context_parse_ecmult_multi_tuning(ctx_clone, out) == 0);
+    CHECK(context_eq(ctx, ctx_clone));
+
+    /* Illegal arguments */
+    CHECK_ILLEGAL(STATIC_CTX, secp256k1_context_tune_ecmult_multi(STATIC_CTX));
+    CHECK_ILLEGAL(STATIC_CTX, secp256k1_context_parse_ecmult_multi_tuning(STATIC_CTX, def));
+    CHECK_ILLEGAL(ctx, secp256k1_context_parse_ecmult_multi_tuning(ctx, NULL));
+    CHECK_ILLEGAL(ctx, secp256k1_context_serialize_ecmult_multi_tuning(ctx, NULL));
+
+    secp256k1_context_destroy(ctx_clone);
+    secp256k1_context_destroy(ctx);
+}
+
 static void run_ecmult_multi_tests(void) {
     secp256k1_scratch *scratch;
     int64_t todo = (int64_t)320 * COUNT;
 
+    test_ecmult_multi_scratch_size();
+    test_ecmult_multi_api();
+    test_ecmult_multi_array_api();
+    /* Simple, Strauss' and Pippenger's algorithm, the latter in several batches */
+    test_ecmult_multi_input(5, 0);
+    test_ecmult_multi_input(5, secp256k1_strauss_scratch_size(5) + STRAUSS_SCRATCH_OBJECTS*ALIGNMENT);
+    test_ecmult_multi_input(2*ECMULT_PIPPENGER_THRESHOLD, secp256k1_pippenger_scratch_size(ECMULT_PIPPENGER_THRESHOLD, secp256k1_pippenger_bucket_window(ECMULT_PIPPENGER_THRESHOLD)) + PIPPENGER_SCRATCH_OBJECTS*ALIGNMENT);
+    /* Fixed bases, processed one by one, in batches and all at once */
+    test_ecmult_multi_fixed(1, 2, 1, 0);
+    test_ecmult_multi_fixed(5, WINDOW_A, 3, 0);
+    test_ecmult_multi_fixed(7, ECMULT_FIXED_BASES_WINDOW, ECMULT_FIXED_BASES_MAX_CHUNKS, 2);
+    test_ecmult_multi_fixed(20, ECMULT_FIXED_BASES_WINDOW, ECMULT_FIXED_BASES_CHUNKS, 20);
+    test_ecmult_multi_fixed_large();
+    test_ecmult_multi_fixed_scratch_size();
+    test_ecmult_fixed_bases_max_points();
+    test_ecmult_multi_fixed_api();
+    test_ecmult_multi_parallel();
+    test_ecmult_multi_parallel_api();
+
     test_secp256k1_pippenger_bucket_window_inv();
     test_ecmult_multi_pippenger_max_points();
+    test_ecmult_pippenger_affine(PIPPENGER_AFFINE_MIN_BUCKET_WINDOW);
+    test_ecmult_pippenger_affine(PIPPENGER_MAX_BUCKET_WINDOW);
     scratch = secp256k1_scratch_create(&CTX->error_callback, 819200);
     test_ecmult_multi(scratch, secp256k1_ecmult_multi_var);
     test_ecmult_multi(NULL, secp256k1_ecmult_multi_var);
@@ -5244,6 +6480,9 @@ static void run_ecmult_multi_tests(void) {
     test_ecmult_multi_batch_single(secp256k1_ecmult_pippenger_batch_single);
     test_ecmult_multi(scratch, secp256k1_ecmult_strauss_batch_single);
     test_ecmult_multi_batch_single(secp256k1_ecmult_strauss_batch_single);
+    test_ecmult_multi(scratch, ecmult_multi_parallel_3);
+    test_ecmult_multi_params(scratch);
+    test_ecmult_multi_tuning_api(scratch);
     while (todo > 0) {
         todo -= test_ecmult_multi_random(scratch);
     }
@@ -5636,6 +6875,97 @@ static void run_ecmult_gen_blind(void) {
     }
 }
 
+static void test_ecmult_gen_generator(int blocks, int teeth) {
+    /* Test comb tables for a generator H other than G against ecmult_const. */
+    secp256k1_ecmult_gen_context gen_ctx;
+    secp256k1_scalar h, s;
+    secp256k1_gej hj, r1, r2;
+    secp256k1_ge hge;
+    unsigned char seed32[32];
+    int i;
+
+    testutil_random_scalar_order_test(&h);
+    secp256k1_ecmult_gen(&CTX->ecmult_gen_ctx, &hj, &h);
+    secp256k1_ge_set_gej(&hge, &hj);
+    CHECK(secp256k1_ecmult_gen_context_build_comb(&gen_ctx, &CTX->error_callback, &hge, blocks, teeth));
+    CHECK(secp256k1_ecmult_gen_context_is_allocated(&gen_ctx));
+    CHECK(secp256k1_ge_eq_var(&gen_ctx.gen, &hge));
+
+    for (i = 0; i < 2 * COUNT; i++) {
+        if (i == COUNT) {
+            testrand256(seed32);
+            secp256k1_ecmult_gen_blind(&gen_ctx, seed32);
+        }
+        testutil_random_scalar_order_test(&s);
+        secp256k1_ecmult_gen(&gen_ctx, &r1, &s);
+        secp256k1_ecmult_const(&r2, &hge, &s);
+        CHECK(secp256k1_gej_eq_var(&r1, &r2));
+    }
+
+    /* 0*H is infinity and 1*H is H, also after resetting the blinding. */
+    secp256k1_ecmult_gen(&gen_ctx, &r1, &secp256k1_scalar_zero);
+    CHECK(secp256k1_gej_is_infinity(&r1));
+    secp256k1_ecmult_gen_blind(&gen_ctx, NULL);
+    secp256k1_ecmult_gen(&gen_ctx, &r1, &secp256k1_scalar_one);
+    CHECK(secp256k1_gej_eq_ge_var(&r1, &hge));
+
+    secp256k1_ecmult_gen_context_free(&gen_ctx);
+    CHECK(!secp256k1_ecmult_gen_context_is_built(&gen_ctx));
+}
+
+static void test_prepared_generator_api(void) {
+    unsigned char h32[32] = { 3 };
+    unsigned char zero[32] = { 0 };
+    unsigned char overflow[32];
+    unsigned char seed32[32];
+    unsigned char scalar32[32];
+    secp256k1_pubkey hpub, result, expected, invalid_pubkey;
+    secp256k1_prepared_generator *prepared;
+    int i;
+
+    memset(overflow, 0xff, sizeof(overflow));
+    memset(&invalid_pubkey, 0, sizeof(invalid_pubkey));
+    CHECK(secp256k1_ec_pubkey_create(CTX, &hpub, h32) == 1);
+    prepared = secp256k1_prepared_generator_create(STATIC_CTX, &hpub);
+    CHECK(prepared != NULL);
+
+    for (i = 0; i < COUNT; i++) {
+        if (i == COUNT / 2) {
+            testrand256(seed32);
+            CHECK(secp256k1_prepared_generator_randomize(STATIC_CTX, prepared, seed32) == 1);
+        }
+        testutil_random_scalar_order_b32(scalar32);
+        CHECK(secp256k1_prepared_generator_mul(STATIC_CTX, &result, scalar32, prepared) == 1);
+        expected = hpub;
+        CHECK(secp256k1_ec_pubkey_tweak_mul(CTX, &expected, scalar32) == 1);
+        CHECK(secp256k1_memcmp_var(&result, &expected, sizeof(result)) == 0);
+    }
+    CHECK(secp256k1_prepared_generator_randomize(CTX, prepared, NULL) == 1);
+
+    /* Scalars that are not valid secret keys are rejected. */
+    CHECK(secp256k1_prepared_generator_mul(CTX, &result, zero, prepared) == 0);
+    CHECK(secp256k1_memcmp_var(&result, &invalid_pubkey, sizeof(result)) == 0);
+    CHECK(secp256k1_prepared_generator_mul(CTX, &result, overflow, prepared) == 0);
+    CHECK(secp256k1_memcmp_var(&result, &invalid_pubkey, sizeof(result)) == 0);
+
+    CHECK_ILLEGAL_VOID(CTX, CHECK(secp256k1_prepared_generator_create(CTX, NULL) == NULL));
+    CHECK_ILLEGAL_VOID(CTX, CHECK(secp256k1_prepared_generator_create(CTX, &invalid_pubkey) == NULL));
+    CHECK_ILLEGAL(CTX, secp256k1_prepared_generator_randomize(CTX, NULL, seed32));
+    CHECK_ILLEGAL(CTX, secp256k1_prepared_generator_mul(CTX, NULL, scalar32, prepared));
+    CHECK_ILLEGAL(CTX, secp256k1_prepared_generator_mul(CTX, &result, NULL, prepared));
+    CHECK_ILLEGAL(CTX, secp256k1_prepared_generator_mul(CTX, &result, scalar32, NULL));
+
+    secp256k1_prepared_generator_destroy(CTX, prepared);
+    secp256k1_prepared_generator_destroy(CTX, NULL);
+}
+
+static void run_ecmult_gen_generator_tests(void) {
+    test_ecmult_gen_generator(COMB_BLOCKS, COMB_TEETH);
+    test_ecmult_gen_generator(1, 8);
+    test_ecmult_gen_generator(43, 6);
+    test_prepared_generator_api();
+}
+
 /***** ENDOMORPHISH TESTS *****/
 static void test_scalar_split(const secp256k1_scalar* full) {
     secp256k1_scalar s, s1, slam;
@@ -6322,10 +7652,10 @@ static void test_ecdsa_sign_verify(void) {
     } else {
         random_sign(&sigr, &sigs, &key, &msg, NULL);
     }
-    CHECK(secp256k1_ecdsa_sig_verify(&sigr, &sigs, &pub, &msg));
+    CHECK(secp256k1_ecdsa_sig_verify(&CTX->ecmult_tables, &sigr, &sigs, &pub, &msg));
     secp256k1_scalar_set_int(&one, 1);
     secp256k1_scalar_add(&msg, &msg, &one);
-    CHECK(!secp256k1_ecdsa_sig_verify(&sigr, &sigs, &pub, &msg));
+    CHECK(!secp256k1_ecdsa_sig_verify(&CTX->ecmult_tables, &sigr, &sigs, &pub, &msg));
 }
 
 static void run_ecdsa_sign_verify(void) {
@@ -6335,6 +7665,193 @@ static void run_ecdsa_sign_verify(void) {
     }
 }
 
+#define N_SIGS 40
+/* Checks that secp256k1_ecdsa_verify_many gives the same results as
+ * verifying the signatures one by one. */
+static void test_ecdsa_verify_many(void) {
+    unsigned char seckey[32];
+    unsigned char msg[N_SIGS][32];
+    const unsigned char *msg_ptr[N_SIGS];
+    secp256k1_ecdsa_signature sig[N_SIGS];
+    const secp256k1_ecdsa_signature *sig_ptr[N_SIGS];
+    secp256k1_pubkey pubkey[N_SIGS];
+    const secp256k1_pubkey *pubkey_ptr[N_SIGS];
+    int results[N_SIGS];
+    size_t n_sigs = testrand_int(N_SIGS + 1);
+    int all_valid = 1;
+    int ret;
+    size_t i;
+
+    for (i = 0; i < N_SIGS; i++) {
+        msg_ptr[i] = msg[i];
+        sig_ptr[i] = &sig[i];
+        pubkey_ptr[i] = &pubkey[i];
+    }
+    for (i = 0; i < n_sigs; i++) {
+        unsigned char sig64[64];
+        secp256k1_scalar sk;
+        testutil_random_scalar_order_test(&sk);
+        secp256k1_scalar_get_b32(seckey, &sk);
+        testrand256_test(msg[i]);
+        CHECK(secp256k1_ec_pubkey_create(CTX, &pubkey[i], seckey) == 1);
+        CHECK(secp256k1_ecdsa_sign(CTX, &sig[i], msg[i], seckey, NULL, NULL) == 1);
+        CHECK(secp256k1_ecdsa_signature_serialize_compact(CTX, sig64, &sig[i]) == 1);
+        switch (testrand_int(6)) {
+        case 0:
+            /* Wrong message */
+            msg[i][testrand_int(32)] ^= 1 + testrand_int(255);
+            break;
+        case 1:
+            /* High S */
+            secp256k1_scalar_set_b32(&sk, &sig64[32], NULL);
+            secp256k1_scalar_negate(&sk, &sk);
+            secp256k1_scalar_get_b32(&sig64[32], &sk);
+            CHECK(secp256k1_ecdsa_signature_parse_compact(CTX, &sig[i], sig64) == 1);
+            break;
+        case 2:
+            /* Zero r or s */
+            memset(&sig64[testrand_bits(1) * 32], 0, 32);
+            CHECK(secp256k1_ecdsa_signature_parse_compact(CTX, &sig[i], sig64) == 1);
+            break;
+        }
+    }
+
+    memset(results, 0xff, sizeof(results));
+    ret = secp256k1_ecdsa_verify_many(CTX, results, sig_ptr, msg_ptr, pubkey_ptr, n_sigs);
+    for (i = 0; i < n_sigs; i++) {
+        int expected = secp256k1_ecdsa_verify(CTX, &sig[i], msg[i], &pubkey[i]);
+        CHECK(results[i] == expected);
+        all_valid &= expected;
+    }
+    CHECK(ret == all_valid);
+    CHECK(secp256k1_ecdsa_verify_many(CTX, NULL, sig_ptr, msg_ptr, pubkey_ptr, n_sigs) == all_valid);
+}
+#undef N_SIGS
+
+static void test_ecdsa_verify_many_api(void) {
+    unsigned char seckey[32] = { 1 };
+    unsigned char msg[32] = { 2 };
+    const unsigned char *msg_ptr[2];
+    secp256k1_ecdsa_signature sig;
+    const secp256k1_ecdsa_signature *sig_ptr[2];
+    secp256k1_pubkey pubkey;
+    secp256k1_pubkey invalid_pubkey;
+    const secp256k1_pubkey *pubkey_ptr[2];
+    int results[2];
+
+    memset(&invalid_pubkey, 0, sizeof(invalid_pubkey));
+    CHECK(secp256k1_ec_pubkey_create(CTX, &pubkey, seckey) == 1);
+    CHECK(secp256k1_ecdsa_sign(CTX, &sig, msg, seckey, NULL, NULL) == 1);
+    msg_ptr[0] = msg_ptr[1] = msg;
+    sig_ptr[0] = sig_ptr[1] = &sig;
+    pubkey_ptr[0] = pubkey_ptr[1] = &pubkey;
+
+    CHECK(secp256k1_ecdsa_verify_many(CTX, results, sig_ptr, msg_ptr, pubkey_ptr, 2) == 1);
+    CHECK(results[0] == 1 && results[1] == 1);
+    CHECK(secp256k1_ecdsa_verify_many(CTX, NULL, NULL, NULL, NULL, 0) == 1);
+    CHECK_ILLEGAL(CTX, secp256k1_ecdsa_verify_many(CTX, results, NULL, msg_ptr, pubkey_ptr, 2));
+    CHECK_ILLEGAL(CTX, secp256k1_ecdsa_verify_many(CTX, results, sig_ptr, NULL, pubkey_ptr, 2));
+    CHECK_ILLEGAL(CTX, secp256k1_ecdsa_verify_many(CTX, results, sig_ptr, msg_ptr, NULL, 2));
+    sig_ptr[1] = NULL;
+    CHECK_ILLEGAL(CTX, secp256k1_ecdsa_verify_many(CTX, results, sig_ptr, msg_ptr, pubkey_ptr, 2));
+    sig_ptr[1] = &sig;
+    msg_ptr[1] = NULL;
+    CHECK_ILLEGAL(CTX, secp256k1_ecdsa_verify_many(CTX, results, sig_ptr, msg_ptr, pubkey_ptr, 2));
+    msg_ptr[1] = msg;
+    pubkey_ptr[1] = NULL;
+    CHECK_ILLEGAL(CTX, secp256k1_ecdsa_verify_many(CTX, results, sig_ptr, msg_ptr, pubkey_ptr, 2));
+    /* An invalid public key calls the illegal callback but the other
+     * signatures are still verified */
+    pubkey_ptr[1] = &invalid_pubkey;
+    CHECK_ILLEGAL(CTX, secp256k1_ecdsa_verify_many(CTX, results, sig_ptr, msg_ptr, pubkey_ptr, 2));
+    CHECK(results[0] == 1 && results[1] == 0);
+}
+static void run_ecdsa_verify_many(void) {
+    int i;
+    test_ecdsa_verify_many_api();
+    for (i = 0; i < COUNT; i++) {
+        test_ecdsa_verify_many();
+    }
+}
+
+static void test_ecdsa_verify_prepared(void) {
+    unsigned char seckey[32];
+    unsigned char msg[32];
+    unsigned char sig64[64];
+    secp256k1_ecdsa_signature sig;
+    secp256k1_pubkey pubkey;
+    secp256k1_prepared_pubkey *prepared;
+    secp256k1_scalar sk;
+    int i;
+
+    testutil_random_scalar_order_test(&sk);
+    secp256k1_scalar_get_b32(seckey, &sk);
+    CHECK(secp256k1_ec_pubkey_create(CTX, &pubkey, seckey) == 1);
+    prepared = secp256k1_prepared_pubkey_create(CTX, &pubkey);
+    CHECK(prepared != NULL);
+
+    for (i = 0; i < COUNT; i++) {
+        testrand256_test(msg);
+        CHECK(secp256k1_ecdsa_sign(CTX, &sig, msg, seckey, NULL, NULL) == 1);
+        CHECK(secp256k1_ecdsa_verify_prepared(CTX, &sig, msg, prepared) == 1);
+        CHECK(secp256k1_ecdsa_signature_serialize_compact(CTX, sig64, &sig) == 1);
+        switch (testrand_int(3)) {
+        case 0:
+            /* Wrong message */
+            msg[testrand_int(32)] ^= 1 + testrand_int(255);
+            break;
+        case 1:
+            /* High S */
+            secp256k1_scalar_set_b32(&sk, &sig64[32], NULL);
+            secp256k1_scalar_negate(&sk, &sk);
+            secp256k1_scalar_get_b32(&sig64[32], &sk);
+            CHECK(secp256k1_ecdsa_signature_parse_compact(CTX, &sig, sig64) == 1);
+            break;
+        case 2:
+            /* Zero r or s */
+            memset(&sig64[testrand_bits(1) * 32], 0, 32);
+            CHECK(secp256k1_ecdsa_signature_parse_compact(CTX, &sig, sig64) == 1);
+            break;
+        }
+        CHECK(secp256k1_ecdsa_verify_prepared(CTX, &sig, msg, prepared) == 0);
+        CHECK(secp256k1_ecdsa_verify(CTX, &sig, msg, &pubkey) == 0);
+    }
+    secp256k1_prepared_pubkey_destroy(CTX, prepared);
+}
+
+static void test_ecdsa_verify_prepared_api(void) {
+    unsigned char seckey[32] = { 1 };
+    unsigned char msg[32] = { 2 };
+    secp256k1_ecdsa_signature sig;
+    secp256k1_pubkey pubkey;
+    secp256k1_pubkey invalid_pubkey;
+    secp256k1_prepared_pubkey *prepared;
+
+    memset(&invalid_pubkey, 0, sizeof(invalid_pubkey));
+    CHECK(secp256k1_ec_pubkey_create(CTX, &pubkey, seckey) == 1);
+    CHECK(secp256k1_ecdsa_sign(CTX, &sig, msg, seckey, NULL, NULL) == 1);
+    prepared = secp256k1_prepared_pubkey_create(STATIC_CTX, &pubkey);
+    CHECK(prepared != NULL);
+    CHECK(secp256k1_ecdsa_verify_prepared(STATIC_CTX, &sig, msg, prepared) == 1);
+
+    CHECK_ILLEGAL_VOID(CTX, CHECK(secp256k1_prepared_pubkey_create(CTX, NULL) == NULL));
+    CHECK_ILLEGAL_VOID(CTX, CHECK(secp256k1_prepared_pubkey_create(CTX, &invalid_pubkey) == NULL));
+    CHECK_ILLEGAL(CTX, secp256k1_ecdsa_verify_prepared(CTX, NULL, msg, prepared));
+    CHECK_ILLEGAL(CTX, secp256k1_ecdsa_verify_prepared(CTX, &sig, NULL, prepared));
+    CHECK_ILLEGAL(CTX, secp256k1_ecdsa_verify_prepared(CTX, &sig, msg, NULL));
+
+    secp256k1_prepared_pubkey_destroy(CTX, prepared);
+    secp256k1_prepared_pubkey_destroy(CTX, NULL);
+}
+
+static void run_ecdsa_verify_prepared(void) {
+    int i;
+    test_ecdsa_verify_prepared_api();
+    for (i = 0; i < 4; i++) {
+        test_ecdsa_verify_prepared();
+    }
+}
+
 /** Dummy nonce generation function that just uses a precomputed nonce, and fails if it is not accepted. Use only for testing. */
 static int precomputed_nonce_function(unsigned char *nonce32, const unsigned char *msg32, const unsigned char *key32, const unsigned char *algo16, void *data, unsigned int counter) {
     (void)msg32;
@@ -7092,7 +8609,7 @@ static void test_ecdsa_edge_cases(void) {
         secp256k1_ecmult_gen(&CTX->ecmult_gen_ctx, &keyj, &sr);
         secp256k1_ge_set_gej(&key, &keyj);
         msg = ss;
-        CHECK(secp256k1_ecdsa_sig_verify(&sr, &ss, &key, &msg) == 0);
+        CHECK(secp256k1_ecdsa_sig_verify(&CTX->ecmult_tables, &sr, &ss, &key, &msg) == 0);
     }
 
     /* Verify signature with r of zero fails. */
@@ -7111,7 +8628,7 @@ static void test_ecdsa_edge_cases(void) {
         secp256k1_scalar_set_int(&msg, 0);
         secp256k1_scalar_set_int(&sr, 0);
         CHECK(secp256k1_eckey_pubkey_parse(&key, pubkey_mods_zero, 33));
-        CHECK(secp256k1_ecdsa_sig_verify( &sr, &ss, &key, &msg) == 0);
+        CHECK(secp256k1_ecdsa_sig_verify( &CTX->ecmult_tables, &sr, &ss, &key, &msg) == 0);
     }
 
     /* Verify signature with s of zero fails. */
@@ -7130,7 +8647,7 @@ static void test_ecdsa_edge_cases(void) {
         secp256k1_scalar_set_int(&msg, 0);
         secp256k1_scalar_set_int(&sr, 1);
         CHECK(secp256k1_eckey_pubkey_parse(&key, pubkey, 33));
-        CHECK(secp256k1_ecdsa_sig_verify(&sr, &ss, &key, &msg) == 0);
+        CHECK(secp256k1_ecdsa_sig_verify(&CTX->ecmult_tables, &sr, &ss, &key, &msg) == 0);
     }
 
     /* Verify signature with message 0 passes. */
@@ -7158,14 +8675,14 @@ static void test_ecdsa_edge_cases(void) {
         secp256k1_scalar_set_int(&sr, 2);
         CHECK(secp256k1_eckey_pubkey_parse(&key, pubkey, 33));
         CHECK(secp256k1_eckey_pubkey_parse(&key2, pubkey2, 33));
-        CHECK(secp256k1_ecdsa_sig_verify(&sr, &ss, &key, &msg) == 1);
-        CHECK(secp256k1_ecdsa_sig_verify(&sr, &ss, &key2, &msg) == 1);
+        CHECK(secp256k1_ecdsa_sig_verify(&CTX->ecmult_tables, &sr, &ss, &key, &msg) == 1);
+        CHECK(secp256k1_ecdsa_sig_verify(&CTX->ecmult_tables, &sr, &ss, &key2, &msg) == 1);
         secp256k1_scalar_negate(&ss, &ss);
-        CHECK(secp256k1_ecdsa_sig_verify(&sr, &ss, &key, &msg) == 1);
-        CHECK(secp256k1_ecdsa_sig_verify(&sr, &ss, &key2, &msg) == 1);
+        CHECK(secp256k1_ecdsa_sig_verify(&CTX->ecmult_tables, &sr, &ss, &key, &msg) == 1);
+        CHECK(secp256k1_ecdsa_sig_verify(&CTX->ecmult_tables, &sr, &ss, &key2, &msg) == 1);
         secp256k1_scalar_set_int(&ss, 1);
-        CHECK(secp256k1_ecdsa_sig_verify(&sr, &ss, &key, &msg) == 0);
-        CHECK(secp256k1_ecdsa_sig_verify(&sr, &ss, &key2, &msg) == 0);
+        CHECK(secp256k1_ecdsa_sig_verify(&CTX->ecmult_tables, &sr, &ss, &key, &msg) == 0);
+        CHECK(secp256k1_ecdsa_sig_verify(&CTX->ecmult_tables, &sr, &ss, &key2, &msg) == 0);
     }
 
     /* Verify signature with message 1 passes. */
@@ -7199,15 +8716,15 @@ static void test_ecdsa_edge_cases(void) {
         secp256k1_scalar_set_b32(&sr, csr, NULL);
         CHECK(secp256k1_eckey_pubkey_parse(&key, pubkey, 33));
         CHECK(secp256k1_eckey_pubkey_parse(&key2, pubkey2, 33));
-        CHECK(secp256k1_ecdsa_sig_verify(&sr, &ss, &key, &msg) == 1);
-        CHECK(secp256k1_ecdsa_sig_verify(&sr, &ss, &key2, &msg) == 1);
+        CHECK(secp256k1_ecdsa_sig_verify(&CTX->ecmult_tables, &sr, &ss, &key, &msg) == 1);
+        CHECK(secp256k1_ecdsa_sig_verify(&CTX->ecmult_tables, &sr, &ss, &key2, &msg) == 1);
         secp256k1_scalar_negate(&ss, &ss);
-        CHECK(secp256k1_ecdsa_sig_verify(&sr, &ss, &key, &msg) == 1);
-        CHECK(secp256k1_ecdsa_sig_verify(&sr, &ss, &key2, &msg) == 1);
+        CHECK(secp256k1_ecdsa_sig_verify(&CTX->ecmult_tables, &sr, &ss, &key, &msg) == 1);
+        CHECK(secp256k1_ecdsa_sig_verify(&CTX->ecmult_tables, &sr, &ss, &key2, &msg) == 1);
         secp256k1_scalar_set_int(&ss, 2);
         secp256k1_scalar_inverse_var(&ss, &ss);
-        CHECK(secp256k1_ecdsa_sig_verify(&sr, &ss, &key, &msg) == 0);
-        CHECK(secp256k1_ecdsa_sig_verify(&sr, &ss, &key2, &msg) == 0);
+        CHECK(secp256k1_ecdsa_sig_verify(&CTX->ecmult_tables, &sr, &ss, &key, &msg) == 0);
+        CHECK(secp256k1_ecdsa_sig_verify(&CTX->ecmult_tables, &sr, &ss, &key2, &msg) == 0);
     }
 
     /* Verify signature with message -1 passes. */
@@ -7233,12 +8750,12 @@ static void test_ecdsa_edge_cases(void) {
         secp256k1_scalar_negate(&msg, &msg);
         secp256k1_scalar_set_b32(&sr, csr, NULL);
         CHECK(secp256k1_eckey_pubkey_parse(&key, pubkey, 33));
-        CHECK(secp256k1_ecdsa_sig_verify(&sr, &ss, &key, &msg) == 1);
+        CHECK(secp256k1_ecdsa_sig_verify(&CTX->ecmult_tables, &sr, &ss, &key, &msg) == 1);
         secp256k1_scalar_negate(&ss, &ss);
-        CHECK(secp256k1_ecdsa_sig_verify(&sr, &ss, &key, &msg) == 1);
+        CHECK(secp256k1_ecdsa_sig_verify(&CTX->ecmult_tables, &sr, &ss, &key, &msg) == 1);
         secp256k1_scalar_set_int(&ss, 3);
         secp256k1_scalar_inverse_var(&ss, &ss);
-        CHECK(secp256k1_ecdsa_sig_verify(&sr, &ss, &key, &msg) == 0);
+        CHECK(secp256k1_ecdsa_sig_verify(&CTX->ecmult_tables, &sr, &ss, &key, &msg) == 0);
     }
 
     /* Signature where s would be zero. */
@@ -7747,6 +9264,8 @@ int main(int argc, char **argv) {
     run_proper_context_tests(0); run_proper_context_tests(1);
     run_static_context_tests(0); run_static_context_tests(1);
     run_deprecated_context_flags_test();
+    run_context_ecmult_window_tests();
+    run_context_ecmult_gen_comb_tests();
 
     /* scratch tests */
     run_scratch_tests();
@@ -7758,6 +9277,7 @@ int main(int argc, char **argv) {
     run_ctz_tests();
     run_modinv_tests();
     run_inverse_tests();
+    run_inverse_all_tests();
 
     /* sorting tests */
     run_hsort_tests();
@@ -7765,9 +9285,11 @@ int main(int argc, char **argv) {
     /* hash tests */
     run_sha256_known_output_tests();
     run_sha256_counter_tests();
+    run_sha256_transform_tests();
     run_hmac_sha256_tests();
     run_rfc6979_hmac_sha256_tests();
     run_tagged_sha256_tests();
+    run_tagged_sha256_midstate_tests();
 
     /* scalar tests */
     run_scalar_tests();
@@ -7791,9 +9313,12 @@ int main(int argc, char **argv) {
     run_wnaf();
     run_point_times_order();
     run_ecmult_near_split_bound();
+    run_ecmult_point_table_tests();
+    run_ecmult_interleaved_tests();
     run_ecmult_chain();
     run_ecmult_constants();
     run_ecmult_gen_blind();
+    run_ecmult_gen_generator_tests();
     run_ecmult_const_tests();
     run_ecmult_multi_tests();
     run_ec_combine();
@@ -7822,6 +9347,8 @@ int main(int argc, char **argv) {
     run_random_pubkeys();
     run_ecdsa_der_parse();
     run_ecdsa_sign_verify();
+    run_ecdsa_verify_many();
+    run_ecdsa_verify_prepared();
     run_ecdsa_end_to_end();
     run_ecdsa_edge_cases();
     run_ecdsa_wycheproof();